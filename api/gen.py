@@ -513,9 +513,12 @@ mesh.add('getEmbedded', doc, None, iint('dim'), iint('tag'), ovectorpair('dimTag
 doc = '''Reorder the elements of type `elementType' classified on the entity of tag `tag' according to the `ordering' vector.'''
 mesh.add('reorderElements', doc, None, iint('elementType'), iint('tag'), ivectorsize('ordering'))
 
-doc = '''Compute a renumbering vector `newTags' corresponding to the input tags `oldTags' for a given list of element tags `elementTags'. If `elementTags' is empty, compute the renumbering on the full mesh. If `method' is equal to "RCMK", compute a node renumering with Reverse Cuthill McKee. If `method' is equal to "Hilbert", compute a node renumering along a Hilbert curve. If `method' is equal to "Metis", compute a node renumering using Metis. Element renumbering is not available yet.'''
+doc = '''Compute a renumbering vector `newTags' corresponding to the input tags `oldTags' for a given list of element tags `elementTags'. If `elementTags' is empty, compute the renumbering on the full mesh. If `method' is equal to "RCMK", compute a node renumering with Reverse Cuthill McKee. If `method' is equal to "Hilbert", compute a node renumering along a Hilbert curve. If `method' is equal to "Metis", compute a node renumering using Metis. See `computeNodeAndElementRenumbering' to also renumber the elements.'''
 mesh.add('computeRenumbering', doc, None, ovectorsize('oldTags'), ovectorsize('newTags'), istring('method', '"RCMK"'), ivectorsize('elementTags', 'std::vector<std::size_t>()', '[]', '[]'))
 
+doc = '''Compute a node renumbering (`oldNodeTags', `newNodeTags') and a consistent element renumbering (`oldElementTags', `newElementTags') for a given list of element tags `elementTags', using the same node graph for both. If `elementTags' is empty, compute the renumbering on the full mesh. The node renumbering is computed with `method' (see `computeRenumbering'); the elements are then sorted according to the smallest new tag of their nodes, and receive a permutation of their current tags. The bandwidth and profile of the node graph before and after renumbering are printed.'''
+mesh.add('computeNodeAndElementRenumbering', doc, None, ovectorsize('oldNodeTags'), ovectorsize('newNodeTags'), ovectorsize('oldElementTags'), ovectorsize('newElementTags'), istring('method', '"RCMK"'), ivectorsize('elementTags', 'std::vector<std::size_t>()', '[]', '[]'))
+
 doc = '''Renumber the node tags. If no explicit renumbering is provided through the `oldTags' and `newTags' vectors, renumber the nodes in a continuous sequence, taking into account the subset of elements to be saved later on if the option "Mesh.SaveAll" is not set.'''
 mesh.add('renumberNodes', doc, None, ivectorsize('oldTags', 'std::vector<std::size_t>()', '[]', '[]'), ivectorsize('newTags', 'std::vector<std::size_t>()', '[]', '[]'))
 
@@ -1208,6 +1211,12 @@ logger.add('getWallTime', doc, odouble)
 doc = '''Return CPU time.'''
 logger.add('getCpuTime', doc, odouble)
 
+doc = '''Write the profile of the operations performed since the initialization of Gmsh (or since the last call to `resetProfile'), i.e. the wall and CPU times, the peak memory usage and the counters (number of insertions, swaps, ...) of each stage (meshing, optimization, input/output, ...), for each model entity when relevant. The profile is written in JSON format, or in CSV format if the extension of `fileName' is ".csv".'''
+logger.add('writeProfile', doc, None, istring('fileName'))
+
+doc = '''Reset the profile of the operations.'''
+logger.add('resetProfile', doc, None)
+
 doc = '''Return last error message, if any.'''
 logger.add('getLastError', doc, None, ostring('error'))
 
@@ -72,6 +72,10 @@ module gmsh
         gmshLoggerGetWallTime
     procedure, nopass :: getCpuTime => &
         gmshLoggerGetCpuTime
+    procedure, nopass :: writeProfile => &
+        gmshLoggerWriteProfile
+    procedure, nopass :: resetProfile => &
+        gmshLoggerResetProfile
     procedure, nopass :: getLastError => &
         gmshLoggerGetLastError
   end type gmsh_logger_t
@@ -676,6 +680,8 @@ module gmsh
         gmshModelMeshReorderElements
     procedure, nopass :: computeRenumbering => &
         gmshModelMeshComputeRenumbering
+    procedure, nopass :: computeNodeAndElementRenumbering => &
+        gmshModelMeshComputeNodeAndElementRenumbering
     procedure, nopass :: renumberNodes => &
         gmshModelMeshRenumberNodes
     procedure, nopass :: renumberElements => &
@@ -6600,8 +6606,8 @@ module gmsh
   !! is empty, compute the renumbering on the full mesh. If `method' is equal to
   !! "RCMK", compute a node renumering with Reverse Cuthill McKee. If `method'
   !! is equal to "Hilbert", compute a node renumering along a Hilbert curve. If
-  !! `method' is equal to "Metis", compute a node renumering using Metis.
-  !! Element renumbering is not available yet.
+  !! `method' is equal to "Metis", compute a node renumering using Metis. See
+  !! `computeNodeAndElementRenumbering' to also renumber the elements.
   subroutine gmshModelMeshComputeRenumbering(oldTags, &
                                              newTags, &
                                              method, &
@@ -6651,6 +6657,87 @@ module gmsh
       api_newTags_n_)
   end subroutine gmshModelMeshComputeRenumbering
 
+  !> Compute a node renumbering (`oldNodeTags', `newNodeTags') and a consistent
+  !! element renumbering (`oldElementTags', `newElementTags') for a given list
+  !! of element tags `elementTags', using the same node graph for both. If
+  !! `elementTags' is empty, compute the renumbering on the full mesh. The node
+  !! renumbering is computed with `method' (see `computeRenumbering'); the
+  !! elements are then sorted according to the smallest new tag of their nodes,
+  !! and receive a permutation of their current tags. The bandwidth and profile
+  !! of the node graph before and after renumbering are printed.
+  subroutine gmshModelMeshComputeNodeAndElementRenumbering(oldNodeTags, &
+                                                           newNodeTags, &
+                                                           oldElementTags, &
+                                                           newElementTags, &
+                                                           method, &
+                                                           elementTags, &
+                                                           ierr)
+    interface
+    subroutine C_API(api_oldNodeTags_, &
+                     api_oldNodeTags_n_, &
+                     api_newNodeTags_, &
+                     api_newNodeTags_n_, &
+                     api_oldElementTags_, &
+                     api_oldElementTags_n_, &
+                     api_newElementTags_, &
+                     api_newElementTags_n_, &
+                     method, &
+                     api_elementTags_, &
+                     api_elementTags_n_, &
+                     ierr_) &
+      bind(C, name="gmshModelMeshComputeNodeAndElementRenumbering")
+      use, intrinsic :: iso_c_binding
+      type(c_ptr), intent(out) :: api_oldNodeTags_
+      integer(c_size_t), intent(out) :: api_oldNodeTags_n_
+      type(c_ptr), intent(out) :: api_newNodeTags_
+      integer(c_size_t), intent(out) :: api_newNodeTags_n_
+      type(c_ptr), intent(out) :: api_oldElementTags_
+      integer(c_size_t), intent(out) :: api_oldElementTags_n_
+      type(c_ptr), intent(out) :: api_newElementTags_
+      integer(c_size_t), intent(out) :: api_newElementTags_n_
+      character(len=1, kind=c_char), dimension(*), intent(in), optional :: method
+      integer(c_size_t), dimension(*), optional :: api_elementTags_
+      integer(c_size_t), value, intent(in) :: api_elementTags_n_
+      integer(c_int), intent(out), optional :: ierr_
+    end subroutine C_API
+    end interface
+    integer(c_size_t), dimension(:), allocatable, intent(out) :: oldNodeTags
+    integer(c_size_t), dimension(:), allocatable, intent(out) :: newNodeTags
+    integer(c_size_t), dimension(:), allocatable, intent(out) :: oldElementTags
+    integer(c_size_t), dimension(:), allocatable, intent(out) :: newElementTags
+    character(len=*), intent(in), optional :: method
+    integer(c_size_t), dimension(:), intent(in), optional :: elementTags
+    integer(c_int), intent(out), optional :: ierr
+    type(c_ptr) :: api_oldNodeTags_
+    integer(c_size_t) :: api_oldNodeTags_n_
+    type(c_ptr) :: api_newNodeTags_
+    integer(c_size_t) :: api_newNodeTags_n_
+    type(c_ptr) :: api_oldElementTags_
+    integer(c_size_t) :: api_oldElementTags_n_
+    type(c_ptr) :: api_newElementTags_
+    integer(c_size_t) :: api_newElementTags_n_
+    call C_API(api_oldNodeTags_=api_oldNodeTags_, &
+         api_oldNodeTags_n_=api_oldNodeTags_n_, &
+         api_newNodeTags_=api_newNodeTags_, &
+         api_newNodeTags_n_=api_newNodeTags_n_, &
+         api_oldElementTags_=api_oldElementTags_, &
+         api_oldElementTags_n_=api_oldElementTags_n_, &
+         api_newElementTags_=api_newElementTags_, &
+         api_newElementTags_n_=api_newElementTags_n_, &
+         method=istring_(optval_c_str("RCMK", method)), &
+         api_elementTags_=elementTags, &
+         api_elementTags_n_=size_gmsh_size(elementTags), &
+         ierr_=ierr)
+    oldNodeTags = ovectorsize_(api_oldNodeTags_, &
+      api_oldNodeTags_n_)
+    newNodeTags = ovectorsize_(api_newNodeTags_, &
+      api_newNodeTags_n_)
+    oldElementTags = ovectorsize_(api_oldElementTags_, &
+      api_oldElementTags_n_)
+    newElementTags = ovectorsize_(api_newElementTags_, &
+      api_newElementTags_n_)
+  end subroutine gmshModelMeshComputeNodeAndElementRenumbering
+
   !> Renumber the node tags. If no explicit renumbering is provided through the
   !! `oldTags' and `newTags' vectors, renumber the nodes in a continuous
   !! sequence, taking into account the subset of elements to be saved later on
@@ -15088,6 +15175,42 @@ module gmsh
     gmshLoggerGetCpuTime = C_API(ierr_=ierr)
   end function gmshLoggerGetCpuTime
 
+  !> Write the profile of the operations performed since the initialization of
+  !! Gmsh (or since the last call to `resetProfile'), i.e. the wall and CPU
+  !! times, the peak memory usage and the counters (number of insertions, swaps,
+  !! ...) of each stage (meshing, optimization, input/output, ...), for each
+  !! model entity when relevant. The profile is written in JSON format, or in
+  !! CSV format if the extension of `fileName' is ".csv".
+  subroutine gmshLoggerWriteProfile(fileName, &
+                                    ierr)
+    interface
+    subroutine C_API(fileName, &
+                     ierr_) &
+      bind(C, name="gmshLoggerWriteProfile")
+      use, intrinsic :: iso_c_binding
+      character(len=1, kind=c_char), dimension(*), intent(in) :: fileName
+      integer(c_int), intent(out), optional :: ierr_
+    end subroutine C_API
+    end interface
+    character(len=*), intent(in) :: fileName
+    integer(c_int), intent(out), optional :: ierr
+    call C_API(fileName=istring_(fileName), &
+         ierr_=ierr)
+  end subroutine gmshLoggerWriteProfile
+
+  !> Reset the profile of the operations.
+  subroutine gmshLoggerResetProfile(ierr)
+    interface
+    subroutine C_API(ierr_) &
+      bind(C, name="gmshLoggerResetProfile")
+      use, intrinsic :: iso_c_binding
+      integer(c_int), intent(out), optional :: ierr_
+    end subroutine C_API
+    end interface
+    integer(c_int), intent(out), optional :: ierr
+    call C_API(ierr_=ierr)
+  end subroutine gmshLoggerResetProfile
+
   !> Return last error message, if any.
   subroutine gmshLoggerGetLastError(error, &
                                     ierr)
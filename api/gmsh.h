@@ -1635,12 +1635,30 @@ namespace gmsh { // Top-level functions
       // to "RCMK", compute a node renumering with Reverse Cuthill McKee. If
       // `method' is equal to "Hilbert", compute a node renumering along a Hilbert
       // curve. If `method' is equal to "Metis", compute a node renumering using
-      // Metis. Element renumbering is not available yet.
+      // Metis. See `computeNodeAndElementRenumbering' to also renumber the
+      // elements.
       GMSH_API void computeRenumbering(std::vector<std::size_t> & oldTags,
                                        std::vector<std::size_t> & newTags,
                                        const std::string & method = "RCMK",
                                        const std::vector<std::size_t> & elementTags = std::vector<std::size_t>());
 
+      // gmsh::model::mesh::computeNodeAndElementRenumbering
+      //
+      // Compute a node renumbering (`oldNodeTags', `newNodeTags') and a consistent
+      // element renumbering (`oldElementTags', `newElementTags') for a given list
+      // of element tags `elementTags', using the same node graph for both. If
+      // `elementTags' is empty, compute the renumbering on the full mesh. The node
+      // renumbering is computed with `method' (see `computeRenumbering'); the
+      // elements are then sorted according to the smallest new tag of their nodes,
+      // and receive a permutation of their current tags. The bandwidth and profile
+      // of the node graph before and after renumbering are printed.
+      GMSH_API void computeNodeAndElementRenumbering(std::vector<std::size_t> & oldNodeTags,
+                                                     std::vector<std::size_t> & newNodeTags,
+                                                     std::vector<std::size_t> & oldElementTags,
+                                                     std::vector<std::size_t> & newElementTags,
+                                                     const std::string & method = "RCMK",
+                                                     const std::vector<std::size_t> & elementTags = std::vector<std::size_t>());
+
       // gmsh::model::mesh::renumberNodes
       //
       // Renumber the node tags. If no explicit renumbering is provided through the
@@ -3997,6 +4015,21 @@ namespace gmsh { // Top-level functions
     // Return CPU time.
     GMSH_API double getCpuTime();
 
+    // gmsh::logger::writeProfile
+    //
+    // Write the profile of the operations performed since the initialization of
+    // Gmsh (or since the last call to `resetProfile'), i.e. the wall and CPU
+    // times, the peak memory usage and the counters (number of insertions, swaps,
+    // ...) of each stage (meshing, optimization, input/output, ...), for each
+    // model entity when relevant. The profile is written in JSON format, or in CSV
+    // format if the extension of `fileName' is ".csv".
+    GMSH_API void writeProfile(const std::string & fileName);
+
+    // gmsh::logger::resetProfile
+    //
+    // Reset the profile of the operations.
+    GMSH_API void resetProfile();
+
     // gmsh::logger::getLastError
     //
     // Return last error message, if any.
@@ -3940,8 +3940,8 @@ for a given list of element tags `elementTags`. If `elementTags` is empty,
 compute the renumbering on the full mesh. If `method` is equal to "RCMK",
 compute a node renumering with Reverse Cuthill McKee. If `method` is equal to
 "Hilbert", compute a node renumering along a Hilbert curve. If `method` is equal
-to "Metis", compute a node renumering using Metis. Element renumbering is not
-available yet.
+to "Metis", compute a node renumering using Metis. See
+`computeNodeAndElementRenumbering` to also renumber the elements.
 
 Return `oldTags`, `newTags`.
 
@@ -3967,6 +3967,50 @@ function computeRenumbering(method = "RCMK", elementTags = Csize_t[])
 end
 const compute_renumbering = computeRenumbering
 
+"""
+    gmsh.model.mesh.computeNodeAndElementRenumbering(method = "RCMK", elementTags = Csize_t[])
+
+Compute a node renumbering (`oldNodeTags`, `newNodeTags`) and a consistent
+element renumbering (`oldElementTags`, `newElementTags`) for a given list of
+element tags `elementTags`, using the same node graph for both. If `elementTags`
+is empty, compute the renumbering on the full mesh. The node renumbering is
+computed with `method` (see `computeRenumbering`); the elements are then sorted
+according to the smallest new tag of their nodes, and receive a permutation of
+their current tags. The bandwidth and profile of the node graph before and after
+renumbering are printed.
+
+Return `oldNodeTags`, `newNodeTags`, `oldElementTags`, `newElementTags`.
+
+Types:
+ - `oldNodeTags`: vector of sizes
+ - `newNodeTags`: vector of sizes
+ - `oldElementTags`: vector of sizes
+ - `newElementTags`: vector of sizes
+ - `method`: string
+ - `elementTags`: vector of sizes
+"""
+function computeNodeAndElementRenumbering(method = "RCMK", elementTags = Csize_t[])
+    api_oldNodeTags_ = Ref{Ptr{Csize_t}}()
+    api_oldNodeTags_n_ = Ref{Csize_t}()
+    api_newNodeTags_ = Ref{Ptr{Csize_t}}()
+    api_newNodeTags_n_ = Ref{Csize_t}()
+    api_oldElementTags_ = Ref{Ptr{Csize_t}}()
+    api_oldElementTags_n_ = Ref{Csize_t}()
+    api_newElementTags_ = Ref{Ptr{Csize_t}}()
+    api_newElementTags_n_ = Ref{Csize_t}()
+    ierr = Ref{Cint}()
+    ccall((:gmshModelMeshComputeNodeAndElementRenumbering, gmsh.lib), Cvoid,
+          (Ptr{Ptr{Csize_t}}, Ptr{Csize_t}, Ptr{Ptr{Csize_t}}, Ptr{Csize_t}, Ptr{Ptr{Csize_t}}, Ptr{Csize_t}, Ptr{Ptr{Csize_t}}, Ptr{Csize_t}, Ptr{Cchar}, Ptr{Csize_t}, Csize_t, Ptr{Cint}),
+          api_oldNodeTags_, api_oldNodeTags_n_, api_newNodeTags_, api_newNodeTags_n_, api_oldElementTags_, api_oldElementTags_n_, api_newElementTags_, api_newElementTags_n_, method, convert(Vector{Csize_t}, elementTags), length(elementTags), ierr)
+    ierr[] != 0 && error(gmsh.logger.getLastError())
+    oldNodeTags = unsafe_wrap(Array, api_oldNodeTags_[], api_oldNodeTags_n_[], own = true)
+    newNodeTags = unsafe_wrap(Array, api_newNodeTags_[], api_newNodeTags_n_[], own = true)
+    oldElementTags = unsafe_wrap(Array, api_oldElementTags_[], api_oldElementTags_n_[], own = true)
+    newElementTags = unsafe_wrap(Array, api_newElementTags_[], api_newElementTags_n_[], own = true)
+    return oldNodeTags, newNodeTags, oldElementTags, newElementTags
+end
+const compute_node_and_element_renumbering = computeNodeAndElementRenumbering
+
 """
     gmsh.model.mesh.renumberNodes(oldTags = Csize_t[], newTags = Csize_t[])
 
@@ -9677,6 +9721,44 @@ function getCpuTime()
 end
 const get_cpu_time = getCpuTime
 
+"""
+    gmsh.logger.writeProfile(fileName)
+
+Write the profile of the operations performed since the initialization of Gmsh
+(or since the last call to `resetProfile`), i.e. the wall and CPU times, the
+peak memory usage and the counters (number of insertions, swaps, ...) of each
+stage (meshing, optimization, input/output, ...), for each model entity when
+relevant. The profile is written in JSON format, or in CSV format if the
+extension of `fileName` is ".csv".
+
+Types:
+ - `fileName`: string
+"""
+function writeProfile(fileName)
+    ierr = Ref{Cint}()
+    ccall((:gmshLoggerWriteProfile, gmsh.lib), Cvoid,
+          (Ptr{Cchar}, Ptr{Cint}),
+          fileName, ierr)
+    ierr[] != 0 && error(gmsh.logger.getLastError())
+    return nothing
+end
+const write_profile = writeProfile
+
+"""
+    gmsh.logger.resetProfile()
+
+Reset the profile of the operations.
+"""
+function resetProfile()
+    ierr = Ref{Cint}()
+    ccall((:gmshLoggerResetProfile, gmsh.lib), Cvoid,
+          (Ptr{Cint},),
+          ierr)
+    ierr[] != 0 && error(gmsh.logger.getLastError())
+    return nothing
+end
+const reset_profile = resetProfile
+
 """
     gmsh.logger.getLastError()
 
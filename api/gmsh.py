@@ -4500,8 +4500,8 @@ class model:
             is empty, compute the renumbering on the full mesh. If `method' is equal to
             "RCMK", compute a node renumering with Reverse Cuthill McKee. If `method'
             is equal to "Hilbert", compute a node renumering along a Hilbert curve. If
-            `method' is equal to "Metis", compute a node renumering using Metis.
-            Element renumbering is not available yet.
+            `method' is equal to "Metis", compute a node renumering using Metis. See
+            `computeNodeAndElementRenumbering' to also renumber the elements.
 
             Return `oldTags', `newTags'.
 
@@ -4528,6 +4528,53 @@ class model:
                 _ovectorsize(api_newTags_, api_newTags_n_.value))
         compute_renumbering = computeRenumbering
 
+        @staticmethod
+        def computeNodeAndElementRenumbering(method="RCMK", elementTags=[]):
+            """
+            gmsh.model.mesh.computeNodeAndElementRenumbering(method="RCMK", elementTags=[])
+
+            Compute a node renumbering (`oldNodeTags', `newNodeTags') and a consistent
+            element renumbering (`oldElementTags', `newElementTags') for a given list
+            of element tags `elementTags', using the same node graph for both. If
+            `elementTags' is empty, compute the renumbering on the full mesh. The node
+            renumbering is computed with `method' (see `computeRenumbering'); the
+            elements are then sorted according to the smallest new tag of their nodes,
+            and receive a permutation of their current tags. The bandwidth and profile
+            of the node graph before and after renumbering are printed.
+
+            Return `oldNodeTags', `newNodeTags', `oldElementTags', `newElementTags'.
+
+            Types:
+            - `oldNodeTags': vector of sizes
+            - `newNodeTags': vector of sizes
+            - `oldElementTags': vector of sizes
+            - `newElementTags': vector of sizes
+            - `method': string
+            - `elementTags': vector of sizes
+            """
+            api_oldNodeTags_, api_oldNodeTags_n_ = POINTER(c_size_t)(), c_size_t()
+            api_newNodeTags_, api_newNodeTags_n_ = POINTER(c_size_t)(), c_size_t()
+            api_oldElementTags_, api_oldElementTags_n_ = POINTER(c_size_t)(), c_size_t()
+            api_newElementTags_, api_newElementTags_n_ = POINTER(c_size_t)(), c_size_t()
+            api_elementTags_, api_elementTags_n_ = _ivectorsize(elementTags)
+            ierr = c_int()
+            lib.gmshModelMeshComputeNodeAndElementRenumbering(
+                byref(api_oldNodeTags_), byref(api_oldNodeTags_n_),
+                byref(api_newNodeTags_), byref(api_newNodeTags_n_),
+                byref(api_oldElementTags_), byref(api_oldElementTags_n_),
+                byref(api_newElementTags_), byref(api_newElementTags_n_),
+                c_char_p(method.encode()),
+                api_elementTags_, api_elementTags_n_,
+                byref(ierr))
+            if ierr.value != 0:
+                raise Exception(logger.getLastError())
+            return (
+                _ovectorsize(api_oldNodeTags_, api_oldNodeTags_n_.value),
+                _ovectorsize(api_newNodeTags_, api_newNodeTags_n_.value),
+                _ovectorsize(api_oldElementTags_, api_oldElementTags_n_.value),
+                _ovectorsize(api_newElementTags_, api_newElementTags_n_.value))
+        compute_node_and_element_renumbering = computeNodeAndElementRenumbering
+
         @staticmethod
         def renumberNodes(oldTags=[], newTags=[]):
             """
@@ -10791,6 +10838,43 @@ class logger:
         return api_result_
     get_cpu_time = getCpuTime
 
+    @staticmethod
+    def writeProfile(fileName):
+        """
+        gmsh.logger.writeProfile(fileName)
+
+        Write the profile of the operations performed since the initialization of
+        Gmsh (or since the last call to `resetProfile'), i.e. the wall and CPU
+        times, the peak memory usage and the counters (number of insertions, swaps,
+        ...) of each stage (meshing, optimization, input/output, ...), for each
+        model entity when relevant. The profile is written in JSON format, or in
+        CSV format if the extension of `fileName' is ".csv".
+
+        Types:
+        - `fileName': string
+        """
+        ierr = c_int()
+        lib.gmshLoggerWriteProfile(
+            c_char_p(fileName.encode()),
+            byref(ierr))
+        if ierr.value != 0:
+            raise Exception(logger.getLastError())
+    write_profile = writeProfile
+
+    @staticmethod
+    def resetProfile():
+        """
+        gmsh.logger.resetProfile()
+
+        Reset the profile of the operations.
+        """
+        ierr = c_int()
+        lib.gmshLoggerResetProfile(
+            byref(ierr))
+        if ierr.value != 0:
+            raise Exception(logger.getLastError())
+    reset_profile = resetProfile
+
     @staticmethod
     def getLastError():
         """
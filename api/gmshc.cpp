@@ -2127,6 +2127,26 @@ GMSH_API void gmshModelMeshComputeRenumbering(size_t ** oldTags, size_t * oldTag
   }
 }
 
+GMSH_API void gmshModelMeshComputeNodeAndElementRenumbering(size_t ** oldNodeTags, size_t * oldNodeTags_n, size_t ** newNodeTags, size_t * newNodeTags_n, size_t ** oldElementTags, size_t * oldElementTags_n, size_t ** newElementTags, size_t * newElementTags_n, const char * method, const size_t * elementTags, const size_t elementTags_n, int * ierr)
+{
+  if(ierr) *ierr = 0;
+  try {
+    std::vector<std::size_t> api_oldNodeTags_;
+    std::vector<std::size_t> api_newNodeTags_;
+    std::vector<std::size_t> api_oldElementTags_;
+    std::vector<std::size_t> api_newElementTags_;
+    std::vector<std::size_t> api_elementTags_(elementTags, elementTags + elementTags_n);
+    gmsh::model::mesh::computeNodeAndElementRenumbering(api_oldNodeTags_, api_newNodeTags_, api_oldElementTags_, api_newElementTags_, method, api_elementTags_);
+    vector2ptr(api_oldNodeTags_, oldNodeTags, oldNodeTags_n);
+    vector2ptr(api_newNodeTags_, newNodeTags, newNodeTags_n);
+    vector2ptr(api_oldElementTags_, oldElementTags, oldElementTags_n);
+    vector2ptr(api_newElementTags_, newElementTags, newElementTags_n);
+  }
+  catch(...){
+    if(ierr) *ierr = 1;
+  }
+}
+
 GMSH_API void gmshModelMeshRenumberNodes(const size_t * oldTags, const size_t oldTags_n, const size_t * newTags, const size_t newTags_n, int * ierr)
 {
   if(ierr) *ierr = 0;
@@ -5045,6 +5065,28 @@ GMSH_API double gmshLoggerGetCpuTime(int * ierr)
   return result_api_;
 }
 
+GMSH_API void gmshLoggerWriteProfile(const char * fileName, int * ierr)
+{
+  if(ierr) *ierr = 0;
+  try {
+    gmsh::logger::writeProfile(fileName);
+  }
+  catch(...){
+    if(ierr) *ierr = 1;
+  }
+}
+
+GMSH_API void gmshLoggerResetProfile(int * ierr)
+{
+  if(ierr) *ierr = 0;
+  try {
+    gmsh::logger::resetProfile();
+  }
+  catch(...){
+    if(ierr) *ierr = 1;
+  }
+}
+
 GMSH_API void gmshLoggerGetLastError(char ** error, int * ierr)
 {
   if(ierr) *ierr = 0;
@@ -1445,14 +1445,30 @@ GMSH_API void gmshModelMeshReorderElements(const int elementType,
  * is empty, compute the renumbering on the full mesh. If `method' is equal to
  * "RCMK", compute a node renumering with Reverse Cuthill McKee. If `method'
  * is equal to "Hilbert", compute a node renumering along a Hilbert curve. If
- * `method' is equal to "Metis", compute a node renumering using Metis.
- * Element renumbering is not available yet. */
+ * `method' is equal to "Metis", compute a node renumering using Metis. See
+ * `computeNodeAndElementRenumbering' to also renumber the elements. */
 GMSH_API void gmshModelMeshComputeRenumbering(size_t ** oldTags, size_t * oldTags_n,
                                               size_t ** newTags, size_t * newTags_n,
                                               const char * method,
                                               const size_t * elementTags, const size_t elementTags_n,
                                               int * ierr);
 
+/* Compute a node renumbering (`oldNodeTags', `newNodeTags') and a consistent
+ * element renumbering (`oldElementTags', `newElementTags') for a given list
+ * of element tags `elementTags', using the same node graph for both. If
+ * `elementTags' is empty, compute the renumbering on the full mesh. The node
+ * renumbering is computed with `method' (see `computeRenumbering'); the
+ * elements are then sorted according to the smallest new tag of their nodes,
+ * and receive a permutation of their current tags. The bandwidth and profile
+ * of the node graph before and after renumbering are printed. */
+GMSH_API void gmshModelMeshComputeNodeAndElementRenumbering(size_t ** oldNodeTags, size_t * oldNodeTags_n,
+                                                            size_t ** newNodeTags, size_t * newNodeTags_n,
+                                                            size_t ** oldElementTags, size_t * oldElementTags_n,
+                                                            size_t ** newElementTags, size_t * newElementTags_n,
+                                                            const char * method,
+                                                            const size_t * elementTags, const size_t elementTags_n,
+                                                            int * ierr);
+
 /* Renumber the node tags. If no explicit renumbering is provided through the
  * `oldTags' and `newTags' vectors, renumber the nodes in a continuous
  * sequence, taking into account the subset of elements to be saved later on
@@ -3514,6 +3530,18 @@ GMSH_API double gmshLoggerGetWallTime(int * ierr);
 /* Return CPU time. */
 GMSH_API double gmshLoggerGetCpuTime(int * ierr);
 
+/* Write the profile of the operations performed since the initialization of
+ * Gmsh (or since the last call to `resetProfile'), i.e. the wall and CPU
+ * times, the peak memory usage and the counters (number of insertions, swaps,
+ * ...) of each stage (meshing, optimization, input/output, ...), for each
+ * model entity when relevant. The profile is written in JSON format, or in
+ * CSV format if the extension of `fileName' is ".csv". */
+GMSH_API void gmshLoggerWriteProfile(const char * fileName,
+                                     int * ierr);
+
+/* Reset the profile of the operations. */
+GMSH_API void gmshLoggerResetProfile(int * ierr);
+
 /* Return last error message, if any. */
 GMSH_API void gmshLoggerGetLastError(char ** error,
                                      int * ierr);
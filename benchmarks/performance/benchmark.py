@@ -0,0 +1,304 @@
+# Gmsh - Copyright (C) 1997-2024 C. Geuzaine, J.-F. Remacle
+#
+# See the LICENSE.txt file in the Gmsh root directory for license information.
+# Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+# Meshing performance benchmarks
+#
+# Runs a curated subset of the benchmark models with the Python API, for
+# several numbers of threads, and records for each run the wall time of each
+# stage of the pipeline (from the profile written by gmsh.logger.writeProfile),
+# the peak memory usage, the number of nodes and elements and the percentiles
+# of the element quality (minSICN). The results are compared with a baseline,
+# so that performance regressions can be caught:
+#
+#   python3 benchmark.py --save-baseline baseline.json   # reference run
+#   python3 benchmark.py --baseline baseline.json        # exit code 1 if slower
+#
+# Each run is performed in a separate process, so that the peak memory usage
+# is measured independently. With the cmake build, "make benchmark" runs the
+# benchmarks with the shared library of the build directory, and compares the
+# results with "benchmark_baseline.json" in the build directory if it exists
+# ("make benchmark_baseline" creates it).
+
+import argparse
+import json
+import os
+import platform
+import subprocess
+import sys
+import tempfile
+import time
+
+# (group, file relative to the benchmarks directory, mesh dimension, options)
+CASES = [
+    ('2d_large', '2d_large/bubble_interphase_layers.geo', 2, {}),
+    ('2d_large', '2d_large/uk.geo', 2, {}),
+    ('2d_large', '2d_large/mediterranean.geo', 2, {}),
+    ('3d_large', '3d_large/spheremodel.geo', 3, {}),
+    ('3d_large', '3d_large/PTE.geo', 3, {}),
+    ('3d_large', '3d_large/gasdis.geo', 3, {}),
+    ('3d_large', '3d_large/many_surfaces.geo', 3, {}),
+    ('occ_large', 'occ_large/spheres.geo', 3, {}),
+    ('occ_large', 'occ_large/rotor2.geo', 3, {}),
+    ('occ_large', 'occ_large/rve_periodic.geo', 3, {}),
+    ('occ_large', 'occ_large/fragment_and_embedded.geo', 3, {}),
+    ('extrude', 'extrude/Torus-ExtrMesh.geo', 3, {}),
+    ('extrude', 'extrude/p7-ExtrMesh.geo', 3, {}),
+    ('extrude', 'extrude/naca12_3d.geo', 3, {}),
+    ('extrude', 'extrude/pump_boundary_layer.geo', 3, {}),
+    ('io_msh', 'io_msh/MSubTetrahedron_input.msh', 0, {}),
+    ('io_msh', 'io_msh/MSubTriangle_input.msh', 0, {}),
+    ('io_msh', '3d_large/spheremodel.geo', 3, {}),
+    ('transfinite', 'transfinite/transfinite3d.geo', 3, {}),
+    ('transfinite', 'transfinite/sphere_in_cube_hexa.geo', 3, {}),
+    ('transfinite', 'transfinite/fire2_3d.geo', 3, {}),
+    ('transfinite', 'transfinite/mem3D_wv2.geo', 3, {}),
+]
+
+# cases that require optional modules
+REQUIRES = {'occ_large': 'OpenCASCADE'}
+
+
+def percentile(values, p):
+    if not values:
+        return 0.
+    k = (len(values) - 1) * p / 100.
+    i = int(k)
+    j = min(i + 1, len(values) - 1)
+    return values[i] + (values[j] - values[i]) * (k - i)
+
+
+def get_stages(node, path, stages):
+    # accumulate the wall time of the stages of the pipeline over the model
+    # entities (e.g. "Mesh/3D/*/Boundary recovery")
+    for c in node.get('children', []):
+        name = c['name']
+        if name.split(' ')[0] in ['Curve', 'Surface', 'Volume']:
+            name = '*'
+        p = path + '/' + name if path else name
+        if 'wall' in c:
+            stages[p] = stages.get(p, 0.) + c['wall']
+        get_stages(c, p, stages)
+
+
+def run_case(spec):
+    # runs in a child process
+    import gmsh
+    result = {'status': 'ok'}
+    tmp = tempfile.mkdtemp()
+    gmsh.initialize(readConfigFiles=False)
+    try:
+        gmsh.option.setNumber('General.Verbosity', 1)
+        gmsh.option.setNumber('General.NumThreads', spec['threads'])
+        for name, value in spec['options'].items():
+            gmsh.option.setNumber(name, value)
+        gmsh.logger.resetProfile()
+        w = time.time()
+        gmsh.open(spec['file'])
+        if spec['dim']:
+            gmsh.model.mesh.generate(spec['dim'])
+        if spec['group'] == 'io_msh':
+            # round-trip in ASCII and binary MSH format
+            for binary in [0, 1]:
+                f = os.path.join(tmp, 'binary.msh' if binary else 'ascii.msh')
+                gmsh.option.setNumber('Mesh.Binary', binary)
+                gmsh.write(f)
+                gmsh.clear()
+                gmsh.open(f)
+        result['wall'] = time.time() - w
+
+        f = os.path.join(tmp, 'profile.json')
+        gmsh.logger.writeProfile(f)
+        with open(f) as fp:
+            profile = json.load(fp)
+        stages = {}
+        get_stages(profile, '', stages)
+        result['stages'] = stages
+        result['peakMemory'] = profile['peakMemory']
+
+        nodes = gmsh.model.mesh.getNodes()[0]
+        result['nodes'] = len(nodes)
+        num = 0
+        for dim in range(4):
+            for tags in gmsh.model.mesh.getElements(dim)[1]:
+                num += len(tags)
+        result['elements'] = num
+        dim = gmsh.model.getDimension()
+        tags = []
+        for t in gmsh.model.mesh.getElements(dim)[1]:
+            tags.extend(t)
+        q = sorted(gmsh.model.mesh.getElementQualities(tags)) if tags else []
+        result['quality'] = {
+            'min': q[0] if q else 0.,
+            'p1': percentile(q, 1),
+            'p5': percentile(q, 5),
+            'p50': percentile(q, 50)
+        }
+    except Exception as e:
+        result['status'] = 'failed'
+        result['error'] = str(e)
+    gmsh.finalize()
+    print(json.dumps(result))
+
+
+def run(spec, timeout):
+    r = {
+        'group': spec['group'],
+        'case': spec['case'],
+        'threads': spec['threads']
+    }
+    try:
+        p = subprocess.run([sys.executable, __file__, '--run',
+                            json.dumps(spec)],
+                           stdout=subprocess.PIPE,
+                           stderr=subprocess.PIPE,
+                           universal_newlines=True,
+                           timeout=timeout)
+        lines = p.stdout.strip().splitlines()
+        if p.returncode or not lines:
+            r['status'] = 'failed'
+            r['error'] = (p.stderr.strip().splitlines() or ['crashed'])[-1]
+        else:
+            r.update(json.loads(lines[-1]))
+    except subprocess.TimeoutExpired:
+        r['status'] = 'timeout'
+    return r
+
+
+def build_options():
+    import gmsh
+    gmsh.initialize(readConfigFiles=False)
+    opt = gmsh.option.getString('General.BuildOptions')
+    version = gmsh.option.getString('General.Version')
+    gmsh.finalize()
+    return opt.split(), version
+
+
+def compare(results, baseline, tol, min_time):
+    base = {}
+    for r in baseline['results']:
+        base[(r['group'], r['case'], r['threads'])] = r
+    regressions = 0
+    for r in results:
+        b = base.get((r['group'], r['case'], r['threads']))
+        if not b:
+            continue
+        name = '{0} ({1} thread{2})'.format(r['case'], r['threads'],
+                                             's' if r['threads'] > 1 else '')
+        if r['status'] != 'ok':
+            if b['status'] == 'ok':
+                print('REGRESSION {0}: {1}'.format(name, r['status']))
+                regressions += 1
+            continue
+        if b['status'] != 'ok':
+            continue
+        # times (total and per stage)
+        times = [('total', r['wall'], b['wall'])]
+        for s, w in sorted(r['stages'].items()):
+            if s in b['stages']:
+                times.append((s, w, b['stages'][s]))
+        for s, w, wb in times:
+            if w > wb * (1. + tol) and w - wb > min_time:
+                print('REGRESSION {0}: {1} wall time {2:.3g} s -> {3:.3g} s '
+                      '(+{4:.0f}%)'.format(name, s, wb, w,
+                                           100. * (w / wb - 1.)))
+                regressions += 1
+        m, mb = r['peakMemory'], b['peakMemory']
+        if m > mb * (1. + tol):
+            print('REGRESSION {0}: peak memory {1:.1f} Mb -> {2:.1f} Mb '
+                  '(+{3:.0f}%)'.format(name, mb / 1048576., m / 1048576.,
+                                       100. * (m / mb - 1.)))
+            regressions += 1
+        # changes in the mesh are reported, but are not counted as performance
+        # regressions
+        for k in ['nodes', 'elements']:
+            if abs(r[k] - b[k]) > tol * b[k]:
+                print('Warning {0}: number of {1} {2} -> {3}'.format(
+                    name, k, b[k], r[k]))
+        q, qb = r['quality']['p5'], b['quality']['p5']
+        if q < qb * (1. - tol):
+            print('Warning {0}: 5th percentile of quality {1:.3g} -> {2:.3g}'.
+                  format(name, qb, q))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Gmsh performance benchmarks')
+    parser.add_argument('--run', help=argparse.SUPPRESS)
+    parser.add_argument('--groups', default=','.join(
+        sorted(set(c[0] for c in CASES))), help='comma-separated groups')
+    parser.add_argument('--threads', default='1,2,4,8,N',
+                        help='comma-separated numbers of threads (N: number '
+                        'of cores)')
+    parser.add_argument('--output', default='benchmark.json',
+                        help='results file')
+    parser.add_argument('--baseline', help='compare with baseline file')
+    parser.add_argument('--save-baseline', help='save results as baseline')
+    parser.add_argument('--tolerance', type=float, default=0.2,
+                        help='relative tolerance for regressions')
+    parser.add_argument('--min-time', type=float, default=0.1,
+                        help='ignore time regressions smaller than this (s)')
+    parser.add_argument('--timeout', type=float, default=3600.,
+                        help='timeout per run (s)')
+    args = parser.parse_args()
+
+    if args.run:
+        run_case(json.loads(args.run))
+        return 0
+
+    ncores = os.cpu_count() or 1
+    threads = []
+    for t in args.threads.split(','):
+        n = ncores if t.strip() == 'N' else int(t)
+        if n <= ncores and n not in threads:
+            threads.append(n)
+    groups = args.groups.split(',')
+    options, version = build_options()
+    root = os.path.dirname(os.path.dirname(os.path.realpath(__file__)))
+
+    results = []
+    for group, case, dim, opt in CASES:
+        if group not in groups:
+            continue
+        if group in REQUIRES and REQUIRES[group] not in options:
+            print('Skipping {0} (requires {1})'.format(case, REQUIRES[group]))
+            continue
+        for n in threads:
+            spec = {'group': group, 'case': case, 'dim': dim, 'options': opt,
+                    'threads': n, 'file': os.path.join(root, case)}
+            r = run(spec, args.timeout)
+            results.append(r)
+            if r['status'] == 'ok':
+                print('{0:<45} {1:>3} thread{2} {3:>9.3f} s {4:>9.1f} Mb '
+                      '{5:>10} elements'.format(
+                          case, n, 's' if n > 1 else ' ', r['wall'],
+                          r['peakMemory'] / 1048576., r['elements']))
+            else:
+                print('{0:<45} {1:>3} thread{2} {3}'.format(
+                    case, n, 's' if n > 1 else ' ', r['status']))
+            sys.stdout.flush()
+
+    data = {'version': version, 'host': platform.node(),
+            'date': time.strftime('%Y-%m-%d %H:%M:%S'), 'cores': ncores,
+            'results': results}
+    for f in [args.output, args.save_baseline]:
+        if f:
+            with open(f, 'w') as fp:
+                json.dump(data, fp, indent=2)
+
+    if args.baseline:
+        if not os.path.exists(args.baseline):
+            print('No baseline file {0}'.format(args.baseline))
+            return 0
+        with open(args.baseline) as fp:
+            baseline = json.load(fp)
+        n = compare(results, baseline, args.tolerance, args.min_time)
+        print('{0} regression{1} with respect to {2}'.format(
+            n, 's' if n != 1 else '', args.baseline))
+        return 1 if n else 0
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -88,17 +88,65 @@ namespace QMT {
     bool operator<(const IV &b) const { return i < b.i; }
   };
 
+  /* Set the number of threads used by Eigen in the current scope (unchanged
+   * if num <= 0) */
+  class EigenThreads {
+#if defined(HAVE_EIGEN)
+    int prev;
+
+  public:
+    EigenThreads(int num) : prev(Eigen::nbThreads())
+    {
+      if(num > 0) Eigen::setNbThreads(num);
+    }
+    ~EigenThreads() { Eigen::setNbThreads(prev); }
+#else
+  public:
+    EigenThreads(int num) {}
+#endif
+  };
+
+  /* Sparse linear system of the diffusion steps. By default, it is solved
+   * with a sparse LU factorization. In iterative mode (used for the large
+   * faces, which are processed one at a time with all the threads), it is
+   * solved with a Jacobi-preconditioned BiCGSTAB on a row-major copy of the
+   * matrix (the sparse matrix-vector products are then multithreaded by
+   * Eigen), warm-started with the previous solution. The LU factorization is
+   * used as a fallback if the iterative solver does not converge. */
   class CrossFieldLinearSystem {
   protected:
     size_t N = 0;
+    bool iterative = false;
 #if defined(HAVE_EIGEN)
+    typedef Eigen::SparseMatrix<double, Eigen::RowMajor> RowMatrix;
     Eigen::VectorXd x, b;
     Eigen::SparseMatrix<double> A;
     Eigen::SparseLU<Eigen::SparseMatrix<double> > solver;
+    bool luAnalyzed = false;
+    bool luFactorized = false;
+    RowMatrix Ar;
+    Eigen::BiCGSTAB<RowMatrix, Eigen::DiagonalPreconditioner<double> >
+      itSolver;
 #endif
 
+    bool factorize_lu()
+    {
+#if defined(HAVE_EIGEN)
+      if(!luAnalyzed) {
+        solver.analyzePattern(A);
+        luAnalyzed = true;
+      }
+      solver.factorize(A);
+      luFactorized = true;
+      return solver.info() == Eigen::ComputationInfo::Success;
+#else
+      return false;
+#endif
+    }
+
   public:
-    CrossFieldLinearSystem(size_t N_) : N(N_)
+    CrossFieldLinearSystem(size_t N_, bool iterative_ = false)
+      : N(N_), iterative(iterative_)
     {
 #if defined(HAVE_EIGEN)
       Msg::Debug("Eigen call: initialize sparse matrix, vectors and solver");
@@ -163,8 +211,10 @@ namespace QMT {
     bool preprocess_sparsity_pattern()
     {
 #if defined(HAVE_EIGEN)
+      if(iterative) return true;
       Msg::Debug("Eigen call: analyse sparse matrix sparsity pattern");
       solver.analyzePattern(A);
+      luAnalyzed = true;
       return true;
 #else
       Msg::Error("Linear solver Eigen required");
@@ -175,9 +225,18 @@ namespace QMT {
     bool factorize()
     {
 #if defined(HAVE_EIGEN)
+      if(iterative) {
+        /* the LU factors (if any) are outdated, only compute the diagonal
+         * preconditioner on the row-major copy */
+        Msg::Debug("Eigen call: update iterative solver");
+        luFactorized = false;
+        Ar = A;
+        itSolver.setTolerance(1.e-10);
+        itSolver.compute(Ar);
+        return true;
+      }
       Msg::Debug("Eigen call: factorize sparse matrix");
-      solver.factorize(A);
-      return true;
+      return factorize_lu();
 #else
       Msg::Error("Linear solver Eigen required");
       return false;
@@ -188,6 +247,25 @@ namespace QMT {
     {
 #if defined(HAVE_EIGEN)
       Msg::Debug("Eigen call: solve linear system");
+      if(iterative && !luFactorized) {
+        /* x still contains the previous solution */
+        Eigen::VectorXd x0 = x;
+        x = itSolver.solveWithGuess(b, x0);
+        if(itSolver.info() == Eigen::ComputationInfo::Success) {
+          slt.resize(x.size());
+          for(size_t i = 0; i < N; ++i) slt[i] = x[i];
+          return true;
+        }
+        Msg::Debug("Eigen: BiCGSTAB did not converge (%li variables, %li "
+                   "iterations, error %g), switching to SparseLU",
+                   N, (size_t)itSolver.iterations(), itSolver.error());
+        if(!factorize_lu()) {
+          Msg::Warning("Eigen: failed to factorize linear system with "
+                       "SparseLU (%li variables)",
+                       N);
+          return false;
+        }
+      }
       x = solver.solve(b);
       if(solver.info() != Eigen::ComputationInfo::Success) {
         Msg::Warning(
@@ -545,7 +623,7 @@ namespace QMT {
     const std::vector<std::array<id, 3> > &triangles,
     std::vector<std::array<double, 3> > &triEdgeTheta, int nbDiffusionLevels,
     double thresholdNormConvergence, int nbBoundaryExtensionLayer,
-    int verbosity)
+    int verbosity, int nbThreads)
   {
     if(N != 4 && N != 6) return false;
 
@@ -724,7 +802,12 @@ namespace QMT {
       vector<double> norms(uIEdges.size(), 0.);
       vector<double> prevNorms = norms;
 
-      CrossFieldLinearSystem solver(2 * uIEdges.size());
+      /* When several threads are available for this face, use the
+       * iterative solver: it is warm-started with the previous solution
+       * and its matrix-vector products are multithreaded */
+      const bool iterative = (nbThreads > 1);
+      CrossFieldLinearSystem solver(2 * uIEdges.size(), iterative);
+      EigenThreads eigenThreads(iterative ? nbThreads : 0);
 
       vector<double> diag_sum(2 * uIEdges.size(), 0.);
       for(size_t i = 0; i < Acol.size(); ++i) {
@@ -984,7 +1067,8 @@ int computeCrossFieldWithHeatEquation(
   int N, const std::vector<MTriangle *> &triangles,
   const std::vector<MLine *> &lines,
   std::vector<std::array<double, 3> > &triEdgeTheta, int nbDiffusionLevels,
-  double thresholdNormConvergence, int nbBoundaryExtensionLayer, int verbosity)
+  double thresholdNormConvergence, int nbBoundaryExtensionLayer, int verbosity,
+  int nbThreads)
 {
   /* Build discrete mesh without reference to gmsh structures */
   std::vector<std::array<double, 3> > dpoints;
@@ -1034,7 +1118,7 @@ int computeCrossFieldWithHeatEquation(
 
   bool ok = QMT::compute_cross_field_with_multilevel_diffusion(
     N, dpoints, dlines, dtriangles, triEdgeTheta, nbDiffusionLevels,
-    thresholdNormConvergence, nbBoundaryExtensionLayer, verbosity);
+    thresholdNormConvergence, nbBoundaryExtensionLayer, verbosity, nbThreads);
   return ok ? 0 : -1;
 }
 
@@ -1164,7 +1248,7 @@ inline double cross_lifting(int Ns, double _a, double a)
 int computeCrossFieldConformalScaling(
   int Ns, const std::vector<MTriangle *> &triangles,
   const std::vector<std::array<double, 3> > &triEdgeTheta,
-  std::unordered_map<MVertex *, double> &scaling)
+  std::unordered_map<MVertex *, double> &scaling, int nbThreads)
 {
 #if defined(HAVE_SOLVER)
   Msg::Debug("compute cross field scaling (N=%i, %li triangles) ...", Ns,
@@ -1177,6 +1261,12 @@ int computeCrossFieldConformalScaling(
 #if defined(HAVE_EIGEN)
   Msg::Debug("- with EIGEN solver");
   linearSystemEigen<double> *_lsys = new linearSystemEigen<double>;
+  QMT::EigenThreads eigenThreads(nbThreads > 1 ? nbThreads : 0);
+  if(nbThreads > 1) {
+    /* symmetric (Laplacian) system: multithreaded conjugate gradient */
+    _lsys->setSolverType(EigenCG);
+    _lsys->setTolerance(1.e-10);
+  }
 #elif defined(HAVE_PETSC)
   Msg::Debug("- with PETSc solver");
   linearSystemPETSc<double> *_lsys = new linearSystemPETSc<double>;
@@ -1318,6 +1408,13 @@ int computeCrossFieldConformalScaling(
   }
 
   int status = _lsys->systemSolve();
+#if defined(HAVE_EIGEN)
+  if(status == -1 && nbThreads > 1) {
+    Msg::Debug("conformal scaling: conjugate gradient failed, use SparseLU");
+    _lsys->setSolverType(EigenSparseLU);
+    status = _lsys->systemSolve();
+  }
+#endif
 
   if(status == -1) { /* failed to solve */
     Msg::Warning("conformal scaling (%li triangles, %li variables), failed to "
@@ -38,6 +38,8 @@ class GFace;
  * @param[in] nbBoundaryExtensionLayer Extend the Dirichlet BCs inside (on X layers)
  *            to push singularities inside the faces.
  * @param[in] verbosity 0: no log (except errors), 1: two lines, 2: one per level, 3+: details
+ * @param[in] nbThreads If > 1, the linear systems are solved with a multithreaded
+ *            iterative solver, warm-started with the previous solution
  *
  * @return 0 if success
  */
@@ -49,7 +51,8 @@ int computeCrossFieldWithHeatEquation(
     int nbDiffusionLevels = 5,
     double thresholdNormConvergence = 1.e-3,
     int nbBoundaryExtensionLayer = 1,
-    int verbosity = 1);
+    int verbosity = 1,
+    int nbThreads = 1);
 
 /**
  * @brief Compute the cross field conformal scaling by canceling the Lie bracket,
@@ -61,6 +64,8 @@ int computeCrossFieldWithHeatEquation(
  * @param[in] triEdgeTheta The cross field, one angle per triangle edge, relative to the edge direction
  *                     should be compatible with the result of computeCrossFieldWithHeatEquation()
  * @param[out] scaling The conformal scaling, scalar field with one value per vertex (P1 FEM)
+ * @param[in] nbThreads If > 1, the linear system is solved with a multithreaded
+ *            conjugate gradient (Eigen only)
  *
  * @return 0 if success
  */
@@ -68,7 +73,8 @@ int computeCrossFieldConformalScaling(
     int N,
     const std::vector<MTriangle*>& triangles,
     const std::vector<std::array<double,3> >& triEdgeTheta,
-    std::unordered_map<MVertex*,double>& scaling);
+    std::unordered_map<MVertex*,double>& scaling,
+    int nbThreads = 1);
 
 
 /**
@@ -209,6 +209,8 @@ std::vector<std::pair<std::string, std::string> > GetUsage()
                  "then exit"));
   s.push_back(mp("-nt int", "Set number of threads (General.NumThreads)"));
   s.push_back(mp("-cpu", "Report CPU times for all operations"));
+  s.push_back(mp("-profile file", "Write profile of all operations (wall and "
+                 "CPU times, memory, counters) in JSON or CSV format"));
   s.push_back(mp("-version", "Show version number"));
   s.push_back(mp("-info", "Show detailed version information"));
   s.push_back(mp("-help", "Show command line usage"));
@@ -1336,6 +1338,15 @@ static bool GetOtherOption(const std::vector<std::string> &argv,
     Msg::SetInfoMem(true);
     i++;
   }
+  else if(argv[i] == "-profile") {
+    i++;
+    if(i < argv.size())
+      CTX::instance()->profileFileName = argv[i++];
+    else {
+      Msg::Error("Missing file name");
+      if(exitOnError) Msg::Exit(1);
+    }
+  }
   else if(argv[i] == "-o") {
     i++;
     if(i < argv.size())
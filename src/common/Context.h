@@ -45,8 +45,11 @@ struct contextMeshOptions {
   int ignorePeriodicityMsh2, ignoreParametrizationMsh4, ignoreUnknownSections;
   int boundaryLayerFanElements;
   int maxNumThreads1D, maxNumThreads2D, maxNumThreads3D;
+  int maxNumThreadsMeshAdapt;
   double angleToleranceFacetOverlap, toleranceReferenceElement;
-  int renumber, compoundClassify, reparamMaxTriangles;
+  int renumber, reorderElements, compoundClassify, reparamMaxTriangles;
+  int surfaceSurrogate;
+  double surfaceSurrogateTolerance;
   double compoundLcFactor;
   unsigned int randomSeed;
   int nLayersPerGap;
@@ -157,7 +160,7 @@ public:
   std::vector<std::string> files;
   std::string bgmFileName, outputFileName, defaultFileName, tmpFileName;
   std::string sessionFileName, optionsFileName, errorFileName;
-  std::string meshStatReportFileName;
+  std::string meshStatReportFileName, profileFileName;
   // filename of the executable, with full path
   std::string exeFileName;
   // the home directory
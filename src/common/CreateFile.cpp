@@ -13,6 +13,7 @@
 #include "OpenFile.h"
 #include "CreateFile.h"
 #include "OS.h"
+#include "Profiler.h"
 
 #if defined(HAVE_OPENGL)
 #include "drawContext.h"
@@ -303,6 +304,9 @@ void CreateOutputFile(const std::string &fileName, int format,
   if(status)
     Msg::StatusBar(true, "Writing '%s'...", name.c_str());
 
+  std::vector<std::string> split = SplitFileName(name);
+  ProfileScope scope("Write " + split[1] + split[2]);
+
   switch (format) {
 
   case FORMAT_AUTO:
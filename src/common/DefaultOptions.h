@@ -1295,6 +1295,11 @@ StringXNumber MeshOptions_Number[] = {
     "Maximum number of threads for 2D meshing (0: use General.NumThreads)" },
   { F|O, "MaxNumThreads3D" , opt_mesh_max_num_threads_3d , 0. ,
     "Maximum number of threads for 3D meshing (0: use General.NumThreads)" },
+  { F|O, "MaxNumThreadsMeshAdapt" , opt_mesh_max_num_threads_meshadapt , 0. ,
+    "Maximum number of threads used to evaluate the mesh size on the edges of "
+    "each surface during MeshAdapt refinement (0 or 1: no threading); only "
+    "effective when surfaces are not meshed in parallel, and requires "
+    "thread-safe mesh size fields" },
   { F|O, "MaxRetries" , opt_mesh_max_retries , 10 ,
     "Maximum number of times meshing is retried on curves and surfaces with a "
     "pending mesh"},
@@ -1529,6 +1534,11 @@ StringXNumber MeshOptions_Number[] = {
     "Number of refinement steps in the MeshAdapt-based 2D algorithms" },
   { F|O, "Renumber" , opt_mesh_renumber , 1 ,
     "Renumber nodes and elements in a continuous sequence after mesh generation" },
+  { F|O, "ReorderElements" , opt_mesh_reorder_elements , 0 ,
+    "Reorder the elements and nodes of each surface and volume after mesh "
+    "generation to improve memory locality (0: no, 1: along a Hilbert curve "
+    "through the element barycenters and the nodes); combined with "
+    "Mesh.Renumber, element and node tags follow the new order" },
   { F|O, "ReparamMaxTriangles" , opt_mesh_reparam_max_triangles , 250000 ,
     "Maximum number of triangles in a single parametrization patch" },
 
@@ -1603,6 +1613,14 @@ StringXNumber MeshOptions_Number[] = {
     "Display surface mesh element labels?" },
   { F|O|D, "SurfaceNumbers" , opt_mesh_surface_labels , 0. ,
     "[Deprecated]" },
+  { F|O, "SurfaceSurrogate" , opt_mesh_surface_surrogate , 0. ,
+    "Evaluate OpenCASCADE surfaces during meshing through a lazily built, cached "
+    "piecewise bicubic approximation (points, derivatives and curvatures); the "
+    "exact surface is used wherever the approximation does not meet the "
+    "tolerance" },
+  { F|O, "SurfaceSurrogateTolerance" , opt_mesh_surface_surrogate_tolerance , 1.e-6 ,
+    "Tolerance of the surface approximation used if Mesh.SurfaceSurrogate is set, "
+    "relative to the bounding box diagonal of each surface" },
   { F|O, "SwitchElementTags", opt_mesh_switch_elem_tags, 0. ,
     "Invert elementary and physical tags when reading the mesh"},
 
@@ -1984,6 +2002,10 @@ StringXNumber ViewOptions_Number[] = {
     "Smooth the normals?" },
   { F|O, "Stipple" , opt_view_use_stipple , 0. ,
     "Stipple curves in 2D and line plots?" },
+  { F|O, "Storage" , opt_view_storage , 0. ,
+    "Storage of the time steps of mesh-based views other than the current one "
+    "(0: double precision, 1: single precision, 2: 16-bit quantized values, "
+    "3: temporary file); the steps are decompressed on access" },
 
   { F|O, "Tangents" , opt_view_tangents , 0. ,
     "Display size of tangent vectors (in pixels)" },
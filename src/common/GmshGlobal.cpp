@@ -23,6 +23,7 @@ typedef unsigned long intptr_t;
 #include "CommandLine.h"
 #include "OS.h"
 #include "Context.h"
+#include "Profiler.h"
 #include "robustPredicates.h"
 #include "BasisFactory.h"
 
@@ -242,6 +243,10 @@ int GmshWriteFile(const std::string &fileName)
 
 int GmshFinalize()
 {
+  // write the profile of all operations (if requested)
+  if(!CTX::instance()->profileFileName.empty())
+    Profiler::write(CTX::instance()->profileFileName);
+
   // delete all models and views
   DeleteAllModelsAndViews();
 
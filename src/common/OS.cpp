@@ -371,6 +371,25 @@ double Cpu()
   return s;
 }
 
+double ThreadCpu()
+{
+#if defined(WIN32) && !defined(__CYGWIN__)
+  FILETIME creation, exit, kernel, user;
+  if(GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+    return 1.e-7 * 4294967296. * (double)user.dwHighDateTime +
+           1.e-7 * (double)user.dwLowDateTime;
+  }
+  return 0.;
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+  struct timespec t;
+  if(!clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t))
+    return (double)t.tv_sec + 1.e-9 * (double)t.tv_nsec;
+  return Cpu();
+#else
+  return Cpu();
+#endif
+}
+
 double TotalRam()
 {
   double ram = 0;
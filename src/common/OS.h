@@ -15,6 +15,7 @@ void SetEnvironmentVar(const std::string &var, const std::string &val);
 void SleepInSeconds(double s);
 void CheckResources();
 double Cpu();
+double ThreadCpu();
 double TotalRam();
 double TimeOfDay();
 std::size_t GetMemoryUsage();
@@ -20,6 +20,7 @@ typedef unsigned long intptr_t;
 #include "OpenFile.h"
 #include "CommandLine.h"
 #include "OS.h"
+#include "Profiler.h"
 #include "StringUtils.h"
 #include "GeomMeshMatcher.h"
 
@@ -320,6 +321,7 @@ int MergeFile(const std::string &fileName, bool errorIfMissing,
 
   std::vector<std::string> split = SplitFileName(fileName);
   std::string noExt = split[0] + split[1], ext = split[2];
+  ProfileScope scope("Read " + split[1] + ext);
 
   if(ext == ".gz") {
     if(DoSystemUncompress(fileName, noExt)) return MergeFile(noExt, false);
@@ -5007,6 +5007,12 @@ double opt_mesh_renumber(OPT_ARGS_NUM)
   return CTX::instance()->mesh.renumber;
 }
 
+double opt_mesh_reorder_elements(OPT_ARGS_NUM)
+{
+  if(action & GMSH_SET) CTX::instance()->mesh.reorderElements = (int)val;
+  return CTX::instance()->mesh.reorderElements;
+}
+
 double opt_mesh_normals(OPT_ARGS_NUM)
 {
   if(action & GMSH_SET) { CTX::instance()->mesh.normals = val; }
@@ -5569,6 +5575,18 @@ double opt_mesh_surface_faces(OPT_ARGS_NUM)
   return CTX::instance()->mesh.surfaceFaces;
 }
 
+double opt_mesh_surface_surrogate(OPT_ARGS_NUM)
+{
+  if(action & GMSH_SET) CTX::instance()->mesh.surfaceSurrogate = (int)val;
+  return CTX::instance()->mesh.surfaceSurrogate;
+}
+
+double opt_mesh_surface_surrogate_tolerance(OPT_ARGS_NUM)
+{
+  if(action & GMSH_SET) CTX::instance()->mesh.surfaceSurrogateTolerance = val;
+  return CTX::instance()->mesh.surfaceSurrogateTolerance;
+}
+
 double opt_mesh_volume_edges(OPT_ARGS_NUM)
 {
   if(action & GMSH_SET) {
@@ -6763,6 +6781,13 @@ double opt_mesh_max_num_threads_3d(OPT_ARGS_NUM)
   return CTX::instance()->mesh.maxNumThreads3D;
 }
 
+double opt_mesh_max_num_threads_meshadapt(OPT_ARGS_NUM)
+{
+  if(action & GMSH_SET)
+    CTX::instance()->mesh.maxNumThreadsMeshAdapt = (int)val;
+  return CTX::instance()->mesh.maxNumThreadsMeshAdapt;
+}
+
 double opt_mesh_angle_tolerance_facet_overlap(OPT_ARGS_NUM)
 {
   if(action & GMSH_SET) {
@@ -7856,6 +7881,21 @@ double opt_view_max_recursion_level(OPT_ARGS_NUM)
 #endif
 }
 
+double opt_view_storage(OPT_ARGS_NUM)
+{
+#if defined(HAVE_POST)
+  GET_VIEW(0.);
+  if(action & GMSH_SET) {
+    opt->storage = (int)val;
+    if(opt->storage < 0 || opt->storage > 3) opt->storage = 0;
+    if(data) data->storeSteps(opt->storage, opt->timeStep);
+  }
+  return opt->storage;
+#else
+  return 0.;
+#endif
+}
+
 double opt_view_target_error(OPT_ARGS_NUM)
 {
 #if defined(HAVE_POST)
@@ -492,6 +492,8 @@ double opt_mesh_trihedra(OPT_ARGS_NUM);
 double opt_mesh_transfinite_tri(OPT_ARGS_NUM);
 double opt_mesh_surface_edges(OPT_ARGS_NUM);
 double opt_mesh_surface_faces(OPT_ARGS_NUM);
+double opt_mesh_surface_surrogate(OPT_ARGS_NUM);
+double opt_mesh_surface_surrogate_tolerance(OPT_ARGS_NUM);
 double opt_mesh_volume_edges(OPT_ARGS_NUM);
 double opt_mesh_volume_faces(OPT_ARGS_NUM);
 double opt_mesh_node_labels(OPT_ARGS_NUM);
@@ -629,9 +631,11 @@ double opt_mesh_max_iter_delaunay_3d(OPT_ARGS_NUM);
 double opt_mesh_max_num_threads_1d(OPT_ARGS_NUM);
 double opt_mesh_max_num_threads_2d(OPT_ARGS_NUM);
 double opt_mesh_max_num_threads_3d(OPT_ARGS_NUM);
+double opt_mesh_max_num_threads_meshadapt(OPT_ARGS_NUM);
 double opt_mesh_angle_tolerance_facet_overlap(OPT_ARGS_NUM);
 double opt_mesh_tolerance_reference_element(OPT_ARGS_NUM);
 double opt_mesh_renumber(OPT_ARGS_NUM);
+double opt_mesh_reorder_elements(OPT_ARGS_NUM);
 double opt_mesh_unv_strict_format(OPT_ARGS_NUM);
 double opt_mesh_reparam_max_triangles(OPT_ARGS_NUM);
 double opt_mesh_ignore_parametrization(OPT_ARGS_NUM);
@@ -717,6 +721,7 @@ double opt_view_visible(OPT_ARGS_NUM);
 double opt_view_intervals_type(OPT_ARGS_NUM);
 double opt_view_saturate_values(OPT_ARGS_NUM);
 double opt_view_max_recursion_level(OPT_ARGS_NUM);
+double opt_view_storage(OPT_ARGS_NUM);
 double opt_view_adapt_visualization_grid(OPT_ARGS_NUM);
 double opt_view_target_error(OPT_ARGS_NUM);
 double opt_view_colormap_alpha(OPT_ARGS_NUM);
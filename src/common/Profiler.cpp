@@ -0,0 +1,287 @@
+// Gmsh - Copyright (C) 1997-2024 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+#include "GmshConfig.h"
+#include "GmshVersion.h"
+#include "GmshMessage.h"
+#include "Profiler.h"
+#include "StringUtils.h"
+#include "Context.h"
+#include "OS.h"
+
+namespace {
+  struct profileRecord {
+    std::size_t sequence, calls, memory;
+    double wall, cpu;
+    std::map<std::string, double> counters;
+    profileRecord() : sequence(0), calls(0), memory(0), wall(0.), cpu(0.) {}
+  };
+
+  // node of the tree of scopes, rebuilt from the paths when writing
+  struct profileNode {
+    std::string name;
+    const profileRecord *record;
+    std::size_t sequence;
+    std::vector<profileNode> children;
+    std::map<std::string, std::size_t> index;
+    profileNode() : record(nullptr), sequence(0) {}
+  };
+} // namespace
+
+// all the measurements are stored by path; counters incremented outside of
+// any scope are stored separately
+static std::map<std::string, profileRecord> records;
+static std::map<std::string, double> counters;
+static std::size_t sequence = 0;
+static double startWall = TimeOfDay(), startCpu = Cpu();
+static thread_local ProfileScope *current = nullptr;
+
+void Profiler::reset()
+{
+#pragma omp critical(profiler)
+  {
+    records.clear();
+    counters.clear();
+    startWall = TimeOfDay();
+    startCpu = Cpu();
+  }
+}
+
+std::string Profiler::getPath() { return current ? current->getPath() : ""; }
+
+void Profiler::count(const std::string &name, double value)
+{
+  if(current) {
+    current->count(name, value);
+    return;
+  }
+#pragma omp critical(profiler)
+  counters[name] += value;
+}
+
+static std::string scopeName(const std::string &name)
+{
+  // '/' separates the scopes in paths
+  std::string s(name);
+  std::replace(s.begin(), s.end(), '/', '_');
+  return s;
+}
+
+ProfileScope::ProfileScope(const std::string &name)
+  : _path(current ? current->_path + "/" + scopeName(name) : scopeName(name))
+{
+  _start();
+}
+
+ProfileScope::ProfileScope(const std::string &parent, const std::string &name)
+  : _path(parent.empty() ? scopeName(name) : parent + "/" + scopeName(name))
+{
+  _start();
+}
+
+void ProfileScope::_start()
+{
+  _previous = current;
+  current = this;
+  // in parallel regions, only measure the CPU time of the calling thread
+  _threadCpu = Msg::GetNumThreads() > 1;
+#pragma omp atomic capture
+  _sequence = sequence++;
+  _cpu = _threadCpu ? ThreadCpu() : Cpu();
+  _wall = TimeOfDay();
+}
+
+ProfileScope::~ProfileScope()
+{
+  double wall = TimeOfDay() - _wall;
+  double cpu = (_threadCpu ? ThreadCpu() : Cpu()) - _cpu;
+  std::size_t memory = GetMemoryUsage();
+  current = _previous;
+#pragma omp critical(profiler)
+  {
+    profileRecord &r = records[_path];
+    if(!r.calls || _sequence < r.sequence) r.sequence = _sequence;
+    r.calls++;
+    r.wall += wall;
+    r.cpu += cpu;
+    r.memory = std::max(r.memory, memory);
+    for(auto &c : _counters) r.counters[c.first] += c.second;
+  }
+}
+
+static std::size_t sortTree(profileNode &n)
+{
+  for(auto &c : n.children) {
+    std::size_t s = sortTree(c);
+    if(s < n.sequence) n.sequence = s;
+  }
+  std::sort(n.children.begin(), n.children.end(),
+            [](const profileNode &a, const profileNode &b) {
+              return a.sequence < b.sequence;
+            });
+  n.index.clear();
+  return n.sequence;
+}
+
+static void buildTree(const std::map<std::string, profileRecord> &rec,
+                      profileNode &root)
+{
+  for(auto &r : rec) {
+    profileNode *n = &root;
+    std::string::size_type b = 0;
+    while(1) {
+      std::string::size_type e = r.first.find('/', b);
+      std::string name = r.first.substr(b, e == std::string::npos ?
+                                             std::string::npos : e - b);
+      auto it = n->index.find(name);
+      if(it == n->index.end()) {
+        it = n->index.insert(std::make_pair(name, n->children.size())).first;
+        n->children.push_back(profileNode());
+        n->children.back().name = name;
+        n->children.back().sequence = r.second.sequence;
+      }
+      n = &n->children[it->second];
+      if(e == std::string::npos) break;
+      b = e + 1;
+    }
+    n->record = &r.second;
+    n->sequence = r.second.sequence;
+  }
+  sortTree(root);
+}
+
+static std::string escape(const std::string &s, char quote)
+{
+  std::string e;
+  for(char c : s) {
+    if(quote == '"' && c == '\\')
+      e += "\\\\";
+    else if(c == '"')
+      e += (quote == '"') ? "\\\"" : "\"\"";
+    else if((unsigned char)c >= 32)
+      e += c;
+  }
+  return e;
+}
+
+static void writeCounters(FILE *fp, const std::map<std::string, double> &c)
+{
+  fprintf(fp, "{");
+  for(auto it = c.begin(); it != c.end(); it++)
+    fprintf(fp, "%s\"%s\": %.16g", it == c.begin() ? "" : ", ",
+            escape(it->first, '"').c_str(), it->second);
+  fprintf(fp, "}");
+}
+
+static void writeJSON(FILE *fp, const profileNode &n, const std::string &path,
+                      int indent)
+{
+  std::string s(indent, ' ');
+  fprintf(fp, "%s{\n", s.c_str());
+  fprintf(fp, "%s  \"name\": \"%s\",\n", s.c_str(),
+          escape(n.name, '"').c_str());
+  fprintf(fp, "%s  \"path\": \"%s\",\n", s.c_str(), escape(path, '"').c_str());
+  if(n.record) {
+    const profileRecord &r = *n.record;
+    fprintf(fp, "%s  \"calls\": %zu,\n", s.c_str(), r.calls);
+    fprintf(fp, "%s  \"wall\": %.9g,\n", s.c_str(), r.wall);
+    fprintf(fp, "%s  \"cpu\": %.9g,\n", s.c_str(), r.cpu);
+    fprintf(fp, "%s  \"threads\": %.6g,\n", s.c_str(),
+            r.wall > 0. ? r.cpu / r.wall : 0.);
+    fprintf(fp, "%s  \"peakMemory\": %zu,\n", s.c_str(), r.memory);
+    fprintf(fp, "%s  \"counters\": ", s.c_str());
+    writeCounters(fp, r.counters);
+    fprintf(fp, ",\n");
+  }
+  fprintf(fp, "%s  \"children\": [", s.c_str());
+  for(std::size_t i = 0; i < n.children.size(); i++) {
+    fprintf(fp, i ? ",\n" : "\n");
+    writeJSON(fp, n.children[i], path + "/" + n.children[i].name, indent + 4);
+  }
+  if(n.children.empty())
+    fprintf(fp, "]\n");
+  else
+    fprintf(fp, "\n%s  ]\n", s.c_str());
+  fprintf(fp, "%s}", s.c_str());
+}
+
+static void writeCSV(FILE *fp, const profileNode &n, const std::string &path)
+{
+  if(n.record) {
+    const profileRecord &r = *n.record;
+    fprintf(fp, "\"%s\",%zu,%.9g,%.9g,%.6g,%zu,\"", escape(path, ',').c_str(),
+            r.calls, r.wall, r.cpu, r.wall > 0. ? r.cpu / r.wall : 0.,
+            r.memory);
+    for(auto it = r.counters.begin(); it != r.counters.end(); it++)
+      fprintf(fp, "%s%s=%.16g", it == r.counters.begin() ? "" : ";",
+              escape(it->first, ',').c_str(), it->second);
+    fprintf(fp, "\"\n");
+  }
+  for(auto &c : n.children)
+    writeCSV(fp, c, path.empty() ? c.name : path + "/" + c.name);
+}
+
+bool Profiler::write(const std::string &fileName)
+{
+  FILE *fp = Fopen(fileName.c_str(), "w");
+  if(!fp) {
+    Msg::Error("Unable to open file '%s'", fileName.c_str());
+    return false;
+  }
+
+  Msg::StatusBar(true, "Writing '%s'...", fileName.c_str());
+
+  std::map<std::string, profileRecord> rec;
+  std::map<std::string, double> c;
+  double wall, cpu;
+#pragma omp critical(profiler)
+  {
+    rec = records;
+    c = counters;
+    wall = TimeOfDay() - startWall;
+    cpu = Cpu() - startCpu;
+  }
+  profileNode root;
+  buildTree(rec, root);
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  std::string ext = SplitFileName(fileName)[2];
+  if(ext == ".csv" || ext == ".CSV") {
+    fprintf(fp, "path,calls,wall,cpu,threads,peakMemory,counters\n");
+    profileRecord total;
+    total.calls = 1;
+    total.wall = wall;
+    total.cpu = cpu;
+    total.memory = GetMemoryUsage();
+    total.counters = c;
+    root.record = &total;
+    writeCSV(fp, root, "");
+  }
+  else {
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"version\": \"%s\",\n", GMSH_VERSION);
+    fprintf(fp, "  \"maxThreads\": %d,\n", nthreads);
+    fprintf(fp, "  \"wall\": %.9g,\n", wall);
+    fprintf(fp, "  \"cpu\": %.9g,\n", cpu);
+    fprintf(fp, "  \"peakMemory\": %zu,\n", GetMemoryUsage());
+    fprintf(fp, "  \"counters\": ");
+    writeCounters(fp, c);
+    fprintf(fp, ",\n  \"children\": [");
+    for(std::size_t i = 0; i < root.children.size(); i++) {
+      fprintf(fp, i ? ",\n" : "\n");
+      writeJSON(fp, root.children[i], root.children[i].name, 4);
+    }
+    fprintf(fp, "%s}\n", root.children.empty() ? "]\n" : "\n  ]\n");
+  }
+
+  fclose(fp);
+  Msg::StatusBar(true, "Done writing '%s'", fileName.c_str());
+  return true;
+}
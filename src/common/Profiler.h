@@ -0,0 +1,63 @@
+// Gmsh - Copyright (C) 1997-2024 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <string>
+#include <map>
+
+// Hierarchical profile of the operations performed by Gmsh. Each
+// ProfileScope object measures the wall and CPU time spent between its
+// construction and its destruction, as well as the peak memory usage; scopes
+// are nested (per thread), and are identified by their path, e.g.
+// "Mesh/2D/Surface 12". The measurements of all the scopes with the same path
+// are accumulated, together with the counters (number of insertions, swaps,
+// ...) that are incremented while they are active. The profile can be written
+// in JSON or CSV format with the "-profile" command line option or with
+// gmsh::logger::writeProfile().
+//
+// Scopes are meant to be used at the granularity of a stage of the pipeline or
+// of a model entity, not in inner loops.
+class Profiler {
+public:
+  // clear all the measurements
+  static void reset();
+  // path of the innermost active scope of the calling thread
+  static std::string getPath();
+  // add value to the counter name of the innermost active scope of the
+  // calling thread
+  static void count(const std::string &name, double value = 1.);
+  // write the profile in JSON format (or in CSV format if the extension of
+  // fileName is ".csv")
+  static bool write(const std::string &fileName);
+};
+
+class ProfileScope {
+private:
+  std::string _path;
+  ProfileScope *_previous;
+  bool _threadCpu;
+  std::size_t _sequence;
+  double _wall, _cpu;
+  std::map<std::string, double> _counters;
+  void _start();
+
+public:
+  // scope nested in the innermost active scope of the calling thread
+  ProfileScope(const std::string &name);
+  // scope nested in the scope with the given path: use this in parallel loops,
+  // where the calling thread can differ from the one that opened the parent
+  // scope (see Profiler::getPath())
+  ProfileScope(const std::string &parent, const std::string &name);
+  ~ProfileScope();
+  const std::string &getPath() const { return _path; }
+  void count(const std::string &name, double value = 1.)
+  {
+    _counters[name] += value;
+  }
+};
+
+#endif
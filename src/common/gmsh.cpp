@@ -44,8 +44,10 @@
 #include "Context.h"
 #include "polynomialBasis.h"
 #include "pyramidalBasis.h"
+#include "QuadratureBasis.h"
 #include "Numeric.h"
 #include "OS.h"
+#include "Profiler.h"
 #include "OpenFile.h"
 #include "HierarchicalBasisH1Quad.h"
 #include "HierarchicalBasisH1Tria.h"
@@ -998,21 +1000,21 @@ gmsh::model::getParametrization(const int dim, const int tag,
     Msg::Error("Number of coordinates should be a multiple of 3");
     return;
   }
+  std::vector<SPoint3> pts(coord.size() / 3);
+  for(std::size_t i = 0; i < pts.size(); i++)
+    pts[i] = SPoint3(coord[3 * i], coord[3 * i + 1], coord[3 * i + 2]);
   if(dim == 1) {
     GEdge *ge = static_cast<GEdge *>(entity);
-    for(std::size_t i = 0; i < coord.size(); i += 3) {
-      SPoint3 p(coord[i], coord[i + 1], coord[i + 2]);
-      double t = ge->parFromPoint(p);
-      parametricCoord.push_back(t);
-    }
+    ge->parFromPoints(pts, parametricCoord);
   }
   else if(dim == 2) {
     GFace *gf = static_cast<GFace *>(entity);
-    for(std::size_t i = 0; i < coord.size(); i += 3) {
-      SPoint3 p(coord[i], coord[i + 1], coord[i + 2]);
-      SPoint2 uv = gf->parFromPoint(p, true, true);
-      parametricCoord.push_back(uv.x());
-      parametricCoord.push_back(uv.y());
+    std::vector<SPoint2> uv;
+    gf->parFromPoints(pts, uv, nullptr, true, true);
+    parametricCoord.resize(2 * uv.size());
+    for(std::size_t i = 0; i < uv.size(); i++) {
+      parametricCoord[2 * i] = uv[i].x();
+      parametricCoord[2 * i + 1] = uv[i].y();
     }
   }
 }
@@ -1142,30 +1144,24 @@ GMSH_API void gmsh::model::getClosestPoint(const int dim, const int tag,
     Msg::Error("Number of coordinates should be a multiple of 3");
     return;
   }
+  std::vector<SPoint3> pts(coord.size() / 3);
+  for(std::size_t i = 0; i < pts.size(); i++)
+    pts[i] = SPoint3(coord[3 * i], coord[3 * i + 1], coord[3 * i + 2]);
+  std::vector<GPoint> res;
   if(dim == 1) {
     GEdge *ge = static_cast<GEdge *>(entity);
-    for(std::size_t i = 0; i < coord.size(); i += 3) {
-      SPoint3 p(coord[i], coord[i + 1], coord[i + 2]);
-      double t;
-      GPoint pp = ge->closestPoint(p, t);
-      closestCoord.push_back(pp.x());
-      closestCoord.push_back(pp.y());
-      closestCoord.push_back(pp.z());
-      parametricCoord.push_back(t);
-    }
+    ge->closestPoints(pts, res);
   }
   else if(dim == 2) {
     GFace *gf = static_cast<GFace *>(entity);
-    for(std::size_t i = 0; i < coord.size(); i += 3) {
-      SPoint3 p(coord[i], coord[i + 1], coord[i + 2]);
-      double uv[2] = {0, 0};
-      GPoint pp = gf->closestPoint(p, uv);
-      closestCoord.push_back(pp.x());
-      closestCoord.push_back(pp.y());
-      closestCoord.push_back(pp.z());
-      parametricCoord.push_back(uv[0]);
-      parametricCoord.push_back(uv[1]);
-    }
+    gf->closestPoints(pts, res);
+  }
+  for(std::size_t i = 0; i < res.size(); i++) {
+    closestCoord.push_back(res[i].x());
+    closestCoord.push_back(res[i].y());
+    closestCoord.push_back(res[i].z());
+    parametricCoord.push_back(res[i].u());
+    if(dim == 2) parametricCoord.push_back(res[i].v());
   }
 }
 
@@ -2464,6 +2460,75 @@ static bool _getFunctionSpaceInfo(const std::string &fsType,
   return false;
 }
 
+// return the tabulated quadrature basis of element type "elementType" if the
+// local coordinates are exactly the points of one of the Gauss rules (e.g. as
+// returned by getIntegrationPoints), and nullptr otherwise. The Gauss rules
+// are tabulated lazily in static tables that are not thread-safe: the rules
+// with the right number of points are thus looked up once per element family,
+// and the bases are created, under a lock.
+struct quadratureRule {
+  int order;
+  bool tensor;
+  fullMatrix<double> points;
+};
+
+static const QuadratureBasis *
+_getQuadratureBasis(const int elementType,
+                    const std::vector<double> &localCoord)
+{
+  const int numPoints = localCoord.size() / 3;
+  const int familyType = ElementType::getParentType(elementType);
+  if(!numPoints || familyType == TYPE_POLYG || familyType == TYPE_POLYH)
+    return nullptr;
+
+  static std::map<std::pair<int, int>, std::vector<quadratureRule> > rules;
+  const std::vector<quadratureRule> *candidates = nullptr;
+#pragma omp critical(gmshQuadratureBasis)
+  {
+    auto key = std::make_pair(familyType, numPoints);
+    auto it = rules.find(key);
+    if(it == rules.end()) {
+      std::vector<quadratureRule> r;
+      for(int tensor = 0; tensor < 2; tensor++) {
+        for(int order = 0; order < 64; order++) {
+          fullMatrix<double> pts;
+          fullVector<double> wgs;
+          gaussIntegration::get(familyType, order, pts, wgs,
+                                tensor ? true : false);
+          if(pts.size1() > numPoints) break;
+          if(pts.size1() != numPoints || pts.size2() != 3) continue;
+          quadratureRule q;
+          q.order = order;
+          q.tensor = tensor ? true : false;
+          q.points = pts;
+          r.push_back(q);
+        }
+      }
+      it = rules.insert(std::make_pair(key, r)).first;
+    }
+    candidates = &it->second;
+  }
+
+  // the entries of the map are never modified once inserted
+  for(const quadratureRule &q : *candidates) {
+    bool same = true;
+    for(int i = 0; i < numPoints && same; i++) {
+      for(int j = 0; j < 3; j++) {
+        if(q.points(i, j) != localCoord[3 * i + j]) {
+          same = false;
+          break;
+        }
+      }
+    }
+    if(!same) continue;
+    const QuadratureBasis *qb = nullptr;
+#pragma omp critical(gmshQuadratureBasis)
+    qb = BasisFactory::getQuadratureBasis(elementType, q.order, q.tensor);
+    return qb;
+  }
+  return nullptr;
+}
+
 GMSH_API void gmsh::model::mesh::getJacobians(
   const int elementType, const std::vector<double> &localCoord,
   std::vector<double> &jacobians, std::vector<double> &determinants,
@@ -2511,7 +2576,45 @@ GMSH_API void gmsh::model::mesh::getJacobians(
   {
     const size_t begin = (task * numElements) / numTasks;
     const size_t end = ((task + 1) * numElements) / numTasks;
-    if(haveDeterminants && haveJacobians && havePoints) {
+    const QuadratureBasis *qb = _getQuadratureBasis(elementType, localCoord);
+    if(qb) {
+      // the evaluation points are the points of a Gauss rule: use the
+      // tabulated gradients and compute all the Jacobians of an element with a
+      // single matrix-matrix product
+      fullVector<double> det;
+      fullMatrix<double> jac, xyz;
+      fullMatrix<double> nodes(qb->getNumShapeFunctions(), 3);
+      size_t o = 0;
+      size_t idx = begin * numPoints;
+      for(std::size_t i = 0; i < entities.size(); i++) {
+        GEntity *ge = entities[i];
+        for(std::size_t j = 0; j < ge->getNumMeshElementsByType(familyType);
+            j++) {
+          if(o >= begin && o < end) {
+            MElement *e = ge->getMeshElementByType(familyType, j);
+            e->getJacobians(qb, det, &jac);
+            if(havePoints) {
+              e->getNodesCoord(nodes);
+              qb->getPointsFromNodes(nodes, xyz);
+            }
+            for(int k = 0; k < numPoints; k++) {
+              if(haveDeterminants) determinants[idx] = det(k);
+              if(haveJacobians) {
+                for(int a = 0; a < 3; a++)
+                  for(int b = 0; b < 3; b++)
+                    jacobians[idx * 9 + 3 * a + b] = jac(b, 3 * k + a);
+              }
+              if(havePoints) {
+                for(int b = 0; b < 3; b++) coord[idx * 3 + b] = xyz(b, k);
+              }
+              idx++;
+            }
+          }
+          o++;
+        }
+      }
+    }
+    else if(haveDeterminants && haveJacobians && havePoints) {
       std::vector<std::vector<SVector3> > gsf;
       size_t o = 0;
       size_t idx = begin * numPoints;
@@ -2816,7 +2919,31 @@ GMSH_API void gmsh::model::mesh::getBasisFunctions(
         basis = BasisFactory::getNodalBasis(newType);
       }
     }
-    if(basis) {
+    const QuadratureBasis *qb = nullptr;
+    if(basis) qb = _getQuadratureBasis(basis->type, localCoord);
+    if(qb) {
+      // copy the tabulated values at the Gauss points
+      const std::size_t n = qb->getNumShapeFunctions();
+      basisFunctions.resize(n * numComponents * numberOfGaussPoints, 0.);
+      for(std::size_t i = 0; i < numberOfGaussPoints; i++) {
+        switch(numComponents) {
+        case 1: {
+          const double *s = qb->getShapeFunctions(i);
+          for(std::size_t j = 0; j < n; j++) basisFunctions[n * i + j] = s[j];
+        } break;
+        case 3: {
+          fullMatrix<double> ds;
+          qb->getGradShapeFunctions(i, ds);
+          for(std::size_t j = 0; j < n; j++) {
+            basisFunctions[n * 3 * i + 3 * j] = ds(j, 0);
+            basisFunctions[n * 3 * i + 3 * j + 1] = ds(j, 1);
+            basisFunctions[n * 3 * i + 3 * j + 2] = ds(j, 2);
+          }
+        } break;
+        }
+      }
+    }
+    else if(basis) {
       const std::size_t n = basis->getNumShapeFunctions();
       basisFunctions.resize(n * numComponents * numberOfGaussPoints, 0.);
       double s[1256], ds[1256][3];
@@ -5277,6 +5404,46 @@ GMSH_API void gmsh::model::mesh::computeRenumbering
   }
 }
 
+GMSH_API void gmsh::model::mesh::computeNodeAndElementRenumbering
+  (std::vector<std::size_t> &oldNodeTags,
+   std::vector<std::size_t> &newNodeTags,
+   std::vector<std::size_t> &oldElementTags,
+   std::vector<std::size_t> &newElementTags,
+   const std::string &method,
+   const std::vector<std::size_t> &elementTags)
+{
+  if(!_checkInit()) return;
+  std::map<std::size_t, std::size_t> remap, eremap;
+#if defined(HAVE_MESH)
+  if(method == "RCMK")
+    meshRenumber_Vertices_RCMK(elementTags, remap, &eremap);
+  else if(method == "Hilbert")
+    meshRenumber_Vertices_Hilbert(elementTags, remap, &eremap);
+  else if(method == "Metis")
+    meshRenumber_Vertices_Metis(elementTags, remap, &eremap);
+  else
+    Msg::Error("Unknown renumbering method %s", method.c_str());
+#else
+  Msg::Error("Computing renumbering requires the mesh module");
+#endif
+  oldNodeTags.clear();
+  newNodeTags.clear();
+  oldNodeTags.reserve(remap.size());
+  newNodeTags.reserve(remap.size());
+  for(auto r : remap) {
+    oldNodeTags.push_back(r.first);
+    newNodeTags.push_back(r.second);
+  }
+  oldElementTags.clear();
+  newElementTags.clear();
+  oldElementTags.reserve(eremap.size());
+  newElementTags.reserve(eremap.size());
+  for(auto r : eremap) {
+    oldElementTags.push_back(r.first);
+    newElementTags.push_back(r.second);
+  }
+}
+
 GMSH_API void gmsh::model::mesh::renumberNodes
   (const std::vector<std::size_t> &oldTags,
    const std::vector<std::size_t> &newTags)
@@ -7332,6 +7499,8 @@ _addModelData(const int tag, const int step, const std::string &modelName,
     Msg::Error("Could not add model data");
     return;
   }
+  if(view->getOptions()->storage)
+    d->storeSteps(view->getOptions()->storage, step);
   if(view->getOptions()->adaptVisualizationGrid)
     d->initAdaptiveData(view->getOptions()->timeStep,
                         view->getOptions()->maxRecursionLevel,
@@ -7403,6 +7572,8 @@ static stepData<double> *_getModelData(const int tag, const int step,
                step);
     return nullptr;
   }
+  if(view->getOptions()->storage)
+    d->storeSteps(view->getOptions()->storage, step);
   time = s->getTime();
   numComponents = s->getNumComponents();
   numEnt = 0;
@@ -8841,6 +9012,18 @@ GMSH_API double gmsh::logger::getCpuTime()
   return Cpu();
 }
 
+GMSH_API void gmsh::logger::writeProfile(const std::string &fileName)
+{
+  if(!_checkInit()) return;
+  Profiler::write(fileName);
+}
+
+GMSH_API void gmsh::logger::resetProfile()
+{
+  if(!_checkInit()) return;
+  Profiler::reset();
+}
+
 GMSH_API void gmsh::logger::getLastError(std::string &error)
 {
   if(!_checkInit()) return;
@@ -202,6 +202,8 @@ statisticsWindow::statisticsWindow(int deltaFontSize)
       value[num++] =
         new Fl_Output(2 * WB, 2 * WB + 10 * BH, IW, BH, "Trihedra");
       value[num++] = new Fl_Output(2 * WB, 2 * WB + 11 * BH, IW, BH, "Strings");
+      value[num++] =
+        new Fl_Output(2 * WB, 2 * WB + 12 * BH, IW, BH, "Memory (Mb)");
       group[2]->end();
     }
     o->end();
@@ -370,6 +372,18 @@ void statisticsWindow::compute(bool elementQuality)
   sprintf(label[num], "%g", s[37]);
   value[num]->value(label[num]);
   num++;
+  sprintf(label[num], "%.4g", s[38]);
+  value[num]->value(label[num]);
+  std::string tip;
+  for(std::size_t i = 0; i < PView::list.size(); i++) {
+    char tmp[256];
+    snprintf(tmp, sizeof(tmp), "View[%d] '%s': %.4g Mb\n", (int)i,
+             PView::list[i]->getData()->getName().c_str(),
+             PView::list[i]->getMemoryInMb());
+    tip += tmp;
+  }
+  value[num]->copy_tooltip(tip.c_str());
+  num++;
 
   static char mem[256];
   std::size_t m = GetMemoryUsage();
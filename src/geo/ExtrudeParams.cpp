@@ -77,7 +77,7 @@ void ExtrudeParams::Extrude(int iLayer, int iElemLayer, double &x, double &y,
 
 void ExtrudeParams::Extrude(double t, double &x, double &y, double &z)
 {
-  double dx, dy, dz, angle;
+  double dx, dy, dz;
   double n[3] = {0., 0., 0.};
 
   switch(geo.Type) {
@@ -89,17 +89,9 @@ void ExtrudeParams::Extrude(double t, double &x, double &y, double &z)
     y += dy;
     z += dz;
     break;
-  case ROTATE:
-    angle = geo.angle;
-    geo.angle = geo.angle * t;
-    ProtudeXYZ(x, y, z, this);
-    geo.angle = angle;
-    break;
+  case ROTATE: ProtudeXYZ(x, y, z, this, t); break;
   case TRANSLATE_ROTATE:
-    angle = geo.angle;
-    geo.angle = geo.angle * t;
-    ProtudeXYZ(x, y, z, this);
-    geo.angle = angle;
+    ProtudeXYZ(x, y, z, this, t);
     dx = geo.trans[0] * t;
     dy = geo.trans[1] * t;
     dz = geo.trans[2] * t;
@@ -30,6 +30,7 @@ GEdge::GEdge(GModel *model, int tag, GVertex *v0, GVertex *v1)
   if(_v0) _v0->addEdge(this);
   if(_v1 && _v1 != _v0) _v1->addEdge(this);
   meshStatistics.status = GEdge::PENDING;
+  meshSizeSamples.cursor = 0;
   GEdge::resetMeshAttributes();
 }
 
@@ -38,6 +39,7 @@ GEdge::GEdge(GModel *model, int tag)
     _v0(nullptr), _v1(nullptr), masterOrientation(0), compoundCurve(nullptr)
 {
   meshStatistics.status = GEdge::PENDING;
+  meshSizeSamples.cursor = 0;
   GEdge::resetMeshAttributes();
 }
 
@@ -194,6 +196,7 @@ void GEdge::resetMeshAttributes()
   meshAttributes.meshSizeFactor = 1.;
   meshAttributes.minimumMeshSegments = 1;
   meshAttributes.reverseMesh = false;
+  clearMeshSizeSamples();
 }
 
 void GEdge::addFace(GFace *f)
@@ -600,6 +603,128 @@ double GEdge::parFromPoint(const SPoint3 &P) const
   return t;
 }
 
+// Newton iterations for the projection of p on the curve, starting from t;
+// the iterations can converge to an end of the parameter range if the closest
+// point is there
+static bool projectOnCurve(const GEdge *ge, const SPoint3 &p, double &t,
+                           double tMin, double tMax)
+{
+  const int MaxIter = 25;
+  const double tol = 1.e-8 * (tMax - tMin);
+  double u = t;
+  for(int iter = 0; iter < MaxIter; iter++) {
+    const SVector3 r = ge->position(u) - SVector3(p.x(), p.y(), p.z());
+    const SVector3 der = ge->firstDer(u);
+    const double d2 = dot(der, der);
+    if(!(d2 > 0.)) return false;
+    const double du = -dot(r, der) / d2;
+    const double uNew = std::min(tMax, std::max(tMin, u + du));
+    const double step = std::abs(uNew - u);
+    u = uNew;
+    if(step <= tol) {
+      t = u;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void projectOnCurve(const GEdge *ge, const std::vector<SPoint3> &pts,
+                           const std::vector<double> *guesses,
+                           std::vector<double> &t,
+                           std::vector<std::size_t> &failed)
+{
+  const Range<double> range = ge->parBounds(0);
+  const double tMin = std::min(range.low(), range.high());
+  const double tMax = std::max(range.low(), range.high());
+
+  // coarse sampling of the curve, to seed the iterations
+  const int n = 100;
+  std::vector<double> st(n + 1);
+  std::vector<SPoint3> sxyz(n + 1);
+  for(int i = 0; i <= n; i++) {
+    st[i] = tMin + (tMax - tMin) * i / n;
+    GPoint gp = ge->point(st[i]);
+    sxyz[i] = SPoint3(gp.x(), gp.y(), gp.z());
+  }
+
+  t.resize(pts.size());
+  std::vector<char> ok(pts.size(), 0);
+  const int nthreads = Msg::GetMaxThreads();
+#pragma omp parallel for schedule(dynamic, 64) num_threads(nthreads)
+  for(std::size_t i = 0; i < pts.size(); i++) {
+    double dmin = 1.e300, seed = tMin;
+    if(guesses) {
+      const double g = std::min(tMax, std::max(tMin, (*guesses)[i]));
+      GPoint gp = ge->point(g);
+      seed = g;
+      dmin = pts[i].distance(SPoint3(gp.x(), gp.y(), gp.z()));
+    }
+    for(int k = 0; k <= n; k++) {
+      const double d = pts[i].distance(sxyz[k]);
+      if(d < dmin) {
+        dmin = d;
+        seed = st[k];
+      }
+    }
+    double u = seed;
+    if(projectOnCurve(ge, pts[i], u, tMin, tMax)) {
+      // reject local minima farther away than the seed
+      GPoint gp = ge->point(u);
+      if(pts[i].distance(SPoint3(gp.x(), gp.y(), gp.z())) <=
+         dmin * (1. + 1.e-12)) {
+        t[i] = u;
+        ok[i] = 1;
+      }
+    }
+  }
+  for(std::size_t i = 0; i < pts.size(); i++)
+    if(!ok[i]) failed.push_back(i);
+}
+
+void GEdge::parFromPoints(const std::vector<SPoint3> &pts,
+                          std::vector<double> &t,
+                          const std::vector<double> *guesses) const
+{
+  std::vector<std::size_t> failed;
+  if(geomType() == BoundaryLayerCurve) {
+    t.resize(pts.size());
+    for(std::size_t i = 0; i < pts.size(); i++) failed.push_back(i);
+  }
+  else {
+    projectOnCurve(this, pts, guesses, t, failed);
+  }
+  for(auto i : failed) t[i] = parFromPoint(pts[i]);
+  Msg::Debug("Batched parametrization of %lu points on curve %d (%lu "
+             "fallbacks)",
+             pts.size(), tag(), failed.size());
+}
+
+void GEdge::closestPoints(const std::vector<SPoint3> &pts,
+                          std::vector<GPoint> &res,
+                          const std::vector<double> *guesses) const
+{
+  std::vector<std::size_t> failed;
+  std::vector<double> t;
+  res.resize(pts.size());
+  if(geomType() == BoundaryLayerCurve) {
+    for(std::size_t i = 0; i < pts.size(); i++) failed.push_back(i);
+  }
+  else {
+    projectOnCurve(this, pts, guesses, t, failed);
+    const int nthreads = Msg::GetMaxThreads();
+#pragma omp parallel for schedule(dynamic, 64) num_threads(nthreads)
+    for(std::size_t i = 0; i < pts.size(); i++) res[i] = point(t[i]);
+  }
+  for(auto i : failed) {
+    double u = guesses ? (*guesses)[i] : 0.;
+    res[i] = closestPoint(pts[i], u);
+  }
+  Msg::Debug("Batched closest point computation for %lu points on curve %d "
+             "(%lu fallbacks)",
+             pts.size(), tag(), failed.size());
+}
+
 bool GEdge::refineProjection(const SVector3 &Q, double &u, int MaxIter,
                              double relax, double tol, double &err) const
 {
@@ -1012,4 +1137,6 @@ void GEdge::setMeshSizeParametric(const std::vector<double> u,
     _u_lc[i] = u[index[i]];
     _lc[i] = lc[index[i]];
   }
+  // the cached mesh size samples are no longer valid
+  clearMeshSizeSamples();
 }
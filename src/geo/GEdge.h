@@ -8,6 +8,7 @@
 
 #include <string>
 #include <vector>
+#include <array>
 #include <stdio.h>
 #include "GmshMessage.h"
 #include "GmshDefines.h"
@@ -236,6 +237,14 @@ public:
   // return the parmater location on the edge given a point in space
   // that is on the edge
   virtual double parFromPoint(const SPoint3 &P) const;
+
+  // batched versions of parFromPoint and closestPoint (see GFace): Newton
+  // iterations seeded by the initial guesses or a coarse sampling of the
+  // curve, computed in parallel, with a sequential fallback
+  void parFromPoints(const std::vector<SPoint3> &pts, std::vector<double> &t,
+                     const std::vector<double> *guesses = nullptr) const;
+  void closestPoints(const std::vector<SPoint3> &pts, std::vector<GPoint> &res,
+                     const std::vector<double> *guesses = nullptr) const;
   virtual bool refineProjection(const SVector3 &Q, double &u, int MaxIter,
                                 double relax, double tol, double &err) const;
 
@@ -269,6 +278,23 @@ public:
     mutable GEntity::MeshGenerationStatus status;
   } meshStatistics;
 
+  // samples (t, x, y, z, norm of the tangent vector, mesh size) of the mesh
+  // size along the edge, in the order in which they were computed by the 1D
+  // mesh generator, with the signature of the mesh size parameters they were
+  // computed with; they are reused as long as the signature does not change
+  // (see meshGEdge.cpp)
+  struct {
+    std::vector<double> signature;
+    std::vector<std::array<double, 6> > values;
+    std::size_t cursor;
+  } meshSizeSamples;
+  void clearMeshSizeSamples()
+  {
+    meshSizeSamples.signature.clear();
+    meshSizeSamples.values.clear();
+    meshSizeSamples.cursor = 0;
+  }
+
   void addLine(MLine *line) { lines.push_back(line); }
   void addElement(MElement *e);
   void removeElement(MElement *e, bool del=false);
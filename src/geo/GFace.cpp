@@ -1279,6 +1279,152 @@ GPoint GFace::closestPoint(const SPoint3 &queryPoint,
 #endif
 }
 
+// Gauss-Newton iterations for the projection of p on the surface, starting
+// from uv; returns false if the iterations do not converge to a point strictly
+// inside the parameter bounds
+static bool projectOnSurface(const GFace *gf, const SPoint3 &p, double uv[2],
+                             const double bounds[4])
+{
+  const int MaxIter = 25;
+  const double tol =
+    1.e-16 * (std::pow(bounds[1] - bounds[0], 2) +
+              std::pow(bounds[3] - bounds[2], 2));
+  double u = uv[0], v = uv[1];
+  for(int iter = 0; iter < MaxIter; iter++) {
+    GPoint P = gf->point(u, v);
+    if(!P.succeeded()) return false;
+    Pair<SVector3, SVector3> der = gf->firstDer(SPoint2(u, v));
+    const SVector3 &du = der.first(), &dv = der.second();
+    const SVector3 r(P.x() - p.x(), P.y() - p.y(), P.z() - p.z());
+    const double a = dot(du, du), b = dot(du, dv), c = dot(dv, dv);
+    const double det = a * c - b * b;
+    if(!(det > 1.e-14 * a * c)) return false;
+    const double ru = dot(du, r), rv = dot(dv, r);
+    const double su = -(c * ru - b * rv) / det, sv = -(a * rv - b * ru) / det;
+    u += su;
+    v += sv;
+    if(u < bounds[0] || u > bounds[1] || v < bounds[2] || v > bounds[3])
+      return false;
+    if(su * su + sv * sv <= tol) {
+      uv[0] = u;
+      uv[1] = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+// project the points in parallel with projectOnSurface, and return the
+// indices of the points for which the iterations failed
+static void projectOnSurface(const GFace *gf, const std::vector<SPoint3> &pts,
+                             const std::vector<SPoint2> *guesses,
+                             std::vector<SPoint2> &uv,
+                             std::vector<std::size_t> &failed)
+{
+  const Range<double> ru = gf->parBounds(0), rv = gf->parBounds(1);
+  const double bounds[4] = {ru.low(), ru.high(), rv.low(), rv.high()};
+
+  // coarse sampling of the surface, to seed the iterations
+  const int n = 16;
+  std::vector<SPoint2> suv((n + 1) * (n + 1));
+  std::vector<SPoint3> sxyz((n + 1) * (n + 1));
+  std::vector<char> sok((n + 1) * (n + 1));
+  for(int i = 0; i <= n; i++) {
+    for(int j = 0; j <= n; j++) {
+      const int k = i * (n + 1) + j;
+      suv[k] = SPoint2(bounds[0] + (bounds[1] - bounds[0]) * i / n,
+                       bounds[2] + (bounds[3] - bounds[2]) * j / n);
+      GPoint gp = gf->point(suv[k]);
+      sxyz[k] = SPoint3(gp.x(), gp.y(), gp.z());
+      sok[k] = gp.succeeded();
+    }
+  }
+
+  uv.resize(pts.size());
+  std::vector<char> ok(pts.size(), 0);
+  const int nthreads = Msg::GetMaxThreads();
+#pragma omp parallel for schedule(dynamic, 64) num_threads(nthreads)
+  for(std::size_t i = 0; i < pts.size(); i++) {
+    double dmin = 1.e300;
+    SPoint2 seed;
+    if(guesses) {
+      GPoint gp = gf->point((*guesses)[i]);
+      if(gp.succeeded()) {
+        seed = (*guesses)[i];
+        dmin = pts[i].distance(SPoint3(gp.x(), gp.y(), gp.z()));
+      }
+    }
+    for(std::size_t k = 0; k < sxyz.size(); k++) {
+      if(!sok[k]) continue;
+      const double d = pts[i].distance(sxyz[k]);
+      if(d < dmin) {
+        dmin = d;
+        seed = suv[k];
+      }
+    }
+    double p[2] = {seed.x(), seed.y()};
+    if(dmin < 1.e300 && projectOnSurface(gf, pts[i], p, bounds)) {
+      // reject local minima farther away than the seed
+      GPoint gp = gf->point(p[0], p[1]);
+      if(pts[i].distance(SPoint3(gp.x(), gp.y(), gp.z())) <=
+         dmin * (1. + 1.e-12)) {
+        uv[i] = SPoint2(p[0], p[1]);
+        ok[i] = 1;
+      }
+    }
+  }
+  for(std::size_t i = 0; i < pts.size(); i++)
+    if(!ok[i]) failed.push_back(i);
+}
+
+void GFace::parFromPoints(const std::vector<SPoint3> &pts,
+                          std::vector<SPoint2> &uv,
+                          const std::vector<SPoint2> *guesses, bool onSurface,
+                          bool convTestXYZ) const
+{
+  std::vector<std::size_t> failed;
+  if(geomType() == DiscreteSurface || geomType() == BoundaryLayerSurface) {
+    uv.resize(pts.size());
+    for(std::size_t i = 0; i < pts.size(); i++) failed.push_back(i);
+  }
+  else {
+    projectOnSurface(this, pts, guesses, uv, failed);
+  }
+  for(auto i : failed) uv[i] = parFromPoint(pts[i], onSurface, convTestXYZ);
+  Msg::Debug("Batched parametrization of %lu points on surface %d (%lu "
+             "fallbacks)",
+             pts.size(), tag(), failed.size());
+}
+
+void GFace::closestPoints(const std::vector<SPoint3> &pts,
+                          std::vector<GPoint> &res,
+                          const std::vector<SPoint2> *guesses) const
+{
+  std::vector<std::size_t> failed;
+  std::vector<SPoint2> uv;
+  res.resize(pts.size());
+  if(geomType() == DiscreteSurface || geomType() == BoundaryLayerSurface) {
+    for(std::size_t i = 0; i < pts.size(); i++) failed.push_back(i);
+  }
+  else {
+    projectOnSurface(this, pts, guesses, uv, failed);
+    const int nthreads = Msg::GetMaxThreads();
+#pragma omp parallel for schedule(dynamic, 64) num_threads(nthreads)
+    for(std::size_t i = 0; i < pts.size(); i++) res[i] = point(uv[i]);
+  }
+  for(auto i : failed) {
+    double guess[2] = {0., 0.};
+    if(guesses) {
+      guess[0] = (*guesses)[i].x();
+      guess[1] = (*guesses)[i].y();
+    }
+    res[i] = closestPoint(pts[i], guess);
+  }
+  Msg::Debug("Batched closest point computation for %lu points on surface %d "
+             "(%lu fallbacks)",
+             pts.size(), tag(), failed.size());
+}
+
 bool GFace::containsParam(const SPoint2 &pt)
 {
   if(geomType() == BoundaryLayerSurface) return false;
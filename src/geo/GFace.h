@@ -197,6 +197,18 @@ public:
   virtual GPoint closestPoint(const SPoint3 &queryPoint,
                               const double initialGuess[2]) const;
 
+  // batched versions of parFromPoint and closestPoint, for large sets of
+  // points: each projection is a Newton iteration started from the best of
+  // the initial guess (if provided) and of the nearest node of a coarse
+  // sampling of the surface, and the points are processed in parallel. Points
+  // for which the iterations do not converge are then handled (sequentially)
+  // by parFromPoint or closestPoint.
+  void parFromPoints(const std::vector<SPoint3> &pts, std::vector<SPoint2> &uv,
+                     const std::vector<SPoint2> *guesses = nullptr,
+                     bool onSurface = true, bool convTestXYZ = false) const;
+  void closestPoints(const std::vector<SPoint3> &pts, std::vector<GPoint> &res,
+                     const std::vector<SPoint2> *guesses = nullptr) const;
+
   // return the normal to the face at the given parameter location
   virtual SVector3 normal(const SPoint2 &param) const;
 
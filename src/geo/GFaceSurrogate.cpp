@@ -0,0 +1,317 @@
+// Gmsh - Copyright (C) 1997-2024 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#include <cmath>
+#include <algorithm>
+#include "GFaceSurrogate.h"
+
+// cubic Lagrange basis functions on the nodes 0, 1/3, 2/3, 1, in monomial
+// form: L_i(s) = sum_k lagrange[i][k] s^k
+static const double lagrange[4][4] = {{1., -5.5, 9., -4.5},
+                                      {0., 9., -22.5, 13.5},
+                                      {0., -4.5, 18., -13.5},
+                                      {0., 1., -4.5, 4.5}};
+
+GFaceSurrogate::patch::patch(double u0_, double u1_, double v0_, double v1_,
+                             int depth_)
+  : u0(u0_), u1(u1_), v0(v0_), v1(v1_), depth(depth_), state(UNBUILT)
+{
+  for(int i = 0; i < 4; i++) children[i] = nullptr;
+}
+
+GFaceSurrogate::patch::~patch()
+{
+  for(int i = 0; i < 4; i++) delete children[i];
+}
+
+GFaceSurrogate::GFaceSurrogate(const evaluator &exact, double umin,
+                               double umax, double vmin, double vmax,
+                               double tolerance, int maxDepth)
+  : _exact(exact), _umin(umin), _umax(umax), _vmin(vmin), _vmax(vmax),
+    _tolerance(tolerance), _maxDepth(maxDepth), _numPatches(0),
+    _numExactPatches(0)
+{
+  _root = new patch(umin, umax, vmin, vmax, 0);
+  // size of the surface, estimated by sampling its parametrization
+  double min[3], max[3];
+  const int n = 8;
+  for(int i = 0; i <= n; i++) {
+    for(int j = 0; j <= n; j++) {
+      double xyz[3];
+      _exact(umin + (umax - umin) * i / n, vmin + (vmax - vmin) * j / n, xyz,
+             nullptr, nullptr, nullptr, nullptr, nullptr);
+      for(int d = 0; d < 3; d++) {
+        min[d] = (i || j) ? std::min(min[d], xyz[d]) : xyz[d];
+        max[d] = (i || j) ? std::max(max[d], xyz[d]) : xyz[d];
+      }
+    }
+  }
+  _size = std::sqrt((max[0] - min[0]) * (max[0] - min[0]) +
+                    (max[1] - min[1]) * (max[1] - min[1]) +
+                    (max[2] - min[2]) * (max[2] - min[2]));
+}
+
+GFaceSurrogate::~GFaceSurrogate() { delete _root; }
+
+// maximum relative error on the curvatures
+static const double curvatureTolerance = 1.e-2;
+
+static double dist(const double a[3], const double b[3])
+{
+  return std::sqrt((a[0] - b[0]) * (a[0] - b[0]) +
+                   (a[1] - b[1]) * (a[1] - b[1]) +
+                   (a[2] - b[2]) * (a[2] - b[2]));
+}
+
+static double norm(const double a[3])
+{
+  return std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+}
+
+// normal curvatures L/E and N/G in the parametric directions, and M/sqrt(EG),
+// with L, M, N the coefficients of the second fundamental form
+static bool normalCurvatures(const double du[3], const double dv[3],
+                             const double duu[3], const double dvv[3],
+                             const double duv[3], double k[3])
+{
+  double n[3] = {du[1] * dv[2] - du[2] * dv[1], du[2] * dv[0] - du[0] * dv[2],
+                 du[0] * dv[1] - du[1] * dv[0]};
+  const double nn = norm(n), E = norm(du), G = norm(dv);
+  if(nn <= 1.e-12 * E * G) return false;
+  for(int d = 0; d < 3; d++) n[d] /= nn;
+  k[0] = (duu[0] * n[0] + duu[1] * n[1] + duu[2] * n[2]) / (E * E);
+  k[1] = (dvv[0] * n[0] + dvv[1] * n[1] + dvv[2] * n[2]) / (G * G);
+  k[2] = (duv[0] * n[0] + duv[1] * n[1] + duv[2] * n[2]) / (E * G);
+  return true;
+}
+
+void GFaceSurrogate::_build(patch *p)
+{
+  const double hu = p->u1 - p->u0, hv = p->v1 - p->v0;
+  if(!(hu > 0.) || !(hv > 0.)) {
+    _numExactPatches++;
+    p->state.store(EXACT, std::memory_order_release);
+    return;
+  }
+
+  // interpolate the surface at the 4 x 4 equally spaced nodes of the patch
+  double val[4][4][3];
+  for(int i = 0; i < 4; i++)
+    for(int j = 0; j < 4; j++)
+      _exact(p->u0 + hu * i / 3., p->v0 + hv * j / 3., val[i][j], nullptr,
+             nullptr, nullptr, nullptr, nullptr);
+  for(int k = 0; k < 4; k++) {
+    for(int l = 0; l < 4; l++) {
+      for(int d = 0; d < 3; d++) {
+        double s = 0.;
+        for(int i = 0; i < 4; i++)
+          for(int j = 0; j < 4; j++)
+            s += lagrange[i][k] * lagrange[j][l] * val[i][j][d];
+        p->c[4 * k + l][d] = s;
+      }
+    }
+  }
+
+  // check the interpolant and its derivatives at the centers of the 3 x 3
+  // sub-cells and on the boundary of the patch (where the error on the
+  // derivatives is the largest): the position error should be below the
+  // tolerance, and the error on the first derivatives times the size of the
+  // patch should remain of the order of the tolerance. The normal curvatures
+  // in the parametric directions, which determine the principal curvatures,
+  // should be accurate within curvatureTolerance, relative to the largest of
+  // them or to the inverse of the size of the surface
+  bool ok = true;
+  const double st[5] = {0., 1. / 6., 0.5, 5. / 6., 1.};
+  for(int i = 0; i < 5 && ok; i++) {
+    for(int j = 0; j < 5 && ok; j++) {
+      const double u = p->u0 + hu * st[i], v = p->v0 + hv * st[j];
+      double xyz[3], du[3], dv[3], duu[3], dvv[3], duv[3];
+      double xyze[3], due[3], dve[3], duue[3], dvve[3], duve[3];
+      _exact(u, v, xyze, due, dve, duue, dvve, duve);
+      _eval(p, u, v, 2, xyz, du, dv, duu, dvv, duv);
+      if(dist(xyz, xyze) > _tolerance ||
+         dist(du, due) * hu > 10. * _tolerance ||
+         dist(dv, dve) * hv > 10. * _tolerance) {
+        ok = false;
+        break;
+      }
+      double k[3], ke[3];
+      // no curvature at singular points of the parametrization
+      if(!normalCurvatures(due, dve, duue, dvve, duve, ke)) continue;
+      if(!normalCurvatures(du, dv, duu, dvv, duv, k)) {
+        ok = false;
+        break;
+      }
+      const double ref =
+        std::max(std::max(std::abs(ke[0]), std::abs(ke[1])),
+                 std::max(std::abs(ke[2]), 1. / _size));
+      for(int l = 0; l < 3; l++)
+        if(std::abs(k[l] - ke[l]) > curvatureTolerance * ref) ok = false;
+    }
+  }
+
+  if(ok) {
+    _numPatches++;
+    p->state.store(POLYNOMIAL, std::memory_order_release);
+  }
+  else if(p->depth >= _maxDepth) {
+    _numExactPatches++;
+    p->state.store(EXACT, std::memory_order_release);
+  }
+  else {
+    const double um = 0.5 * (p->u0 + p->u1), vm = 0.5 * (p->v0 + p->v1);
+    p->children[0] = new patch(p->u0, um, p->v0, vm, p->depth + 1);
+    p->children[1] = new patch(um, p->u1, p->v0, vm, p->depth + 1);
+    p->children[2] = new patch(p->u0, um, vm, p->v1, p->depth + 1);
+    p->children[3] = new patch(um, p->u1, vm, p->v1, p->depth + 1);
+    p->state.store(SPLIT, std::memory_order_release);
+  }
+}
+
+const GFaceSurrogate::patch *GFaceSurrogate::_find(double u, double v)
+{
+  if(!(u >= _umin && u <= _umax && v >= _vmin && v <= _vmax)) return nullptr;
+  patch *p = _root;
+  while(1) {
+    const int state = p->state.load(std::memory_order_acquire);
+    if(state == UNBUILT) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if(p->state.load(std::memory_order_relaxed) == UNBUILT) _build(p);
+    }
+    else if(state == POLYNOMIAL)
+      return p;
+    else if(state == EXACT)
+      return nullptr;
+    else {
+      const double um = 0.5 * (p->u0 + p->u1), vm = 0.5 * (p->v0 + p->v1);
+      p = p->children[(u > um ? 1 : 0) + (v > vm ? 2 : 0)];
+    }
+  }
+}
+
+void GFaceSurrogate::_eval(const patch *p, double u, double v, int order,
+                           double *xyz, double *du, double *dv, double *duu,
+                           double *dvv, double *duv) const
+{
+  const double hu = p->u1 - p->u0, hv = p->v1 - p->v0;
+  const double s = (u - p->u0) / hu, t = (v - p->v0) / hv;
+  // powers of s and t, and their first and second derivatives
+  const double S[4] = {1., s, s * s, s * s * s};
+  const double T[4] = {1., t, t * t, t * t * t};
+  const double dS[4] = {0., 1., 2. * s, 3. * s * s};
+  const double dT[4] = {0., 1., 2. * t, 3. * t * t};
+  const double d2S[4] = {0., 0., 2., 6. * s};
+  const double d2T[4] = {0., 0., 2., 6. * t};
+  for(int d = 0; d < 3; d++) {
+    double x = 0., xu = 0., xv = 0., xuu = 0., xvv = 0., xuv = 0.;
+    for(int k = 0; k < 4; k++) {
+      for(int l = 0; l < 4; l++) {
+        const double c = p->c[4 * k + l][d];
+        x += c * S[k] * T[l];
+        if(order > 0) {
+          xu += c * dS[k] * T[l];
+          xv += c * S[k] * dT[l];
+        }
+        if(order > 1) {
+          xuu += c * d2S[k] * T[l];
+          xvv += c * S[k] * d2T[l];
+          xuv += c * dS[k] * dT[l];
+        }
+      }
+    }
+    if(xyz) xyz[d] = x;
+    if(order > 0) {
+      if(du) du[d] = xu / hu;
+      if(dv) dv[d] = xv / hv;
+    }
+    if(order > 1) {
+      if(duu) duu[d] = xuu / (hu * hu);
+      if(dvv) dvv[d] = xvv / (hv * hv);
+      if(duv) duv[d] = xuv / (hu * hv);
+    }
+  }
+}
+
+bool GFaceSurrogate::point(double u, double v, double xyz[3])
+{
+  const patch *p = _find(u, v);
+  if(!p) return false;
+  _eval(p, u, v, 0, xyz, nullptr, nullptr, nullptr, nullptr, nullptr);
+  return true;
+}
+
+bool GFaceSurrogate::firstDer(double u, double v, double du[3], double dv[3])
+{
+  const patch *p = _find(u, v);
+  if(!p) return false;
+  _eval(p, u, v, 1, nullptr, du, dv, nullptr, nullptr, nullptr);
+  return true;
+}
+
+bool GFaceSurrogate::secondDer(double u, double v, double duu[3],
+                               double dvv[3], double duv[3])
+{
+  const patch *p = _find(u, v);
+  if(!p) return false;
+  _eval(p, u, v, 2, nullptr, nullptr, nullptr, duu, dvv, duv);
+  return true;
+}
+
+bool GFaceSurrogate::curvatures(double u, double v, double dirMax[3],
+                                double dirMin[3], double &curvMax,
+                                double &curvMin)
+{
+  const patch *p = _find(u, v);
+  if(!p) return false;
+  double du[3], dv[3], duu[3], dvv[3], duv[3];
+  _eval(p, u, v, 2, nullptr, du, dv, duu, dvv, duv);
+
+  double n[3] = {du[1] * dv[2] - du[2] * dv[1], du[2] * dv[0] - du[0] * dv[2],
+                 du[0] * dv[1] - du[1] * dv[0]};
+  const double nn = norm(n);
+  if(nn == 0.) return false;
+  for(int d = 0; d < 3; d++) n[d] /= nn;
+
+  // first and second fundamental forms
+  const double E = du[0] * du[0] + du[1] * du[1] + du[2] * du[2];
+  const double F = du[0] * dv[0] + du[1] * dv[1] + du[2] * dv[2];
+  const double G = dv[0] * dv[0] + dv[1] * dv[1] + dv[2] * dv[2];
+  const double L = duu[0] * n[0] + duu[1] * n[1] + duu[2] * n[2];
+  const double M = duv[0] * n[0] + duv[1] * n[1] + duv[2] * n[2];
+  const double N = dvv[0] * n[0] + dvv[1] * n[1] + dvv[2] * n[2];
+  const double det = E * G - F * F;
+  if(det <= 0.) return false;
+
+  // shape operator [a b; c d] in the (du, dv) basis, and its eigenvalues
+  const double a = (G * L - F * M) / det, b = (G * M - F * N) / det;
+  const double c = (E * M - F * L) / det, d = (E * N - F * M) / det;
+  const double half = 0.5 * (a + d);
+  const double disc = std::sqrt(std::max(0., 0.25 * (a - d) * (a - d) + b * c));
+  curvMax = half + disc;
+  curvMin = half - disc;
+
+  // principal directions
+  double x, y;
+  if(std::abs(b) > std::abs(c)) {
+    x = b;
+    y = curvMax - a;
+  }
+  else {
+    x = curvMax - d;
+    y = c;
+  }
+  if(std::abs(x) + std::abs(y) < 1.e-12 * (std::abs(a) + std::abs(d) + 1.)) {
+    // umbilic point: any direction is principal
+    x = 1.;
+    y = 0.;
+  }
+  for(int k = 0; k < 3; k++) dirMax[k] = x * du[k] + y * dv[k];
+  const double nm = norm(dirMax);
+  for(int k = 0; k < 3; k++) dirMax[k] /= nm;
+  dirMin[0] = n[1] * dirMax[2] - n[2] * dirMax[1];
+  dirMin[1] = n[2] * dirMax[0] - n[0] * dirMax[2];
+  dirMin[2] = n[0] * dirMax[1] - n[1] * dirMax[0];
+  return true;
+}
@@ -0,0 +1,79 @@
+// Gmsh - Copyright (C) 1997-2024 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#ifndef GFACE_SURROGATE_H
+#define GFACE_SURROGATE_H
+
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <cstddef>
+
+// Piecewise polynomial surrogate of the parametrization of a surface, used to
+// speed up the (many) evaluations of CAD surfaces during meshing. The
+// parameter domain is split lazily, as a quadtree, until the bicubic
+// interpolant of the surface on each patch reproduces the exact surface (and
+// its first and second derivatives, and thus its curvatures) within the
+// prescribed tolerance. Patches on which the
+// tolerance cannot be reached before the maximum depth, as well as points
+// outside of the parameter bounds, are evaluated exactly: in that case the
+// query functions return false.
+//
+// The surrogate can be queried concurrently: patches are only built (once)
+// under a lock, and are never modified afterwards.
+class GFaceSurrogate {
+public:
+  // exact evaluation of the surface at (u, v); du and dv (resp. duu, dvv and
+  // duv) are null if the first (resp. second) derivatives are not requested
+  typedef std::function<void(double u, double v, double xyz[3], double du[3],
+                             double dv[3], double duu[3], double dvv[3],
+                             double duv[3])>
+    evaluator;
+
+private:
+  enum { UNBUILT = 0, SPLIT = 1, POLYNOMIAL = 2, EXACT = 3 };
+  struct patch {
+    double u0, u1, v0, v1;
+    int depth;
+    std::atomic<int> state;
+    patch *children[4];
+    // coefficients of s^i t^j in c[4 * i + j], with s and t the local
+    // coordinates in [0, 1]
+    double c[16][3];
+    patch(double u0_, double u1_, double v0_, double v1_, int depth_);
+    ~patch();
+  };
+  evaluator _exact;
+  double _umin, _umax, _vmin, _vmax;
+  double _tolerance, _size;
+  int _maxDepth;
+  patch *_root;
+  std::mutex _mutex;
+  std::atomic<std::size_t> _numPatches, _numExactPatches;
+  void _build(patch *p);
+  const patch *_find(double u, double v);
+  void _eval(const patch *p, double u, double v, int order, double *xyz,
+             double *du, double *dv, double *duu, double *dvv,
+             double *duv) const;
+
+public:
+  // tolerance is the maximum distance between the surrogate and the exact
+  // surface
+  GFaceSurrogate(const evaluator &exact, double umin, double umax, double vmin,
+                 double vmax, double tolerance, int maxDepth = 8);
+  ~GFaceSurrogate();
+  double getTolerance() const { return _tolerance; }
+  std::size_t getNumPatches() const { return _numPatches; }
+  std::size_t getNumExactPatches() const { return _numExactPatches; }
+  bool point(double u, double v, double xyz[3]);
+  bool firstDer(double u, double v, double du[3], double dv[3]);
+  bool secondDer(double u, double v, double duu[3], double dvv[3],
+                 double duv[3]);
+  // principal curvatures (signed w.r.t. du x dv) and directions
+  bool curvatures(double u, double v, double dirMax[3], double dirMin[3],
+                  double &curvMax, double &curvMin);
+};
+
+#endif
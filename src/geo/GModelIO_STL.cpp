@@ -4,6 +4,11 @@
 // Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <cmath>
 #include <string>
 #include <algorithm>
 #include <sstream>
@@ -12,13 +17,149 @@
 #include "MLine.h"
 #include "MTriangle.h"
 #include "MQuadrangle.h"
-#include "MVertexRTree.h"
 #include "discreteFace.h"
 #include "StringUtils.h"
 #include "Context.h"
 
 static bool invalidChar(char c) { return !(c >= 32 && c <= 126); }
 
+// read the coordinates on a "vertex x y z" line (faster than sscanf)
+static bool readVertex(const char *s, SPoint3 &p)
+{
+  while(*s && isspace(*s)) s++;
+  while(*s && !isspace(*s)) s++;
+  double x[3];
+  for(int i = 0; i < 3; i++) {
+    char *end;
+    x[i] = strtod(s, &end);
+    if(end == s) return false;
+    s = end;
+  }
+  p = SPoint3(x[0], x[1], x[2]);
+  return true;
+}
+
+// Spatial hash of points, with cells of size h: the points in cell (i, j, k)
+// are chained in the bucket hash(i, j, k), together with the points of the
+// other cells with the same hash, if any.
+class pointHash {
+private:
+  const std::vector<SPoint3> &_p;
+  SPoint3 _min;
+  double _h;
+  std::size_t _mask;
+  std::vector<std::size_t> _head, _next;
+  int64_t _cell(double x, int d) const
+  {
+    return (int64_t)std::floor((x - _min[d]) / _h);
+  }
+  std::size_t _bucket(int64_t i, int64_t j, int64_t k) const
+  {
+    return (((uint64_t)i * 73856093ULL) ^ ((uint64_t)j * 19349663ULL) ^
+            ((uint64_t)k * 83492791ULL)) &
+           _mask;
+  }
+
+public:
+  static const std::size_t none = (std::size_t)-1;
+  pointHash(const std::vector<SPoint3> &p, const SBoundingBox3d &bbox,
+            double h, int nthreads)
+    : _p(p), _min(bbox.min()), _h(h), _mask(1)
+  {
+    while(_mask < 2 * p.size()) _mask *= 2;
+    _head.resize(_mask, none);
+    _next.resize(p.size(), none);
+    _mask--;
+#pragma omp parallel for num_threads(nthreads)
+    for(std::size_t i = 0; i < p.size(); i++) {
+      std::size_t &head = _head[_bucket(_cell(p[i][0], 0), _cell(p[i][1], 1),
+                                        _cell(p[i][2], 2))];
+      std::size_t old;
+#pragma omp atomic capture
+      {
+        old = head;
+        head = i;
+      }
+      _next[i] = old;
+    }
+  }
+  // call f(j) for all the points j at distance (in the infinity norm) at most
+  // d <= h of point i, as long as f returns true
+  template <class F> void visit(std::size_t i, double d, F f) const
+  {
+    const SPoint3 &p = _p[i];
+    int64_t lo[3], hi[3];
+    for(int k = 0; k < 3; k++) {
+      lo[k] = _cell(p[k] - d, k);
+      hi[k] = _cell(p[k] + d, k);
+    }
+    for(int64_t a = lo[0]; a <= hi[0]; a++) {
+      for(int64_t b = lo[1]; b <= hi[1]; b++) {
+        for(int64_t c = lo[2]; c <= hi[2]; c++) {
+          for(std::size_t j = _head[_bucket(a, b, c)]; j != none;
+              j = _next[j]) {
+            const SPoint3 &q = _p[j];
+            if(std::abs(q.x() - p.x()) <= d && std::abs(q.y() - p.y()) <= d &&
+               std::abs(q.z() - p.z()) <= d && !f(j))
+              return;
+          }
+        }
+      }
+    }
+  }
+};
+
+const std::size_t pointHash::none;
+
+// Weld the points closer than d (in the infinity norm): rep[i] is the index of
+// the point that replaces point i. The result is the same as inserting the
+// points one by one in an MVertexRTree: a point is replaced by the first
+// previous point that was kept, if any, within the tolerance. Most points are
+// either isolated or only coincide exactly with other points: they are handled
+// in parallel, and only the others are welded serially.
+static std::size_t weldPoints(const std::vector<SPoint3> &points,
+                              const SBoundingBox3d &bbox, double d,
+                              std::vector<std::size_t> &rep, int nthreads)
+{
+  // cells larger than the tolerance, so that most points only need to check
+  // their own cell (but small enough to fit the cell indices in 64 bits)
+  double h = std::max(4. * d, 1e-12 * norm(SVector3(bbox.max(), bbox.min())));
+  if(h <= 0.) h = 1.;
+  pointHash hash(points, bbox, h, nthreads);
+
+  const std::size_t none = pointHash::none;
+  rep.resize(points.size());
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+  for(std::size_t i = 0; i < points.size(); i++) {
+    std::size_t r = i;
+    const SPoint3 &p = points[i];
+    hash.visit(i, d, [&](std::size_t j) {
+      if(points[j].x() != p.x() || points[j].y() != p.y() ||
+         points[j].z() != p.z()) {
+        r = none;
+        return false;
+      }
+      r = std::min(r, j);
+      return true;
+    });
+    rep[i] = r;
+  }
+
+  std::size_t n = 0;
+  for(std::size_t i = 0; i < points.size(); i++) {
+    if(rep[i] == none) {
+      std::size_t r = i;
+      hash.visit(i, d, [&](std::size_t j) {
+        if(j < r && rep[j] == j) r = j;
+        return true;
+      });
+      rep[i] = r;
+    }
+    if(rep[i] == i) n++;
+  }
+  return n;
+}
+
 int GModel::readSTL(const std::string &name, double tolerance)
 {
   FILE *fp = Fopen(name.c_str(), "rb");
@@ -27,9 +168,14 @@ int GModel::readSTL(const std::string &name, double tolerance)
     return 0;
   }
 
-  // store triplets of points for each solid found in the file
-  std::vector<std::vector<SPoint3> > points;
-  SBoundingBox3d bbox;
+  double t1 = TimeOfDay();
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  // store triplets of points for the facets of all the solids found in the
+  // file, the facets of solid i being stored in [start[i], start[i + 1])
+  std::vector<SPoint3> points;
+  std::vector<std::size_t> start;
   std::vector<std::string> names;
 
   // "solid", or binary data header
@@ -49,7 +195,7 @@ int GModel::readSTL(const std::string &name, double tolerance)
       names.push_back(&buffer[6]);
     else
       names.push_back("");
-    points.resize(1);
+    start.push_back(0);
     while(!feof(fp)) {
       // "facet normal x y z" or "endsolid"
       if(!fgets(buffer, sizeof(buffer), fp)) break;
@@ -61,7 +207,7 @@ int GModel::readSTL(const std::string &name, double tolerance)
             names.push_back(&buffer[6]);
           else
             names.push_back("");
-          points.resize(points.size() + 1);
+          start.push_back(points.size());
           // "facet normal x y z"
           if(!fgets(buffer, sizeof(buffer), fp)) break;
         }
@@ -71,13 +217,10 @@ int GModel::readSTL(const std::string &name, double tolerance)
       // "vertex x y z"
       for(int i = 0; i < 3; i++) {
         if(!fgets(buffer, sizeof(buffer), fp)) break;
-        char s1[256];
-        double x, y, z;
-        if(sscanf(buffer, "%s %lf %lf %lf", s1, &x, &y, &z) != 4) break;
-        SPoint3 p(x, y, z);
+        SPoint3 p;
+        if(!readVertex(buffer, p)) break;
         // p -= p0;
-        points.back().push_back(p);
-        bbox += p;
+        points.push_back(p);
       }
       // "endloop"
       if(!fgets(buffer, sizeof(buffer), fp)) break;
@@ -87,14 +230,8 @@ int GModel::readSTL(const std::string &name, double tolerance)
   }
 
   // check if we could parse something
-  bool empty = true;
-  for(std::size_t i = 0; i < points.size(); i++) {
-    if(points[i].size()) {
-      empty = false;
-      break;
-    }
-  }
-  if(empty) points.clear();
+  bool empty = points.empty();
+  if(empty) start.clear();
 
   // binary STL (we also try to read in binary mode if the header told
   // us the format was ASCII but we could not read any vertices)
@@ -103,6 +240,7 @@ int GModel::readSTL(const std::string &name, double tolerance)
       Msg::Info("Mesh is in binary format");
     else
       Msg::Info("Wrong ASCII header or empty file: trying binary read");
+    names.clear();
     rewind(fp);
     while(!feof(fp)) {
       char header[80];
@@ -118,30 +256,35 @@ int GModel::readSTL(const std::string &name, double tolerance)
       }
       if(ret && nfacets) {
         names.push_back(header);
-        points.resize(points.size() + 1);
-        char *data = new char[nfacets * 50 * sizeof(char)];
-        ret = fread(data, sizeof(char), nfacets * 50, fp);
-        if(ret == nfacets * 50) {
+        start.push_back(points.size());
+        // read all the facets at once, and decode them in parallel
+        std::size_t size = (std::size_t)nfacets * 50;
+        std::vector<char> data(size);
+        ret = fread(&data[0], sizeof(char), size, fp);
+        if(ret == size) {
+          std::size_t offset = points.size();
+          points.resize(offset + 3 * (std::size_t)nfacets);
+#pragma omp parallel for num_threads(nthreads)
           for(std::size_t i = 0; i < nfacets; i++) {
-            float *xyz = (float *)&data[i * 50 * sizeof(char)];
+            float xyz[12];
+            memcpy(xyz, &data[i * 50], sizeof(xyz));
             if(swap) SwapBytes((char *)xyz, sizeof(float), 12);
             for(int j = 0; j < 3; j++) {
               SPoint3 p(xyz[3 + 3 * j], xyz[3 + 3 * j + 1], xyz[3 + 3 * j + 2]);
               // p -= p0;
-              points.back().push_back(p);
-              bbox += p;
+              points[offset + 3 * i + j] = p;
             }
           }
         }
-        delete[] data;
       }
     }
   }
+  start.push_back(points.size());
 
   // cleanup names
-  if(names.size() != points.size()) {
+  if(names.size() != start.size() - 1) {
     Msg::Debug("Invalid number of names in STL file - should never happen");
-    names.resize(points.size());
+    names.resize(start.size() - 1);
   }
   for(std::size_t i = 0; i < names.size(); i++) {
     names[i].erase(remove_if(names[i].begin(), names[i].end(), invalidChar),
@@ -149,57 +292,57 @@ int GModel::readSTL(const std::string &name, double tolerance)
   }
 
   std::vector<GFace *> faces;
-  for(std::size_t i = 0; i < points.size(); i++) {
-    if(points[i].empty()) {
+  for(std::size_t i = 0; i < names.size(); i++) {
+    std::size_t n = start[i + 1] - start[i];
+    if(!n) {
       Msg::Error("No facets found in STL file for solid %d %s", i,
                  names[i].c_str());
       fclose(fp);
       return 0;
     }
-    if(points[i].size() % 3) {
-      Msg::Error("Wrong number of points (%d) in STL file for solid %d %s",
-                 points[i].size(), i, names[i].c_str());
+    if(n % 3) {
+      Msg::Error("Wrong number of points (%d) in STL file for solid %d %s", n,
+                 i, names[i].c_str());
       fclose(fp);
       return 0;
     }
-    Msg::Info("%d facets in solid %d %s", points[i].size() / 3, i,
-              names[i].c_str());
+    Msg::Info("%d facets in solid %d %s", n / 3, i, names[i].c_str());
     // create face
     GFace *face = new discreteFace(this, getMaxElementaryNumber(2) + 1);
     faces.push_back(face);
     add(face);
     if(!names[i].empty()) setElementaryName(2, face->tag(), names[i]);
   }
+  fclose(fp);
 
-  // create triangles using unique vertices
+  // weld the points closer than the tolerance, and create the nodes (with the
+  // same numbering as if all the points were welded one by one with an
+  // MVertexRTree(eps), whose nodes are considered identical if their distance
+  // is smaller than 2 * eps)
+  SBoundingBox3d bbox;
+  for(std::size_t i = 0; i < points.size(); i++) bbox += points[i];
   double eps = norm(SVector3(bbox.max(), bbox.min())) * tolerance;
-  std::vector<MVertex *> vertices;
-  for(std::size_t i = 0; i < points.size(); i++)
-    for(std::size_t j = 0; j < points[i].size(); j++)
-      vertices.push_back(
-        new MVertex(points[i][j].x(), points[i][j].y(), points[i][j].z()));
-  MVertexRTree pos(eps);
-  pos.insert(vertices);
+  std::vector<std::size_t> rep;
+  std::size_t numNodes = weldPoints(points, bbox, 2 * eps, rep, nthreads);
+  std::vector<MVertex *> vertices, nodes(points.size());
+  vertices.reserve(numNodes);
+  for(std::size_t i = 0; i < points.size(); i++) {
+    if(rep[i] == i) {
+      nodes[i] = new MVertex(points[i].x(), points[i].y(), points[i].z());
+      vertices.push_back(nodes[i]);
+    }
+    else
+      nodes[i] = nodes[rep[i]];
+  }
+  Msg::Info("Welded %lu points into %lu nodes", points.size(), numNodes);
 
+  // create triangles using unique vertices
   std::set<MFace, MFaceLessThan> unique;
   int nbDuplic = 0, nbDegen = 0;
-  for(std::size_t i = 0; i < points.size(); i++) {
-    for(std::size_t j = 0; j < points[i].size(); j += 3) {
-      MVertex *v[3];
-      for(int k = 0; k < 3; k++) {
-        double x = points[i][j + k].x();
-        double y = points[i][j + k].y();
-        double z = points[i][j + k].z();
-        v[k] = pos.find(x, y, z);
-        if(!v[k])
-          Msg::Error("Could not find node at position (%.16g, %.16g, %.16g) "
-                     "with tol=%.16g",
-                     x, y, z, eps);
-      }
-      if(!v[0] || !v[1] || !v[2]) {
-        // error
-      }
-      else if(v[0] == v[1] || v[0] == v[2] || v[1] == v[2]) {
+  for(std::size_t i = 0; i < faces.size(); i++) {
+    for(std::size_t j = start[i]; j < start[i + 1]; j += 3) {
+      MVertex *v[3] = {nodes[j], nodes[j + 1], nodes[j + 2]};
+      if(v[0] == v[1] || v[0] == v[2] || v[1] == v[2]) {
         Msg::Debug("Skipping degenerated triangle %lu %lu %lu", v[0]->getNum(),
                    v[1]->getNum(), v[2]->getNum());
         nbDegen++;
@@ -227,7 +370,9 @@ int GModel::readSTL(const std::string &name, double tolerance)
 
   _storeVerticesInEntities(vertices); // will delete unused vertices
 
-  fclose(fp);
+  double t2 = TimeOfDay();
+  Msg::Info("Read %lu triangles in %g s (%g triangles/s)", points.size() / 3,
+            t2 - t1, points.size() / 3 / std::max(t2 - t1, 1e-12));
   return 1;
 }
 
@@ -35,7 +35,7 @@
 #if defined(HAVE_SOLVER)
 #include "linearSystemPETSc.h"
 #include "linearSystemCSR.h"
-#include "linearSystemFull.h"
+#include "linearSystemCSRIterative.h"
 #endif
 
 #if defined(HAVE_MESH)
@@ -615,7 +615,7 @@ bool computeParametrization(const std::vector<MTriangle *> &triangles,
 #elif defined(HAVE_GMM)
   linearSystemCSRGmm<double> *lsys = new linearSystemCSRGmm<double>;
 #else
-  linearSystemFull<double> *lsys = new linearSystemFull<double>;
+  linearSystemCSRIterative<double> *lsys = new linearSystemCSRIterative<double>;
 #endif
 
   lsys->allocate(nodes.size());
@@ -2545,7 +2545,7 @@ void ReplaceAllDuplicatesNew(double tol)
   ReplaceDuplicateSurfaces(nullptr);
 }
 
-void ProtudeXYZ(double &x, double &y, double &z, ExtrudeParams *e)
+void ProtudeXYZ(double &x, double &y, double &z, ExtrudeParams *e, double t)
 {
   double matrix[4][4];
   double T[3];
@@ -2557,7 +2557,7 @@ void ProtudeXYZ(double &x, double &y, double &z, ExtrudeParams *e)
   SetTranslationMatrix(matrix, T);
   ApplyTransformationToPointAlways(matrix, &v);
 
-  SetRotationMatrix(matrix, e->geo.axe, e->geo.angle);
+  SetRotationMatrix(matrix, e->geo.axe, e->geo.angle * t);
   ApplyTransformationToPointAlways(matrix, &v);
 
   T[0] = -T[0];
@@ -2569,8 +2569,6 @@ void ProtudeXYZ(double &x, double &y, double &z, ExtrudeParams *e)
   x = v.Pos.X;
   y = v.Pos.Y;
   z = v.Pos.Z;
-
-  List_Reset(ListOfTransformedPoints);
 }
 
 int ExtrudePoint(int type, int ip, double T0, double T1, double T2, double A0,
@@ -30,6 +30,7 @@
 #include "FuncSpaceData.h"
 #include "bezierBasis.h"
 #include "polynomialBasis.h"
+#include "QuadratureBasis.h"
 
 #if defined(HAVE_MESH)
 #include "qualityMeasuresJacobian.h"
@@ -936,6 +937,47 @@ double MElement::getJacobian(double u, double v, double w,
   return detJ;
 }
 
+double MElement::getJacobian(const QuadratureBasis *qb, int i,
+                             double jac[3][3]) const
+{
+  fullMatrix<double> gsf;
+  qb->getGradShapeFunctions(i, gsf);
+  return getJacobian(gsf, jac);
+}
+
+void MElement::getJacobians(const QuadratureBasis *qb, fullVector<double> &det,
+                            fullMatrix<double> *jac) const
+{
+  const int numPoints = qb->getNumPoints();
+  det.resize(numPoints, false);
+  if(getDim() > 3 ||
+     (int)getNumShapeFunctions() != qb->getNumShapeFunctions()) {
+    Msg::Error("Quadrature basis does not match element type %d",
+               getTypeForMSH());
+    det.setAll(0.);
+    return;
+  }
+
+  fullMatrix<double> nodes(qb->getNumShapeFunctions(), 3);
+  getNodesCoord(nodes);
+  fullMatrix<double> tmp;
+  fullMatrix<double> &allJac = jac ? *jac : tmp;
+  qb->getJacobiansFromNodes(nodes, allJac);
+  for(int i = 0; i < numPoints; i++) {
+    double J[3][3];
+    for(int j = 0; j < 3; j++) {
+      for(int k = 0; k < 3; k++) J[k][j] = allJac(j, 3 * i + k);
+    }
+    det(i) = _computeDeterminantAndRegularize(this, J);
+    if(jac) {
+      // regularization can modify the Jacobian of lower-dimensional elements
+      for(int j = 0; j < 3; j++) {
+        for(int k = 0; k < 3; k++) allJac(j, 3 * i + k) = J[k][j];
+      }
+    }
+  }
+}
+
 double MElement::getPrimaryJacobian(double u, double v, double w,
                                     double jac[3][3]) const
 {
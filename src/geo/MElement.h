@@ -22,6 +22,7 @@
 class GModel;
 class nodalBasis;
 class JacobianBasis;
+class QuadratureBasis;
 class bezierCoeff;
 template <class scalar> class fullVector;
 template <class scalar> class fullMatrix;
@@ -371,6 +372,15 @@ public:
   virtual double getJacobian(double u, double v, double w,
                              double jac[3][3]) const;
   double getJacobian(double u, double v, double w, fullMatrix<double> &j) const;
+  // return the Jacobian at the i-th point of a tabulated quadrature basis (see
+  // BasisFactory::getQuadratureBasis), without re-evaluating the shape
+  // functions
+  double getJacobian(const QuadratureBasis *qb, int i, double jac[3][3]) const;
+  // return the Jacobian determinants at all the points of a tabulated
+  // quadrature basis, computed with a single matrix-matrix product; if jac is
+  // provided, also return the Jacobian matrices jac(j, 3 * i + k) = dx_j/du_k
+  void getJacobians(const QuadratureBasis *qb, fullVector<double> &det,
+                    fullMatrix<double> *jac = nullptr) const;
   virtual double getPrimaryJacobian(double u, double v, double w,
                                     double jac[3][3]) const;
   double getJacobianDeterminant(double u, double v, double w) const
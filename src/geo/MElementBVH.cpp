@@ -0,0 +1,348 @@
+// Gmsh - Copyright (C) 1997-2024 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "GmshDefines.h"
+#include "MElement.h"
+#include "MElementBVH.h"
+
+// maximum number of primitives in a leaf
+static const std::size_t leafSize = 4;
+
+static inline double dot(const double *a, const double *b)
+{
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static void closestOnSegment(const double *p, const double *a, const double *b,
+                             double *w)
+{
+  double ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+  double ap[3] = {p[0] - a[0], p[1] - a[1], p[2] - a[2]};
+  double l2 = dot(ab, ab);
+  double t = l2 > 0. ? std::max(0., std::min(1., dot(ap, ab) / l2)) : 0.;
+  w[0] = 1. - t;
+  w[1] = t;
+}
+
+// barycentric coordinates of the closest point to p in the triangle abc,
+// following the classification of the Voronoi regions of the vertices and
+// of the edges of the triangle (C. Ericson, Real-Time Collision Detection)
+static void closestOnTriangle(const double *p, const double *a,
+                              const double *b, const double *c, double *w)
+{
+  double ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+  double ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+  double ap[3] = {p[0] - a[0], p[1] - a[1], p[2] - a[2]};
+  double d1 = dot(ab, ap), d2 = dot(ac, ap);
+  if(d1 <= 0. && d2 <= 0.) {
+    w[0] = 1.;
+    w[1] = w[2] = 0.;
+    return;
+  }
+  double bp[3] = {p[0] - b[0], p[1] - b[1], p[2] - b[2]};
+  double d3 = dot(ab, bp), d4 = dot(ac, bp);
+  if(d3 >= 0. && d4 <= d3) {
+    w[1] = 1.;
+    w[0] = w[2] = 0.;
+    return;
+  }
+  double vc = d1 * d4 - d3 * d2;
+  if(vc <= 0. && d1 >= 0. && d3 <= 0.) {
+    double v = d1 - d3 > 0. ? d1 / (d1 - d3) : 0.;
+    w[0] = 1. - v;
+    w[1] = v;
+    w[2] = 0.;
+    return;
+  }
+  double cp[3] = {p[0] - c[0], p[1] - c[1], p[2] - c[2]};
+  double d5 = dot(ab, cp), d6 = dot(ac, cp);
+  if(d6 >= 0. && d5 <= d6) {
+    w[2] = 1.;
+    w[0] = w[1] = 0.;
+    return;
+  }
+  double vb = d5 * d2 - d1 * d6;
+  if(vb <= 0. && d2 >= 0. && d6 <= 0.) {
+    double v = d2 - d6 > 0. ? d2 / (d2 - d6) : 0.;
+    w[0] = 1. - v;
+    w[1] = 0.;
+    w[2] = v;
+    return;
+  }
+  double va = d3 * d6 - d5 * d4;
+  if(va <= 0. && d4 - d3 >= 0. && d5 - d6 >= 0.) {
+    double s = (d4 - d3) + (d5 - d6);
+    double v = s > 0. ? (d4 - d3) / s : 0.;
+    w[0] = 0.;
+    w[1] = 1. - v;
+    w[2] = v;
+    return;
+  }
+  double denom = va + vb + vc;
+  if(denom > 0.) {
+    w[1] = vb / denom;
+    w[2] = vc / denom;
+    w[0] = 1. - w[1] - w[2];
+    return;
+  }
+  // degenerate triangle: closest point on its edges
+  const double *x[3] = {a, b, c};
+  double best = std::numeric_limits<double>::max();
+  for(int i = 0; i < 3; i++) {
+    int j = (i + 1) % 3;
+    double ws[2];
+    closestOnSegment(p, x[i], x[j], ws);
+    double d = 0.;
+    for(int k = 0; k < 3; k++) {
+      double dk = ws[0] * x[i][k] + ws[1] * x[j][k] - p[k];
+      d += dk * dk;
+    }
+    if(d < best) {
+      best = d;
+      w[0] = w[1] = w[2] = 0.;
+      w[i] = ws[0];
+      w[j] = ws[1];
+    }
+  }
+}
+
+static inline double boxDistance2(const double *min, const double *max,
+                                  const double *p)
+{
+  double d = 0.;
+  for(int k = 0; k < 3; k++) {
+    double dk = p[k] < min[k] ? min[k] - p[k] : p[k] > max[k] ? p[k] - max[k] :
+                                                                0.;
+    d += dk * dk;
+  }
+  return d;
+}
+
+void MElementBVH::_add(std::size_t id, int n, const double *xyz, const int *v)
+{
+  for(int i = 0; i < 3; i++)
+    for(int k = 0; k < 3; k++) _xyz.push_back(xyz[3 * std::min(i, n - 1) + k]);
+  _ids.push_back(id);
+  _numVertices.push_back(n);
+  for(int i = 0; i < 3; i++) _vertices.push_back(v[std::min(i, n - 1)]);
+}
+
+void MElementBVH::addPoint(const SPoint3 &p, std::size_t id)
+{
+  double xyz[3] = {p.x(), p.y(), p.z()};
+  int v[1] = {0};
+  _add(id, 1, xyz, v);
+}
+
+void MElementBVH::addSegment(const SPoint3 &p0, const SPoint3 &p1,
+                             std::size_t id)
+{
+  double xyz[6] = {p0.x(), p0.y(), p0.z(), p1.x(), p1.y(), p1.z()};
+  int v[2] = {0, 1};
+  _add(id, 2, xyz, v);
+}
+
+void MElementBVH::addTriangle(const SPoint3 &p0, const SPoint3 &p1,
+                              const SPoint3 &p2, std::size_t id)
+{
+  double xyz[9] = {p0.x(), p0.y(), p0.z(), p1.x(), p1.y(),
+                   p1.z(), p2.x(), p2.y(), p2.z()};
+  int v[3] = {0, 1, 2};
+  _add(id, 3, xyz, v);
+}
+
+void MElementBVH::addElement(MElement *e, std::size_t id)
+{
+  // high-order elements are approximated by their primary vertices
+  static const int tri[2][3] = {{0, 1, 2}, {0, 2, 3}};
+  int n = 0, num = 1;
+  switch(e->getType()) {
+  case TYPE_PNT: n = 1; break;
+  case TYPE_LIN: n = 2; break;
+  case TYPE_TRI: n = 3; break;
+  case TYPE_QUA:
+    n = 3;
+    num = 2;
+    break;
+  default: return;
+  }
+  for(int i = 0; i < num; i++) {
+    double xyz[9];
+    for(int j = 0; j < n; j++) {
+      MVertex *v = e->getVertex(tri[i][j]);
+      xyz[3 * j] = v->x();
+      xyz[3 * j + 1] = v->y();
+      xyz[3 * j + 2] = v->z();
+    }
+    _add(id, n, xyz, tri[i]);
+  }
+}
+
+std::size_t MElementBVH::_build(std::vector<std::size_t> &order,
+                                std::size_t first, std::size_t count,
+                                const std::vector<double> &centers)
+{
+  std::size_t index = _nodes.size();
+  _nodes.push_back(node());
+  node n;
+  for(int k = 0; k < 3; k++) {
+    n.min[k] = std::numeric_limits<double>::max();
+    n.max[k] = -std::numeric_limits<double>::max();
+  }
+  double cmin[3] = {n.min[0], n.min[1], n.min[2]};
+  double cmax[3] = {n.max[0], n.max[1], n.max[2]};
+  for(std::size_t i = first; i < first + count; i++) {
+    const double *x = &_xyz[9 * order[i]];
+    for(int j = 0; j < 3; j++) {
+      for(int k = 0; k < 3; k++) {
+        n.min[k] = std::min(n.min[k], x[3 * j + k]);
+        n.max[k] = std::max(n.max[k], x[3 * j + k]);
+      }
+    }
+    for(int k = 0; k < 3; k++) {
+      cmin[k] = std::min(cmin[k], centers[3 * order[i] + k]);
+      cmax[k] = std::max(cmax[k], centers[3 * order[i] + k]);
+    }
+  }
+  n.first = first;
+  n.second = 0;
+  if(count <= leafSize) {
+    n.count = count;
+    _nodes[index] = n;
+    return index;
+  }
+  // split at the median of the centers, along their largest extent
+  n.count = 0;
+  int axis = 0;
+  for(int k = 1; k < 3; k++)
+    if(cmax[k] - cmin[k] > cmax[axis] - cmin[axis]) axis = k;
+  std::size_t half = count / 2;
+  std::nth_element(order.begin() + first, order.begin() + first + half,
+                   order.begin() + first + count,
+                   [&centers, axis](std::size_t a, std::size_t b) {
+                     return centers[3 * a + axis] < centers[3 * b + axis];
+                   });
+  _build(order, first, half, centers);
+  n.second = _build(order, first + half, count - half, centers);
+  _nodes[index] = n;
+  return index;
+}
+
+void MElementBVH::build()
+{
+  _nodes.clear();
+  std::size_t num = _ids.size();
+  if(!num) return;
+  std::vector<double> centers(3 * num);
+  std::vector<std::size_t> order(num);
+  for(std::size_t i = 0; i < num; i++) {
+    for(int k = 0; k < 3; k++)
+      centers[3 * i + k] =
+        (_xyz[9 * i + k] + _xyz[9 * i + 3 + k] + _xyz[9 * i + 6 + k]) / 3.;
+    order[i] = i;
+  }
+  _nodes.reserve(2 * num / leafSize + 1);
+  _build(order, 0, num, centers);
+
+  // store the primitives in the order of the leaves
+  std::vector<double> xyz(_xyz.size());
+  std::vector<std::size_t> ids(num);
+  std::vector<char> numVertices(num), vertices(_vertices.size());
+  for(std::size_t i = 0; i < num; i++) {
+    std::size_t j = order[i];
+    std::copy(&_xyz[9 * j], &_xyz[9 * j] + 9, &xyz[9 * i]);
+    ids[i] = _ids[j];
+    numVertices[i] = _numVertices[j];
+    std::copy(&_vertices[3 * j], &_vertices[3 * j] + 3, &vertices[3 * i]);
+  }
+  _xyz.swap(xyz);
+  _ids.swap(ids);
+  _numVertices.swap(numVertices);
+  _vertices.swap(vertices);
+}
+
+void MElementBVH::clear()
+{
+  _nodes.clear();
+  _xyz.clear();
+  _ids.clear();
+  _numVertices.clear();
+  _vertices.clear();
+}
+
+void MElementBVH::_closest(std::size_t i, const double *p,
+                           closestPoint &c) const
+{
+  const double *x = &_xyz[9 * i];
+  int n = _numVertices[i];
+  if(n == 1)
+    c.weight[0] = 1.;
+  else if(n == 2)
+    closestOnSegment(p, x, x + 3, c.weight);
+  else
+    closestOnTriangle(p, x, x + 3, x + 6, c.weight);
+  double q[3] = {0., 0., 0.};
+  for(int j = 0; j < n; j++) {
+    for(int k = 0; k < 3; k++) q[k] += c.weight[j] * x[3 * j + k];
+    c.vertex[j] = _vertices[3 * i + j];
+  }
+  c.id = _ids[i];
+  c.numVertices = n;
+  c.point = SPoint3(q[0], q[1], q[2]);
+  c.distance =
+    (q[0] - p[0]) * (q[0] - p[0]) + (q[1] - p[1]) * (q[1] - p[1]) +
+    (q[2] - p[2]) * (q[2] - p[2]);
+}
+
+bool MElementBVH::closest(const SPoint3 &p, closestPoint &c) const
+{
+  if(_nodes.empty()) return false;
+  const double q[3] = {p.x(), p.y(), p.z()};
+  double best = std::numeric_limits<double>::max();
+  // depth-first traversal, visiting the closest child first and pruning the
+  // nodes farther than the closest primitive found so far; the median split
+  // bounds the depth of the tree, and thus the size of the stack
+  std::pair<std::size_t, double> stack[128];
+  int top = 0;
+  stack[top++] = std::make_pair(0, 0.);
+  closestPoint tmp;
+  while(top) {
+    std::pair<std::size_t, double> s = stack[--top];
+    if(s.second >= best) continue;
+    const node &n = _nodes[s.first];
+    if(n.count) {
+      for(std::size_t i = n.first; i < n.first + n.count; i++) {
+        _closest(i, q, tmp);
+        if(tmp.distance < best) {
+          best = tmp.distance;
+          c = tmp;
+        }
+      }
+      continue;
+    }
+    std::size_t a = s.first + 1, b = n.second;
+    double da = boxDistance2(_nodes[a].min, _nodes[a].max, q);
+    double db = boxDistance2(_nodes[b].min, _nodes[b].max, q);
+    if(da > db) {
+      std::swap(a, b);
+      std::swap(da, db);
+    }
+    if(db < best) stack[top++] = std::make_pair(b, db);
+    if(da < best) stack[top++] = std::make_pair(a, da);
+  }
+  c.distance = std::sqrt(best);
+  return true;
+}
+
+void MElementBVH::closest(const std::vector<SPoint3> &p,
+                          std::vector<closestPoint> &c, int nthreads) const
+{
+  c.resize(p.size());
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+  for(int i = 0; i < (int)p.size(); i++) closest(p[i], c[i]);
+}
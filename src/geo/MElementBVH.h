@@ -0,0 +1,73 @@
+// Gmsh - Copyright (C) 1997-2024 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#ifndef MELEMENT_BVH_H
+#define MELEMENT_BVH_H
+
+#include <cstddef>
+#include <vector>
+#include "SPoint3.h"
+
+class MElement;
+
+// Bounding volume hierarchy of points, segments and triangles, for exact
+// closest point queries. Mesh elements are added through their primary
+// vertices: lines as segments, triangles as triangles and quadrangles as pairs
+// of triangles. Each primitive carries an id chosen by the caller, which is
+// returned by the queries together with the barycentric coordinates of the
+// closest point. Once built the hierarchy is read-only, and can thus be
+// queried concurrently.
+class MElementBVH {
+public:
+  struct closestPoint {
+    // id of the closest primitive
+    std::size_t id;
+    // number of vertices of the closest primitive (1, 2 or 3), local indices
+    // of these vertices in the mesh element (if the primitive was added as an
+    // element) and barycentric coordinates of the closest point
+    int numVertices, vertex[3];
+    double weight[3];
+    SPoint3 point;
+    double distance;
+  };
+
+private:
+  struct node {
+    double min[3], max[3];
+    // leaves: range of primitives; internal nodes: the first child is the next
+    // node, and "second" is the index of the second child
+    std::size_t first, count, second;
+  };
+  std::vector<node> _nodes;
+  // 3 vertices (9 coordinates) per primitive, repeated for points and segments
+  std::vector<double> _xyz;
+  std::vector<std::size_t> _ids;
+  std::vector<char> _numVertices, _vertices;
+  void _add(std::size_t id, int n, const double *xyz, const int *v);
+  std::size_t _build(std::vector<std::size_t> &order, std::size_t first,
+                     std::size_t count, const std::vector<double> &centers);
+  void _closest(std::size_t i, const double *p, closestPoint &c) const;
+
+public:
+  MElementBVH() {}
+  void addPoint(const SPoint3 &p, std::size_t id);
+  void addSegment(const SPoint3 &p0, const SPoint3 &p1, std::size_t id);
+  void addTriangle(const SPoint3 &p0, const SPoint3 &p1, const SPoint3 &p2,
+                   std::size_t id);
+  // add a point, line, triangle or quadrangle; other elements are ignored
+  void addElement(MElement *e, std::size_t id);
+  // build the hierarchy: call once, after all the primitives have been added
+  void build();
+  void clear();
+  std::size_t size() const { return _ids.size(); }
+  bool empty() const { return _ids.empty(); }
+  // closest point to p; returns false if the hierarchy is empty
+  bool closest(const SPoint3 &p, closestPoint &c) const;
+  // closest points to a set of points, computed in parallel
+  void closest(const std::vector<SPoint3> &p, std::vector<closestPoint> &c,
+               int nthreads = 1) const;
+};
+
+#endif
@@ -42,7 +42,8 @@
 #include <gp_Sphere.hxx>
 
 OCCFace::OCCFace(GModel *m, TopoDS_Face s, int num)
-  : GFace(m, num), _s(s), _sf(s, Standard_True), _radius(-1)
+  : GFace(m, num), _s(s), _sf(s, Standard_True), _radius(-1),
+    _surrogate(nullptr), _surrogateSize(0.)
 {
   _setup();
 
@@ -51,6 +52,87 @@ OCCFace::OCCFace(GModel *m, TopoDS_Face s, int num)
     writeBREP("debugSurface.brep");
 }
 
+OCCFace::~OCCFace() { delete _surrogate.load(); }
+
+GFaceSurrogate *OCCFace::_getSurrogate() const
+{
+  if(!CTX::instance()->mesh.surfaceSurrogate) return nullptr;
+
+  const double rel = CTX::instance()->mesh.surfaceSurrogateTolerance;
+  GFaceSurrogate *s = _surrogate.load(std::memory_order_acquire);
+  if(s) {
+    // the tolerance can only be changed between meshing runs: rebuild the
+    // surrogate only if we are not in a parallel region
+    static std::atomic<bool> warned(false);
+    if(rel > 0. && s->getTolerance() != rel * _surrogateSize) {
+      if(Msg::GetNumThreads() == 1) {
+        std::lock_guard<std::mutex> lock(_surrogateMutex);
+        delete _surrogate.exchange(nullptr);
+        s = nullptr;
+        warned = false;
+      }
+      else if(!warned.exchange(true)) {
+        Msg::Warning("Mesh.SurfaceSurrogateTolerance cannot be changed during "
+                     "parallel meshing: keeping tolerance %g on surface %d",
+                     s->getTolerance(), tag());
+      }
+    }
+    if(s) return s;
+  }
+  if(!(rel > 0.)) return nullptr;
+
+  std::lock_guard<std::mutex> lock(_surrogateMutex);
+  s = _surrogate.load(std::memory_order_acquire);
+  if(s) return s;
+
+  // size of the surface, estimated by sampling its parametrization
+  SBoundingBox3d bbox;
+  const int n = 8;
+  for(int i = 0; i <= n; i++) {
+    for(int j = 0; j <= n; j++) {
+      gp_Pnt p = _occface->Value(_umin + (_umax - _umin) * i / n,
+                                 _vmin + (_vmax - _vmin) * j / n);
+      bbox += SPoint3(p.X(), p.Y(), p.Z());
+    }
+  }
+  _surrogateSize = bbox.empty() ? 0. : bbox.diag();
+
+  Handle(Geom_Surface) occface = _occface;
+  GFaceSurrogate::evaluator exact =
+    [occface](double u, double v, double xyz[3], double du[3], double dv[3],
+              double duu[3], double dvv[3], double duv[3]) {
+    gp_Pnt p;
+    if(duu && dvv && duv) {
+      gp_Vec d1u, d1v, d2u, d2v, d2uv;
+      occface->D2(u, v, p, d1u, d1v, d2u, d2v, d2uv);
+      for(int k = 0; k < 3; k++) {
+        du[k] = d1u.Coord(k + 1);
+        dv[k] = d1v.Coord(k + 1);
+        duu[k] = d2u.Coord(k + 1);
+        dvv[k] = d2v.Coord(k + 1);
+        duv[k] = d2uv.Coord(k + 1);
+      }
+    }
+    else if(du && dv) {
+      gp_Vec d1u, d1v;
+      occface->D1(u, v, p, d1u, d1v);
+      for(int k = 0; k < 3; k++) {
+        du[k] = d1u.Coord(k + 1);
+        dv[k] = d1v.Coord(k + 1);
+      }
+    }
+    else
+      occface->D0(u, v, p);
+    for(int k = 0; k < 3; k++) xyz[k] = p.Coord(k + 1);
+  };
+  s = new GFaceSurrogate(exact, _umin, _umax, _vmin, _vmax,
+                         rel * _surrogateSize);
+  _surrogate.store(s, std::memory_order_release);
+  Msg::Debug("Created surrogate for surface %d (tolerance %g)", tag(),
+             rel * _surrogateSize);
+  return s;
+}
+
 void OCCFace::_setup()
 {
   edgeLoops.clear();
@@ -236,13 +318,20 @@ Range<double> OCCFace::parBounds(int i) const
 
 SVector3 OCCFace::normal(const SPoint2 &param) const
 {
-  gp_Pnt pnt;
-  gp_Vec du, dv;
-
-  _occface->D1(param.x(), param.y(), pnt, du, dv);
-
-  SVector3 t1(du.X(), du.Y(), du.Z());
-  SVector3 t2(dv.X(), dv.Y(), dv.Z());
+  SVector3 t1, t2;
+  GFaceSurrogate *s = _getSurrogate();
+  double d1[3], d2[3];
+  if(s && s->firstDer(param.x(), param.y(), d1, d2)) {
+    t1 = SVector3(d1[0], d1[1], d1[2]);
+    t2 = SVector3(d2[0], d2[1], d2[2]);
+  }
+  else {
+    gp_Pnt pnt;
+    gp_Vec du, dv;
+    _occface->D1(param.x(), param.y(), pnt, du, dv);
+    t1 = SVector3(du.X(), du.Y(), du.Z());
+    t2 = SVector3(dv.X(), dv.Y(), dv.Z());
+  }
   SVector3 n(crossprod(t1, t2));
   n.normalize();
   if(_s.Orientation() == TopAbs_REVERSED) return n * (-1.);
@@ -251,6 +340,11 @@ SVector3 OCCFace::normal(const SPoint2 &param) const
 
 Pair<SVector3, SVector3> OCCFace::firstDer(const SPoint2 &param) const
 {
+  GFaceSurrogate *s = _getSurrogate();
+  double d1[3], d2[3];
+  if(s && s->firstDer(param.x(), param.y(), d1, d2))
+    return Pair<SVector3, SVector3>(SVector3(d1[0], d1[1], d1[2]),
+                                    SVector3(d2[0], d2[1], d2[2]));
   gp_Pnt pnt;
   gp_Vec du, dv;
   _occface->D1(param.x(), param.y(), pnt, du, dv);
@@ -261,6 +355,14 @@ Pair<SVector3, SVector3> OCCFace::firstDer(const SPoint2 &param) const
 void OCCFace::secondDer(const SPoint2 &param, SVector3 &dudu, SVector3 &dvdv,
                         SVector3 &dudv) const
 {
+  GFaceSurrogate *s = _getSurrogate();
+  double d11[3], d22[3], d12[3];
+  if(s && s->secondDer(param.x(), param.y(), d11, d22, d12)) {
+    dudu = SVector3(d11[0], d11[1], d11[2]);
+    dvdv = SVector3(d22[0], d22[1], d22[2]);
+    dudv = SVector3(d12[0], d12[1], d12[2]);
+    return;
+  }
   gp_Pnt pnt;
   gp_Vec du, dv, duu, dvv, duv;
   _occface->D2(param.x(), param.y(), pnt, du, dv, duu, dvv, duv);
@@ -273,6 +375,10 @@ void OCCFace::secondDer(const SPoint2 &param, SVector3 &dudu, SVector3 &dvdv,
 GPoint OCCFace::point(double par1, double par2) const
 {
   double pp[2] = {par1, par2};
+  GFaceSurrogate *s = _getSurrogate();
+  double xyz[3];
+  if(s && s->point(par1, par2, xyz))
+    return GPoint(xyz[0], xyz[1], xyz[2], this, pp);
   gp_Pnt val = _occface->Value(par1, par2);
   return GPoint(val.X(), val.Y(), val.Z(), this, pp);
 }
@@ -351,6 +457,11 @@ GEntity::GeomType OCCFace::geomType() const
 
 double OCCFace::curvatureMax(const SPoint2 &param) const
 {
+  GFaceSurrogate *s = _getSurrogate();
+  double dMax[3], dMin[3], cMax, cMin;
+  if(s && s->curvatures(param.x(), param.y(), dMax, dMin, cMax, cMin))
+    return std::max(fabs(cMin), fabs(cMax));
+
   const double eps = 1.e-12;
   BRepLProp_SLProps prop(_sf, 2, eps);
   prop.SetParameters(param.x(), param.y());
@@ -364,6 +475,14 @@ double OCCFace::curvatures(const SPoint2 &param, SVector3 &dirMax,
                            SVector3 &dirMin, double &curvMax,
                            double &curvMin) const
 {
+  GFaceSurrogate *s = _getSurrogate();
+  double dMax[3], dMin[3];
+  if(s && s->curvatures(param.x(), param.y(), dMax, dMin, curvMax, curvMin)) {
+    dirMax = SVector3(dMax[0], dMax[1], dMax[2]);
+    dirMin = SVector3(dMin[0], dMin[1], dMin[2]);
+    return curvMax;
+  }
+
   const double eps = 1.e-12;
   BRepLProp_SLProps prop(_sf, 2, eps);
   prop.SetParameters(param.x(), param.y());
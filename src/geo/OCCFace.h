@@ -10,9 +10,12 @@
 #include "GFace.h"
 #include "GModel.h"
 #include "Range.h"
+#include "GFaceSurrogate.h"
 
 #if defined(HAVE_OCC)
 
+#include <atomic>
+#include <mutex>
 #include <BRepLProp_SLProps.hxx>
 #include <GeomAPI_ProjectPointOnSurf.hxx>
 #include <TopoDS_Face.hxx>
@@ -30,10 +33,15 @@ private:
   void _setup();
   mutable GeomAPI_ProjectPointOnSurf _projector;
   bool _project(const double p[3], double uv[2], double xyz[3]) const;
+  // cached approximation of the surface, if Mesh.SurfaceSurrogate is set
+  mutable std::atomic<GFaceSurrogate *> _surrogate;
+  mutable std::mutex _surrogateMutex;
+  mutable double _surrogateSize;
+  GFaceSurrogate *_getSurrogate() const;
 
 public:
   OCCFace(GModel *m, TopoDS_Face s, int num);
-  virtual ~OCCFace() {}
+  virtual ~OCCFace();
   virtual SBoundingBox3d bounds(bool fast = false);
   virtual Range<double> parBounds(int i) const;
   virtual GPoint point(double par1, double par2) const;
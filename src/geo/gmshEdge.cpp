@@ -52,6 +52,8 @@ void gmshEdge::resetNativePtr(Curve *c, GVertex *v1, GVertex *v2)
   if(_v0) _v0->addEdge(this);
   if(_v1 && _v1 != _v0) _v1->addEdge(this);
   setMeshSizeFromCurvePoints(*this, *c);
+  // the curve may have changed
+  clearMeshSizeSamples();
 }
 
 bool gmshEdge::degenerate(int dim) const
@@ -67,6 +69,7 @@ void gmshEdge::resetMeshAttributes()
   meshAttributes.coeffTransfinite = _c->coeffTransfinite;
   meshAttributes.extrude = _c->Extrude;
   meshAttributes.reverseMesh = _c->ReverseMesh;
+  clearMeshSizeSamples();
 }
 
 Range<double> gmshEdge::parBounds(int i) const
@@ -265,7 +265,7 @@ std::vector<BDS_Face *> BDS_Point::getTriangles() const
 BDS_Point *BDS_Mesh::add_point(int const num, double const x, double const y,
                                double const z)
 {
-  BDS_Point *pp = new BDS_Point(num, x, y, z);
+  BDS_Point *pp = _pointPool.create(num, x, y, z);
   points.insert(pp);
   MAXPOINTNUMBER = std::max(MAXPOINTNUMBER, num);
   return pp;
@@ -274,7 +274,7 @@ BDS_Point *BDS_Mesh::add_point(int const num, double const x, double const y,
 BDS_Point *BDS_Mesh::add_point(int num, double u, double v, GFace *gf)
 {
   GPoint gp = gf->point(u, v);
-  BDS_Point *pp = new BDS_Point(num, gp.x(), gp.y(), gp.z());
+  BDS_Point *pp = _pointPool.create(num, gp.x(), gp.y(), gp.z());
   pp->u = u;
   pp->v = v;
   points.insert(pp);
@@ -496,7 +496,7 @@ BDS_Edge *BDS_Mesh::add_edge(int const p1, int const p2)
     Msg::Error("Could not find points %d or %d", p1, p2);
     return nullptr;
   }
-  edges.push_back(new BDS_Edge(pp1, pp2));
+  edges.push_back(_newEdge(pp1, pp2));
 
   return edges.back();
 }
@@ -513,7 +513,7 @@ BDS_Face *BDS_Mesh::add_triangle(int p1, int p2, int p3)
 BDS_Face *BDS_Mesh::add_triangle(BDS_Edge *e1, BDS_Edge *e2, BDS_Edge *e3)
 {
   if(e1 && e2 && e3) {
-    BDS_Face *t = new BDS_Face(e1, e2, e3);
+    BDS_Face *t = _newFace(e1, e2, e3);
     triangles.push_back(t);
     return t;
   }
@@ -541,7 +541,7 @@ void BDS_Mesh::del_edge(BDS_Edge *e)
 void BDS_Mesh::del_point(BDS_Point *p)
 {
   if(!p) return;
-  if(points.erase(p)) delete p;
+  if(points.erase(p)) _pointPool.destroy(p);
 }
 
 void BDS_Mesh::add_geom(int p1, int p2)
@@ -654,7 +654,7 @@ void BDS_Mesh::cleanup()
       std::partition(triangles.begin(), triangles.end(), is_not_deleted());
     auto it = last;
     while(it != triangles.end()) {
-      delete *it;
+      _facePool.destroy(*it);
       ++it;
     }
     triangles.erase(last, triangles.end());
@@ -663,7 +663,7 @@ void BDS_Mesh::cleanup()
     auto last = std::partition(edges.begin(), edges.end(), is_not_deleted());
     auto it = last;
     while(it != edges.end()) {
-      delete *it;
+      _edgePool.destroy(*it);
       ++it;
     }
     edges.erase(last, edges.end());
@@ -673,10 +673,11 @@ void BDS_Mesh::cleanup()
 BDS_Mesh::~BDS_Mesh()
 {
   DESTROOOY(geom.begin(), geom.end());
-  DESTROOOY(points.begin(), points.end());
-  cleanup();
-  DESTROOOY(edges.begin(), edges.end());
-  DESTROOOY(triangles.begin(), triangles.end());
+  for(auto it = points.begin(); it != points.end(); ++it)
+    _pointPool.destroy(*it);
+  for(std::size_t i = 0; i < edges.size(); i++) _edgePool.destroy(edges[i]);
+  for(std::size_t i = 0; i < triangles.size(); i++)
+    _facePool.destroy(triangles[i]);
 }
 
 bool BDS_Mesh::split_edge(BDS_Edge *e, BDS_Point *mid, bool check_area_param)
@@ -752,27 +753,27 @@ bool BDS_Mesh::split_edge(BDS_Edge *e, BDS_Point *mid, bool check_area_param)
 
   del_edge(e);
 
-  BDS_Edge *p1_mid = new BDS_Edge(p1, mid);
+  BDS_Edge *p1_mid = _newEdge(p1, mid);
   edges.push_back(p1_mid);
-  BDS_Edge *mid_p2 = new BDS_Edge(mid, p2);
+  BDS_Edge *mid_p2 = _newEdge(mid, p2);
   edges.push_back(mid_p2);
-  BDS_Edge *op1_mid = new BDS_Edge(op[0], mid);
+  BDS_Edge *op1_mid = _newEdge(op[0], mid);
   edges.push_back(op1_mid);
-  BDS_Edge *mid_op2 = new BDS_Edge(mid, op[1]);
+  BDS_Edge *mid_op2 = _newEdge(mid, op[1]);
   edges.push_back(mid_op2);
 
   BDS_Face *t1, *t2, *t3, *t4;
   if(orientation == 1) {
-    t1 = new BDS_Face(op1_mid, p1_op1, p1_mid);
-    t2 = new BDS_Face(mid_op2, op2_p2, mid_p2);
-    t3 = new BDS_Face(op1_p2, op1_mid, mid_p2);
-    t4 = new BDS_Face(p1_op2, mid_op2, p1_mid);
+    t1 = _newFace(op1_mid, p1_op1, p1_mid);
+    t2 = _newFace(mid_op2, op2_p2, mid_p2);
+    t3 = _newFace(op1_p2, op1_mid, mid_p2);
+    t4 = _newFace(p1_op2, mid_op2, p1_mid);
   }
   else {
-    t1 = new BDS_Face(p1_op1, op1_mid, p1_mid);
-    t2 = new BDS_Face(op2_p2, mid_op2, mid_p2);
-    t3 = new BDS_Face(op1_mid, op1_p2, mid_p2);
-    t4 = new BDS_Face(mid_op2, p1_op2, p1_mid);
+    t1 = _newFace(p1_op1, op1_mid, p1_mid);
+    t2 = _newFace(op2_p2, mid_op2, mid_p2);
+    t3 = _newFace(op1_mid, op1_p2, mid_p2);
+    t4 = _newFace(mid_op2, p1_op2, p1_mid);
   }
   t1->g = g1;
   t2->g = g2;
@@ -1028,16 +1029,16 @@ bool BDS_Mesh::swap_edge(BDS_Edge *e, const BDS_SwapEdgeTest &theTest,
   }
   del_edge(e);
 
-  edges.push_back(new BDS_Edge(op[0], op[1]));
+  edges.push_back(_newEdge(op[0], op[1]));
 
   BDS_Face *t1, *t2;
   if(orientation == 1) {
-    t1 = new BDS_Face(p1_op1, p1_op2, edges.back());
-    t2 = new BDS_Face(edges.back(), op2_p2, op1_p2);
+    t1 = _newFace(p1_op1, p1_op2, edges.back());
+    t2 = _newFace(edges.back(), op2_p2, op1_p2);
   }
   else {
-    t1 = new BDS_Face(p1_op2, p1_op1, edges.back());
-    t2 = new BDS_Face(op2_p2, edges.back(), op1_p2);
+    t1 = _newFace(p1_op2, p1_op1, edges.back());
+    t2 = _newFace(op2_p2, edges.back(), op1_p2);
   }
 
   t1->g = g1;
@@ -1652,11 +1653,14 @@ bool BDS_Mesh::smooth_point_centroid(BDS_Point *p, GFace *gf, double threshold)
 
   computeSomeKindOfKernel(p, nbg, kernel, lc, CHECK);
 
+  // the point can be moved even if the smoothing is not successful
+  const double old[6] = {p->X, p->Y, p->Z, p->u, p->v, p->lc()};
+  bool ret = true;
   if(!minimizeTutteEnergyParam(p, E_unmoved, RATIO, nbg, kernel, lc, gf,
                                CHECK)) {
     if(!minimizeTutteEnergyProj(p, E_unmoved, RATIO, nbg, kernel, lc, gf,
                                 CHECK)) {
-      return false;
+      ret = false;
     }
     else {
       p->config_modified = true;
@@ -1667,6 +1671,9 @@ bool BDS_Mesh::smooth_point_centroid(BDS_Point *p, GFace *gf, double threshold)
   else {
     p->config_modified = true;
   }
+  if(p->X != old[0] || p->Y != old[1] || p->Z != old[2] || p->u != old[3] ||
+     p->v != old[4] || p->lc() != old[5])
+    p->modified();
 
-  return true;
+  return ret;
 }
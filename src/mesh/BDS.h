@@ -16,6 +16,9 @@
 #include <algorithm>
 #include <functional>
 #include <cmath>
+#include <new>
+#include <utility>
+#include <type_traits>
 
 #include "GmshMessage.h"
 
@@ -51,6 +54,9 @@ class BDS_Point {
   // second one is dictated by characteristic lengths at points and is
   // propagated
   double _lcBGM, _lcPTS;
+  // incremented each time the point is moved (or its size is changed), to
+  // invalidate the quantities cached on its edges
+  unsigned int _version;
 
 public:
   double X, Y, Z;
@@ -65,6 +71,8 @@ public:
   double &lcBGM() { return _lcBGM; }
   double &lc() { return _lcPTS; }
   double const &lc() const { return _lcPTS; }
+  unsigned int version() const { return _version; }
+  void modified() { _version++; }
 
   bool operator<(const BDS_Point &other) const { return iD < other.iD; }
 
@@ -75,7 +83,7 @@ public:
   }
   std::vector<BDS_Face *> getTriangles() const;
   BDS_Point(int id, double x = 0, double y = 0, double z = 0)
-    : _lcBGM(1.e22), _lcPTS(1.e22), X(x), Y(y), Z(z), u(0), v(0),
+    : _lcBGM(1.e22), _lcPTS(1.e22), _version(0), X(x), Y(y), Z(z), u(0), v(0),
       config_modified(true), degenerated(0), _periodicCounterpart(nullptr),
       iD(id), g(nullptr)
   {
@@ -84,9 +92,14 @@ public:
 
 class BDS_Edge {
   std::vector<BDS_Face *> _faces;
+  // cached length of the edge in the mesh size field, valid as long as the
+  // versions of its nodes have not changed (_lcVersion == 0 if unset)
+  double _lc;
+  unsigned int _lcVersion;
 
 public:
-  BDS_Edge(BDS_Point *A, BDS_Point *B) : deleted(false), g(nullptr)
+  BDS_Edge(BDS_Point *A, BDS_Point *B)
+    : _lc(0.), _lcVersion(0), deleted(false), g(nullptr)
   {
     if(*A < *B) {
       p1 = A;
@@ -108,6 +121,18 @@ public:
                      (p1->Z - p2->Z) * (p1->Z - p2->Z));
   }
   int numfaces() const { return static_cast<int>(_faces.size()); }
+  bool getCachedLc(double &lc) const
+  {
+    if(_lcVersion != p1->version() + p2->version() + 1) return false;
+    lc = _lc;
+    return true;
+  }
+  void setCachedLc(double lc)
+  {
+    _lc = lc;
+    _lcVersion = p1->version() + p2->version() + 1;
+  }
+  void clearCachedLc() { _lcVersion = 0; }
   int numTriangles() const;
   inline BDS_Point *commonvertex(const BDS_Edge *other) const
   {
@@ -336,13 +361,67 @@ struct EdgeToRecover {
   }
 };
 
+// Storage of the points, edges and faces of a mesh, allocated in blocks: the
+// entities are stored contiguously, and the memory of the deleted ones is
+// reused through a free list
+template <class T> class BDS_Pool {
+private:
+  typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type slot;
+  enum { BLOCK_SIZE = 4096 };
+  std::vector<slot *> _blocks;
+  std::size_t _used;
+  std::vector<T *> _free;
+
+public:
+  BDS_Pool() : _used(BLOCK_SIZE) {}
+  BDS_Pool(const BDS_Pool &) = delete;
+  BDS_Pool &operator=(const BDS_Pool &) = delete;
+  ~BDS_Pool()
+  {
+    for(std::size_t i = 0; i < _blocks.size(); i++) delete[] _blocks[i];
+  }
+  template <class... Args> T *create(Args &&...args)
+  {
+    void *p;
+    if(!_free.empty()) {
+      p = _free.back();
+      _free.pop_back();
+    }
+    else {
+      if(_used == BLOCK_SIZE) {
+        _blocks.push_back(new slot[BLOCK_SIZE]);
+        _used = 0;
+      }
+      p = &_blocks.back()[_used++];
+    }
+    return new(p) T(std::forward<Args>(args)...);
+  }
+  void destroy(T *t)
+  {
+    t->~T();
+    _free.push_back(t);
+  }
+};
+
 class BDS_Mesh {
+private:
+  BDS_Pool<BDS_Point> _pointPool;
+  BDS_Pool<BDS_Edge> _edgePool;
+  BDS_Pool<BDS_Face> _facePool;
+  BDS_Edge *_newEdge(BDS_Point *p1, BDS_Point *p2)
+  {
+    return _edgePool.create(p1, p2);
+  }
+  BDS_Face *_newFace(BDS_Edge *e1, BDS_Edge *e2, BDS_Edge *e3)
+  {
+    return _facePool.create(e1, e2, e3);
+  }
+
 public:
   int MAXPOINTNUMBER;
   double Min[3], Max[3], LC;
   BDS_Mesh(int MAXX = 0) : MAXPOINTNUMBER(MAXX) {}
   virtual ~BDS_Mesh();
-  BDS_Mesh(const BDS_Mesh &other);
   std::set<BDS_GeomEntity *, GeomLessThan> geom;
   std::set<BDS_Point *, PointLessThan> points;
   std::vector<BDS_Edge *> edges;
@@ -14,7 +14,6 @@
 #include "OS.h"
 #include "Field.h"
 #include "MElement.h"
-#include "MElementOctree.h"
 #include "MLine.h"
 #include "MTriangle.h"
 #include "MQuadrangle.h"
@@ -24,16 +23,150 @@
 #include "dofManager.h"
 #include "laplaceTerm.h"
 #include "linearSystemCSR.h"
-#include "linearSystemFull.h"
+#include "linearSystemCSRIterative.h"
 #include "linearSystemPETSc.h"
 #endif
 
-#if defined(HAVE_ANN)
+// number of boundary nodes used to compute the cross field by distance
 static const int NBANN = 2;
-#endif
 
 static const int MAX_THREADS = 256;
 
+// Uniform grid on the bounding box of a set of items (triangles or points) in
+// the parametric plane, storing the indices of the items overlapping each
+// cell. The grid is read-only once built.
+class backgroundMeshGrid {
+private:
+  double _min[2], _h[2];
+  int _n[2];
+  std::vector<std::size_t> _start;
+  std::vector<long> _items;
+  int _cell(double x, int d) const
+  {
+    int i = (int)std::floor((x - _min[d]) / _h[d]);
+    return std::max(0, std::min(_n[d] - 1, i));
+  }
+
+public:
+  // boxes contains the (umin, vmin, umax, vmax) boxes of the items
+  backgroundMeshGrid(const std::vector<double> &boxes)
+  {
+    std::size_t N = boxes.size() / 4;
+    double max[2] = {-1e300, -1e300};
+    _min[0] = _min[1] = 1e300;
+    for(std::size_t i = 0; i < N; i++) {
+      for(int d = 0; d < 2; d++) {
+        _min[d] = std::min(_min[d], boxes[4 * i + d]);
+        max[d] = std::max(max[d], boxes[4 * i + 2 + d]);
+      }
+    }
+    if(!N) _min[0] = _min[1] = max[0] = max[1] = 0.;
+    // about one item per cell, with cells as square as possible
+    double l[2] = {max[0] - _min[0], max[1] - _min[1]};
+    double eps = 1e-12 * std::max(1., std::max(l[0], l[1]));
+    for(int d = 0; d < 2; d++) l[d] = std::max(l[d], eps);
+    double h = std::sqrt(l[0] * l[1] / std::max((std::size_t)1, N));
+    for(int d = 0; d < 2; d++) {
+      _n[d] = std::max(1, std::min(2048, (int)std::ceil(l[d] / h)));
+      _h[d] = l[d] / _n[d];
+    }
+    _start.assign(_n[0] * _n[1] + 1, 0);
+    for(int pass = 0; pass < 2; pass++) {
+      std::vector<std::size_t> pos;
+      if(pass) {
+        for(std::size_t c = 1; c < _start.size(); c++)
+          _start[c] += _start[c - 1];
+        _items.resize(_start.back());
+        pos.assign(_start.begin(), _start.end() - 1);
+      }
+      for(std::size_t k = 0; k < N; k++) {
+        int i0 = _cell(boxes[4 * k], 0), i1 = _cell(boxes[4 * k + 2], 0);
+        int j0 = _cell(boxes[4 * k + 1], 1), j1 = _cell(boxes[4 * k + 3], 1);
+        for(int i = i0; i <= i1; i++) {
+          for(int j = j0; j <= j1; j++) {
+            std::size_t c = i + _n[0] * j;
+            if(pass)
+              _items[pos[c]++] = k;
+            else
+              _start[c + 1]++;
+          }
+        }
+      }
+    }
+  }
+  // items in the cell containing (u, v) (or in the closest cell)
+  void getItems(double u, double v, const long *&begin, const long *&end) const
+  {
+    std::size_t c = _cell(u, 0) + _n[0] * _cell(v, 1);
+    begin = _items.data() + _start[c];
+    end = _items.data() + _start[c + 1];
+  }
+  // the k items closest to (u, v), according to the distance function dist,
+  // sorted by increasing distance
+  template <class F>
+  void getClosest(double u, double v, std::size_t k, F dist,
+                  std::vector<std::pair<double, long> > &closest) const
+  {
+    closest.clear();
+    int ci = _cell(u, 0), cj = _cell(v, 1);
+    double h = std::min(_h[0], _h[1]);
+    for(int r = 0; r <= std::max(_n[0], _n[1]); r++) {
+      for(int i = ci - r; i <= ci + r; i++) {
+        for(int j = cj - r; j <= cj + r; j++) {
+          if(i < 0 || j < 0 || i >= _n[0] || j >= _n[1]) continue;
+          // only the cells of ring r
+          if(std::abs(i - ci) != r && std::abs(j - cj) != r) continue;
+          std::size_t c = i + _n[0] * j;
+          for(std::size_t l = _start[c]; l < _start[c + 1]; l++)
+            closest.push_back(std::make_pair(dist(_items[l]), _items[l]));
+        }
+      }
+      // items can overlap several cells
+      std::sort(closest.begin(), closest.end());
+      closest.erase(std::unique(closest.begin(), closest.end()),
+                    closest.end());
+      if(closest.size() > k) closest.resize(k);
+      // items outside of ring r are at least at distance r * h
+      if(closest.size() == k && closest.back().first <= r * h) break;
+    }
+  }
+};
+
+// thread-local hint for the walk: last triangle located by the thread
+namespace {
+  struct bgmLastTriangle {
+    const backgroundMesh *bgm;
+    long t;
+  };
+} // namespace
+static thread_local bgmLastTriangle lastTriangle = {nullptr, 0};
+
+static void barycentric(const double *a, const double *b, const double *c,
+                        double u, double v, double bary[3])
+{
+  double det = (b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]);
+  if(det == 0.) {
+    bary[0] = bary[1] = bary[2] = -1.;
+    return;
+  }
+  bary[1] = ((u - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (v - a[1])) / det;
+  bary[2] = ((b[0] - a[0]) * (v - a[1]) - (u - a[0]) * (b[1] - a[1])) / det;
+  bary[0] = 1. - bary[1] - bary[2];
+}
+
+// squared distance from (u, v) to the segment [a, b], and parameter of the
+// closest point
+static double distanceToSegment(const double *a, const double *b, double u,
+                                double v, double &t)
+{
+  double dx = b[0] - a[0], dy = b[1] - a[1];
+  double l2 = dx * dx + dy * dy;
+  t = l2 > 0. ? ((u - a[0]) * dx + (v - a[1]) * dy) / l2 : 0.;
+  t = std::max(0., std::min(1., t));
+  double x = a[0] + t * dx - u, y = a[1] + t * dy - v;
+  return x * x + y * y;
+}
+
 std::vector<backgroundMesh *> backgroundMesh::_current =
   std::vector<backgroundMesh *>(MAX_THREADS, (backgroundMesh *)nullptr);
 
@@ -73,10 +206,7 @@ backgroundMesh *backgroundMesh::current()
 }
 
 backgroundMesh::backgroundMesh(GFace *_gf, bool cfd)
-#if defined(HAVE_ANN)
-  : _octree(nullptr), uv_kdtree(nullptr), nodes(nullptr), angle_nodes(nullptr),
-    angle_kdtree(nullptr)
-#endif
+  : _grid(nullptr), _angleGrid(nullptr)
 {
   if(cfd) {
     Msg::Debug("Building cross field using closest distance");
@@ -88,7 +218,6 @@ backgroundMesh::backgroundMesh(GFace *_gf, bool cfd)
   // those triangles are local to the backgroundMesh so that
   // they do not depend on the actual mesh that can be deleted
 
-  std::set<SPoint2> myBCNodes;
   for(std::size_t i = 0; i < _gf->triangles.size(); i++) {
     MTriangle *e = _gf->triangles[i];
     MVertex *news[3];
@@ -100,10 +229,10 @@ backgroundMesh::backgroundMesh(GFace *_gf, bool cfd)
         SPoint2 p;
         reparamMeshVertexOnFace(v, _gf, p);
         newv = new MVertex(p.x(), p.y(), 0.0);
+        newv->setIndex(_vertices.size());
         _vertices.push_back(newv);
         _3Dto2D[v] = newv;
         _2Dto3D[newv] = v;
-        if(v->onWhat()->dim() < 2) myBCNodes.insert(p);
       }
       else
         newv = it->second;
@@ -113,34 +242,12 @@ backgroundMesh::backgroundMesh(GFace *_gf, bool cfd)
     _triangles.push_back(T2D);
   }
 
-#if defined(HAVE_ANN)
-  index = new ANNidx[2];
-  dist = new ANNdist[2];
-  nodes = annAllocPts(myBCNodes.size(), 3);
-  auto itp = myBCNodes.begin();
-  int ind = 0;
-  while(itp != myBCNodes.end()) {
-    SPoint2 pt = *itp;
-    nodes[ind][0] = pt.x();
-    nodes[ind][1] = pt.y();
-    nodes[ind][2] = 0.0;
-    itp++;
-    ind++;
-  }
-  uv_kdtree = new ANNkd_tree(nodes, myBCNodes.size(), 3);
-#endif
-
-  // build a search structure
-  _octree = new MElementOctree(_triangles);
+  // build the search structures
+  _buildSearchStructures();
 
   // compute the mesh sizes at nodes
+  _sizes.assign(_vertices.size(), CTX::instance()->mesh.lcMax);
   if(CTX::instance()->mesh.lcFromPoints) { propagate1dMesh(_gf); }
-  else {
-    auto itv2 = _2Dto3D.begin();
-    for(; itv2 != _2Dto3D.end(); ++itv2) {
-      _sizes[itv2->first] = CTX::instance()->mesh.lcMax;
-    }
-  }
   // ensure that other criteria are fulfilled
   updateSizes(_gf);
 
@@ -155,15 +262,123 @@ backgroundMesh::~backgroundMesh()
 {
   for(std::size_t i = 0; i < _vertices.size(); i++) delete _vertices[i];
   for(std::size_t i = 0; i < _triangles.size(); i++) delete _triangles[i];
-  if(_octree) delete _octree;
-#if defined(HAVE_ANN)
-  if(uv_kdtree) delete uv_kdtree;
-  if(angle_kdtree) delete angle_kdtree;
-  if(nodes) annDeallocPts(nodes);
-  if(angle_nodes) annDeallocPts(angle_nodes);
-  delete[] index;
-  delete[] dist;
-#endif
+  if(_grid) delete _grid;
+  if(_angleGrid) delete _angleGrid;
+}
+
+void backgroundMesh::_buildSearchStructures()
+{
+  _uv.resize(2 * _vertices.size());
+  for(std::size_t i = 0; i < _vertices.size(); i++) {
+    _uv[2 * i] = _vertices[i]->x();
+    _uv[2 * i + 1] = _vertices[i]->y();
+  }
+
+  // nodes and boxes of the triangles
+  std::size_t N = _triangles.size();
+  _tri.resize(3 * N);
+  std::vector<double> boxes(4 * N);
+  for(std::size_t i = 0; i < N; i++) {
+    boxes[4 * i] = boxes[4 * i + 1] = 1e300;
+    boxes[4 * i + 2] = boxes[4 * i + 3] = -1e300;
+    for(int j = 0; j < 3; j++) {
+      long n = _tri[3 * i + j] = _triangles[i]->getVertex(j)->getIndex();
+      for(int d = 0; d < 2; d++) {
+        boxes[4 * i + d] = std::min(boxes[4 * i + d], _uv[2 * n + d]);
+        boxes[4 * i + 2 + d] = std::max(boxes[4 * i + 2 + d], _uv[2 * n + d]);
+      }
+    }
+  }
+  _grid = new backgroundMeshGrid(boxes);
+
+  // neighbors of the triangles, for the walk
+  std::map<std::pair<long, long>, std::pair<long, int> > edges;
+  _neighbors.assign(3 * N, -1);
+  for(std::size_t i = 0; i < N; i++) {
+    for(int j = 0; j < 3; j++) {
+      long a = _tri[3 * i + (j + 1) % 3], b = _tri[3 * i + (j + 2) % 3];
+      auto key = std::make_pair(std::min(a, b), std::max(a, b));
+      auto it = edges.find(key);
+      if(it == edges.end())
+        edges[key] = std::make_pair((long)i, j);
+      else {
+        _neighbors[3 * i + j] = it->second.first;
+        _neighbors[3 * it->second.first + it->second.second] = i;
+      }
+    }
+  }
+}
+
+long backgroundMesh::_locate(double u, double v, double bary[3],
+                             bool strict) const
+{
+  if(_triangles.empty()) return -1;
+  const double tol = CTX::instance()->mesh.toleranceReferenceElement;
+
+  // walk from the last triangle located by this thread, or from a triangle in
+  // the grid cell
+  const long *begin, *end;
+  _grid->getItems(u, v, begin, end);
+  long t = (begin != end) ? *begin : 0;
+  if(lastTriangle.bgm == this && lastTriangle.t < (long)_triangles.size())
+    t = lastTriangle.t;
+  long maxSteps = 10 + 2 * (long)std::sqrt((double)_triangles.size());
+  for(long step = 0; step < maxSteps; step++) {
+    barycentric(&_uv[2 * _tri[3 * t]], &_uv[2 * _tri[3 * t + 1]],
+                &_uv[2 * _tri[3 * t + 2]], u, v, bary);
+    int k = 0;
+    if(bary[1] < bary[k]) k = 1;
+    if(bary[2] < bary[k]) k = 2;
+    if(bary[k] >= -tol) {
+      lastTriangle.bgm = this;
+      lastTriangle.t = t;
+      return t;
+    }
+    // cross the edge opposite to the most negative coordinate
+    long n = _neighbors[3 * t + k];
+    if(n < 0) break;
+    t = n;
+  }
+
+  // search the triangles in the grid cell
+  for(const long *it = begin; it != end; it++) {
+    t = *it;
+    barycentric(&_uv[2 * _tri[3 * t]], &_uv[2 * _tri[3 * t + 1]],
+                &_uv[2 * _tri[3 * t + 2]], u, v, bary);
+    if(bary[0] >= -tol && bary[1] >= -tol && bary[2] >= -tol) {
+      lastTriangle.bgm = this;
+      lastTriangle.t = t;
+      return t;
+    }
+  }
+  if(strict) return -1;
+
+  // closest triangle: use the closest point on its boundary
+  std::vector<std::pair<double, long> > closest;
+  auto dist = [&](long t) {
+    double d = 1e300, p;
+    for(int j = 0; j < 3; j++)
+      d = std::min(d, distanceToSegment(&_uv[2 * _tri[3 * t + j]],
+                                        &_uv[2 * _tri[3 * t + (j + 1) % 3]],
+                                        u, v, p));
+    return std::sqrt(d);
+  };
+  _grid->getClosest(u, v, 1, dist, closest);
+  if(closest.empty()) return -1;
+  t = closest[0].second;
+  double dmin = 1e300;
+  for(int j = 0; j < 3; j++) {
+    double p;
+    double d = distanceToSegment(&_uv[2 * _tri[3 * t + j]],
+                                 &_uv[2 * _tri[3 * t + (j + 1) % 3]], u, v, p);
+    if(d < dmin) {
+      dmin = d;
+      bary[j] = 1. - p;
+      bary[(j + 1) % 3] = p;
+      bary[(j + 2) % 3] = 0.;
+    }
+  }
+  return t;
 }
 
 static void propagateValuesOnFace(GFace *_gf,
@@ -177,7 +392,8 @@ static void propagateValuesOnFace(GFace *_gf,
 #elif defined(HAVE_GMM)
   linearSystemCSRGmm<double> *_lsys = new linearSystemCSRGmm<double>;
 #else
-  linearSystemFull<double> *_lsys = new linearSystemFull<double>;
+  linearSystemCSRIterative<double> *_lsys =
+    new linearSystemCSRIterative<double>;
 #endif
 
   dofManager<double> myAssembler(_lsys);
@@ -269,7 +485,7 @@ void backgroundMesh::propagate1dMesh(GFace *_gf)
   for(; itv2 != _2Dto3D.end(); ++itv2) {
     MVertex *v_2D = itv2->first;
     MVertex *v_3D = itv2->second;
-    _sizes[v_2D] = exp(sizes[v_3D]);
+    _sizes[v_2D->getIndex()] = exp(sizes[v_3D]);
   }
 }
 
@@ -330,29 +546,21 @@ void backgroundMesh::propagateCrossFieldByDistance(GFace *_gf)
     }
   }
 
-#if defined(HAVE_ANN)
-  index = new ANNidx[NBANN];
-  dist = new ANNdist[NBANN];
-  angle_nodes = annAllocPts(_cosines4.size(), 3);
-  auto itp = _cosines4.begin();
-  int ind = 0;
+  std::vector<double> boxes;
+  _angleUV.clear();
   _sin.clear();
   _cos.clear();
-  while(itp != _cosines4.end()) {
+  for(auto itp = _cosines4.begin(); itp != _cosines4.end(); itp++) {
     MVertex *v = itp->first;
-    double c = itp->second;
     SPoint2 pt = _param[v];
-    double s = _sines4[v];
-    angle_nodes[ind][0] = pt.x();
-    angle_nodes[ind][1] = pt.y();
-    angle_nodes[ind][2] = 0.0;
-    _cos.push_back(c);
-    _sin.push_back(s);
-    itp++;
-    ind++;
-  }
-  angle_kdtree = new ANNkd_tree(angle_nodes, _cosines4.size(), 3);
-#endif
+    _angleUV.push_back(pt.x());
+    _angleUV.push_back(pt.y());
+    _cos.push_back(itp->second);
+    _sin.push_back(_sines4[v]);
+    double box[4] = {pt.x(), pt.y(), pt.x(), pt.y()};
+    boxes.insert(boxes.end(), box, box + 4);
+  }
+  _angleGrid = new backgroundMeshGrid(boxes);
 }
 
 inline double myAngle(const SVector3 &a, const SVector3 &b, const SVector3 &d)
@@ -369,18 +577,16 @@ inline double myAngle(const SVector3 &a, const SVector3 &b, const SVector3 &d)
 // L --> domain size
 double backgroundMesh::getSmoothness(MElement *e)
 {
-  MVertex *v0 = _3Dto2D[e->getVertex(0)];
-  MVertex *v1 = _3Dto2D[e->getVertex(1)];
-  MVertex *v2 = _3Dto2D[e->getVertex(2)];
-  auto i0 = _angles.find(v0);
-  auto i1 = _angles.find(v1);
-  auto i2 = _angles.find(v2);
-  double a[3] = {cos(4 * i0->second), cos(4 * i1->second), cos(4 * i2->second)};
-  double b[3] = {sin(4 * i0->second), sin(4 * i1->second), sin(4 * i2->second)};
+  double ang[3];
+  for(int i = 0; i < 3; i++) {
+    auto it = _3Dto2D.find(e->getVertex(i));
+    if(it == _3Dto2D.end()) return 0.;
+    ang[i] = _angles[it->second->getIndex()];
+  }
+  double a[3] = {cos(4 * ang[0]), cos(4 * ang[1]), cos(4 * ang[2])};
   double f[3];
   e->interpolateGrad(a, 0, 0, 0, f);
   const double gradcos = sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
-  e->interpolateGrad(b, 0, 0, 0, f);
   // const double gradsin = sqrt (f[0]*f[0]+f[1]*f[1]+f[2]*f[2]);
   const double h = e->maxEdge();
   return (gradcos /*+ gradsin*/) * h;
@@ -388,21 +594,17 @@ double backgroundMesh::getSmoothness(MElement *e)
 
 double backgroundMesh::getSmoothness(double u, double v, double w)
 {
-  if(!_octree) return 0.;
-  MElement *e = _octree->find(u, v, w, 2, true);
-  if(!e) return -1.0;
-  MVertex *v0 = e->getVertex(0);
-  MVertex *v1 = e->getVertex(1);
-  MVertex *v2 = e->getVertex(2);
-  auto i0 = _angles.find(v0);
-  auto i1 = _angles.find(v1);
-  auto i2 = _angles.find(v2);
-  double a[3] = {cos(4 * i0->second), cos(4 * i1->second), cos(4 * i2->second)};
-  double b[3] = {sin(4 * i0->second), sin(4 * i1->second), sin(4 * i2->second)};
+  if(_triangles.empty()) return 0.;
+  double bary[3];
+  long t = _locate(u, v, bary, true);
+  if(t < 0) return -1.0;
+  MElement *e = _triangles[t];
+  double ang[3];
+  for(int i = 0; i < 3; i++) ang[i] = _angles[_tri[3 * t + i]];
+  double a[3] = {cos(4 * ang[0]), cos(4 * ang[1]), cos(4 * ang[2])};
   double f[3];
   e->interpolateGrad(a, 0, 0, 0, f);
   const double gradcos = sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
-  e->interpolateGrad(b, 0, 0, 0, f);
   // const double gradsin = sqrt (f[0]*f[0]+f[1]*f[1]+f[2]*f[2]);
   const double h = e->maxEdge();
   return (gradcos /*+ gradsin*/) * h;
@@ -425,7 +627,6 @@ void backgroundMesh::propagateCrossField(GFace *_gf)
     // if(NSMOOTH_NOW == NSMOOTH) break;
     // NSMOOTH = NSMOOTH_NOW;
     // break;
-    _angles.clear();
     propagateCrossField(_gf, &C);
     if(++ITER > 0) break;
   }
@@ -492,22 +693,22 @@ void backgroundMesh::propagateCrossField(GFace *_gf,
   //    print("cos4.pos",0,_cosines4,0);
   //    print("sin4.pos",0,_sines4,0);
 
+  _angles.assign(_vertices.size(), 0.);
   auto itv2 = _2Dto3D.begin();
   for(; itv2 != _2Dto3D.end(); ++itv2) {
     MVertex *v_2D = itv2->first;
     MVertex *v_3D = itv2->second;
     double angle = atan2(_sines4[v_3D], _cosines4[v_3D]) / 4.0;
     crossField2d::normalizeAngle(angle);
-    _angles[v_2D] = angle;
+    _angles[v_2D->getIndex()] = angle;
   }
 }
 
 void backgroundMesh::updateSizes(GFace *_gf)
 {
-  auto itv = _sizes.begin();
-  for(; itv != _sizes.end(); ++itv) {
+  for(std::size_t i = 0; i < _vertices.size(); i++) {
     SPoint2 p;
-    MVertex *v = _2Dto3D[itv->first];
+    MVertex *v = _2Dto3D[_vertices[i]];
     double lc;
     if(v->onWhat()->dim() == 0) {
       lc = BGM_MeshSize(v->onWhat(), 0, 0, v->x(), v->y(), v->z());
@@ -521,106 +722,55 @@ void backgroundMesh::updateSizes(GFace *_gf)
       reparamMeshVertexOnFace(v, _gf, p);
       lc = BGM_MeshSize(_gf, p.x(), p.y(), v->x(), v->y(), v->z());
     }
-    itv->second = std::min(lc, itv->second);
-    itv->second = std::max(itv->second, CTX::instance()->mesh.lcMin);
-    itv->second = std::min(itv->second, CTX::instance()->mesh.lcMax);
-  }
-  // do not allow large variations in the size field
-  // (Int. J. Numer. Meth. Engng. 43, 1143-1165 (1998) MESH GRADATION
-  // CONTROL, BOROUCHAKI, HECHT, FREY)
-  std::set<MEdge, MEdgeLessThan> edges;
-  for(std::size_t i = 0; i < _triangles.size(); i++) {
-    for(int j = 0; j < _triangles[i]->getNumEdges(); j++) {
-      edges.insert(_triangles[i]->getEdge(j));
-    }
-  }
-  const double _beta = 1.3;
-  for(int i = 0; i < 3; i++) {
-    auto it = edges.begin();
-    for(; it != edges.end(); ++it) {
-      MVertex *v0 = it->getVertex(0);
-      MVertex *v1 = it->getVertex(1);
-      MVertex *V0 = _2Dto3D[v0];
-      MVertex *V1 = _2Dto3D[v1];
-      auto s0 = _sizes.find(V0);
-      auto s1 = _sizes.find(V1);
-      if(s0 == _sizes.end() || s1 == _sizes.end()) {
-        // Note: this Warning is disabled because it's too verbose in logs
-        //       is this behavior normal ? Was doing undefined behavior before
-        //       (detected by valgrind)
-        // Msg::Warning("in backgroundMesh::updateSizes(), vertex not found in maps");
-        continue;
-      }
-      if(s0->second < s1->second)
-        s1->second = std::min(s1->second, _beta * s0->second);
-      else
-        s0->second = std::min(s0->second, _beta * s1->second);
-    }
+    _sizes[i] = std::min(lc, _sizes[i]);
+    _sizes[i] = std::max(_sizes[i], CTX::instance()->mesh.lcMin);
+    _sizes[i] = std::min(_sizes[i], CTX::instance()->mesh.lcMax);
   }
 }
 
 bool backgroundMesh::inDomain(double u, double v, double w) const
 {
-  if(!_octree) return false;
-  return _octree->find(u, v, w, 2, true) != nullptr;
+  double bary[3];
+  return _locate(u, v, bary, true) >= 0;
 }
 
 double backgroundMesh::operator()(double u, double v, double w) const
 {
-  if(!_octree) {
-    Msg::Error("No octree in background mesh");
+  if(_triangles.empty()) {
+    Msg::Error("Empty background mesh");
     return 0.;
   }
-  double uv[3] = {u, v, w};
-  double uv2[3];
-  MElement *e = _octree->find(u, v, w, 2, true);
-  if(!e) {
-#if defined(HAVE_ANN)
-    if(uv_kdtree->nPoints() < 2) return -1000.;
-    double pt[3] = {u, v, 0.0};
-#pragma omp critical // just to avoid crash (still incorrect) - should use nanoflann
-    uv_kdtree->annkSearch(pt, 2, index, dist);
-    SPoint3 p1(nodes[index[0]][0], nodes[index[0]][1], nodes[index[0]][2]);
-    SPoint3 p2(nodes[index[1]][0], nodes[index[1]][1], nodes[index[1]][2]);
-    SPoint3 pnew;
-    double d;
-    signedDistancePointLine(p1, p2, SPoint3(u, v, 0.), d, pnew);
-    e = _octree->find(pnew.x(), pnew.y(), 0.0, 2, true);
-#endif
-    if(!e) {
-      Msg::Error("BGM octree: cannot find UVW=%g %g %g", u, v, w);
-      return -1000.0; // 0.4;
-    }
+  double bary[3];
+  long t = _locate(u, v, bary, false);
+  if(t < 0) {
+    Msg::Error("BGM: cannot find UVW=%g %g %g", u, v, w);
+    return -1000.0; // 0.4;
   }
-  e->xyz2uvw(uv, uv2);
-  auto itv1 = _sizes.find(e->getVertex(0));
-  auto itv2 = _sizes.find(e->getVertex(1));
-  auto itv3 = _sizes.find(e->getVertex(2));
-  return itv1->second * (1 - uv2[0] - uv2[1]) + itv2->second * uv2[0] +
-         itv3->second * uv2[1];
+  return _interpolate(_sizes, t, bary);
 }
 
 double backgroundMesh::getAngle(double u, double v, double w) const
 {
   // use closest point for computing cross field angles: this allows NOT to
   // generate a spurious mesh and solve a PDE
-  if(!_octree) {
-#if defined(HAVE_ANN)
+  if(_angleGrid) {
     double angle = 0.;
-    if(angle_kdtree->nPoints() >= NBANN) {
-      double pt[3] = {u, v, 0.0};
-#pragma omp critical // just to avoid crash (still incorrect) - should use nanoflann
-      angle_kdtree->annkSearch(pt, NBANN, index, dist);
+    if((int)_cos.size() >= NBANN) {
+      std::vector<std::pair<double, long> > closest;
+      auto dist = [&](long i) {
+        double du = _angleUV[2 * i] - u, dv = _angleUV[2 * i + 1] - v;
+        return std::sqrt(du * du + dv * dv);
+      };
+      _angleGrid->getClosest(u, v, NBANN, dist, closest);
       double SINE = 0.0, COSINE = 0.0;
-      for(int i = 0; i < NBANN; i++) {
-        SINE += _sin[index[i]];
-        COSINE += _cos[index[i]];
+      for(std::size_t i = 0; i < closest.size(); i++) {
+        SINE += _sin[closest[i].second];
+        COSINE += _cos[closest[i].second];
       }
       angle = atan2(SINE, COSINE) / 4.0;
     }
     crossField2d::normalizeAngle(angle);
     return angle;
-#endif
   }
 
   // HACK FOR LEWIS
@@ -633,36 +783,19 @@ double backgroundMesh::getAngle(double u, double v, double w) const
   //  crossField2d::normalizeAngle (angles);
   //  return angles;
 
-  double uv[3] = {u, v, w};
-  double uv2[3];
-  MElement *e = _octree->find(u, v, w, 2, true);
-  if(!e) {
-#if defined(HAVE_ANN)
-    if(uv_kdtree->nPoints() < 2) return -1000.0;
-    double pt[3] = {u, v, 0.0};
-#pragma omp critical // just to avoid crash (still incorrect) - should use nanoflann
-    uv_kdtree->annkSearch(pt, 2, index, dist);
-    SPoint3 p1(nodes[index[0]][0], nodes[index[0]][1], nodes[index[0]][2]);
-    SPoint3 p2(nodes[index[1]][0], nodes[index[1]][1], nodes[index[1]][2]);
-    SPoint3 pnew;
-    double d;
-    signedDistancePointLine(p1, p2, SPoint3(u, v, 0.), d, pnew);
-    e = _octree->find(pnew.x(), pnew.y(), 0., 2, true);
-#endif
-    if(!e) {
-      Msg::Error("BGM octree angle: cannot find UVW=%g %g %g", u, v, w);
-      return -1000.0;
-    }
+  double bary[3];
+  long t = _locate(u, v, bary, false);
+  if(t < 0) {
+    Msg::Error("BGM angle: cannot find UVW=%g %g %g", u, v, w);
+    return -1000.0;
   }
-  e->xyz2uvw(uv, uv2);
-  auto itv1 = _angles.find(e->getVertex(0));
-  auto itv2 = _angles.find(e->getVertex(1));
-  auto itv3 = _angles.find(e->getVertex(2));
+  double a[3];
+  for(int i = 0; i < 3; i++) a[i] = _angles[_tri[3 * t + i]];
 
-  double cos4 = cos(4 * itv1->second) * (1 - uv2[0] - uv2[1]) +
-                cos(4 * itv2->second) * uv2[0] + cos(4 * itv3->second) * uv2[1];
-  double sin4 = sin(4 * itv1->second) * (1 - uv2[0] - uv2[1]) +
-                sin(4 * itv2->second) * uv2[0] + sin(4 * itv3->second) * uv2[1];
+  double cos4 = cos(4 * a[0]) * bary[0] + cos(4 * a[1]) * bary[1] +
+                cos(4 * a[2]) * bary[2];
+  double sin4 = sin(4 * a[0]) * bary[0] + sin(4 * a[1]) * bary[1] +
+                sin(4 * a[2]) * bary[2];
   double angle = atan2(sin4, cos4) / 4.0;
   crossField2d::normalizeAngle(angle);
 
@@ -670,7 +803,7 @@ double backgroundMesh::getAngle(double u, double v, double w) const
 }
 
 void backgroundMesh::print(const std::string &filename, GFace *gf,
-                           const std::map<MVertex *, double> &_whatToPrint,
+                           const std::vector<double> &_whatToPrint,
                            int smooth)
 {
   FILE *f = Fopen(filename.c_str(), "w");
@@ -695,13 +828,13 @@ void backgroundMesh::print(const std::string &filename, GFace *gf,
       MVertex *v1 = _triangles[i]->getVertex(0);
       MVertex *v2 = _triangles[i]->getVertex(1);
       MVertex *v3 = _triangles[i]->getVertex(2);
-      auto itv1 = _whatToPrint.find(v1);
-      auto itv2 = _whatToPrint.find(v2);
-      auto itv3 = _whatToPrint.find(v3);
+      double d1 = _whatToPrint[v1->getIndex()];
+      double d2 = _whatToPrint[v2->getIndex()];
+      double d3 = _whatToPrint[v3->getIndex()];
       if(!gf) {
         fprintf(f, "ST(%g,%g,%g,%g,%g,%g,%g,%g,%g) {%g,%g,%g};\n", v1->x(),
                 v1->y(), v1->z(), v2->x(), v2->y(), v2->z(), v3->x(), v3->y(),
-                v3->z(), itv1->second, itv2->second, itv3->second);
+                v3->z(), d1, d2, d3);
       }
       else {
         GPoint p1 = gf->point(SPoint2(v1->x(), v1->y()));
@@ -709,7 +842,7 @@ void backgroundMesh::print(const std::string &filename, GFace *gf,
         GPoint p3 = gf->point(SPoint2(v3->x(), v3->y()));
         fprintf(f, "ST(%g,%g,%g,%g,%g,%g,%g,%g,%g) {%g,%g,%g};\n", p1.x(),
                 p1.y(), p1.z(), p2.x(), p2.y(), p2.z(), p3.x(), p3.y(), p3.z(),
-                itv1->second, itv2->second, itv3->second);
+                d1, d2, d3);
       }
     }
   }
@@ -718,13 +851,11 @@ void backgroundMesh::print(const std::string &filename, GFace *gf,
 }
 
 MElement *backgroundMesh::getMeshElementByCoord(double u, double v, double w,
-                                                bool strict)
+                                                bool strict) const
 {
-  if(!_octree) {
-    Msg::Debug("Rebuilding BackgroundMesh element octree");
-    _octree = new MElementOctree(_triangles);
-  }
-  return _octree->find(u, v, w, 2, strict);
+  double bary[3];
+  long t = _locate(u, v, bary, strict);
+  return (t < 0) ? nullptr : _triangles[t];
 }
 
 /* Global variable instanciation */
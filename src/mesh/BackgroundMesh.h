@@ -16,18 +16,13 @@
 #include "MLine.h"
 #include "MTriangle.h"
 
-#if defined(HAVE_ANN)
-#include "ANN/ANN.h"
-class ANNkd_tree;
-#endif
-
 class GEntity;
 class GModel;
-class MElementOctree;
 class GFace;
 class GEdge;
 class MElement;
 class MVertex;
+class backgroundMeshGrid;
 
 struct crossField2d {
   double _angle;
@@ -43,27 +38,38 @@ struct crossField2d {
   crossField2d &operator+=(const crossField2d &);
 };
 
+// Background mesh of a surface, defined in its parametric plane. The sizes
+// and the cross field angles are stored in arrays indexed by the local index
+// of the nodes (MVertex::getIndex() of the nodes in _vertices). Points are
+// located by walking through the triangles from the last triangle located by
+// the calling thread, with a uniform grid as fallback: queries are
+// thread-safe.
 class backgroundMesh : public simpleFunction<double> {
-  MElementOctree *_octree;
   std::vector<MVertex *> _vertices;
   std::vector<MElement *> _triangles;
-  std::map<MVertex *, double> _sizes;
+  // (u, v) coordinates, sizes and cross field angles of the nodes
+  std::vector<double> _uv, _sizes, _angles;
+  // nodes of the triangles, and triangle adjacent to the edge opposite to
+  // each node (-1 on the boundary)
+  std::vector<long> _tri, _neighbors;
+  backgroundMeshGrid *_grid;
   std::map<MVertex *, MVertex *> _3Dto2D;
   std::map<MVertex *, MVertex *> _2Dto3D;
-  std::map<MVertex *, double> _distance;
-  std::map<MVertex *, double> _angles;
+  // cross field defined by the closest boundary nodes
+  std::vector<double> _angleUV, _cos, _sin;
+  backgroundMeshGrid *_angleGrid;
   static std::vector<backgroundMesh *> _current;
   backgroundMesh(GFace *, bool dist = false);
   ~backgroundMesh();
-#if defined(HAVE_ANN)
-  mutable ANNkd_tree *uv_kdtree;
-  mutable ANNpointArray nodes;
-  ANNidxArray index;
-  ANNdistArray dist;
-  mutable ANNpointArray angle_nodes;
-  mutable ANNkd_tree *angle_kdtree;
-  std::vector<double> _cos, _sin;
-#endif
+  void _buildSearchStructures();
+  long _locate(double u, double v, double bary[3], bool strict) const;
+  double _interpolate(const std::vector<double> &values, long t,
+                      const double bary[3]) const
+  {
+    return values[_tri[3 * t]] * bary[0] + values[_tri[3 * t + 1]] * bary[1] +
+           values[_tri[3 * t + 2]] * bary[2];
+  }
+
 public:
   static void set(GFace *);
   static void setCrossFieldsByDistance(GFace *);
@@ -82,7 +88,7 @@ public:
   double getSmoothness(double u, double v, double w);
   double getSmoothness(MElement *);
   void print(const std::string &filename, GFace *gf,
-             const std::map<MVertex *, double> &, int smooth = 0);
+             const std::vector<double> &, int smooth = 0);
   void print(const std::string &filename, GFace *gf, int choice = 0)
   {
     switch(choice) {
@@ -92,7 +98,7 @@ public:
     }
   }
   MElement *getMeshElementByCoord(double u, double v, double w,
-                                  bool strict = true);
+                                  bool strict = true) const;
   int getNumMeshElements() const { return _triangles.size(); }
   std::vector<MVertex *>::iterator begin_vertices()
   {
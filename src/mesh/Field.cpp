@@ -16,6 +16,7 @@
 #include <string.h>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 #include "GmshConfig.h"
 #include "Context.h"
 #include "Field.h"
@@ -30,7 +31,11 @@
 #include "automaticMeshSizeField.h"
 #include "fullMatrix.h"
 #include "SPoint3KDTree.h"
+#include "MElementBVH.h"
 #include "MVertex.h"
+#include "MLine.h"
+#include "MTriangle.h"
+#include "MQuadrangle.h"
 
 #if defined(HAVE_POST)
 #include "PView.h"
@@ -44,10 +49,6 @@
 #include <unistd.h>
 #endif
 
-#if defined(HAVE_ANN)
-#include "ANN/ANN.h"
-#endif
-
 Field::~Field()
 {
   for(auto it = options.begin(); it != options.end(); ++it) delete it->second;
@@ -65,10 +66,30 @@ FieldOption *Field::getOption(const std::string &optionName)
   return it->second;
 }
 
+static std::atomic<std::size_t> fieldsRevision(0);
+
+std::size_t FieldManager::getRevision() { return fieldsRevision; }
+
+void FieldManager::touch() { fieldsRevision++; }
+
+void FieldOption::modified()
+{
+  if(status) *status = true;
+  FieldManager::touch();
+}
+
+bool FieldManager::dependsOnExternalData()
+{
+  for(auto it = begin(); it != end(); it++)
+    if(it->second->dependsOnExternalData()) return true;
+  return false;
+}
+
 void FieldManager::reset()
 {
   for(auto it = begin(); it != end(); it++) { delete it->second; }
   clear();
+  touch();
 }
 
 Field *FieldManager::get(int id)
@@ -92,6 +113,7 @@ Field *FieldManager::newField(int id, const std::string &type_name)
   if(!f) return nullptr;
   f->id = id;
   (*this)[id] = f;
+  touch();
   return f;
 }
 
@@ -124,6 +146,7 @@ void FieldManager::deleteField(int id)
   }
   delete it->second;
   erase(it);
+  touch();
 }
 
 // StructuredField
@@ -178,6 +201,7 @@ public:
            "each direction, and v are the values on each node.";
   }
   const char *getName() { return "Structured"; }
+  bool dependsOnExternalData() const { return true; }
   virtual ~StructuredField()
   {
     if(_data) delete[] _data;
@@ -1431,6 +1455,7 @@ public:
     return f;
   }
   const char *getName() { return "ExternalProcess"; }
+  bool dependsOnExternalData() const { return true; }
   std::string getDescription()
   {
     return "**This Field is experimental**\n"
@@ -1705,6 +1730,7 @@ public:
     }
   }
   const char *getName() { return "PostView"; }
+  bool dependsOnExternalData() const { return true; }
   std::string getDescription()
   {
     return "Evaluate the post processing view with index ViewIndex, or "
@@ -2104,24 +2130,19 @@ struct AttractorInfo {
   double u, v;
 };
 
-#if defined(HAVE_ANN)
-
 class AttractorAnisoCurveField : public Field {
 private:
-  ANNkd_tree *_kdTree;
-  ANNpointArray _zeroNodes;
-  ANNidxArray _index;
-  ANNdistArray _dist;
+  // segments between the sampling points, and unit tangents to the curves at
+  // their end points
+  MElementBVH _bvh;
   std::list<int> _curveTags;
   double _dMin, _dMax, _lMinTangent, _lMaxTangent, _lMinNormal, _lMaxNormal;
   int _sampling;
   std::vector<SVector3> _tg;
 
 public:
-  AttractorAnisoCurveField() : _kdTree(nullptr), _zeroNodes(nullptr)
+  AttractorAnisoCurveField()
   {
-    _index = new ANNidx[1];
-    _dist = new ANNdist[1];
     _sampling = 20;
     updateNeeded = true;
     _dMin = 0.1;
@@ -2179,63 +2200,59 @@ public:
     GModel::current()->getGEOInternals()->synchronize(GModel::current());
   }
   virtual bool isotropic() const { return false; }
-  ~AttractorAnisoCurveField()
-  {
-    if(_kdTree) delete _kdTree;
-    if(_zeroNodes) annDeallocPts(_zeroNodes);
-    delete[] _index;
-    delete[] _dist;
-  }
   const char *getName() { return "AttractorAnisoCurve"; }
   std::string getDescription()
   {
     return "Compute the distance to the given curves and specify the mesh size "
            "independently in the direction normal and parallel to the nearest "
-           "curve. For efficiency each curve is replaced by a set of Sampling "
-           "points, to which the distance is actually computed.";
+           "curve. For efficiency each curve is replaced by the polyline "
+           "through Sampling points, to which the distance is actually "
+           "computed.";
   }
   void update()
   {
-    if(_zeroNodes) {
-      annDeallocPts(_zeroNodes);
-      delete _kdTree;
-    }
-    int totpoints = _sampling * _curveTags.size();
-    if(totpoints) { _zeroNodes = annAllocPts(totpoints, 3); }
-    _tg.resize(totpoints);
-    int k = 0;
+    _bvh.clear();
+    _tg.clear();
+    int n = std::max(_sampling, 2);
     for(auto it = _curveTags.begin(); it != _curveTags.end(); ++it) {
       GEdge *e = GModel::current()->getEdgeByTag(*it);
       if(e) {
-        for(int i = 0; i < _sampling; i++) {
-          double u = (double)i / (_sampling - 1);
-          Range<double> b = e->parBounds(0);
+        Range<double> b = e->parBounds(0);
+        SPoint3 p0;
+        SVector3 t0;
+        for(int i = 0; i < n; i++) {
+          double u = (double)i / (n - 1);
           double t = b.low() + u * (b.high() - b.low());
           GPoint gp = e->point(t);
+          SPoint3 p(gp.x(), gp.y(), gp.z());
           SVector3 d = e->firstDer(t);
-          _zeroNodes[k][0] = gp.x();
-          _zeroNodes[k][1] = gp.y();
-          _zeroNodes[k][2] = gp.z();
-          _tg[k] = d;
-          _tg[k].normalize();
-          k++;
+          d.normalize();
+          if(i) {
+            _bvh.addSegment(p0, p, _tg.size());
+            _tg.push_back(t0);
+            _tg.push_back(d);
+          }
+          p0 = p;
+          t0 = d;
         }
       }
       else {
         Msg::Warning("Unknown curve %d", *it);
       }
     }
-    _kdTree = new ANNkd_tree(_zeroNodes, totpoints, 3);
+    _bvh.build();
     updateNeeded = false;
   }
   void operator()(double x, double y, double z, SMetric3 &metr,
                   GEntity *ge = nullptr)
   {
     if(updateNeeded) update();
-    double xyz[3] = {x, y, z};
-#pragma omp critical // avoid crash (still incorrect) - use Distance instead
-    _kdTree->annkSearch(xyz, 1, _index, _dist);
-    double d = sqrt(_dist[0]);
+    MElementBVH::closestPoint c;
+    if(!_bvh.closest(SPoint3(x, y, z), c)) {
+      metr = SMetric3(1 / _lMaxTangent / _lMaxTangent);
+      return;
+    }
+    double d = c.distance;
     double lTg = d < _dMin ? _lMinTangent :
                  d > _dMax ? _lMaxTangent :
                              _lMinTangent + (_lMaxTangent - _lMinTangent) *
@@ -2244,7 +2261,8 @@ public:
                 d > _dMax ? _lMaxNormal :
                             _lMinNormal + (_lMaxNormal - _lMinNormal) *
                                             (d - _dMin) / (_dMax - _dMin);
-    SVector3 t = _tg[_index[0]];
+    SVector3 t = c.weight[0] * _tg[c.id] + c.weight[1] * _tg[c.id + 1];
+    t.normalize();
     SVector3 n0 = crossprod(t, fabs(t(0)) > fabs(t(1)) ? SVector3(0, 1, 0) :
                                                          SVector3(1, 0, 0));
     SVector3 n1 = crossprod(t, n0);
@@ -2253,16 +2271,12 @@ public:
   virtual double operator()(double X, double Y, double Z, GEntity *ge = nullptr)
   {
     if(updateNeeded) update();
-    double xyz[3] = {X, Y, Z};
-#pragma omp critical // avoid crash (still incorrect) - use Distance instead
-    _kdTree->annkSearch(xyz, 1, _index, _dist);
-    double d = sqrt(_dist[0]);
-    return std::max(d, 0.05);
+    MElementBVH::closestPoint c;
+    if(!_bvh.closest(SPoint3(X, Y, Z), c)) return MAX_LC;
+    return std::max(c.distance, 0.05);
   }
 };
 
-#endif // ANN
-
 class OctreeField : public Field {
 private:
   // octree field
@@ -2456,16 +2470,162 @@ template <typename Derived> struct PointCloudAdaptor {
 
 class DistanceField : public Field {
   std::list<int> _pointTags, _curveTags, _surfaceTags;
-  std::vector<AttractorInfo> _infos;
   int _sampling;
   int _xFieldId, _yFieldId, _zFieldId; // unused
-  SPoint3Cloud _pc;
-  SPoint3CloudAdaptor<SPoint3Cloud> _pc2kdtree;
-  SPoint3KDTree *_kdtree;
-  std::size_t _outIndex;
+  // points, segments and triangles of the mesh of the curves and surfaces (or
+  // of a sampling of their geometry if they are not meshed), for exact closest
+  // point queries
+  MElementBVH _bvh;
+  // number of elements (and first element) of the mesh of each curve and
+  // surface when the hierarchy was built, to rebuild it when they get meshed
+  std::vector<std::size_t> _meshState;
+  // parametric coordinates of the vertices of each primitive (starting at
+  // _first[id] in _infos); the parametric coordinates of the closest point
+  // are interpolated, except on surface meshes (which store a single entry
+  // per primitive) where they are computed by projection
+  std::vector<AttractorInfo> _infos;
+  std::vector<std::size_t> _first;
+  // closest point of the last query of the calling thread, as the field is
+  // evaluated concurrently when meshing in parallel; the entries are tagged
+  // with the (globally unique) generation of the hierarchy they refer to, so
+  // that entries left by a previous hierarchy or by a deleted field at the
+  // same address are never used
+  struct lastQuery {
+    std::size_t generation;
+    MElementBVH::closestPoint closest;
+  };
+  static thread_local std::map<const DistanceField *, lastQuery> _closest;
+  static std::atomic<std::size_t> _generations;
+  std::size_t _generation;
+  std::size_t _addPrimitive(const AttractorInfo &a)
+  {
+    _first.push_back(_infos.size());
+    _infos.push_back(a);
+    return _first.size() - 1;
+  }
+  std::size_t _addPrimitive(const AttractorInfo &a, const AttractorInfo &b)
+  {
+    std::size_t id = _addPrimitive(a);
+    _infos.push_back(b);
+    return id;
+  }
+  std::size_t _addPrimitive(const AttractorInfo &a, const AttractorInfo &b,
+                            const AttractorInfo &c)
+  {
+    std::size_t id = _addPrimitive(a, b);
+    _infos.push_back(c);
+    return id;
+  }
+  std::vector<std::size_t> _getMeshState() const
+  {
+    std::vector<std::size_t> state;
+    for(auto it = _curveTags.begin(); it != _curveTags.end(); ++it) {
+      GEdge *e = GModel::current()->getEdgeByTag(*it);
+      if(!e) continue;
+      state.push_back(e->lines.size());
+      state.push_back(e->lines.empty() ? 0 : (std::size_t)e->lines[0]);
+    }
+    for(auto it = _surfaceTags.begin(); it != _surfaceTags.end(); ++it) {
+      GFace *f = GModel::current()->getFaceByTag(*it);
+      if(!f) continue;
+      state.push_back(f->triangles.size());
+      state.push_back(f->triangles.empty() ? 0 : (std::size_t)f->triangles[0]);
+      state.push_back(f->quadrangles.size());
+      state.push_back(f->quadrangles.empty() ? 0 :
+                                               (std::size_t)f->quadrangles[0]);
+    }
+    return state;
+  }
+  // triangulate a surface that is not meshed, by subdividing its STL
+  // triangulation (or a grid on its parametric plane) into triangles whose
+  // edges are at most maxDist long
+  void _addSampledSurface(GFace *f, int tag, double maxDist)
+  {
+    std::vector<SPoint2> uv;
+    std::vector<SPoint3> xyz;
+    std::vector<int> tri;
+    if(f->buildSTLTriangulation()) {
+      bool param = f->stl_vertices_xyz.empty();
+      for(std::size_t i = 0; i + 2 < f->stl_triangles.size(); i += 3) {
+        SPoint2 q[3];
+        SPoint3 p[3];
+        for(int j = 0; j < 3; j++) {
+          int k = f->stl_triangles[i + j];
+          if(param) {
+            q[j] = f->stl_vertices_uv[k];
+            GPoint gp = f->point(q[j]);
+            p[j] = SPoint3(gp.x(), gp.y(), gp.z());
+          }
+          else
+            p[j] = f->stl_vertices_xyz[k];
+        }
+        double maxEdge = std::max(p[0].distance(p[1]),
+                                  std::max(p[1].distance(p[2]),
+                                           p[2].distance(p[0])));
+        int N = std::max((int)std::ceil(maxEdge / maxDist), 1);
+        // nodes (a, b) with a + b <= N, at barycentric coordinates (a/N, b/N)
+        std::size_t start = xyz.size();
+        for(int a = 0; a <= N; a++) {
+          for(int b = 0; a + b <= N; b++) {
+            double u = (double)a / N, v = (double)b / N;
+            if(param) {
+              SPoint2 r = q[0] * (1. - u - v) + q[1] * u + q[2] * v;
+              GPoint gp = f->point(r);
+              uv.push_back(r);
+              xyz.push_back(SPoint3(gp.x(), gp.y(), gp.z()));
+            }
+            else
+              xyz.push_back(p[0] * (1. - u - v) + p[1] * u + p[2] * v);
+          }
+        }
+        auto node = [&](int a, int b) {
+          return (int)start + a * (N + 1) - a * (a - 1) / 2 + b;
+        };
+        for(int a = 0; a < N; a++) {
+          for(int b = 0; a + b < N; b++) {
+            tri.insert(tri.end(), {node(a, b), node(a + 1, b), node(a, b + 1)});
+            if(a + b < N - 1)
+              tri.insert(tri.end(), {node(a + 1, b), node(a + 1, b + 1),
+                                     node(a, b + 1)});
+          }
+        }
+      }
+    }
+    else {
+      int N = std::max((int)(f->bounds().diag() / maxDist), 2);
+      Range<double> b1 = f->parBounds(0), b2 = f->parBounds(1);
+      for(int i = 0; i < N; i++) {
+        for(int j = 0; j < N; j++) {
+          double t1 = b1.low() + (double)i / (N - 1) * (b1.high() - b1.low());
+          double t2 = b2.low() + (double)j / (N - 1) * (b2.high() - b2.low());
+          GPoint gp = f->point(t1, t2);
+          uv.push_back(SPoint2(t1, t2));
+          xyz.push_back(SPoint3(gp.x(), gp.y(), gp.z()));
+        }
+      }
+      for(int i = 0; i < N - 1; i++) {
+        for(int j = 0; j < N - 1; j++) {
+          int n0 = i * N + j, n1 = n0 + N, n2 = n1 + 1, n3 = n0 + 1;
+          tri.insert(tri.end(), {n0, n1, n2, n0, n2, n3});
+        }
+      }
+    }
+    for(std::size_t i = 0; i < tri.size(); i += 3) {
+      const SPoint3 &p0 = xyz[tri[i]], &p1 = xyz[tri[i + 1]],
+                    &p2 = xyz[tri[i + 2]];
+      if(uv.empty()) {
+        _bvh.addTriangle(p0, p1, p2, _addPrimitive(AttractorInfo(tag, 2)));
+        continue;
+      }
+      AttractorInfo a[3];
+      for(int j = 0; j < 3; j++)
+        a[j] = AttractorInfo(tag, 2, uv[tri[i + j]].x(), uv[tri[i + j]].y());
+      _bvh.addTriangle(p0, p1, p2, _addPrimitive(a[0], a[1], a[2]));
+    }
+  }
 
 public:
-  DistanceField() : _pc2kdtree(_pc), _kdtree(nullptr), _outIndex(0)
+  DistanceField() : _generation(++_generations)
   {
     _sampling = 20;
 
@@ -2475,11 +2635,12 @@ public:
       _curveTags, "Tags of curves in the geometric model", &updateNeeded);
     options["SurfacesList"] = new FieldOptionList(
       _surfaceTags, "Tags of surfaces in the geometric model "
-      "(only OpenCASCADE and discrete surfaces are currently supported)",
+      "(only OpenCASCADE and discrete surfaces are currently supported if "
+      "the surfaces are not meshed)",
       &updateNeeded);
     options["Sampling"] = new FieldOptionInt(
       _sampling, "Linear (i.e. per dimension) number of sampling points to "
-      "discretize each curve and surface", &updateNeeded);
+      "discretize each curve and surface that is not meshed", &updateNeeded);
 
     // deprecated names
     options["NodesList"] =
@@ -2500,7 +2661,7 @@ public:
       new FieldOptionInt(_sampling, "[Deprecated]", &updateNeeded, true);
   }
   DistanceField(int dim, int tag, int nbe)
-    : _sampling(nbe), _pc2kdtree(_pc), _kdtree(nullptr), _outIndex(0)
+    : _sampling(nbe), _generation(++_generations)
   {
     if(dim == 0)
       _pointTags.push_back(tag);
@@ -2511,105 +2672,154 @@ public:
     _xFieldId = _yFieldId = _zFieldId = -1; // not used
     updateNeeded = true;
   }
-  ~DistanceField()
-  {
-    if(_kdtree) delete _kdtree;
-  }
+  ~DistanceField() { _closest.erase(this); }
   const char *getName() { return "Distance"; }
   std::string getDescription()
   {
     return "Compute the distance to the given points, curves or surfaces. "
-           "For efficiency, curves and surfaces are replaced by a set "
-           "of points (sampled according to Sampling), to which the distance "
-           "is actually computed.";
+           "The distance is computed exactly to the mesh of the curves and "
+           "surfaces if they are meshed, and to polylines and triangles "
+           "sampled on their geometry (according to Sampling) otherwise. The "
+           "distance vanishes on the points, curves and surfaces: expressions "
+           "dividing by the distance should guard against a zero value.";
   }
   std::pair<AttractorInfo, SPoint3> getAttractorInfo() const
   {
-    if(_outIndex < _infos.size() && _outIndex < _pc.pts.size())
-      return std::make_pair(_infos[_outIndex], _pc.pts[_outIndex]);
-    return std::make_pair(AttractorInfo(), SPoint3());
+    auto it = _closest.find(this);
+    if(it == _closest.end() || it->second.generation != _generation ||
+       it->second.closest.id >= _first.size())
+      return std::make_pair(AttractorInfo(), SPoint3());
+    const MElementBVH::closestPoint &c = it->second.closest;
+    const std::size_t first = _first[c.id];
+    const std::size_t n =
+      (c.id + 1 < _first.size() ? _first[c.id + 1] : _infos.size()) - first;
+    const AttractorInfo *infos = &_infos[first];
+    AttractorInfo info(infos[0].ent, infos[0].dim, 0., 0.);
+    if(info.dim == 2 && c.numVertices > 1 && n == 1) {
+      GFace *gf = GModel::current()->getFaceByTag(info.ent);
+      if(gf) {
+        SPoint2 uv = gf->parFromPoint(c.point);
+        info.u = uv.x();
+        info.v = uv.y();
+      }
+    }
+    else {
+      for(int i = 0; i < c.numVertices; i++) {
+        if(c.vertex[i] >= (int)n)
+          return std::make_pair(AttractorInfo(), SPoint3());
+        info.u += c.weight[i] * infos[c.vertex[i]].u;
+        info.v += c.weight[i] * infos[c.vertex[i]].v;
+      }
+    }
+    return std::make_pair(info, c.point);
   }
   void update()
   {
-    if(updateNeeded) {
-      _infos.clear();
-      _pc.pts.clear();
-      if(_kdtree) delete _kdtree;
-
-      for(auto it = _pointTags.begin(); it != _pointTags.end(); ++it) {
-        GVertex *gv = GModel::current()->getVertexByTag(*it);
-        if(gv) {
-          _pc.pts.push_back(SPoint3(gv->x(), gv->y(), gv->z()));
-          _infos.push_back(AttractorInfo(*it, 0, 0, 0));
-        }
-        else {
-          Msg::Warning("Unknown point %d", *it);
-        }
+    // the hierarchy is rebuilt when the options change, and when the curves
+    // and surfaces get meshed (the fields are updated before each meshing
+    // stage), so that the distance is computed to their mesh
+    std::vector<std::size_t> state = _getMeshState();
+    if(!updateNeeded && state == _meshState) return;
+    _meshState.swap(state);
+
+    _bvh.clear();
+    _infos.clear();
+    _first.clear();
+
+    for(auto it = _pointTags.begin(); it != _pointTags.end(); ++it) {
+      GVertex *gv = GModel::current()->getVertexByTag(*it);
+      if(gv) {
+        _bvh.addPoint(SPoint3(gv->x(), gv->y(), gv->z()),
+                      _addPrimitive(AttractorInfo(*it, 0)));
+      }
+      else {
+        Msg::Warning("Unknown point %d", *it);
       }
+    }
 
-      for(auto it = _curveTags.begin(); it != _curveTags.end(); ++it) {
-        GEdge *e = GModel::current()->getEdgeByTag(*it);
-        if(e) {
-          if(e->mesh_vertices.size()) {
-            for(std::size_t i = 0; i < e->mesh_vertices.size(); i++) {
-              _pc.pts.push_back(SPoint3(e->mesh_vertices[i]->x(),
-                                        e->mesh_vertices[i]->y(),
-                                        e->mesh_vertices[i]->z()));
-              double t = 0.;
-              e->mesh_vertices[i]->getParameter(0, t);
-              _infos.push_back(AttractorInfo(*it, 1, t, 0));
-            }
-          }
-          int NNN = _sampling - e->mesh_vertices.size();
-          for(int i = 1; i < NNN - 1; i++) {
-            double u = (double)i / (NNN - 1);
-            Range<double> b = e->parBounds(0);
-            double t = b.low() + u * (b.high() - b.low());
-            GPoint gp = e->point(t);
-            _pc.pts.push_back(SPoint3(gp.x(), gp.y(), gp.z()));
-            _infos.push_back(AttractorInfo(*it, 1, t, 0));
+    for(auto it = _curveTags.begin(); it != _curveTags.end(); ++it) {
+      GEdge *e = GModel::current()->getEdgeByTag(*it);
+      if(!e) {
+        Msg::Warning("Unknown curve %d", *it);
+        continue;
+      }
+      Range<double> b = e->parBounds(0);
+      if(e->lines.size()) {
+        GVertex *gv = e->getBeginVertex();
+        bool closed = gv && gv == e->getEndVertex();
+        for(auto l : e->lines) {
+          double t[2];
+          for(int i = 0; i < 2; i++)
+            reparamMeshVertexOnEdge(l->getVertex(i), e, t[i]);
+          // the end point of a closed curve has two parameters
+          for(int i = 0; i < 2 && closed; i++) {
+            if(l->getVertex(i)->onWhat() == gv &&
+               std::abs(t[i] - t[1 - i]) > 0.5 * (b.high() - b.low()))
+              t[i] = (t[i] == b.low()) ? b.high() : b.low();
           }
-        }
-        else {
-          Msg::Warning("Unknown curve %d", *it);
+          _bvh.addElement(l, _addPrimitive(AttractorInfo(*it, 1, t[0]),
+                                           AttractorInfo(*it, 1, t[1])));
         }
       }
-
-      for(auto it = _surfaceTags.begin(); it != _surfaceTags.end(); ++it) {
-        GFace *f = GModel::current()->getFaceByTag(*it);
-        if(f) {
-          double maxDist = f->bounds().diag() / _sampling;
-          std::vector<SPoint2> uvpoints;
-          f->fillPointCloud(maxDist, &_pc.pts, &uvpoints);
-          for(std::size_t i = 0; i < uvpoints.size(); i++)
-            _infos.push_back
-              (AttractorInfo(*it, 2, uvpoints[i].x(), uvpoints[i].y()));
-        }
-        else {
-          Msg::Warning("Unknown surface %d", *it);
+      else {
+        int n = std::max(_sampling, 2);
+        SPoint3 p0;
+        double t0 = 0.;
+        for(int i = 0; i < n; i++) {
+          double t = b.low() + (double)i / (n - 1) * (b.high() - b.low());
+          GPoint gp = e->point(t);
+          SPoint3 p(gp.x(), gp.y(), gp.z());
+          if(i)
+            _bvh.addSegment(p0, p,
+                            _addPrimitive(AttractorInfo(*it, 1, t0),
+                                          AttractorInfo(*it, 1, t)));
+          p0 = p;
+          t0 = t;
         }
       }
+    }
 
-      // construct a kd-tree index:
-      _kdtree = new SPoint3KDTree(3, _pc2kdtree,
-                                  nanoflann::KDTreeSingleIndexAdaptorParams(10));
-      _kdtree->buildIndex();
-      updateNeeded = false;
+    for(auto it = _surfaceTags.begin(); it != _surfaceTags.end(); ++it) {
+      GFace *f = GModel::current()->getFaceByTag(*it);
+      if(!f) {
+        Msg::Warning("Unknown surface %d", *it);
+        continue;
+      }
+      if(f->triangles.size() || f->quadrangles.size()) {
+        for(auto t : f->triangles)
+          _bvh.addElement(t, _addPrimitive(AttractorInfo(*it, 2)));
+        for(auto q : f->quadrangles)
+          _bvh.addElement(q, _addPrimitive(AttractorInfo(*it, 2)));
+      }
+      else {
+        _addSampledSurface(f, *it, f->bounds().diag() / std::max(_sampling, 1));
+      }
     }
+
+    _bvh.build();
+    _generation = ++_generations;
+    updateNeeded = false;
+    // the field may have changed even if its options have not (if the curves
+    // or surfaces have been meshed in the meantime)
+    FieldManager::touch();
   }
   using Field::operator();
   virtual double operator()(double X, double Y, double Z, GEntity *ge = nullptr)
   {
-    if(!_kdtree) return MAX_LC;
-    double pt[3] = {X, Y, Z};
-    nanoflann::KNNResultSet<double> res(1);
-    double outDistSqr;
-    res.init(&_outIndex, &outDistSqr);
-    _kdtree->findNeighbors(res, &pt[0], nanoflann::SearchParams(10));
-    return sqrt(outDistSqr);
+    lastQuery &q = _closest[this];
+    q.generation = _generation;
+    if(!_bvh.closest(SPoint3(X, Y, Z), q.closest)) {
+      q.closest.id = _first.size();
+      return MAX_LC;
+    }
+    return q.closest.distance;
   }
 };
 
+thread_local std::map<const DistanceField *, DistanceField::lastQuery>
+  DistanceField::_closest;
+std::atomic<std::size_t> DistanceField::_generations(0);
+
 class ExtendField : public Field {
   std::list<int> _tagCurves, _tagSurfaces;
   std::vector<double> _sizeCurves, _sizeSurfaces;
@@ -2642,6 +2852,7 @@ public:
     if(_kdtreeSurfaces) delete _kdtreeSurfaces;
   }
   const char *getName() { return "Extend"; }
+  bool dependsOnExternalData() const { return true; }
   std::string getDescription()
   {
     return "Compute an extension of the mesh sizes from the given boundary "
@@ -3207,10 +3418,8 @@ FieldManager::FieldManager()
   mapTypeName["ExternalProcess"] = new FieldFactoryT<ExternalProcessField>();
   mapTypeName["MathEval"] = new FieldFactoryT<MathEvalField>();
   mapTypeName["MathEvalAniso"] = new FieldFactoryT<MathEvalFieldAniso>();
-#if defined(HAVE_ANN)
   mapTypeName["AttractorAnisoCurve"] =
     new FieldFactoryT<AttractorAnisoCurveField>();
-#endif
   mapTypeName["MaxEigenHessian"] = new FieldFactoryT<MaxEigenHessianField>();
   mapTypeName["AutomaticMeshSizeField"] =
     new FieldFactoryT<automaticMeshSizeField>();
@@ -3235,6 +3444,7 @@ void FieldManager::setBackgroundField(Field *BGF)
   int id = newId();
   (*this)[id] = BGF;
   _backgroundField = id;
+  touch();
 }
 
 void Field::putOnNewView(int viewTag)
@@ -54,10 +54,7 @@ private:
 
 protected:
   bool *status;
-  inline void modified()
-  {
-    if(status) *status = true;
-  }
+  void modified();
 
 public:
   FieldOption(const std::string &help, bool *_status, bool deprecated)
@@ -128,6 +125,9 @@ public:
   }
   bool updateNeeded;
   virtual const char *getName() = 0;
+  // true if the value of the field does not only depend on its options and on
+  // the model geometry (e.g. if it depends on a view, a file or a callback)
+  virtual bool dependsOnExternalData() const { return false; }
 #if defined(HAVE_POST)
   void putOnView(PView *view, int comp = -1);
 #endif
@@ -162,13 +162,18 @@ public:
   void setBackgroundMesh(int iView);
   // set and get background field
   void setBackgroundField(Field *BGF);
-  inline void setBackgroundFieldId(int id) { _backgroundField = id; };
+  inline void setBackgroundFieldId(int id)
+  {
+    _backgroundField = id;
+    touch();
+  };
   inline void addBoundaryLayerFieldId(int id)
   {
     for(std::size_t i = 0; i < _boundaryLayerFields.size(); ++i) {
       if(_boundaryLayerFields[i] == id) return;
     }
     _boundaryLayerFields.push_back(id);
+    touch();
   }
   inline void addBoundaryLayerFieldId(std::vector<int> &tags)
   {
@@ -181,6 +186,14 @@ public:
     return (int)_boundaryLayerFields.size();
   }
   inline int getBoundaryLayerField(int i) { return _boundaryLayerFields[i]; }
+  // revision counter of the fields (of all the models), incremented each time
+  // a field is created, deleted or modified, so that data computed from the
+  // fields can be invalidated
+  static std::size_t getRevision();
+  static void touch();
+  // true if one of the fields depends on external data, in which case data
+  // computed from the fields cannot be reused based on the revision counter
+  bool dependsOnExternalData();
 };
 
 // Boundary Layer Field (used both for anisotropic meshing and BL
@@ -461,6 +474,7 @@ public:
   virtual double operator()(double x, double y, double z,
                             GEntity *ge = nullptr);
   virtual const char *getName() { return "GenericField"; };
+  bool dependsOnExternalData() const { return true; }
 
   // sets the callbacks
   void setCallbackWithData(ptrfunction fct, void *data);
@@ -14,6 +14,7 @@ class FieldPython : public Field {
 
 public:
   const char *getName() { return "Python"; }
+  bool dependsOnExternalData() const { return true; }
 
   std::string getDescription() { return "simple call to a python function"; }
 
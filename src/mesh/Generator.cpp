@@ -30,12 +30,14 @@
 #include "meshGRegionLocalMeshMod.h"
 #include "meshRelocateVertex.h"
 #include "meshRefine.h"
+#include "meshRenumber.h"
 #include "BackgroundMesh.h"
 #include "BoundaryLayers.h"
 #include "ExtrudeParams.h"
 #include "HighOrder.h"
 #include "Field.h"
 #include "Options.h"
+#include "Profiler.h"
 #include "Generator.h"
 #include "meshQuadQuasiStructured.h"
 #include "meshGFaceBipartiteLabelling.h"
@@ -292,6 +294,7 @@ void GetStatistics(double stat[50], double quality[3][100], bool visibleOnly)
     stat[34] += data->getNumPrisms();
     stat[35] += data->getNumPyramids();
     stat[36] += data->getNumStrings2D() + data->getNumStrings3D();
+    stat[38] += PView::list[i]->getMemoryInMb();
   }
 #endif
 }
@@ -320,6 +323,14 @@ static void Mesh0D(GModel *m)
   }
 }
 
+// meshes of the "top" of extrusions are copied from their source, and are
+// thus generated serially after each parallel pass, once their source is meshed
+template <class T> static bool isExtrudedCopy(T *ge)
+{
+  ExtrudeParams *ep = ge->meshAttributes.extrude;
+  return ep && ep->mesh.ExtrudeMesh && ep->geo.Mode == COPIED_ENTITY;
+}
+
 static void Mesh1D(GModel *m)
 {
   if(CTX::instance()->abortOnError && Msg::GetErrorCount()) return;
@@ -328,6 +339,7 @@ static void Mesh1D(GModel *m)
 
   Msg::StatusBar(true, "Meshing 1D...");
   double t1 = Cpu(), w1 = TimeOfDay();
+  ProfileScope scope("1D");
 
   int nthreads = CTX::instance()->numThreads;
   if(CTX::instance()->mesh.maxNumThreads1D > 0)
@@ -338,17 +350,13 @@ static void Mesh1D(GModel *m)
   if(m->getFields()->getNumBoundaryLayerFields())
     nthreads = 1;
 
-  for(auto it = m->firstEdge(); it != m->lastEdge(); ++it) {
-    // Extruded meshes are not yet fully thread-safe (not sure why!)
-    if((*it)->meshAttributes.extrude &&
-       (*it)->meshAttributes.extrude->mesh.ExtrudeMesh)
-      nthreads = 1;
-  }
-
-  std::vector<GEdge *> temp;
+  std::vector<GEdge *> temp, copies;
   for(auto it = m->firstEdge(); it != m->lastEdge(); ++it) {
     (*it)->meshStatistics.status = GEdge::PENDING;
-    temp.push_back(*it);
+    if(isExtrudedCopy(*it))
+      copies.push_back(*it);
+    else
+      temp.push_back(*it);
   }
 
   int nIter = 0, nTot = m->getNumEdges();
@@ -368,12 +376,14 @@ static void Mesh1D(GModel *m)
       int localPending = 0;
       GEdge *ed = temp[K];
       if(ed->meshStatistics.status == GEdge::PENDING) {
+        ProfileScope s(scope.getPath(), "Curve " + std::to_string(ed->tag()));
         try{ // OpenMP forbids leaving block via exception
           ed->mesh(true);
         }
         catch(...){
           exceptions = true;
         }
+        s.count("Elements", ed->getNumMeshElements());
 #pragma omp atomic capture
         {
           ++nPending;
@@ -383,6 +393,15 @@ static void Mesh1D(GModel *m)
       if(!nIter) Msg::ProgressMeter(localPending, false, "Meshing 1D...");
     }
     if(exceptions) throw std::runtime_error(Msg::GetLastError());
+    for(auto ed : copies) {
+      if(ed->meshStatistics.status == GEdge::PENDING) {
+        ProfileScope s("Curve " + std::to_string(ed->tag()));
+        ed->mesh(true);
+        s.count("Elements", ed->getNumMeshElements());
+        nPending++;
+      }
+      if(!nIter) Msg::ProgressMeter(nPending, false, "Meshing 1D...");
+    }
     if(!nPending) break;
     if(nIter++ > CTX::instance()->mesh.maxRetries) break;
   }
@@ -460,6 +479,45 @@ static void PrintMesh2dStatistics(GModel *m)
   fclose(statreport);
 }
 
+// Group the entities by periodic level: the mesh master of an entity of level
+// l > 0 is of level l - 1, and the other entities are of level 0. Processing
+// the levels in order, and the entities of each level in parallel, guarantees
+// that the mesh of the master of an entity is available when the entity is
+// processed. The entities of each level are kept in their original order.
+template <class T>
+static void getPeriodicLevels(const std::vector<T *> &entities,
+                              std::vector<std::vector<T *> > &levels)
+{
+  std::set<T *> all(entities.begin(), entities.end());
+  std::map<T *, std::size_t> level;
+  for(auto e : entities) {
+    // follow the chain of masters up to an entity of known level
+    std::vector<T *> chain;
+    T *c = e;
+    while(level.find(c) == level.end()) {
+      T *master = dynamic_cast<T *>(c->getMeshMaster());
+      if(!master || master == c || !all.count(master) ||
+         chain.size() > entities.size()) { // no master, or cycle
+        level[c] = 0;
+        break;
+      }
+      chain.push_back(c);
+      c = master;
+    }
+    std::size_t l = level[c];
+    for(auto it = chain.rbegin(); it != chain.rend(); it++) {
+      if(level.find(*it) == level.end()) level[*it] = ++l;
+      else l = level[*it];
+    }
+  }
+  levels.clear();
+  for(auto e : entities) {
+    std::size_t l = level[e];
+    if(l >= levels.size()) levels.resize(l + 1);
+    levels[l].push_back(e);
+  }
+}
+
 static void Mesh2D(GModel *m)
 {
   if(CTX::instance()->abortOnError && Msg::GetErrorCount()) return;
@@ -468,6 +526,7 @@ static void Mesh2D(GModel *m)
 
   Msg::StatusBar(true, "Meshing 2D...");
   double t1 = Cpu(), w1 = TimeOfDay();
+  ProfileScope scope("2D");
 
   int nthreads = CTX::instance()->numThreads;
   if(CTX::instance()->mesh.maxNumThreads2D > 0)
@@ -483,14 +542,6 @@ static void Mesh2D(GModel *m)
        (*it)->getMeshingAlgo() == ALGO_2D_PACK_PRLGRMS ||
        (*it)->getMeshingAlgo() == ALGO_2D_PACK_PRLGRMS_CSTR)
       nthreads = 1;
-
-    // Periodic meshing is not yet thread-safe
-    if((*it)->getMeshMaster() != *it) nthreads = 1;
-
-    // Extruded meshes are not yet fully thread-safe (not sure why!)
-    if((*it)->meshAttributes.extrude &&
-       (*it)->meshAttributes.extrude->mesh.ExtrudeMesh)
-      nthreads = 1;
   }
 
   for(auto it = m->firstFace(); it != m->lastFace(); ++it)
@@ -515,29 +566,54 @@ static void Mesh2D(GModel *m)
 
       int nPending = 0;
       bool exceptions = false;
-      std::vector<GFace *> temp;
-      temp.insert(temp.begin(), f.begin(), f.end());
+      std::vector<GFace *> temp, copies;
+      for(auto gf : f) {
+        if(isExtrudedCopy(gf))
+          copies.push_back(gf);
+        else
+          temp.push_back(gf);
+      }
+      // periodic copies are meshed right after their master, in the same
+      // parallel loop as the other surfaces of the same level
+      std::vector<std::vector<GFace *> > levels;
+      getPeriodicLevels(temp, levels);
+      for(auto &level : levels) {
+        if(exceptions) break;
 #pragma omp parallel for schedule(dynamic) num_threads(nthreads)
-      for(size_t K = 0; K < temp.size(); K++) {
-        if(exceptions) continue;
-        int localPending = 0;
-        if(temp[K]->meshStatistics.status == GFace::PENDING) {
-          backgroundMesh::current()->unset();
-          try{ // OpenMP forbids leaving block via exception
-            temp[K]->mesh(true);
-          }
-          catch(...) {
-            exceptions = true;
-          }
+        for(size_t K = 0; K < level.size(); K++) {
+          if(exceptions) continue;
+          int localPending = 0;
+          if(level[K]->meshStatistics.status == GFace::PENDING) {
+            ProfileScope s(scope.getPath(),
+                           "Surface " + std::to_string(level[K]->tag()));
+            backgroundMesh::current()->unset();
+            try{ // OpenMP forbids leaving block via exception
+              level[K]->mesh(true);
+            }
+            catch(...) {
+              exceptions = true;
+            }
+            s.count("Elements", level[K]->getNumMeshElements());
 #pragma omp atomic capture
-          {
-            ++nPending;
-            localPending = nPending;
+            {
+              ++nPending;
+              localPending = nPending;
+            }
           }
+          if(!nIter) Msg::ProgressMeter(localPending, false, "Meshing 2D...");
         }
-        if(!nIter) Msg::ProgressMeter(localPending, false, "Meshing 2D...");
       }
       if(exceptions) throw std::runtime_error(Msg::GetLastError());
+      for(auto gf : copies) {
+        if(gf->meshStatistics.status == GFace::PENDING) {
+          ProfileScope s("Surface " + std::to_string(gf->tag()));
+          backgroundMesh::current()->unset();
+          gf->mesh(true);
+          s.count("Elements", gf->getNumMeshElements());
+          nPending++;
+        }
+        if(!nIter) Msg::ProgressMeter(nPending, false, "Meshing 2D...");
+      }
       if(!nPending) break;
       // iter == 2 is for meshing re-parametrized surfaces; after that, we
       // serialize (self-intersections of 1D meshes are not thread safe)!
@@ -676,6 +752,7 @@ static void Mesh3D(GModel *m)
 
   Msg::StatusBar(true, "Meshing 3D...");
   double t1 = Cpu(), w1 = TimeOfDay();
+  ProfileScope scope("3D");
 
   if(m->getNumRegions()) {
     Msg::StartProgressMeter(1);
@@ -718,7 +795,9 @@ static void Mesh3D(GModel *m)
       break;
     }
 
+    ProfileScope s("Volume " + std::to_string(connected[i][0]->tag()));
     MeshDelaunayVolume(connected[i]);
+    for(auto gr : connected[i]) s.count("Elements", gr->getNumMeshElements());
 
 #if defined(HAVE_DOMHEX) and defined(HAVE_HXT)
     // additional code for experimental hex mesh - will eventually be replaced
@@ -804,6 +883,7 @@ void OptimizeMesh(GModel *m, const std::string &how, bool force, int niter)
   else
     Msg::StatusBar(true, "Optimizing mesh (%s)...", how.c_str());
   double t1 = Cpu(), w1 = TimeOfDay();
+  ProfileScope scope(how.empty() ? "Optimize" : "Optimize " + how);
 
   if(how == "" || how == "Gmsh" || how == "Optimize") {
     for(auto it = m->firstRegion(); it != m->lastRegion(); it++) {
@@ -980,6 +1060,17 @@ void RecombineMesh(GModel *m)
   Msg::StatusBar(true, "Recombining 2D mesh...");
   double t1 = Cpu(), w1 = TimeOfDay();
 
+  // the topological optimization removes nodes, which must thus not be
+  // referenced by the elements of other surfaces
+  int topo = CTX::instance()->mesh.recombineOptimizeTopology;
+  for(auto it = m->firstFace(); it != m->lastFace() && topo > 0; ++it) {
+    if(!isMeshOkForTopologicalOpti(*it)) {
+      Msg::Info
+        ("Skipping topological optimization - mesh topology is not complete");
+      topo = 0;
+    }
+  }
+
   for(auto it = m->firstFace(); it != m->lastFace(); ++it) {
     GFace *gf = *it;
     if(CTX::instance()->mesh.algoRecombine == 4) {
@@ -988,7 +1079,6 @@ void RecombineMesh(GModel *m)
     else {
       bool blossom = (CTX::instance()->mesh.algoRecombine == 1 ||
                       CTX::instance()->mesh.algoRecombine == 3);
-      int topo = CTX::instance()->mesh.recombineOptimizeTopology;
       int repos = CTX::instance()->mesh.recombineNodeRepositioning;
       double minqual = CTX::instance()->mesh.recombineMinimumQuality;
       recombineIntoQuads(gf, blossom, topo, repos, minqual);
@@ -1015,249 +1105,320 @@ static void relocateSlaveVertices(GFace *slave,
                                   std::map<MVertex *, MVertex *> &vertS2M,
                                   bool useClosestPoint)
 {
+  std::vector<MFaceVertex *> verts;
+  std::vector<SPoint3> pts;
+  std::vector<SPoint2> guesses;
   for(auto vit = vertS2M.begin(); vit != vertS2M.end(); ++vit) {
     MFaceVertex *v = dynamic_cast<MFaceVertex *>(vit->first);
     if(v && v->onWhat() == slave) {
-      SPoint3 p = transform(vit->second, slave->affineTransform);
-      SPoint2 p2;
-      if(useClosestPoint) {
-        double guess[2];
-        v->getParameter(0, guess[0]);
-        v->getParameter(1, guess[1]);
-        GPoint pp = slave->closestPoint(p, guess);
-        p2.setPosition(pp.u(), pp.v());
-      }
-      else {
-        p2 = slave->parFromPoint(p);
-      }
-      GPoint gp = slave->point(p2);
-      v->setXYZ(gp.x(), gp.y(), gp.z());
-      v->setParameter(0, gp.u());
-      v->setParameter(1, gp.v());
+      verts.push_back(v);
+      pts.push_back(transform(vit->second, slave->affineTransform));
+      double guess[2];
+      v->getParameter(0, guess[0]);
+      v->getParameter(1, guess[1]);
+      guesses.push_back(SPoint2(guess[0], guess[1]));
     }
   }
+  std::vector<SPoint2> uv;
+  if(useClosestPoint) {
+    std::vector<GPoint> res;
+    slave->closestPoints(pts, res, &guesses);
+    uv.resize(res.size());
+    for(std::size_t i = 0; i < res.size(); i++)
+      uv[i] = SPoint2(res[i].u(), res[i].v());
+  }
+  else {
+    slave->parFromPoints(pts, uv);
+  }
+  for(std::size_t i = 0; i < verts.size(); i++) {
+    GPoint gp = slave->point(uv[i]);
+    verts[i]->setXYZ(gp.x(), gp.y(), gp.z());
+    verts[i]->setParameter(0, gp.u());
+    verts[i]->setParameter(1, gp.v());
+  }
 }
 
 static void relocateSlaveVertices(GEdge *slave,
                                   std::map<MVertex *, MVertex *> &vertS2M,
                                   bool useClosestPoint)
 {
+  std::vector<MEdgeVertex *> verts;
+  std::vector<SPoint3> pts;
+  std::vector<double> guesses;
   for(auto vit = vertS2M.begin(); vit != vertS2M.end(); ++vit) {
     MEdgeVertex *v = dynamic_cast<MEdgeVertex *>(vit->first);
     if(v && v->onWhat() == slave) {
-      SPoint3 p = transform(vit->second, slave->affineTransform);
+      verts.push_back(v);
+      pts.push_back(transform(vit->second, slave->affineTransform));
       double u;
-      if(useClosestPoint) {
-        v->getParameter(0, u);
-        GPoint pp = slave->closestPoint(p, u);
-        u = pp.u();
-      }
-      else {
-        u = slave->parFromPoint(p);
-      }
-      GPoint gp = slave->point(u);
-      v->setXYZ(gp.x(), gp.y(), gp.z());
-      v->setParameter(0, u);
+      v->getParameter(0, u);
+      guesses.push_back(u);
     }
   }
+  std::vector<double> t;
+  if(useClosestPoint) {
+    std::vector<GPoint> res;
+    slave->closestPoints(pts, res, &guesses);
+    t.resize(res.size());
+    for(std::size_t i = 0; i < res.size(); i++) t[i] = res[i].u();
+  }
+  else {
+    slave->parFromPoints(pts, t);
+  }
+  for(std::size_t i = 0; i < verts.size(); i++) {
+    GPoint gp = slave->point(t[i]);
+    verts[i]->setXYZ(gp.x(), gp.y(), gp.z());
+    verts[i]->setParameter(0, t[i]);
+  }
 }
 
 static void relocateSlaveVertices(std::vector<GEntity *> &entities,
                                   bool useClosestPoint)
 {
-  std::multimap<GEntity *, GEntity *> master2slave;
-  for(std::size_t i = 0; i < entities.size(); ++i) {
-    if(entities[i]->dim() == 0) continue;
-    GEntity *master = entities[i]->getMeshMaster();
-    if(master != entities[i]) {
-      master2slave.insert(std::make_pair(master, entities[i]));
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  // each slave only moves its own nodes, but reads the nodes of its master:
+  // process the chains of masters level by level
+  std::vector<std::vector<GEntity *> > levels;
+  getPeriodicLevels(entities, levels);
+  for(std::size_t l = 1; l < levels.size(); l++) {
+    std::vector<GEntity *> &slaves = levels[l];
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(std::size_t i = 0; i < slaves.size(); i++) {
+      if(slaves[i]->dim() == 2) {
+        GFace *master = dynamic_cast<GFace *>(slaves[i]->getMeshMaster());
+        GFace *slave = dynamic_cast<GFace *>(slaves[i]);
+        if(slave->affineTransform.size() < 16) continue;
+        Msg::Info("Relocating nodes of slave surface %i using master %i%s",
+                  slave->tag(), master->tag(),
+                  useClosestPoint ? " (using closest point)" : "");
+        relocateSlaveVertices(slave, slave->correspondingVertices,
+                              useClosestPoint);
+        relocateSlaveVertices(slave, slave->correspondingHighOrderVertices,
+                              useClosestPoint);
+      }
+      else if(slaves[i]->dim() == 1) {
+        GEdge *master = dynamic_cast<GEdge *>(slaves[i]->getMeshMaster());
+        GEdge *slave = dynamic_cast<GEdge *>(slaves[i]);
+        if(slave->affineTransform.size() < 16) continue;
+        Msg::Info("Relocating nodes of slave curve %i using master %i%s",
+                  slave->tag(), master->tag(),
+                  useClosestPoint ? " (using closest point)" : "");
+        relocateSlaveVertices(slave, slave->correspondingVertices,
+                              useClosestPoint);
+        relocateSlaveVertices(slave, slave->correspondingHighOrderVertices,
+                              useClosestPoint);
+      }
     }
   }
+}
+
+static bool fixPeriodicCurve(GEdge *tgt, GEdge *src)
+{
+  std::map<MVertex *, MVertex *> &v2v = tgt->correspondingVertices;
+  std::map<MVertex *, MVertex *> &p2p = tgt->correspondingHighOrderVertices;
+  p2p.clear();
+
+  Msg::Info("Reconstructing periodicity for curve connection %d - %d",
+            tgt->tag(), src->tag());
+
+  std::map<MEdge, MLine *, MEdgeLessThan> srcEdges;
+  for(std::size_t i = 0; i < src->getNumMeshElements(); i++) {
+    MLine *srcLine = dynamic_cast<MLine *>(src->getMeshElement(i));
+    if(!srcLine) {
+      Msg::Error("Master element %d is not a line",
+                 src->getMeshElement(i)->getNum());
+      return false;
+    }
+    srcEdges[MEdge(srcLine->getVertex(0), srcLine->getVertex(1))] = srcLine;
+  }
+
+  for(std::size_t i = 0; i < tgt->getNumMeshElements(); ++i) {
+    MLine *tgtLine = dynamic_cast<MLine *>(tgt->getMeshElement(i));
+    MVertex *vtcs[2];
+    if(!tgtLine) {
+      Msg::Error("Slave element %d is not a line",
+                 tgt->getMeshElement(i)->getNum());
+      return false;
+    }
+    for(int iVtx = 0; iVtx < 2; iVtx++) {
+      MVertex *vtx = tgtLine->getVertex(iVtx);
+      auto tIter = v2v.find(vtx);
+      if(tIter == v2v.end()) {
+        Msg::Error("Cannot find periodic counterpart of node %d"
+                   " of curve %d on curve %d",
+                   vtx->getNum(), tgt->tag(), src->tag());
+        return false;
+      }
+      else
+        vtcs[iVtx] = tIter->second;
+    }
 
-  for(auto it = master2slave.begin(); it != master2slave.end(); ++it) {
-    if(it->first->dim() == 2) {
-      GFace *master = dynamic_cast<GFace *>(it->first);
-      GFace *slave = dynamic_cast<GFace *>(it->second);
-      if(slave->affineTransform.size() < 16) continue;
-      Msg::Info("Relocating nodes of slave surface %i using master %i%s",
-                slave->tag(), master->tag(),
-                useClosestPoint ? " (using closest point)" : "");
-      relocateSlaveVertices(slave, slave->correspondingVertices,
-                            useClosestPoint);
-      relocateSlaveVertices(slave, slave->correspondingHighOrderVertices,
-                            useClosestPoint);
+    auto srcIter = srcEdges.find(MEdge(vtcs[0], vtcs[1]));
+    if(srcIter == srcEdges.end()) {
+      Msg::Error("Can't find periodic counterpart of mesh edge %d-%d "
+                 "on curve %d, connected to mesh edge %d-%d on curve %d",
+                 tgtLine->getVertex(0)->getNum(),
+                 tgtLine->getVertex(1)->getNum(), tgt->tag(),
+                 vtcs[0]->getNum(), vtcs[1]->getNum(), src->tag());
+      return false;
     }
-    else if(it->first->dim() == 1) {
-      GEdge *master = dynamic_cast<GEdge *>(it->first);
-      GEdge *slave = dynamic_cast<GEdge *>(it->second);
-      if(slave->affineTransform.size() < 16) continue;
-      Msg::Info("Relocating nodes of slave curve %i using master %i%s",
-                slave->tag(), master->tag(),
-                useClosestPoint ? " (using closest point)" : "");
-      relocateSlaveVertices(slave, slave->correspondingVertices,
-                            useClosestPoint);
-      relocateSlaveVertices(slave, slave->correspondingHighOrderVertices,
-                            useClosestPoint);
+    else {
+      MLine *srcLine = srcIter->second;
+      for(std::size_t i = 2; i < tgtLine->getNumVertices(); i++)
+        p2p[tgtLine->getVertex(i)] = srcLine->getVertex(i);
     }
   }
+  return true;
 }
 
-void FixPeriodicMesh(GModel *m)
+// The pairs of (target, source) elements whose source element must be reverted
+// to match the high-order nodes are returned in "reverted": since reverting
+// modifies the source element, which can be shared by several targets, this is
+// done afterwards, serially.
+static bool
+fixPeriodicSurface(GFace *tgt, GFace *src,
+                   std::vector<std::pair<MElement *, MElement *> > &reverted)
 {
-  if(CTX::instance()->abortOnError && Msg::GetErrorCount()) return;
-
-  for(auto it = m->firstEdge(); it != m->lastEdge(); ++it) {
-    GEdge *tgt = *it;
+  Msg::Info("Reconstructing periodicity for surface connection %d - %d",
+            tgt->tag(), src->tag());
+
+  std::map<MVertex *, MVertex *> &v2v = tgt->correspondingVertices;
+  std::map<MVertex *, MVertex *> &p2p = tgt->correspondingHighOrderVertices;
+  p2p.clear();
+
+  if(tgt->getNumMeshElements() && v2v.empty()) {
+    Msg::Info("No periodic vertices in surface %d (maybe due to a "
+              "structured mesh constraint on the target surface)",
+              tgt->tag());
+    return true;
+  }
 
-    // non complete periodic info (e.g. through extrusion)
-    if(tgt->vertexCounterparts.empty()) continue;
+  std::map<MFace, MElement *, MFaceLessThan> srcFaces;
+
+  for(std::size_t i = 0; i < src->getNumMeshElements(); ++i) {
+    MElement *srcElmt = src->getMeshElement(i);
+    int nbVtcs = 0;
+    if(dynamic_cast<MTriangle *>(srcElmt)) nbVtcs = 3;
+    if(dynamic_cast<MQuadrangle *>(srcElmt)) nbVtcs = 4;
+    std::vector<MVertex *> vtcs;
+    vtcs.reserve(nbVtcs);
+    for(int iVtx = 0; iVtx < nbVtcs; iVtx++) {
+      vtcs.push_back(srcElmt->getVertex(iVtx));
+    }
+    srcFaces[MFace(vtcs)] = srcElmt;
+  }
 
-    GEdge *src = dynamic_cast<GEdge *>(tgt->getMeshMaster());
+  for(std::size_t i = 0; i < tgt->getNumMeshElements(); ++i) {
+    MElement *tgtElmt = tgt->getMeshElement(i);
+    int nbVtcs = 0;
+    if(dynamic_cast<MTriangle *>(tgtElmt)) nbVtcs = 3;
+    if(dynamic_cast<MQuadrangle *>(tgtElmt)) nbVtcs = 4;
+    std::vector<MVertex *> vtcs;
+    for(int iVtx = 0; iVtx < nbVtcs; iVtx++) {
+      MVertex *vtx = tgtElmt->getVertex(iVtx);
+
+      auto tIter = v2v.find(vtx);
+      if(tIter == v2v.end()) {
+        Msg::Error("Cannot find periodic counterpart of node %d "
+                   "of surface %d on surface %d",
+                   vtx->getNum(), tgt->tag(), src->tag());
+        return false;
+      }
+      else
+        vtcs.push_back(tIter->second);
+    }
 
-    if(src != nullptr && src != tgt) {
-      std::map<MVertex *, MVertex *> &v2v = tgt->correspondingVertices;
-      std::map<MVertex *, MVertex *> &p2p = tgt->correspondingHighOrderVertices;
-      p2p.clear();
+    MFace tgtFace(vtcs);
+    auto srcIter = srcFaces.find(tgtFace);
+    if(srcIter == srcFaces.end()) {
+      std::ostringstream faceDef;
+      for(int iVtx = 0; iVtx < nbVtcs; iVtx++)
+        faceDef << vtcs[iVtx]->getNum() << " ";
+      Msg::Error("Cannot find periodic counterpart of mesh face %s in "
+                 "surface %d on surface %d",
+                 faceDef.str().c_str(), tgt->tag(), src->tag());
+      return false;
+    }
+    else {
+      MElement *srcElmt = srcIter->second;
+      // Warning: this check is made in case the source and target surface
+      // meshes are oriented differently (e.g. to be consistent with the
+      // underlying orientation of the geometrical surfaces)
+      if(dot(tgtFace.normal(), srcIter->first.normal()) < 0) {
+        if(nbVtcs < (int)srcElmt->getNumVertices())
+          reverted.push_back(std::make_pair(tgtElmt, srcElmt));
+        continue;
+      }
+      for(std::size_t j = nbVtcs; j < srcElmt->getNumVertices(); j++) {
+        p2p[tgtElmt->getVertex(j)] = srcElmt->getVertex(j);
+      }
+    }
+  }
+  return true;
+}
 
-      Msg::Info("Reconstructing periodicity for curve connection %d - %d",
-                tgt->tag(), src->tag());
+void FixPeriodicMesh(GModel *m)
+{
+  if(CTX::instance()->abortOnError && Msg::GetErrorCount()) return;
 
-      std::map<MEdge, MLine *, MEdgeLessThan> srcEdges;
-      for(std::size_t i = 0; i < src->getNumMeshElements(); i++) {
-        MLine *srcLine = dynamic_cast<MLine *>(src->getMeshElement(i));
-        if(!srcLine) {
-          Msg::Error("Master element %d is not a line",
-                     src->getMeshElement(i)->getNum());
-          return;
-        }
-        srcEdges[MEdge(srcLine->getVertex(0), srcLine->getVertex(1))] = srcLine;
-      }
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
 
-      for(std::size_t i = 0; i < tgt->getNumMeshElements(); ++i) {
-        MLine *tgtLine = dynamic_cast<MLine *>(tgt->getMeshElement(i));
-        MVertex *vtcs[2];
-        if(!tgtLine) {
-          Msg::Error("Slave element %d is not a line",
-                     tgt->getMeshElement(i)->getNum());
-          return;
-        }
-        for(int iVtx = 0; iVtx < 2; iVtx++) {
-          MVertex *vtx = tgtLine->getVertex(iVtx);
-          auto tIter = v2v.find(vtx);
-          if(tIter == v2v.end()) {
-            Msg::Error("Cannot find periodic counterpart of node %d"
-                       " of curve %d on curve %d",
-                       vtx->getNum(), tgt->tag(), src->tag());
-            return;
-          }
-          else
-            vtcs[iVtx] = tIter->second;
-        }
+  // the slaves are processed in parallel: each one only modifies its own
+  // correspondence of high-order nodes
+  std::vector<GEdge *> edges;
+  for(auto it = m->firstEdge(); it != m->lastEdge(); ++it) {
+    // non complete periodic info (e.g. through extrusion)
+    if((*it)->vertexCounterparts.empty()) continue;
+    GEdge *src = dynamic_cast<GEdge *>((*it)->getMeshMaster());
+    if(src != nullptr && src != *it) edges.push_back(*it);
+  }
 
-        auto srcIter = srcEdges.find(MEdge(vtcs[0], vtcs[1]));
-        if(srcIter == srcEdges.end()) {
-          Msg::Error("Can't find periodic counterpart of mesh edge %d-%d "
-                     "on curve %d, connected to mesh edge %d-%d on curve %d",
-                     tgtLine->getVertex(0)->getNum(),
-                     tgtLine->getVertex(1)->getNum(), tgt->tag(),
-                     vtcs[0]->getNum(), vtcs[1]->getNum(), src->tag());
-          return;
-        }
-        else {
-          MLine *srcLine = srcIter->second;
-          for(std::size_t i = 2; i < tgtLine->getNumVertices(); i++)
-            p2p[tgtLine->getVertex(i)] = srcLine->getVertex(i);
-        }
-      }
-    }
+  bool error = false;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < edges.size(); i++) {
+    if(error) continue;
+    GEdge *src = dynamic_cast<GEdge *>(edges[i]->getMeshMaster());
+    if(!fixPeriodicCurve(edges[i], src)) error = true;
   }
+  if(error) return;
 
   if(CTX::instance()->mesh.hoPeriodic) {
     std::vector<GEntity *> modelEdges(m->firstEdge(), m->lastEdge());
     relocateSlaveVertices(modelEdges, CTX::instance()->mesh.hoPeriodic > 1);
   }
 
+  std::vector<GFace *> faces;
   for(auto it = m->firstFace(); it != m->lastFace(); ++it) {
-    GFace *tgt = *it;
-
     // non complete periodic info (e.g. through extrusion)
-    if(tgt->vertexCounterparts.empty()) continue;
-
-    GFace *src = dynamic_cast<GFace *>(tgt->getMeshMaster());
-    if(src != nullptr && src != tgt) {
-      Msg::Info("Reconstructing periodicity for surface connection %d - %d",
-                tgt->tag(), src->tag());
-
-      std::map<MVertex *, MVertex *> &v2v = tgt->correspondingVertices;
-      std::map<MVertex *, MVertex *> &p2p = tgt->correspondingHighOrderVertices;
-      p2p.clear();
-
-      if(tgt->getNumMeshElements() && v2v.empty()) {
-        Msg::Info("No periodic vertices in surface %d (maybe due to a "
-                  "structured mesh constraint on the target surface)",
-                  tgt->tag());
-        continue;
-      }
-
-      std::map<MFace, MElement *, MFaceLessThan> srcFaces;
-
-      for(std::size_t i = 0; i < src->getNumMeshElements(); ++i) {
-        MElement *srcElmt = src->getMeshElement(i);
-        int nbVtcs = 0;
-        if(dynamic_cast<MTriangle *>(srcElmt)) nbVtcs = 3;
-        if(dynamic_cast<MQuadrangle *>(srcElmt)) nbVtcs = 4;
-        std::vector<MVertex *> vtcs;
-        vtcs.reserve(nbVtcs);
-        for(int iVtx = 0; iVtx < nbVtcs; iVtx++) {
-          vtcs.push_back(srcElmt->getVertex(iVtx));
-        }
-        srcFaces[MFace(vtcs)] = srcElmt;
-      }
-
-      for(std::size_t i = 0; i < tgt->getNumMeshElements(); ++i) {
-        MElement *tgtElmt = tgt->getMeshElement(i);
-        int nbVtcs = 0;
-        if(dynamic_cast<MTriangle *>(tgtElmt)) nbVtcs = 3;
-        if(dynamic_cast<MQuadrangle *>(tgtElmt)) nbVtcs = 4;
-        std::vector<MVertex *> vtcs;
-        for(int iVtx = 0; iVtx < nbVtcs; iVtx++) {
-          MVertex *vtx = tgtElmt->getVertex(iVtx);
-
-          auto tIter = v2v.find(vtx);
-          if(tIter == v2v.end()) {
-            Msg::Error("Cannot find periodic counterpart of node %d "
-                       "of surface %d on surface %d",
-                       vtx->getNum(), tgt->tag(), src->tag());
-            return;
-          }
-          else
-            vtcs.push_back(tIter->second);
-        }
+    if((*it)->vertexCounterparts.empty()) continue;
+    GFace *src = dynamic_cast<GFace *>((*it)->getMeshMaster());
+    if(src != nullptr && src != *it) faces.push_back(*it);
+  }
 
-        MFace tgtFace(vtcs);
-        auto srcIter = srcFaces.find(tgtFace);
-        if(srcIter == srcFaces.end()) {
-          std::ostringstream faceDef;
-          for(int iVtx = 0; iVtx < nbVtcs; iVtx++)
-            faceDef << vtcs[iVtx]->getNum() << " ";
-          Msg::Error("Cannot find periodic counterpart of mesh face %s in "
-                     "surface %d on surface %d",
-                     faceDef.str().c_str(), tgt->tag(), src->tag());
-          return;
-        }
-        else {
-          MElement *srcElmt = srcIter->second;
-          // Warning: this check is made in case the source and target surface
-          // meshes are oriented differently (e.g. to be consistent with the
-          // underlying orientation of the geometrical surfaces)
-          bool revert = dot(tgtFace.normal(), srcIter->first.normal()) < 0;
-          if(revert) srcElmt->reverse();
-          for(std::size_t j = nbVtcs; j < srcElmt->getNumVertices(); j++) {
-            p2p[tgtElmt->getVertex(j)] = srcElmt->getVertex(j);
-          }
-          if(revert) srcElmt->reverse();
-        }
+  std::vector<std::vector<std::pair<MElement *, MElement *> > > reverted(
+    faces.size());
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < faces.size(); i++) {
+    if(error) continue;
+    GFace *src = dynamic_cast<GFace *>(faces[i]->getMeshMaster());
+    if(!fixPeriodicSurface(faces[i], src, reverted[i])) error = true;
+  }
+  if(error) return;
+
+  for(std::size_t i = 0; i < faces.size(); i++) {
+    std::map<MVertex *, MVertex *> &p2p =
+      faces[i]->correspondingHighOrderVertices;
+    for(auto &r : reverted[i]) {
+      MElement *tgtElmt = r.first, *srcElmt = r.second;
+      std::size_t nbVtcs = srcElmt->getNumPrimaryVertices();
+      srcElmt->reverse();
+      for(std::size_t j = nbVtcs; j < srcElmt->getNumVertices(); j++) {
+        p2p[tgtElmt->getVertex(j)] = srcElmt->getVertex(j);
       }
+      srcElmt->reverse();
     }
   }
 
@@ -1278,6 +1439,8 @@ void GenerateMesh(GModel *m, int ask)
   }
   CTX::instance()->lock = 1;
 
+  ProfileScope scope("Mesh");
+
   Msg::ResetErrorCounter();
 
   m->clearLastMeshEntityError();
@@ -1416,6 +1579,11 @@ void GenerateMesh(GModel *m, int ask)
   // correspondences
   FixPeriodicMesh(m);
 
+  // reorder the elements and nodes in each entity to improve memory locality
+  // (tags are then renumbered in the same order if Mesh.Renumber is set)
+  if(CTX::instance()->mesh.reorderElements == 1)
+    meshReorder_Elements_Hilbert(m);
+
   Msg::Info("%d nodes %d elements", m->getNumMeshVertices(),
             m->getNumMeshElements());
 
@@ -9,6 +9,7 @@
 
 #include <sstream>
 #include <vector>
+#include <algorithm>
 #include "GmshConfig.h"
 #include "GModel.h"
 #include "HighOrder.h"
@@ -21,6 +22,7 @@
 #include "MPyramid.h"
 #include "GmshMessage.h"
 #include "OS.h"
+#include "Profiler.h"
 #include "fullMatrix.h"
 #include "BasisFactory.h"
 #include "nodalBasis.h"
@@ -28,6 +30,8 @@
 #include "Context.h"
 #include "MFace.h"
 #include "ExtrudeParams.h"
+#include "ElementType.h"
+#include "meshVertexTuples.h"
 
 // for each pair of vertices (an edge), we build a list of vertices that are the
 // high order representation of the edge. The ordering of vertices in the list
@@ -369,14 +373,15 @@ static bool getEdgeVerticesOnGeo(GFace *gf, MVertex *v0, MVertex *v1,
 
 static void interpVerticesInExistingEdge(GEntity *ge, const MElement *edgeEl,
                                          std::vector<MVertex *> &veEdge,
-                                         int nPts)
+                                         int nPts, std::size_t num = 0)
 {
   fullMatrix<double> points;
   points = edgeEl->getFunctionSpace(nPts + 1)->points;
   for(int k = 2; k < nPts + 2; k++) {
     SPoint3 pos;
     edgeEl->pnt(points(k, 0), 0., 0., pos);
-    MVertex *v = new MVertex(pos.x(), pos.y(), pos.z(), ge);
+    MVertex *v =
+      new MVertex(pos.x(), pos.y(), pos.z(), ge, num ? num++ : 0);
     veEdge.push_back(v);
   }
 }
@@ -481,38 +486,6 @@ static void getEdgeVertices(GFace *gf, MElement *ele,
   }
 }
 
-// Get new interior vertices for an edge in a 3D element
-static void getEdgeVertices(GRegion *gr, MElement *ele,
-                            std::vector<MVertex *> &ve,
-                            edgeContainer &edgeVertices, int nPts = 1)
-{
-  for(int i = 0; i < ele->getNumEdges(); i++) {
-    std::vector<MVertex *> veOld;
-    ele->getEdgeVertices(i, veOld);
-    MVertex *vMin, *vMax;
-    const bool increasing = getMinMaxVert(veOld[0], veOld[1], vMin, vMax);
-    std::pair<MVertex *, MVertex *> p(vMin, vMax);
-    std::vector<MVertex *> veEdge;
-    if(edgeVertices.count(p)) { // Vertices already exist
-      if(increasing)
-        veEdge.assign(edgeVertices[p].begin(), edgeVertices[p].end());
-      else
-        veEdge.assign(edgeVertices[p].rbegin(), edgeVertices[p].rend());
-    }
-    else { // Vertices do not exist, create them
-      const MLineN edgeEl(veOld, ele->getPolynomialOrder());
-      interpVerticesInExistingEdge(gr, &edgeEl, veEdge, nPts);
-      if(increasing) // Add newly created vertices to list
-        edgeVertices[p].insert(edgeVertices[p].end(), veEdge.begin(),
-                               veEdge.end());
-      else
-        edgeVertices[p].insert(edgeVertices[p].end(), veEdge.rbegin(),
-                               veEdge.rend());
-    }
-    ve.insert(ve.end(), veEdge.begin(), veEdge.end());
-  }
-}
-
 // Creation of high-order face vertices
 
 static void reorientTrianglePoints(std::vector<MVertex *> &vtcs,
@@ -668,7 +641,8 @@ static void reorientQuadPoints(std::vector<MVertex *> &vtcs, int orientation,
 static void interpVerticesInExistingFace(GEntity *ge,
                                          const fullMatrix<double> &coefficients,
                                          const std::vector<MVertex *> &vertices,
-                                         std::vector<MVertex *> &vFace)
+                                         std::vector<MVertex *> &vFace,
+                                         std::size_t num = 0)
 {
   for(int k = 0; k < coefficients.size1(); k++) {
     double x(0), y(0), z(0);
@@ -678,7 +652,7 @@ static void interpVerticesInExistingFace(GEntity *ge,
       y += coefficients(k, j) * v->y();
       z += coefficients(k, j) * v->z();
     }
-    vFace.push_back(new MVertex(x, y, z, ge));
+    vFace.push_back(new MVertex(x, y, z, ge, num ? num++ : 0));
   }
 }
 
@@ -855,53 +829,10 @@ static int retrieveFaceBoundaryVertices(int k, int type, int nPts,
   }
 }
 
-// Get new face (excluding edge) vertices for a face of a 3D element
-static void getFaceVertices(GRegion *gr, MElement *ele,
-                            std::vector<MVertex *> &newVertices,
-                            faceContainer &faceVertices, int nPts = 1)
-{
-  std::vector<MVertex *> vCorner;
-  ele->getVertices(vCorner);
-  // NB: We can get more than corner vertices but we use only corners
-
-  for(int i = 0; i < ele->getNumFaces(); i++) {
-    MFace face = ele->getFace(i);
-    std::vector<MVertex *> vFace;
-    auto fIter = faceVertices.find(face);
-    if(fIter != faceVertices.end()) { // Vertices already exist
-      std::vector<MVertex *> vtcs = fIter->second;
-      int orientation;
-      bool swap;
-      if(fIter->first.computeCorrespondence(face, orientation, swap)) {
-        // Check correspondence and apply permutation if needed
-        if(face.getNumVertices() == 3 && nPts > 1)
-          reorientTrianglePoints(vtcs, orientation, swap);
-        else if(face.getNumVertices() == 4)
-          reorientQuadPoints(vtcs, orientation, swap, nPts - 1);
-      }
-      else
-        Msg::Error(
-          "Error in face lookup for retrieval of high order face nodes");
-      vFace.assign(vtcs.begin(), vtcs.end());
-    }
-    else { // Vertices do not exist, create them by interpolation
-      std::vector<MVertex *> faceBoundaryVertices;
-      int type = retrieveFaceBoundaryVertices(
-        i, ele->getType(), nPts, vCorner, newVertices, faceBoundaryVertices);
-      fullMatrix<double> *coefficients =
-        getInnerVertexPlacement(type, nPts + 1);
-      interpVerticesInExistingFace(gr, *coefficients, faceBoundaryVertices,
-                                   vFace);
-      faceVertices[face].insert(faceVertices[face].end(), vFace.begin(),
-                                vFace.end());
-    }
-    newVertices.insert(newVertices.end(), vFace.begin(), vFace.end());
-  }
-}
-
 // Get new interior vertices for a 3D element
 static void getVolumeVertices(GRegion *gr, MElement *ele,
-                              std::vector<MVertex *> &newVertices, int nPts = 1)
+                              std::vector<MVertex *> &newVertices, int nPts,
+                              std::size_t num = 0)
 {
   std::vector<MVertex *> boundaryVertices;
   {
@@ -923,7 +854,7 @@ static void getVolumeVertices(GRegion *gr, MElement *ele,
       y += coefficients(k, j) * v->y();
       z += coefficients(k, j) * v->z();
     }
-    MVertex *v = new MVertex(x, y, z, gr);
+    MVertex *v = new MVertex(x, y, z, gr, num ? num++ : 0);
     newVertices.push_back(v);
   }
 }
@@ -1028,168 +959,380 @@ static void setHighOrder(GFace *gf, edgeContainer &edgeVertices,
   gf->deleteVertexArrays();
 }
 
-static MTetrahedron *setHighOrder(MTetrahedron *t, GRegion *gr,
-                                  edgeContainer &edgeVertices,
-                                  faceContainer &faceVertices, bool incomplete,
-                                  int nPts)
+// Creation of high-order volume elements
+//
+// The volume elements of all the volumes are processed together (and in
+// parallel): their edges and faces are stored in tables of node tuples, the
+// nodes on an edge (resp. a face) being created by the first element
+// containing the edge (resp. face), or reused from the curves and surfaces.
+// The new nodes and elements are numbered explicitly, in the order in which
+// they would be created by processing the elements one by one.
+
+static bool needFaceVertices(int type, bool incomplete, int nPts)
 {
-  std::vector<MVertex *> v;
-  getEdgeVertices(gr, t, v, edgeVertices, nPts);
-  if(nPts == 1) {
-    return new MTetrahedron10(t->getVertex(0), t->getVertex(1), t->getVertex(2),
-                              t->getVertex(3), v[0], v[1], v[2], v[3], v[4],
-                              v[5], 0, t->getPartition());
-  }
-  else {
-    if(!incomplete) {
-      getFaceVertices(gr, t, v, faceVertices, nPts);
-      getVolumeVertices(gr, t, v, nPts);
-    }
-    return new MTetrahedronN(t->getVertex(0), t->getVertex(1), t->getVertex(2),
-                             t->getVertex(3), v, nPts + 1, 0,
-                             t->getPartition());
-  }
+  return !incomplete && (type != TYPE_TET || nPts > 1);
 }
 
-static MHexahedron *setHighOrder(MHexahedron *h, GRegion *gr,
-                                 edgeContainer &edgeVertices,
-                                 faceContainer &faceVertices, bool incomplete,
-                                 int nPts)
+static bool needVolumeVertices(int type, bool incomplete, int nPts)
 {
-  std::vector<MVertex *> v;
-  getEdgeVertices(gr, h, v, edgeVertices, nPts);
-  if(incomplete) {
-    if(nPts == 1) {
-      return new MHexahedron20(
-        h->getVertex(0), h->getVertex(1), h->getVertex(2), h->getVertex(3),
-        h->getVertex(4), h->getVertex(5), h->getVertex(6), h->getVertex(7),
-        v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10],
-        v[11], 0, h->getPartition());
-    }
-    else {
-      return new MHexahedronN(h->getVertex(0), h->getVertex(1), h->getVertex(2),
-                              h->getVertex(3), h->getVertex(4), h->getVertex(5),
-                              h->getVertex(6), h->getVertex(7), v, nPts + 1, 0,
-                              h->getPartition());
-    }
-  }
-  else {
-    getFaceVertices(gr, h, v, faceVertices, nPts);
-    getVolumeVertices(gr, h, v, nPts);
-    if(nPts == 1) {
-      return new MHexahedron27(
-        h->getVertex(0), h->getVertex(1), h->getVertex(2), h->getVertex(3),
-        h->getVertex(4), h->getVertex(5), h->getVertex(6), h->getVertex(7),
-        v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10],
-        v[11], v[12], v[13], v[14], v[15], v[16], v[17], v[18], 0,
-        h->getPartition());
-    }
-    else {
-      return new MHexahedronN(h->getVertex(0), h->getVertex(1), h->getVertex(2),
-                              h->getVertex(3), h->getVertex(4), h->getVertex(5),
-                              h->getVertex(6), h->getVertex(7), v, nPts + 1, 0,
-                              h->getPartition());
-    }
-  }
+  return !incomplete && (type == TYPE_HEX || nPts > 1);
 }
 
-static MPrism *setHighOrder(MPrism *p, GRegion *gr, edgeContainer &edgeVertices,
-                            faceContainer &faceVertices, bool incomplete,
-                            int nPts)
+static int getNumFaceVertices(int numCorners, int nPts)
 {
-  std::vector<MVertex *> v;
-  getEdgeVertices(gr, p, v, edgeVertices, nPts);
-  if(incomplete) {
-    if(nPts == 1) {
-      return new MPrism15(p->getVertex(0), p->getVertex(1), p->getVertex(2),
-                          p->getVertex(3), p->getVertex(4), p->getVertex(5),
-                          v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8],
-                          0, p->getPartition());
-    }
-    else {
-      return new MPrismN(p->getVertex(0), p->getVertex(1), p->getVertex(2),
-                         p->getVertex(3), p->getVertex(4), p->getVertex(5), v,
-                         nPts + 1, 0, p->getPartition());
-    }
-  }
-  else {
-    getFaceVertices(gr, p, v, faceVertices, nPts);
-    if(nPts == 1) {
-      return new MPrism18(p->getVertex(0), p->getVertex(1), p->getVertex(2),
-                          p->getVertex(3), p->getVertex(4), p->getVertex(5),
-                          v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8],
-                          v[9], v[10], v[11], 0, p->getPartition());
-    }
-    else {
-      getVolumeVertices(gr, p, v, nPts);
-      return new MPrismN(p->getVertex(0), p->getVertex(1), p->getVertex(2),
-                         p->getVertex(3), p->getVertex(4), p->getVertex(5), v,
-                         nPts + 1, 0, p->getPartition());
-    }
+  return numCorners == 3 ? (nPts - 1) * nPts / 2 : nPts * nPts;
+}
+
+// corners of face f of a volume element (in the order of getFace(f))
+static int getFaceCorners(MElement *e, int f, MVertex *c[4])
+{
+  switch(e->getType()) {
+  case TYPE_TET:
+    for(int k = 0; k < 3; k++)
+      c[k] = e->getVertex(MTetrahedron::faces_tetra(f, k));
+    return 3;
+  case TYPE_HEX:
+    for(int k = 0; k < 4; k++)
+      c[k] = e->getVertex(MHexahedron::faces_hexa(f, k));
+    return 4;
+  case TYPE_PRI:
+    for(int k = 0; k < (f < 2 ? 3 : 4); k++)
+      c[k] = e->getVertex(MPrism::faces_prism(f, k));
+    return f < 2 ? 3 : 4;
+  case TYPE_PYR:
+    for(int k = 0; k < (f < 4 ? 3 : 4); k++)
+      c[k] = e->getVertex(MPyramid::faces_pyramid(f, k));
+    return f < 4 ? 3 : 4;
+  default: return 0;
   }
 }
 
-static MPyramid *setHighOrder(MPyramid *p, GRegion *gr,
-                              edgeContainer &edgeVertices,
-                              faceContainer &faceVertices, bool incomplete,
-                              int nPts)
+static MElement *newHighOrderElement(MElement *e, std::vector<MVertex *> &v,
+                                     bool incomplete, int nPts, int num)
 {
-  std::vector<MVertex *> v;
-  getEdgeVertices(gr, p, v, edgeVertices, nPts);
-  if(!incomplete) {
-    getFaceVertices(gr, p, v, faceVertices, nPts);
-    if(nPts > 1) { getVolumeVertices(gr, p, v, nPts); }
-  }
-  return new MPyramidN(p->getVertex(0), p->getVertex(1), p->getVertex(2),
-                       p->getVertex(3), p->getVertex(4), v, nPts + 1, 0,
-                       p->getPartition());
+  MVertex *c[8];
+  for(std::size_t k = 0; k < e->getNumPrimaryVertices(); k++)
+    c[k] = e->getVertex(k);
+  int part = e->getPartition();
+  switch(e->getType()) {
+  case TYPE_TET:
+    if(nPts == 1)
+      return new MTetrahedron10(c[0], c[1], c[2], c[3], v[0], v[1], v[2], v[3],
+                                v[4], v[5], num, part);
+    return new MTetrahedronN(c[0], c[1], c[2], c[3], v, nPts + 1, num, part);
+  case TYPE_HEX:
+    if(nPts == 1 && incomplete)
+      return new MHexahedron20(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7],
+                               v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7],
+                               v[8], v[9], v[10], v[11], num, part);
+    if(nPts == 1)
+      return new MHexahedron27(
+        c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7], v[0], v[1], v[2], v[3],
+        v[4], v[5], v[6], v[7], v[8], v[9], v[10], v[11], v[12], v[13], v[14],
+        v[15], v[16], v[17], v[18], num, part);
+    return new MHexahedronN(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7], v,
+                            nPts + 1, num, part);
+  case TYPE_PRI:
+    if(nPts == 1 && incomplete)
+      return new MPrism15(c[0], c[1], c[2], c[3], c[4], c[5], v[0], v[1], v[2],
+                          v[3], v[4], v[5], v[6], v[7], v[8], num, part);
+    if(nPts == 1)
+      return new MPrism18(c[0], c[1], c[2], c[3], c[4], c[5], v[0], v[1], v[2],
+                          v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10],
+                          v[11], num, part);
+    return new MPrismN(c[0], c[1], c[2], c[3], c[4], c[5], v, nPts + 1, num,
+                       part);
+  case TYPE_PYR:
+    return new MPyramidN(c[0], c[1], c[2], c[3], c[4], v, nPts + 1, num, part);
+  default: return nullptr;
+  }
 }
 
-static void setHighOrder(GRegion *gr, edgeContainer &edgeVertices,
+static void setHighOrder(GModel *m, std::vector<GRegion *> &regions,
+                         edgeContainer &edgeVertices,
                          faceContainer &faceVertices, bool incomplete,
-                         int nPts = 1)
+                         int nPts)
 {
-  std::vector<MTetrahedron *> tetrahedra2;
-  for(std::size_t i = 0; i < gr->tetrahedra.size(); i++) {
-    MTetrahedron *t = gr->tetrahedra[i];
-    MTetrahedron *tNew =
-      setHighOrder(t, gr, edgeVertices, faceVertices, incomplete, nPts);
-    tetrahedra2.push_back(tNew);
-    delete t;
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  // flat list of elements, ordered by volume and by type
+  std::vector<std::size_t> regionStart(1, 0);
+  std::vector<MElement *> elms;
+  for(auto gr : regions) {
+    elms.insert(elms.end(), gr->tetrahedra.begin(), gr->tetrahedra.end());
+    elms.insert(elms.end(), gr->hexahedra.begin(), gr->hexahedra.end());
+    elms.insert(elms.end(), gr->prisms.begin(), gr->prisms.end());
+    elms.insert(elms.end(), gr->pyramids.begin(), gr->pyramids.end());
+    regionStart.push_back(elms.size());
+  }
+  if(elms.empty()) return;
+  auto regionOf = [&](std::size_t e) {
+    return regions[std::upper_bound(regionStart.begin(), regionStart.end(),
+                                    e) -
+                   regionStart.begin() - 1];
+  };
+
+  // index the corner nodes of the elements (the original indices are restored
+  // at the end)
+  std::vector<GEntity *> entities;
+  m->getEntities(entities);
+  std::vector<long int> oldIndex;
+  for(auto ge : entities)
+    for(auto v : ge->mesh_vertices) oldIndex.push_back(v->getIndex());
+  for(auto e : elms)
+    for(std::size_t k = 0; k < e->getNumPrimaryVertices(); k++)
+      e->getVertex(k)->setIndex(-1);
+  std::vector<MVertex *> verts;
+  for(auto e : elms) {
+    for(std::size_t k = 0; k < e->getNumPrimaryVertices(); k++) {
+      MVertex *v = e->getVertex(k);
+      if(v->getIndex() < 0) {
+        v->setIndex(verts.size());
+        verts.push_back(v);
+      }
+    }
+  }
+  int numVertices = verts.size();
+
+  // the code of each edge (resp. face) identifies the first element containing
+  // it, and the edge (resp. face) in this element
+  meshVertexTuples<2> edges;
+  edges.build(
+    numVertices, elms.size(),
+    [&](std::size_t e, int t[][2], std::size_t *c) {
+      MElement *el = elms[e];
+      for(int j = 0; j < el->getNumEdges(); j++) {
+        MEdge ed = el->getEdge(j);
+        t[j][0] = ed.getVertex(0)->getIndex();
+        t[j][1] = ed.getVertex(1)->getIndex();
+        c[j] = 16 * e + j;
+      }
+      return el->getNumEdges();
+    },
+    nthreads);
+  meshVertexTuples<4> faces;
+  faces.build(
+    numVertices, elms.size(),
+    [&](std::size_t e, int t[][4], std::size_t *c) {
+      MElement *el = elms[e];
+      if(!needFaceVertices(el->getType(), incomplete, nPts)) return 0;
+      for(int f = 0; f < el->getNumFaces(); f++) {
+        MVertex *v[4];
+        int n = getFaceCorners(el, f, v);
+        for(int k = 0; k < 4; k++) t[f][k] = k < n ? v[k]->getIndex() : -1;
+        c[f] = 8 * e + f;
+      }
+      return el->getNumFaces();
+    },
+    nthreads);
+  auto findEdge = [&](MVertex *v0, MVertex *v1) {
+    int t[2] = {(int)v0->getIndex(), (int)v1->getIndex()};
+    return edges.find(t);
+  };
+  auto findFace = [&](MElement *el, int f) {
+    MVertex *v[4];
+    int n = getFaceCorners(el, f, v);
+    int t[4];
+    for(int k = 0; k < 4; k++) t[k] = k < n ? v[k]->getIndex() : -1;
+    return faces.find(t);
+  };
+  auto inVolume = [](MVertex *v) {
+    return v->onWhat() && v->onWhat()->dim() == 3;
+  };
+
+  // reuse the nodes on the curves and surfaces (only looked up for the edges
+  // and faces whose nodes are all classified on the boundary); the nodes of
+  // the edges are stored in the direction starting from edgeFirst
+  std::vector<MVertex *> edgeFirst(edges.size(), nullptr);
+  std::vector<MVertex *> edgeNodes(edges.size() * nPts, nullptr);
+  std::vector<const MFace *> faceRef(faces.size(), nullptr);
+  std::vector<std::size_t> faceStart(faces.size() + 1, 0);
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+  for(int i = 0; i < numVertices; i++) {
+    for(std::size_t k = edges.begin(i); k < edges.end(i); k++) {
+      MVertex *v0 = verts[i], *v1 = verts[edges.getKey(k)[0]];
+      if(inVolume(v0) || inVolume(v1)) continue;
+      MVertex *vMin, *vMax;
+      getMinMaxVert(v0, v1, vMin, vMax);
+      auto it = edgeVertices.find(std::make_pair(vMin, vMax));
+      if(it == edgeVertices.end()) continue;
+      edgeFirst[k] = vMin;
+      for(int j = 0; j < nPts && j < (int)it->second.size(); j++)
+        edgeNodes[k * nPts + j] = it->second[j];
+    }
+    for(std::size_t k = faces.begin(i); k < faces.end(i); k++) {
+      const auto &key = faces.getKey(k);
+      int n = key[2] < 0 ? 3 : 4;
+      faceStart[k + 1] = getNumFaceVertices(n, nPts);
+      MVertex *v[4] = {verts[i], verts[key[0]], verts[key[1]],
+                       n == 4 ? verts[key[2]] : nullptr};
+      bool bnd = true;
+      for(int j = 0; j < n; j++) bnd &= !inVolume(v[j]);
+      if(!bnd) continue;
+      auto it = faceVertices.find(MFace(v[0], v[1], v[2], v[3]));
+      if(it != faceVertices.end()) faceRef[k] = &it->first;
+    }
+  }
+  for(std::size_t k = 0; k < faces.size(); k++)
+    faceStart[k + 1] += faceStart[k];
+  std::vector<MVertex *> faceNodes(faceStart[faces.size()], nullptr);
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+  for(std::size_t k = 0; k < faces.size(); k++) {
+    if(!faceRef[k]) continue;
+    const std::vector<MVertex *> &fv = faceVertices.find(*faceRef[k])->second;
+    for(std::size_t j = 0; j < faceStart[k + 1] - faceStart[k]; j++)
+      faceNodes[faceStart[k] + j] = j < fv.size() ? fv[j] : nullptr;
   }
-  gr->tetrahedra = tetrahedra2;
 
-  std::vector<MHexahedron *> hexahedra2;
-  for(std::size_t i = 0; i < gr->hexahedra.size(); i++) {
-    MHexahedron *h = gr->hexahedra[i];
-    MHexahedron *hNew =
-      setHighOrder(h, gr, edgeVertices, faceVertices, incomplete, nPts);
-    hexahedra2.push_back(hNew);
-    delete h;
+  Msg::Info("Creating high-order nodes for %lu volume elements (%lu edges, "
+            "%lu faces)",
+            elms.size(), edges.size(), faces.size());
+
+  // count the new nodes created by each element, to number them (the number
+  // of edge nodes is stored, as edgeFirst is modified when they are created)
+  std::vector<std::size_t> numNew(elms.size() + 1, 0);
+  std::vector<std::size_t> numEdgeNodes(elms.size(), 0);
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+  for(std::size_t e = 0; e < elms.size(); e++) {
+    MElement *el = elms[e];
+    std::size_t n = 0;
+    for(int j = 0; j < el->getNumEdges(); j++) {
+      MEdge ed = el->getEdge(j);
+      std::size_t k = findEdge(ed.getVertex(0), ed.getVertex(1));
+      if(edges.getCode(k) == 16 * e + j && !edgeFirst[k]) n += nPts;
+    }
+    numEdgeNodes[e] = n;
+    if(needFaceVertices(el->getType(), incomplete, nPts)) {
+      for(int f = 0; f < el->getNumFaces(); f++) {
+        std::size_t k = findFace(el, f);
+        if(faces.getCode(k) == 8 * e + f && !faceRef[k])
+          n += faceStart[k + 1] - faceStart[k];
+      }
+    }
+    if(needVolumeVertices(el->getType(), incomplete, nPts))
+      n += getInnerVertexPlacement(el->getType(), nPts + 1)->size1();
+    numNew[e + 1] = n;
+  }
+  for(std::size_t e = 0; e < elms.size(); e++) numNew[e + 1] += numNew[e];
+  const std::size_t vertexNum = m->getMaxVertexNumber();
+  const std::size_t elementNum = m->getMaxElementNumber();
+
+  // create the new nodes on the edges
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+  for(std::size_t e = 0; e < elms.size(); e++) {
+    MElement *el = elms[e];
+    std::size_t num = vertexNum + numNew[e] + 1;
+    for(int j = 0; j < el->getNumEdges(); j++) {
+      MEdge ed = el->getEdge(j);
+      std::size_t k = findEdge(ed.getVertex(0), ed.getVertex(1));
+      if(edges.getCode(k) != 16 * e + j || edgeFirst[k]) continue;
+      std::vector<MVertex *> veOld, veEdge;
+      el->getEdgeVertices(j, veOld);
+      const MLineN edgeEl(veOld, el->getPolynomialOrder());
+      interpVerticesInExistingEdge(regionOf(e), &edgeEl, veEdge, nPts, num);
+      num += nPts;
+      edgeFirst[k] = veOld[0];
+      std::copy(veEdge.begin(), veEdge.end(), edgeNodes.begin() + k * nPts);
+    }
   }
-  gr->hexahedra = hexahedra2;
 
-  std::vector<MPrism *> prisms2;
-  for(std::size_t i = 0; i < gr->prisms.size(); i++) {
-    MPrism *p = gr->prisms[i];
-    MPrism *pNew =
-      setHighOrder(p, gr, edgeVertices, faceVertices, incomplete, nPts);
-    prisms2.push_back(pNew);
-    delete p;
+  // nodes on the edges of an element, in the direction of the element edges
+  auto getEdgeNodes = [&](MElement *el, std::vector<MVertex *> &v) {
+    for(int j = 0; j < el->getNumEdges(); j++) {
+      MEdge ed = el->getEdge(j);
+      std::size_t k = findEdge(ed.getVertex(0), ed.getVertex(1));
+      bool increasing = (edgeFirst[k] == ed.getVertex(0));
+      for(int l = 0; l < nPts; l++)
+        v.push_back(edgeNodes[k * nPts + (increasing ? l : nPts - 1 - l)]);
+    }
+  };
+
+  // create the new nodes on the faces
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+  for(std::size_t e = 0; e < elms.size(); e++) {
+    MElement *el = elms[e];
+    if(!needFaceVertices(el->getType(), incomplete, nPts)) continue;
+    std::size_t num = vertexNum + numNew[e] + numEdgeNodes[e] + 1;
+    std::vector<MVertex *> vCorner, vEdges;
+    for(int f = 0; f < el->getNumFaces(); f++) {
+      std::size_t k = findFace(el, f);
+      if(faces.getCode(k) != 8 * e + f || faceRef[k]) continue;
+      if(faceStart[k + 1] == faceStart[k]) continue;
+      if(vCorner.empty()) {
+        el->getVertices(vCorner);
+        getEdgeNodes(el, vEdges);
+      }
+      std::vector<MVertex *> faceBoundaryVertices, vFace;
+      int type = retrieveFaceBoundaryVertices(f, el->getType(), nPts, vCorner,
+                                              vEdges, faceBoundaryVertices);
+      fullMatrix<double> *coefficients =
+        getInnerVertexPlacement(type, nPts + 1);
+      interpVerticesInExistingFace(regionOf(e), *coefficients,
+                                   faceBoundaryVertices, vFace, num);
+      num += vFace.size();
+      std::copy(vFace.begin(), vFace.end(), faceNodes.begin() + faceStart[k]);
+    }
   }
-  gr->prisms = prisms2;
 
-  std::vector<MPyramid *> pyramids2;
-  for(std::size_t i = 0; i < gr->pyramids.size(); i++) {
-    MPyramid *p = gr->pyramids[i];
-    MPyramid *pNew =
-      setHighOrder(p, gr, edgeVertices, faceVertices, incomplete, nPts);
-    pyramids2.push_back(pNew);
-    delete p;
+  // create the new elements, with their interior nodes
+  std::vector<MElement *> newElms(elms.size());
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+  for(std::size_t e = 0; e < elms.size(); e++) {
+    MElement *el = elms[e];
+    std::vector<MVertex *> v;
+    getEdgeNodes(el, v);
+    if(needFaceVertices(el->getType(), incomplete, nPts)) {
+      for(int f = 0; f < el->getNumFaces(); f++) {
+        std::size_t k = findFace(el, f);
+        std::vector<MVertex *> vtcs(faceNodes.begin() + faceStart[k],
+                                    faceNodes.begin() + faceStart[k + 1]);
+        std::size_t c = faces.getCode(k);
+        if(c != 8 * e + f) {
+          MFace face = el->getFace(f);
+          MFace ref = faceRef[k] ? *faceRef[k] : elms[c / 8]->getFace(c % 8);
+          int orientation;
+          bool swap;
+          if(ref.computeCorrespondence(face, orientation, swap)) {
+            // Check correspondence and apply permutation if needed
+            if(face.getNumVertices() == 3 && nPts > 1)
+              reorientTrianglePoints(vtcs, orientation, swap);
+            else if(face.getNumVertices() == 4)
+              reorientQuadPoints(vtcs, orientation, swap, nPts - 1);
+          }
+          else
+            Msg::Error(
+              "Error in face lookup for retrieval of high order face nodes");
+        }
+        v.insert(v.end(), vtcs.begin(), vtcs.end());
+      }
+    }
+    if(needVolumeVertices(el->getType(), incomplete, nPts)) {
+      std::size_t n = getInnerVertexPlacement(el->getType(), nPts + 1)->size1();
+      getVolumeVertices(regionOf(e), el, v, nPts,
+                        vertexNum + numNew[e + 1] - n + 1);
+    }
+    newElms[e] = newHighOrderElement(el, v, incomplete, nPts,
+                                     elementNum + e + 1);
   }
-  gr->pyramids = pyramids2;
 
-  gr->deleteVertexArrays();
+  // restore the indices, and replace the elements
+  std::size_t n = 0;
+  for(auto ge : entities)
+    for(auto v : ge->mesh_vertices) v->setIndex(oldIndex[n++]);
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t e = 0; e < elms.size(); e++) delete elms[e];
+  for(std::size_t r = 0; r < regions.size(); r++) {
+    GRegion *gr = regions[r];
+    std::size_t e = regionStart[r];
+    for(auto &t : gr->tetrahedra) t = static_cast<MTetrahedron *>(newElms[e++]);
+    for(auto &h : gr->hexahedra) h = static_cast<MHexahedron *>(newElms[e++]);
+    for(auto &p : gr->prisms) p = static_cast<MPrism *>(newElms[e++]);
+    for(auto &p : gr->pyramids) p = static_cast<MPyramid *>(newElms[e++]);
+    gr->deleteVertexArrays();
+  }
+  m->setMaxVertexNumber(vertexNum + numNew[elms.size()]);
+  m->setMaxElementNumber(elementNum + elms.size());
 }
 
 // High-level functions
@@ -1393,8 +1536,84 @@ static void setHighOrderFromExistingMesh(GFace *gf, edgeContainer &edgeVertices,
   }
 }
 
+// The nodal bases and the inner node placement matrices are cached in
+// containers that are not thread-safe: create the ones used to create the
+// high-order nodes before processing the entities in parallel
+static void initializeHighOrder(GModel *m, int order)
+{
+  int maxOrder = order;
+  std::vector<GEntity *> entities;
+  m->getEntities(entities);
+  for(auto ge : entities) maxOrder = std::max(maxOrder, getOrder(ge));
+  for(int o = 1; o <= maxOrder; o++)
+    BasisFactory::getNodalBasis(ElementType::getType(TYPE_LIN, o));
+  for(int type = TYPE_TRI; type <= TYPE_HEX; type++)
+    getInnerVertexPlacement(type, order);
+}
+
+// Surfaces can only be processed independently if the mesh edges they share
+// are discretized on curves: check for nodes classified on other surfaces or
+// on volumes, and for edges between nodes on curves that are not discretized
+// (e.g. invisible curves) and that belong to several surfaces
+static bool surfacesShareEdges(const std::vector<GFace *> &surfaces,
+                               const edgeContainer &edgeVertices)
+{
+  std::map<std::pair<MVertex *, MVertex *>, GFace *> curveEdges;
+  for(auto gf : surfaces) {
+    for(std::size_t i = 0; i < gf->getNumMeshElements(); i++) {
+      MElement *e = gf->getMeshElement(i);
+      for(int j = 0; j < e->getNumEdges(); j++) {
+        MEdge edg = e->getEdge(j);
+        bool onCurves = true;
+        for(int k = 0; k < 2; k++) {
+          GEntity *ge = edg.getVertex(k)->onWhat();
+          if(!ge || ge->dim() == 3 || (ge->dim() == 2 && ge != gf)) return true;
+          if(ge->dim() == 2) onCurves = false;
+        }
+        if(!onCurves) continue;
+        MVertex *vMin, *vMax;
+        getMinMaxVert(edg.getVertex(0), edg.getVertex(1), vMin, vMax);
+        std::pair<MVertex *, MVertex *> p(vMin, vMax);
+        if(edgeVertices.count(p)) continue;
+        auto it = curveEdges.insert(std::make_pair(p, gf)).first;
+        if(it->second != gf) return true;
+      }
+    }
+  }
+  return false;
+}
+
+// Renumber the nodes and the elements created in the entities (i.e. whose
+// number is larger than vertexNum and elementNum) when processing them in
+// parallel, in the order in which they would have been created serially
+template <class T>
+static void renumberHighOrder(const std::vector<T *> &entities,
+                              std::size_t vertexNum, std::size_t elementNum)
+{
+  std::size_t nv = vertexNum, ne = elementNum;
+  for(auto ge : entities) {
+    // each entity is processed by a single thread: the nodes are numbered in
+    // their order of creation
+    std::vector<MVertex *> v;
+    for(std::size_t i = 0; i < ge->getNumMeshElements(); i++) {
+      MElement *e = ge->getMeshElement(i);
+      for(std::size_t k = e->getNumPrimaryVertices(); k < e->getNumVertices();
+          k++) {
+        if(e->getVertex(k)->getNum() > vertexNum) v.push_back(e->getVertex(k));
+      }
+    }
+    std::sort(v.begin(), v.end(), MVertexPtrLessThan());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+    for(auto vv : v) vv->forceNum(++nv);
+    for(std::size_t i = 0; i < ge->getNumMeshElements(); i++) {
+      MElement *e = ge->getMeshElement(i);
+      if(e->getNum() > elementNum) e->forceNum(++ne);
+    }
+  }
+}
+
 void SetOrderN(GModel *m, int order, bool linear, bool incomplete,
-               bool onlyVisible)
+               bool onlyVisible, int maxDim)
 {
   if(CTX::instance()->abortOnError && Msg::GetErrorCount()) return;
 
@@ -1414,6 +1633,12 @@ void SetOrderN(GModel *m, int order, bool linear, bool incomplete,
   //   9-node quads, 27-node hexas, etc.)
 
   // - if onlyVisible is true, then only the visible entities will be curved.
+  //
+  // - entities of dimension larger than maxDim are left untouched.
+  //
+  // Curves and surfaces are processed in parallel (one entity per thread),
+  // and volume elements in parallel; the numbering of the new nodes and
+  // elements does not depend on the number of threads.
 
   int nPts = order - 1;
 
@@ -1424,49 +1649,151 @@ void SetOrderN(GModel *m, int order, bool linear, bool incomplete,
   Msg::StatusBar(true, msg);
 
   double t1 = Cpu(), w1 = TimeOfDay();
+  ProfileScope scope("High order");
 
   m->destroyMeshCaches();
 
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  initializeHighOrder(m, order);
+
   // Keep track of vertex/entities created
   edgeContainer edgeVertices;
   faceContainer faceVertices;
 
   int counter = 0;
-  int nTot = m->getNumEdges() + m->getNumFaces() + m->getNumRegions();
+  int nTot = (maxDim > 0 ? m->getNumEdges() : 0) +
+             (maxDim > 1 ? m->getNumFaces() : 0) +
+             (maxDim > 2 ? m->getNumRegions() : 0);
   Msg::StartProgressMeter(nTot);
 
   // TODO: we can leak nodes of discrete entities with existing high-order
   // nodes, if we ask a mesh with a different order
 
+  std::vector<GEdge *> curves;
   for(auto it = m->firstEdge(); it != m->lastEdge(); ++it) {
-    Msg::Info("Meshing curve %d order %d", (*it)->tag(), order);
-    Msg::ProgressMeter(++counter, false, msg);
-    if(onlyVisible && !(*it)->getVisibility()) continue;
-    if(getOrder(*it) != order)
-      setHighOrder(*it, edgeVertices, linear, nPts);
+    if(maxDim < 1) break;
+    if(onlyVisible && !(*it)->getVisibility())
+      counter++;
     else
-      setHighOrderFromExistingMesh(*it, edgeVertices);
+      curves.push_back(*it);
+  }
+  std::vector<char> generate(curves.size());
+  for(std::size_t i = 0; i < curves.size(); i++)
+    generate[i] = (getOrder(curves[i]) != order);
+
+  // each curve creates its nodes in its own container; the containers are
+  // then merged, in the order of the curves
+  std::size_t vertexNum = m->getMaxVertexNumber();
+  std::size_t elementNum = m->getMaxElementNumber();
+  std::vector<edgeContainer> curveEdgeVertices(curves.size());
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < curves.size(); i++) {
+    Msg::Info("Meshing curve %d order %d", curves[i]->tag(), order);
+    if(generate[i])
+      setHighOrder(curves[i], curveEdgeVertices[i], linear, nPts);
+    int localCounter;
+#pragma omp atomic capture
+    localCounter = ++counter;
+    Msg::ProgressMeter(localCounter, false, msg);
   }
+  for(std::size_t i = 0; i < curves.size(); i++) {
+    if(!generate[i]) {
+      setHighOrderFromExistingMesh(curves[i], edgeVertices);
+      continue;
+    }
+    for(auto &p : curveEdgeVertices[i]) {
+      if(!edgeVertices.insert(p).second && p.first.first != p.first.second) {
+        // Vertices already exist and edge is not a degenerated edge
+        Msg::Error(
+          "Mesh edges from different curves share nodes: create a finer mesh "
+          "(curve involved: %d)",
+          curves[i]->tag());
+      }
+    }
+  }
+  if(nthreads > 1) renumberHighOrder(curves, vertexNum, elementNum);
 
+  std::vector<GFace *> surfaces;
   for(auto it = m->firstFace(); it != m->lastFace(); ++it) {
-    Msg::Info("Meshing surface %d order %d", (*it)->tag(), order);
-    Msg::ProgressMeter(++counter, false, msg);
-    if(onlyVisible && !(*it)->getVisibility()) continue;
-    if(getOrder(*it) != order)
-      setHighOrder(*it, edgeVertices, faceVertices, linear, incomplete, nPts);
+    if(maxDim < 2) break;
+    if(onlyVisible && !(*it)->getVisibility())
+      counter++;
     else
-      setHighOrderFromExistingMesh(*it, edgeVertices, faceVertices);
-    if((*it)->getColumns() != nullptr) (*it)->getColumns()->clearElementData();
+      surfaces.push_back(*it);
+  }
+  generate.resize(surfaces.size());
+  for(std::size_t i = 0; i < surfaces.size(); i++)
+    generate[i] = (getOrder(surfaces[i]) != order);
+
+  if(nthreads > 1 && !surfacesShareEdges(surfaces, edgeVertices)) {
+    // each surface creates its nodes in its own containers, initialized with
+    // the nodes on its boundary curves; the containers are then merged, in
+    // the order of the surfaces
+    vertexNum = m->getMaxVertexNumber();
+    elementNum = m->getMaxElementNumber();
+    std::vector<edgeContainer> surfaceEdgeVertices(surfaces.size());
+    std::vector<faceContainer> surfaceFaceVertices(surfaces.size());
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(std::size_t i = 0; i < surfaces.size(); i++) {
+      GFace *gf = surfaces[i];
+      Msg::Info("Meshing surface %d order %d", gf->tag(), order);
+      if(generate[i]) {
+        for(std::size_t j = 0; j < gf->getNumMeshElements(); j++) {
+          MElement *e = gf->getMeshElement(j);
+          for(int k = 0; k < e->getNumEdges(); k++) {
+            MEdge edg = e->getEdge(k);
+            MVertex *vMin, *vMax;
+            getMinMaxVert(edg.getVertex(0), edg.getVertex(1), vMin, vMax);
+            auto it = edgeVertices.find(std::make_pair(vMin, vMax));
+            if(it != edgeVertices.end()) surfaceEdgeVertices[i].insert(*it);
+          }
+        }
+        setHighOrder(gf, surfaceEdgeVertices[i], surfaceFaceVertices[i],
+                     linear, incomplete, nPts);
+      }
+      int localCounter;
+#pragma omp atomic capture
+      localCounter = ++counter;
+      Msg::ProgressMeter(localCounter, false, msg);
+    }
+    for(std::size_t i = 0; i < surfaces.size(); i++) {
+      GFace *gf = surfaces[i];
+      if(generate[i]) {
+        edgeVertices.insert(surfaceEdgeVertices[i].begin(),
+                            surfaceEdgeVertices[i].end());
+        faceVertices.insert(surfaceFaceVertices[i].begin(),
+                            surfaceFaceVertices[i].end());
+      }
+      else
+        setHighOrderFromExistingMesh(gf, edgeVertices, faceVertices);
+      if(gf->getColumns() != nullptr) gf->getColumns()->clearElementData();
+    }
+    renumberHighOrder(surfaces, vertexNum, elementNum);
+  }
+  else {
+    for(std::size_t i = 0; i < surfaces.size(); i++) {
+      GFace *gf = surfaces[i];
+      Msg::Info("Meshing surface %d order %d", gf->tag(), order);
+      Msg::ProgressMeter(++counter, false, msg);
+      if(generate[i])
+        setHighOrder(gf, edgeVertices, faceVertices, linear, incomplete, nPts);
+      else
+        setHighOrderFromExistingMesh(gf, edgeVertices, faceVertices);
+      if(gf->getColumns() != nullptr) gf->getColumns()->clearElementData();
+    }
   }
 
+  std::vector<GRegion *> regions;
   for(auto it = m->firstRegion(); it != m->lastRegion(); ++it) {
+    if(maxDim < 3) break;
     Msg::Info("Meshing volume %d order %d", (*it)->tag(), order);
     Msg::ProgressMeter(++counter, false, msg);
     if(onlyVisible && !(*it)->getVisibility()) continue;
-    if(getOrder(*it) != order)
-      setHighOrder(*it, edgeVertices, faceVertices, incomplete, nPts);
+    if(getOrder(*it) != order) regions.push_back(*it);
     if((*it)->getColumns() != nullptr) (*it)->getColumns()->clearElementData();
   }
+  setHighOrder(m, regions, edgeVertices, faceVertices, incomplete, nPts);
 
   // store nodes in entities
   m->pruneMeshVertexAssociations();
@@ -13,7 +13,8 @@ class MElement;
 
 void SetOrder1(GModel *m, bool onlyVisible = false, bool skipDiscrete = false);
 void SetOrderN(GModel *m, int order, bool linear = true,
-               bool incomplete = false, bool onlyVisible = false);
+               bool incomplete = false, bool onlyVisible = false,
+               int maxDim = 3);
 void checkHighOrderTriangles(const char *cc, GModel *m,
                              std::vector<MElement *> &bad, double &minJGlob);
 void checkHighOrderTetrahedron(const char *cc, GModel *m,
@@ -198,6 +198,7 @@ public:
 
   virtual bool isotropic() const { return false; }
   const char *getName() { return "AutomaticMeshSizeField"; }
+  bool dependsOnExternalData() const { return true; }
 
   std::string getDescription()
   {
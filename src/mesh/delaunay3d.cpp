@@ -12,6 +12,7 @@
 #include <set>
 #include <stack>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <algorithm>
 #include <cmath>
@@ -1227,14 +1228,14 @@ static void delaunayTriangulation(const int numThreads, const int nptsatonce,
   // print("finalTetrahedrization.pos",0, allocator);
 }
 
-void delaunayTriangulation(const int numThreads, const int nptsatonce,
-                           std::vector<MVertex *> &S,
-                           std::vector<MTetrahedron *> &T, bool removeBox)
+// randomly perturb the vertices in S and tetrahedralize them: the vertices
+// are numbered from 1 in the order of S
+static void perturbAndTriangulate(const int numThreads, const int nptsatonce,
+                                  std::vector<MVertex *> &S,
+                                  std::vector<Vert *> &vertices, Vert *box[8],
+                                  tetContainer &allocator)
 {
-  std::vector<MVertex *> _temp;
-  std::vector<Vert *> _vertices;
   std::size_t N = S.size();
-  _temp.resize(N + 1 + 8);
   double maxx = 0, maxy = 0, maxz = 0;
   for(std::size_t i = 0; i < N; i++) {
     MVertex *mv = S[i];
@@ -1244,8 +1245,6 @@ void delaunayTriangulation(const int numThreads, const int nptsatonce,
   }
   double d = 1 * sqrt(maxx * maxx + maxy * maxy + maxz * maxz);
 
-  tetContainer allocator(numThreads, S.size() * 10);
-
   for(std::size_t i = 0; i < N; i++) {
     MVertex *mv = S[i];
     double dx =
@@ -1258,15 +1257,29 @@ void delaunayTriangulation(const int numThreads, const int nptsatonce,
     mv->y() += dy;
     mv->z() += dz;
     Vert *v = new Vert(mv->x(), mv->y(), mv->z(), 1.e22, i + 1);
-    _vertices.push_back(v);
-    _temp[v->getNum()] = mv;
+    vertices.push_back(v);
   }
 
   robustPredicates::exactinit(maxx, maxy, maxz);
 
-  Vert *box[8];
-  delaunayTriangulation(numThreads, nptsatonce, _vertices, box, allocator);
+  delaunayTriangulation(numThreads, nptsatonce, vertices, box, allocator);
   // print("finalTetrahedrization.pos",0, allocator);
+}
+
+void delaunayTriangulation(const int numThreads, const int nptsatonce,
+                           std::vector<MVertex *> &S,
+                           std::vector<MTetrahedron *> &T, bool removeBox)
+{
+  std::vector<MVertex *> _temp;
+  std::vector<Vert *> _vertices;
+  std::size_t N = S.size();
+  _temp.resize(N + 1 + 8);
+  for(std::size_t i = 0; i < N; i++) _temp[i + 1] = S[i];
+
+  tetContainer allocator(numThreads, S.size() * 10);
+
+  Vert *box[8];
+  perturbAndTriangulate(numThreads, nptsatonce, S, _vertices, box, allocator);
 
   for(int i = 0; i < 8; i++) {
     Vert *v = box[i];
@@ -1302,3 +1315,50 @@ void delaunayTriangulation(const int numThreads, const int nptsatonce,
   for(int i = 0; i < 8; i++) delete box[i];
   for(std::size_t i = 0; i < _vertices.size(); i++) delete _vertices[i];
 }
+
+void delaunayTriangulation(const int numThreads, const int nptsatonce,
+                           std::vector<MVertex *> &S,
+                           std::vector<std::size_t> &tets,
+                           std::vector<long> &neighbors)
+{
+  std::size_t N = S.size();
+  std::vector<Vert *> _vertices;
+  tetContainer allocator(numThreads, S.size() * 10);
+
+  Vert *box[8];
+  perturbAndTriangulate(numThreads, nptsatonce, S, _vertices, box, allocator);
+
+  for(int i = 0; i < 8; i++) {
+    Vert *v = box[i];
+    v->setNum(N + i + 1);
+    S.push_back(new MVertex(v->x(), v->y(), v->z(), nullptr, N + (i + 1)));
+  }
+
+  // number the tetrahedra, so that the adjacencies can be given as indices
+  std::unordered_map<Tet *, long> index;
+  for(int myThread = 0; myThread < numThreads; myThread++) {
+    for(std::size_t i = 0; i < allocator.size(myThread); i++) {
+      Tet *t = allocator(myThread, i);
+      if(t->V[0]) index.insert(std::make_pair(t, (long)index.size()));
+    }
+  }
+
+  tets.resize(4 * index.size());
+  neighbors.resize(4 * index.size());
+  std::size_t k = 0;
+  for(int myThread = 0; myThread < numThreads; myThread++) {
+    for(std::size_t i = 0; i < allocator.size(myThread); i++) {
+      Tet *t = allocator(myThread, i);
+      if(!t->V[0]) continue;
+      for(int j = 0; j < 4; j++, k++) {
+        tets[k] = t->V[j]->getNum() - 1;
+        // the face opposite to vertex j is face (j + 1) % 4 (see getFace)
+        auto it = index.find(t->T[(j + 1) % 4]);
+        neighbors[k] = (it == index.end()) ? -1 : it->second;
+      }
+    }
+  }
+
+  for(int i = 0; i < 8; i++) delete box[i];
+  for(std::size_t i = 0; i < _vertices.size(); i++) delete _vertices[i];
+}
@@ -15,4 +15,12 @@ void delaunayTriangulation(const int numThreads, const int nptsatonce,
                            std::vector<MVertex *> &S,
                            std::vector<MTetrahedron *> &T, bool removeBox);
 
+// same, but returns the tetrahedra as 4 consecutive indices in S (including
+// the 8 vertices of the box), together with the index of the tetrahedron
+// adjacent to the face opposite to each of their vertices (-1 if none)
+void delaunayTriangulation(const int numThreads, const int nptsatonce,
+                           std::vector<MVertex *> &S,
+                           std::vector<std::size_t> &tets,
+                           std::vector<long> &neighbors);
+
 #endif
@@ -0,0 +1,145 @@
+// Gmsh - Copyright (C) 1997-2024 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#ifndef MESH_EXTRUDED_VERTICES_H
+#define MESH_EXTRUDED_VERTICES_H
+
+#include <cmath>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include "MElement.h"
+#include "MVertexRTree.h"
+#include "ExtrudeParams.h"
+#include "GmshMessage.h"
+
+// Nodes of an extruded mesh, indexed by source node (a node of the mesh of the
+// source entity) and by sub-layer (sub-layer 0 being the source entity, and
+// sub-layer l > 0 the top of the l-th element layer). The extruded elements
+// are created by direct lookup in this table, instead of searching for each of
+// their nodes by position in each layer: only the nodes that were not created
+// with the extruded entity (i.e. the nodes on its boundary) are looked up by
+// position, once.
+class extrudedVertices {
+private:
+  ExtrudeParams *_ep;
+  // first sub-layer of each layer
+  std::vector<int> _layerStart;
+  std::vector<MVertex *> _sources;
+  std::unordered_map<MVertex *, std::size_t> _index;
+  // node of source i at sub-layer l: _nodes[l * _sources.size() + i]
+  std::vector<MVertex *> _nodes;
+
+public:
+  extrudedVertices(ExtrudeParams *ep) : _ep(ep)
+  {
+    _layerStart.resize(ep->mesh.NbLayer + 1, 0);
+    for(int j = 0; j < ep->mesh.NbLayer; j++)
+      _layerStart[j + 1] = _layerStart[j] + ep->mesh.NbElmLayer[j];
+  }
+  // add source nodes (before calling allocate())
+  void addSource(MVertex *v)
+  {
+    if(_index.insert(std::make_pair(v, _sources.size())).second)
+      _sources.push_back(v);
+  }
+  template <class T> void addSources(const std::vector<T *> &elements)
+  {
+    for(auto e : elements)
+      for(std::size_t k = 0; k < e->getNumVertices(); k++)
+        addSource(e->getVertex(k));
+  }
+  void allocate()
+  {
+    _nodes.assign((getNumSubLayers() + 1) * _sources.size(), nullptr);
+    std::copy(_sources.begin(), _sources.end(), _nodes.begin());
+  }
+  int getNumSubLayers() const { return _layerStart.back(); }
+  std::size_t getNumSources() const { return _sources.size(); }
+  MVertex *getSource(std::size_t i) const { return _sources[i]; }
+  // index of source node v, or getNumSources() if v is not a source node
+  std::size_t getIndex(MVertex *v) const
+  {
+    auto it = _index.find(v);
+    return it == _index.end() ? _sources.size() : it->second;
+  }
+  int getSubLayer(int j, int k) const { return _layerStart[j] + k; }
+  MVertex *&node(std::size_t i, int l)
+  {
+    return _nodes[l * _sources.size() + i];
+  }
+  // position of the node of source i at sub-layer l
+  void getPosition(std::size_t i, int l, double &x, double &y, double &z) const
+  {
+    x = _sources[i]->x();
+    y = _sources[i]->y();
+    z = _sources[i]->z();
+    if(!l) return;
+    int j = std::upper_bound(_layerStart.begin(), _layerStart.end(), l - 1) -
+            _layerStart.begin() - 1;
+    _ep->Extrude(j, l - _layerStart[j], x, y, z);
+  }
+  // check if the extruded position (x, y, z) of source i coincides with the
+  // source node (e.g. on a rotation axis)
+  bool isDegenerate(std::size_t i, double x, double y, double z,
+                    double tol) const
+  {
+    return std::abs(x - _sources[i]->x()) <= tol &&
+           std::abs(y - _sources[i]->y()) <= tol &&
+           std::abs(z - _sources[i]->z()) <= tol;
+  }
+  // look up by position the nodes that are not defined yet
+  void lookup(MVertexRTree &pos, int nthreads)
+  {
+    const int numSubLayers = getNumSubLayers();
+#pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads)
+    for(std::size_t i = 0; i < _sources.size(); i++) {
+      for(int l = 1; l <= numSubLayers; l++) {
+        MVertex *&v = node(i, l);
+        if(v) continue;
+        double x, y, z;
+        getPosition(i, l, x, y, z);
+        v = pos.find(x, y, z);
+      }
+    }
+  }
+  // indices of the nodes of element ele of the source mesh
+  void getIndices(MElement *ele, std::size_t *idx) const
+  {
+    for(std::size_t p = 0; p < ele->getNumVertices(); p++)
+      idx[p] = getIndex(ele->getVertex(p));
+  }
+  // nodes of element ele of the source mesh (whose node indices are idx) at
+  // the bottom, then at the top of sub-layer k of layer j; returns the number
+  // of nodes found
+  int get(MElement *ele, const std::size_t *idx, int j, int k,
+          std::vector<MVertex *> &verts)
+  {
+    int n = ele->getNumVertices(), l = getSubLayer(j, k);
+    for(int p = 0; p < 2 * n; p++) {
+      MVertex *v =
+        idx[p % n] < _sources.size() ? node(idx[p % n], p < n ? l : l + 1) :
+                                       nullptr;
+      if(v) {
+        verts.push_back(v);
+        continue;
+      }
+      MVertex *s = ele->getVertex(p % n);
+      double x = s->x(), y = s->y(), z = s->z();
+      _ep->Extrude(j, p < n ? k : k + 1, x, y, z);
+      Msg::Error("Could not find extruded vertex (%.16g, %.16g, %.16g)", x, y,
+                 z);
+    }
+    return verts.size();
+  }
+  int get(MElement *ele, int j, int k, std::vector<MVertex *> &verts)
+  {
+    std::size_t idx[8];
+    getIndices(ele, idx);
+    return get(ele, idx, j, k, verts);
+  }
+};
+
+#endif
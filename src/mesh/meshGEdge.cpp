@@ -17,6 +17,7 @@
 #include "STensor3.h"
 #include "Field.h"
 #include "OS.h"
+#include <unordered_map>
 
 typedef struct {
   int Num;
@@ -27,6 +28,36 @@ typedef struct {
   double t, lc, p, xp;
 } IntPoint;
 
+// Compute the primitive at the integration points. Points produced by
+// Integration() come in groups of three equally spaced points (the points 2i,
+// 2i+1 and 2i+2), on which the integrand is interpolated quadratically.
+static double computePrimitive(std::vector<IntPoint> &Points)
+{
+  if(Points.empty()) return 0.;
+  Points[0].p = 0.;
+  if(Points.size() % 2) {
+    for(std::size_t i = 2; i < Points.size(); i += 2) {
+      IntPoint &p0 = Points[i - 2], &p1 = Points[i - 1], &p2 = Points[i];
+      const double h = p2.t - p0.t;
+      const double all = h / 6. * (p0.lc + 4. * p1.lc + p2.lc);
+      double half = h / 24. * (5. * p0.lc + 8. * p1.lc - p2.lc);
+      // keep the primitive monotonic across jumps of the integrand
+      if(half < 0. || half > all)
+        half = all * (p0.lc + p1.lc) / (p0.lc + 2. * p1.lc + p2.lc);
+      p1.p = p0.p + half;
+      p2.p = p0.p + all;
+    }
+  }
+  else {
+    for(std::size_t i = 1; i < Points.size(); i++) {
+      IntPoint &pt2 = Points[i];
+      IntPoint &pt1 = Points[i - 1];
+      pt2.p = pt1.p + (pt2.t - pt1.t) * 0.5 * (pt2.lc + pt1.lc);
+    }
+  }
+  return Points.back().p;
+}
+
 static double smoothPrimitive(GEdge *ge, double alpha,
                               std::vector<IntPoint> &Points)
 {
@@ -69,12 +100,7 @@ static double smoothPrimitive(GEdge *ge, double alpha,
   }
 
   // recompute the primitive
-  for(std::size_t i = 1; i < Points.size(); i++) {
-    IntPoint &pt2 = Points[i];
-    IntPoint &pt1 = Points[i - 1];
-    pt2.p = pt1.p + (pt2.t - pt1.t) * 0.5 * (pt2.lc + pt1.lc);
-  }
-  return Points[Points.size() - 1].p;
+  return computePrimitive(Points);
 }
 
 struct F_LcB {
@@ -85,9 +111,87 @@ struct F_LcB {
   }
 };
 
+// The samples of the mesh size along a curve are cached in the GEdge, in the
+// order in which they are computed. Since the adaptive integration is
+// deterministic, meshing the curve again with the same mesh size parameters
+// requests the same sequence of parameters, which can then be replayed
+// without evaluating the curve nor the mesh size fields. The signature
+// gathers everything the mesh size on the curve depends on; the geometry is
+// stamped with the end points and a few points inside the curve, and the
+// samples are also cleared when the underlying curve is reset (see
+// GEdge::clearMeshSizeSamples()).
+static bool getMeshSizeSignature(GEdge *ge, std::vector<double> &sig)
+{
+  FieldManager *fields = ge->model()->getFields();
+  if(ge->model()->lcCallback || fields->dependsOnExternalData()) return false;
+  Range<double> bounds = ge->parBounds(0);
+  sig = {(double)FieldManager::getRevision(),
+         (double)fields->getBackgroundField(),
+         bounds.low(),
+         bounds.high(),
+         CTX::instance()->lc,
+         CTX::instance()->mesh.lcMin,
+         CTX::instance()->mesh.lcMax,
+         CTX::instance()->mesh.lcFactor,
+         (double)CTX::instance()->mesh.lcFromPoints,
+         (double)CTX::instance()->mesh.lcFromParametricPoints,
+         (double)CTX::instance()->mesh.lcFromCurvature,
+         (double)CTX::instance()->mesh.lcFromCurvatureIso,
+         ge->getMeshSize(),
+         ge->getMeshSizeFactor()};
+  GVertex *gv[2] = {ge->getBeginVertex(), ge->getEndVertex()};
+  for(int i = 0; i < 2; i++) {
+    if(!gv[i]) continue;
+    sig.push_back(gv[i]->x());
+    sig.push_back(gv[i]->y());
+    sig.push_back(gv[i]->z());
+    sig.push_back(gv[i]->prescribedMeshSizeAtVertex());
+    sig.push_back(gv[i]->getMeshSize());
+    sig.push_back(gv[i]->getMeshSizeFactor());
+  }
+  for(int i = 1; i < 4; i++) {
+    double t = bounds.low() + 0.25 * i * (bounds.high() - bounds.low());
+    GPoint p = ge->point(t);
+    sig.push_back(p.x());
+    sig.push_back(p.y());
+    sig.push_back(p.z());
+  }
+  return true;
+}
+
+// Start replaying the cached samples of the curve, after having discarded
+// them if the mesh size parameters have changed. Returns false if the mesh
+// size cannot be cached.
+static bool resetMeshSizeSamples(GEdge *ge)
+{
+  std::vector<double> sig;
+  ge->meshSizeSamples.cursor = 0;
+  if(!getMeshSizeSignature(ge, sig)) {
+    std::vector<std::array<double, 6> >().swap(ge->meshSizeSamples.values);
+    return false;
+  }
+  if(sig != ge->meshSizeSamples.signature) {
+    ge->meshSizeSamples.signature = sig;
+    ge->meshSizeSamples.values.clear();
+  }
+  return true;
+}
+
 struct F_Lc {
+  bool cached;
+  F_Lc(bool c = false) : cached(c) {}
   double operator()(GEdge *ge, double t)
   {
+    auto &samples = ge->meshSizeSamples;
+    if(cached) {
+      if(samples.cursor < samples.values.size() &&
+         samples.values[samples.cursor][0] == t) {
+        const std::array<double, 6> &s = samples.values[samples.cursor++];
+        return s[4] / s[5];
+      }
+      // the sequence diverges: drop the remaining samples
+      samples.values.resize(samples.cursor);
+    }
     GPoint p = ge->point(t);
     Range<double> bounds = ge->parBounds(0);
     double t_begin = bounds.low();
@@ -100,7 +204,12 @@ struct F_Lc {
 
     lc_here = std::min(lc_here, BGM_MeshSize(ge, t, 0, p.x(), p.y(), p.z()));
     SVector3 der = ge->firstDer(t);
-    return norm(der) / lc_here;
+    const double xp = norm(der);
+    if(cached) {
+      samples.values.push_back({t, p.x(), p.y(), p.z(), xp, lc_here});
+      samples.cursor++;
+    }
+    return xp / lc_here;
   }
 };
 
@@ -241,40 +350,47 @@ struct F_One {
   }
 };
 
-static double trapezoidal(IntPoint *const P1, IntPoint *const P2)
+static double simpson(const IntPoint &P1, const IntPoint &P2,
+                      const IntPoint &P3)
 {
-  return 0.5 * (P1->lc + P2->lc) * (P2->t - P1->t);
+  return (P3.t - P1.t) / 6. * (P1.lc + 4. * P2.lc + P3.lc);
 }
 
+// Adaptive Simpson integration on [from, to], with mid the middle of the
+// interval: the interval is accepted when the Simpson rules on the interval
+// and on its two halves agree, and its points (except from) are then added to
+// Points. This needs far fewer evaluations of the integrand (i.e. of the mesh
+// size field) than the trapezoidal rule for the same precision.
 template <typename function>
-static void RecursiveIntegration(GEdge *ge, IntPoint *from, IntPoint *to,
+static void RecursiveIntegration(GEdge *ge, const IntPoint &from,
+                                 const IntPoint &mid, const IntPoint &to,
                                  function f, std::vector<IntPoint> &Points,
                                  double Prec, int *depth)
 {
-  IntPoint P, p1;
+  IntPoint P1, P2;
 
   (*depth)++;
 
-  P.t = 0.5 * (from->t + to->t);
-  P.lc = f(ge, P.t);
-
-  double const val1 = trapezoidal(from, to);
-  double const val2 = trapezoidal(from, &P);
-  double const val3 = trapezoidal(&P, to);
-  double const err = std::abs(val1 - val2 - val3);
-
-  if(((err < Prec) && (*depth > 6)) || (*depth > 25)) {
-    p1 = Points.back();
-    P.p = p1.p + val2;
-    Points.push_back(P);
-
-    p1 = Points.back();
-    to->p = p1.p + val3;
-    Points.push_back(*to);
+  P1.t = 0.5 * (from.t + mid.t);
+  P1.lc = f(ge, P1.t);
+  P2.t = 0.5 * (mid.t + to.t);
+  P2.lc = f(ge, P2.t);
+
+  double const val1 = simpson(from, mid, to);
+  double const val2 = simpson(from, P1, mid);
+  double const val3 = simpson(mid, P2, to);
+  double const err = std::abs(val1 - val2 - val3) / 15.;
+
+  // at least 16 intervals, i.e. 65 points, are used
+  if(((err < Prec) && (*depth > 4)) || (*depth > 25)) {
+    Points.push_back(P1);
+    Points.push_back(mid);
+    Points.push_back(P2);
+    Points.push_back(to);
   }
   else {
-    RecursiveIntegration(ge, from, &P, f, Points, Prec, depth);
-    RecursiveIntegration(ge, &P, to, f, Points, Prec, depth);
+    RecursiveIntegration(ge, from, P1, mid, f, Points, Prec, depth);
+    RecursiveIntegration(ge, mid, P2, to, f, Points, Prec, depth);
   }
 
   (*depth)--;
@@ -284,21 +400,23 @@ template <typename function>
 static double Integration(GEdge *ge, double t1, double t2, function f,
                           std::vector<IntPoint> &Points, double Prec)
 {
-  IntPoint from, to;
+  IntPoint from, mid, to;
 
   int depth = 0;
 
   from.t = t1;
   from.lc = f(ge, from.t);
-  from.p = 0.0;
   Points.push_back(from);
 
   to.t = t2;
   to.lc = f(ge, to.t);
 
-  RecursiveIntegration(ge, &from, &to, f, Points, Prec, &depth);
+  mid.t = 0.5 * (t1 + t2);
+  mid.lc = f(ge, mid.t);
 
-  return Points.back().p;
+  RecursiveIntegration(ge, from, mid, to, f, Points, Prec, &depth);
+
+  return computePrimitive(Points);
 }
 
 static SPoint3 transform(MVertex *vsource, const std::vector<double> &tfo)
@@ -659,7 +777,7 @@ int meshGEdgeProcessing(GEdge *ge, const double t_begin, double t_end, int &N,
           ge->meshAttributes.typeTransfinite == 4) {
     // Transfinite (prescribed number of edges) but the points are positioned
     // according to the standard size constraints (size map, etc)
-    a = Integration(ge, t_begin, t_end, F_Lc(), Points,
+    a = Integration(ge, t_begin, t_end, F_Lc(resetMeshSizeSamples(ge)), Points,
                     CTX::instance()->mesh.lcIntegrationPrecision);
     N = ge->meshAttributes.nbPointsTransfinite;
   }
@@ -672,20 +790,35 @@ int meshGEdgeProcessing(GEdge *ge, const double t_begin, double t_end, int &N,
       N /= CTX::instance()->mesh.lcFactor;
   }
   else {
+    bool cached = false;
     if(CTX::instance()->mesh.algo2d == ALGO_2D_BAMG /* || blf*/) {
       a = Integration(ge, t_begin, t_end, F_Lc_aniso(), Points,
                       CTX::instance()->mesh.lcIntegrationPrecision);
     }
     else {
-      a = Integration(ge, t_begin, t_end, F_Lc(), Points,
+      cached = resetMeshSizeSamples(ge);
+      a = Integration(ge, t_begin, t_end, F_Lc(cached), Points,
                       CTX::instance()->mesh.lcIntegrationPrecision);
     }
 
+    // norm of the tangent vector, from the cached samples if available
+    std::unordered_map<double, double> xp;
+    if(cached) {
+      for(std::size_t i = 0; i < ge->meshSizeSamples.cursor; i++) {
+        const std::array<double, 6> &s = ge->meshSizeSamples.values[i];
+        xp[s[0]] = s[4];
+      }
+    }
     // we should maybe provide an option to disable the smoothing
     for(std::size_t i = 0; i < Points.size(); i++) {
       IntPoint &pt = Points[i];
-      SVector3 der = ge->firstDer(pt.t);
-      pt.xp = der.norm();
+      auto it = xp.find(pt.t);
+      if(it != xp.end())
+        pt.xp = it->second;
+      else {
+        SVector3 der = ge->firstDer(pt.t);
+        pt.xp = der.norm();
+      }
     }
     if(CTX::instance()->mesh.algo2d != ALGO_2D_BAMG)
       a = smoothPrimitive(ge, std::sqrt(CTX::instance()->mesh.smoothRatio),
@@ -21,6 +21,7 @@
 #include "BDS.h"
 #include "qualityMeasures.h"
 #include "OS.h"
+#include "Profiler.h"
 #include "robustPredicates.h"
 
 static void getDegeneratedVertices(
@@ -116,8 +117,30 @@ static double correctLC_(BDS_Point *p1, BDS_Point *p2, GFace *f)
 
 static double NewGetLc(BDS_Edge *const edge, GFace *const face)
 {
-  return computeEdgeLinearLength(edge, face) /
-         correctLC_(edge->p1, edge->p2, face);
+  double l;
+  if(edge->getCachedLc(l)) return l;
+  l = computeEdgeLinearLength(edge, face) /
+      correctLC_(edge->p1, edge->p2, face);
+  edge->setCachedLc(l);
+  return l;
+}
+
+// compute the length (in the mesh size field) of the edges of the surface mesh
+// whose nodes have been modified since the length was last computed, in
+// parallel if requested
+static void updateEdgeLengths(GFace *gf, BDS_Mesh &m)
+{
+  int nthreads = CTX::instance()->mesh.maxNumThreadsMeshAdapt;
+  if(nthreads <= 1) return;
+  std::vector<BDS_Edge *> edges;
+  for(auto it = m.edges.begin(); it != m.edges.end(); ++it) {
+    double l;
+    if(!(*it)->deleted && (*it)->numfaces() == 2 && (*it)->g &&
+       (*it)->g->classif_degree == 2 && !(*it)->getCachedLc(l))
+      edges.push_back(*it);
+  }
+#pragma omp parallel for schedule(dynamic, 64) num_threads(nthreads)
+  for(std::size_t i = 0; i < edges.size(); i++) NewGetLc(edges[i], gf);
 }
 
 // SWAP TESTS i.e. tell if swap should be done
@@ -411,6 +434,8 @@ static void splitEdgePass(GFace *gf, BDS_Mesh &m, double MAXE_, int &nb_split,
   SPoint2 out(gf->parBounds(0).high() + 1.21982512,
               gf->parBounds(1).high() + 1.8635436432);
 
+  updateEdgeLengths(gf, m);
+
   for(auto it = m.points.begin(); it != m.points.end(); ++it) {
     BDS_Point *p = *it;
     if(!p->_periodicCounterpart && (p->g && p->g->classif_degree == 2)) {
@@ -534,6 +559,7 @@ void collapseEdgePass(GFace *gf, BDS_Mesh &m, double MINE_, int MAXNP,
 {
   double t1 = Cpu();
   std::vector<std::pair<double, BDS_Edge *> > edges;
+  updateEdgeLengths(gf, m);
   auto it = m.edges.begin();
   while(it != m.edges.end()) {
     if(!(*it)->deleted && (*it)->numfaces() == 2 && (*it)->g &&
@@ -761,6 +787,8 @@ void refineMeshBDS(GFace *gf, BDS_Mesh &m, const int NIT,
 
   const double MINE_ = 0.7, MAXE_ = 1.4;
 
+  // the lengths of the edges in the mesh size field are cached during the
+  // refinement, and only recomputed for the edges whose nodes are modified
   {
     auto it = m.edges.begin();
     while(it != m.edges.end()) {
@@ -768,6 +796,7 @@ void refineMeshBDS(GFace *gf, BDS_Mesh &m, const int NIT,
         (*it)->p1->config_modified = true;
         (*it)->p2->config_modified = true;
       }
+      (*it)->clearCachedLc();
       ++it;
     }
   }
@@ -856,6 +885,11 @@ void refineMeshBDS(GFace *gf, BDS_Mesh &m, const int NIT,
 
     m.cleanup();
 
+    Profiler::count("Splits", nb_split);
+    Profiler::count("Swaps", nb_swap);
+    Profiler::count("Collapses", nb_collaps);
+    Profiler::count("Moves", nb_smooth);
+
     double minL = 1.e22, maxL = 0;
     auto it = m.edges.begin();
     int LARGE = 0, SMALL = 0, TOTAL = 0;
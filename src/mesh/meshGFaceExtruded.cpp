@@ -4,6 +4,7 @@
 // Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
 #include <set>
+#include <unordered_map>
 #include "GmshConfig.h"
 #include "GModel.h"
 #include "MLine.h"
@@ -11,6 +12,7 @@
 #include "MQuadrangle.h"
 #include "ExtrudeParams.h"
 #include "MVertexRTree.h"
+#include "meshExtrudedVertices.h"
 #include "Context.h"
 #include "GmshMessage.h"
 
@@ -88,43 +90,57 @@ extrudeMesh(GEdge *from, GFace *to, MVertexRTree &pos,
 {
   ExtrudeParams *ep = to->meshAttributes.extrude;
 
-  // create vertices (if the edges are constrained, they already exist)
+  // the nodes of all the sub-layers, indexed by source node
+  extrudedVertices ev(ep);
+  ev.addSources(from->lines);
+  for(auto v : from->mesh_vertices) ev.addSource(v);
+  ev.allocate();
+  const int numSubLayers = ev.getNumSubLayers();
+
+  // create vertices (if the edges are constrained, they already exist); they
+  // are only shared with their source node if they coincide (e.g. on a
+  // rotation axis)
   if(!constrainedEdges) {
+    const double tol = CTX::instance()->geom.tolerance * CTX::instance()->lc;
     for(std::size_t i = 0; i < from->mesh_vertices.size(); i++) {
       std::vector<MVertex *> extruded_vertices;
       MVertex *v = from->mesh_vertices[i];
-      MEdgeVertex *mv = dynamic_cast<MEdgeVertex *>(v);
-      if(mv) mv->bl_data = new MVertexBoundaryLayerData();
-      for(int j = 0; j < ep->mesh.NbLayer; j++) {
-        for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
-          double x = v->x(), y = v->y(), z = v->z();
-          ep->Extrude(j, k + 1, x, y, z);
-          if(j != ep->mesh.NbLayer - 1 || k != ep->mesh.NbElmLayer[j] - 1) {
-            MVertex *newv = pos.find(x, y, z);
-            if(!newv) {
-              if(from->geomType() != GEntity::DiscreteCurve &&
-                 to->geomType() != GEntity::DiscreteSurface &&
-                 to->geomType() != GEntity::BoundaryLayerSurface) {
-                // This can be inefficient, and sometimes useless. We could add
-                // an option to disable it.
-                SPoint3 xyz(x, y, z);
-                SPoint2 uv = to->parFromPoint(xyz);
-                newv = new MFaceVertex(x, y, z, to, uv[0], uv[1]);
-              }
-              else {
-                newv = new MVertex(x, y, z, to);
-              }
-              to->mesh_vertices.push_back(newv);
-            }
-            pos.insert(newv);
-            extruded_vertices.push_back(newv);
+      std::size_t idx = ev.getIndex(v);
+      for(int l = 1; l < numSubLayers; l++) {
+        double x, y, z;
+        ev.getPosition(idx, l, x, y, z);
+        MVertex *newv = v;
+        if(!ev.isDegenerate(idx, x, y, z, tol)) {
+          if(from->geomType() != GEntity::DiscreteCurve &&
+             to->geomType() != GEntity::DiscreteSurface &&
+             to->geomType() != GEntity::BoundaryLayerSurface) {
+            // This can be inefficient, and sometimes useless. We could add
+            // an option to disable it.
+            SPoint3 xyz(x, y, z);
+            SPoint2 uv = to->parFromPoint(xyz);
+            newv = new MFaceVertex(x, y, z, to, uv[0], uv[1]);
           }
+          else {
+            newv = new MVertex(x, y, z, to);
+          }
+          to->mesh_vertices.push_back(newv);
         }
+        ev.node(idx, l) = newv;
+        extruded_vertices.push_back(newv);
+      }
+      // the source curve can be extruded into several surfaces in parallel
+      MEdgeVertex *mv = dynamic_cast<MEdgeVertex *>(v);
+#pragma omp critical(extrudeBoundaryLayerData)
+      if(mv) {
+        if(!mv->bl_data) mv->bl_data = new MVertexBoundaryLayerData();
+        mv->bl_data->addChildrenFamily(extruded_vertices);
       }
-      if(mv) mv->bl_data->addChildrenFamily(extruded_vertices);
     }
   }
 
+  // look up the other nodes (on the boundary of the surface)
+  ev.lookup(pos, 1);
+
   int tri_quad_flag = 0;
 
 #if defined(HAVE_QUADTRI)
@@ -141,31 +157,16 @@ extrudeMesh(GEdge *from, GFace *to, MVertexRTree &pos,
                to->tag());
 #endif
 
-  // create elements (note that it would be faster to access the *interior*
-  // nodes by direct indexing, but it's just simpler to query everything by
-  // position)
+  // create elements
   for(std::size_t i = 0; i < from->lines.size(); i++) {
-    MVertex *v0 = from->lines[i]->getVertex(0);
-    MVertex *v1 = from->lines[i]->getVertex(1);
+    std::size_t idx[2];
+    ev.getIndices(from->lines[i], idx);
     for(int j = 0; j < ep->mesh.NbLayer; j++) {
       for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
         std::vector<MVertex *> verts;
-        double x[4] = {v0->x(), v1->x(), v0->x(), v1->x()};
-        double y[4] = {v0->y(), v1->y(), v0->y(), v1->y()};
-        double z[4] = {v0->z(), v1->z(), v0->z(), v1->z()};
-        for(int p = 0; p < 2; p++) {
-          ep->Extrude(j, k, x[p], y[p], z[p]);
-          ep->Extrude(j, k + 1, x[p + 2], y[p + 2], z[p + 2]);
-        }
-        for(int p = 0; p < 4; p++) {
-          MVertex *tmp = pos.find(x[p], y[p], z[p]);
-          if(!tmp) {
-            Msg::Error("Could not find extruded node (%.16g, %.16g, %.16g) "
-                       "in surface %d",
-                       x[p], y[p], z[p], to->tag());
-            return;
-          }
-          verts.push_back(tmp);
+        if(ev.get(from->lines[i], idx, j, k, verts) != 4) {
+          Msg::Error("Missing extruded nodes in surface %d", to->tag());
+          return;
         }
         createQuaTri(verts, to, constrainedEdges, from->lines[i],
                      tri_quad_flag);
@@ -185,7 +186,9 @@ static void copyMesh(GFace *from, GFace *to, MVertexRTree &pos)
   std::vector<MVertex *> embedded = from->getEmbeddedMeshVertices();
   mesh_vertices.insert(mesh_vertices.end(), embedded.begin(), embedded.end());
 
-  // create extruded vertices
+  // create extruded vertices, and store the correspondence between the nodes
+  // of the source and of the copy
+  std::unordered_map<MVertex *, MVertex *> copies;
   for(std::size_t i = 0; i < mesh_vertices.size(); i++) {
     MVertex *v = mesh_vertices[i];
     double x = v->x(), y = v->y(), z = v->z();
@@ -205,6 +208,7 @@ static void copyMesh(GFace *from, GFace *to, MVertexRTree &pos)
       to->mesh_vertices.push_back(newv);
       pos.insert(newv);
     }
+    copies[v] = newv;
   }
 
 #if defined(HAVE_QUADTRI)
@@ -237,11 +241,12 @@ static void copyMesh(GFace *from, GFace *to, MVertexRTree &pos)
   }
 #endif
 
-  // create triangle elements
-  for(std::size_t i = 0; i < from->triangles.size(); i++) {
-    std::vector<MVertex *> verts;
-    for(int j = 0; j < 3; j++) {
-      MVertex *v = from->triangles[i]->getVertex(j);
+  // the nodes on the boundary are only looked up once
+  for(std::size_t i = 0; i < from->getNumMeshElements(); i++) {
+    MElement *e = from->getMeshElement(i);
+    for(std::size_t j = 0; j < e->getNumVertices(); j++) {
+      MVertex *v = e->getVertex(j);
+      if(copies.count(v)) continue;
       double x = v->x(), y = v->y(), z = v->z();
       ep->Extrude(ep->mesh.NbLayer - 1,
                   ep->mesh.NbElmLayer[ep->mesh.NbLayer - 1], x, y, z);
@@ -252,8 +257,15 @@ static void copyMesh(GFace *from, GFace *to, MVertexRTree &pos)
           y, z, to->tag());
         return;
       }
-      verts.push_back(tmp);
+      copies[v] = tmp;
     }
+  }
+
+  // create triangle elements
+  for(std::size_t i = 0; i < from->triangles.size(); i++) {
+    std::vector<MVertex *> verts;
+    for(int j = 0; j < 3; j++)
+      verts.push_back(copies[from->triangles[i]->getVertex(j)]);
     addTriangle(verts[0], verts[1], verts[2], to);
   }
 
@@ -270,20 +282,8 @@ static void copyMesh(GFace *from, GFace *to, MVertexRTree &pos)
   // create quadrangle elements if NOT QuadToTri and NOT toroidal
   for(std::size_t i = 0; i < from->quadrangles.size(); i++) {
     std::vector<MVertex *> verts;
-    for(int j = 0; j < 4; j++) {
-      MVertex *v = from->quadrangles[i]->getVertex(j);
-      double x = v->x(), y = v->y(), z = v->z();
-      ep->Extrude(ep->mesh.NbLayer - 1,
-                  ep->mesh.NbElmLayer[ep->mesh.NbLayer - 1], x, y, z);
-      MVertex *tmp = pos.find(x, y, z);
-      if(!tmp) {
-        Msg::Error(
-          "Could not find extruded node (%.16g, %.16g, %.16g) in surface %d", x,
-          y, z, to->tag());
-        return;
-      }
-      verts.push_back(tmp);
-    }
+    for(int j = 0; j < 4; j++)
+      verts.push_back(copies[from->quadrangles[i]->getVertex(j)]);
     addQuadrangle(verts[0], verts[1], verts[2], verts[3], to);
   }
 }
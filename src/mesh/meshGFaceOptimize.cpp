@@ -1295,18 +1295,18 @@ static double printStats(GFace *gf, const char *message)
 // model exists. When reading multi-surface STL files for example, if
 // CreateTopology or ReclassifySurfaces is not called, quads can have nodes
 // owned by an adjacent surface. Since the topological optimization routines
-// remove nodes, this will produce an invalide model mesh (and crash).
-static bool _isModelOkForTopologicalOpti(GModel *m)
+// remove nodes, this will produce an invalide model mesh (and crash). Only the
+// elements of gf are checked, so that surfaces can be recombined in parallel:
+// when recombining existing meshes, the check should be performed on all the
+// surfaces beforehand (see RecombineMesh).
+bool isMeshOkForTopologicalOpti(GFace *gf)
 {
-  for(auto it = m->firstFace(); it != m->lastFace(); it++) {
-    GFace *gf = *it;
-    for(std::size_t j = 0; j < gf->getNumMeshElements(); j++) {
-      MElement *e = gf->getMeshElement(j);
-      for(std::size_t k = 0; k < e->getNumVertices(); k++) {
-        GEntity *ge = e->getVertex(k)->onWhat();
-        if(!ge) return false;
-        if(ge->dim() == 2 && ge != gf) return false;
-      }
+  for(std::size_t j = 0; j < gf->getNumMeshElements(); j++) {
+    MElement *e = gf->getMeshElement(j);
+    for(std::size_t k = 0; k < e->getNumVertices(); k++) {
+      GEntity *ge = e->getVertex(k)->onWhat();
+      if(!ge) return false;
+      if(ge->dim() == 2 && ge != gf) return false;
     }
   }
   return true;
@@ -1331,28 +1331,24 @@ void recombineIntoQuads(GFace *gf, bool blossom, int topologicalOptiPasses,
     if(debug) gf->model()->writeMSH("recombine_2smoothed.msh");
   }
 
-// FIXME: not thread-safe
-#pragma omp critical
-  {
-    if(topologicalOptiPasses > 0) {
-      if(!_isModelOkForTopologicalOpti(gf->model())) {
-        Msg::Info
-          ("Skipping topological optimization - mesh topology is not complete");
-      }
-      else {
-        int iter = 0, nbTwoQuadNodes = 1, nbDiamonds = 1;
-        while(nbTwoQuadNodes || nbDiamonds) {
-          Msg::Debug("Topological optimization of quad mesh: pass %d", iter);
-          nbTwoQuadNodes = removeTwoQuadsNodes(gf);
-          // removeDiamonds uses the parametrization or searches for closest point
-          nbDiamonds = haveParam ? removeDiamonds(gf) : 0;
-          if(haveParam && nodeRepositioning)
-            RelocateVertices(gf, CTX::instance()->mesh.nbSmoothing);
-          iter++;
-          if(iter > topologicalOptiPasses) break;
-        }
-        if(debug) gf->model()->writeMSH("recombine_3topo.msh");
+  if(topologicalOptiPasses > 0) {
+    if(!isMeshOkForTopologicalOpti(gf)) {
+      Msg::Info
+        ("Skipping topological optimization - mesh topology is not complete");
+    }
+    else {
+      int iter = 0, nbTwoQuadNodes = 1, nbDiamonds = 1;
+      while(nbTwoQuadNodes || nbDiamonds) {
+        Msg::Debug("Topological optimization of quad mesh: pass %d", iter);
+        nbTwoQuadNodes = removeTwoQuadsNodes(gf);
+        // removeDiamonds uses the parametrization or searches for closest point
+        nbDiamonds = haveParam ? removeDiamonds(gf) : 0;
+        if(haveParam && nodeRepositioning)
+          RelocateVertices(gf, CTX::instance()->mesh.nbSmoothing);
+        iter++;
+        if(iter > topologicalOptiPasses) break;
       }
+      if(debug) gf->model()->writeMSH("recombine_3topo.msh");
     }
   }
 
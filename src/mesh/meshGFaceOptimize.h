@@ -66,6 +66,7 @@ void transferDataStructure(GFace *gf,
 void computeEquivalences(GFace *gf, bidimMeshData &DATA);
 void recombineIntoQuads(GFace *gf, bool blossom, int topologicalOptiPasses,
                         bool nodeRepositioning, double minqual);
+bool isMeshOkForTopologicalOpti(GFace *gf);
 
 // used for meshGFaceRecombine development
 void quadsToTriangles(GFace *gf, double minqual);
@@ -29,6 +29,7 @@
 #include "ExtrudeParams.h"
 #include "OS.h"
 #include "Context.h"
+#include "Profiler.h"
 
 void splitQuadRecovery::add(const MFace &f, MVertex *v, GFace *gf)
 {
@@ -148,7 +149,11 @@ void MeshDelaunayVolume(std::vector<GRegion *> &regions)
   gr->embeddedVertices() = allEmbVertices;
 
   splitQuadRecovery sqr;
-  bool success = meshGRegionBoundaryRecovery(gr, &sqr);
+  bool success;
+  {
+    ProfileScope scope("Boundary recovery");
+    success = meshGRegionBoundaryRecovery(gr, &sqr);
+  }
 
   // sort triangles in all model faces in order to be able to search in vectors
   auto itf = allFaces.begin();
@@ -187,6 +192,7 @@ void MeshDelaunayVolume(std::vector<GRegion *> &regions)
   }
   else if(CTX::instance()->mesh.algo3d != ALGO_3D_INITIAL_ONLY &&
 	  CTX::instance()->mesh.algo3d != ALGO_3D_RTREE) {
+    ProfileScope scope("Insertion");
     insertVerticesInRegion(gr, CTX::instance()->mesh.maxIterDelaunay3D, 1.,
                            true, &sqr);
 
@@ -14,6 +14,7 @@
 
 #include "meshGRegion.h"
 #include "meshGRegionDelaunayInsertion.h"
+#include "delaunay3d.h"
 #include "robustPredicates.h"
 #include "GModel.h"
 #include "GRegion.h"
@@ -26,6 +27,7 @@
 #include "MTetrahedron.h"
 #include "Context.h"
 #include "OS.h"
+#include "Profiler.h"
 #if !defined(HAVE_NO_STDINT_H)
 #include <stdint.h>
 #elif defined(HAVE_NO_INTPTR_T)
@@ -219,10 +221,20 @@ namespace tetgenBR {
       originalCoordinates[v] = v->point();
     }
 
-    std::vector<MTetrahedron *> tets;
-
-    delaunayMeshIn3D(_vertices,
-                     tets); // will add 8 MVertices at the end of _vertices
+    // the tetrahedra are directly returned as indices in _vertices, with their
+    // adjacencies, which avoids creating temporary MTetrahedra and searching
+    // for the common faces
+    std::vector<std::size_t> tets;
+    std::vector<long> neighbors;
+    {
+      Msg::Info("Tetrahedrizing %d nodes...", _vertices.size());
+      double t1 = Cpu(), w1 = TimeOfDay();
+      // will add 8 MVertices at the end of _vertices
+      delaunayTriangulation(1, 1, _vertices, tets, neighbors);
+      double t2 = Cpu(), w2 = TimeOfDay();
+      Msg::Info("Done tetrahedrizing %d nodes (Wall %gs, CPU %gs)",
+                _vertices.size(), w2 - w1, t2 - t1);
+    }
     if(Msg::GetErrorCount()) return 0;
 
     Msg::Debug("Points have been tetrahedralized");
@@ -281,67 +293,24 @@ namespace tetgenBR {
     }
 
     {
-      tetrahedron *ver2tetarray;
-      triface tetloop, checktet, prevchktet;
-      triface hulltet, face1, face2;
+      triface tetloop, hulltet, face1, face2;
       tetrahedron tptr;
       point p[4], q[3];
-      REAL ori; //, attrib, volume;
-      int bondflag;
+      REAL ori;
       int t1ver;
-      int idx, k;
 
       Msg::Info("Reconstructing mesh...");
 
-      // Allocate an array that maps each vertex to its adjacent tets.
-      ver2tetarray = new tetrahedron[_vertices.size() + in->firstnumber];
       for(std::size_t i = 0; i < _vertices.size() + in->firstnumber; i++) {
         setpointtype(idx2verlist[i], VOLVERTEX); // initial type.
-        ver2tetarray[i] = nullptr;
-      }
-
-#if 0
-      /*  N E W   V E R S I O N	  */
-      std::vector<triface> ts( tets.size() );
-      for(std::size_t i = 0; i < tets.size(); i++) {
-	point p[4];
-	// index tetrahedra in order to have access to neighbors ids.
-	tets[i]->tet()->forceNum(i+1);
-	p[0] = idx2verlist[tets[i]->getVertex(0)->getIndex()];
-	p[1] = idx2verlist[tets[i]->getVertex(1)->getIndex()];
-	p[2] = idx2verlist[tets[i]->getVertex(2)->getIndex()];
-	p[3] = idx2verlist[tets[i]->getVertex(3)->getIndex()];
-	setvertices(ts[i], p[0], p[1], p[2], p[3]);
-      }
-          // we can make this in parallel, iterations are totally independent
-      for (uint64_t i = 0; i < tets.size(); i++) {
-	triface tf1 = ts[i];
-
-	for (tf1.ver=0; tf1.ver<4; tf1.ver++){
-	  uint64_t neigh = tets[i]->getNeigh(tf1.ver)->tet()->getNum() - 1;
-	  triface tf2 = ts[neigh];
-	  int iface2 = tf1.ver;
-
-	  int face2[3] = {
-	    tets[i]->getVertex(faces_tetra(tf1.ver),0)->getIndex(),
-	    tets[i]->getVertex(faces_tetra(tf1.ver),1)->getIndex(),
-	    tets[i]->getVertex(faces_tetra(tf1.ver),2)->getIndex()};
-
-	  tf2.ver = computeTetGenVersion2(faces2[0], face2, iface2);
-	  bond(tf1,tf2);
-	}
       }
 
-#else
-
-      /*  N E W   V E R S I O N	  */
-
-      // Create the tetrahedra and connect those that share a common face.
-      for(std::size_t i = 0; i < tets.size(); i++) {
+      // Create the tetrahedra.
+      std::size_t numTets = tets.size() / 4;
+      std::vector<tetrahedron *> tetlist(numTets);
+      for(std::size_t i = 0; i < numTets; i++) {
         // Get the four vertices.
-        for(int j = 0; j < 4; j++) {
-          p[j] = idx2verlist[tets[i]->getVertex(j)->getIndex()];
-        }
+        for(int j = 0; j < 4; j++) { p[j] = idx2verlist[tets[4 * i + j] + 1]; }
         // Check the orientation.
         ori = orient3d(p[0], p[1], p[2], p[3]);
         if(ori > 0.0) {
@@ -358,81 +327,47 @@ namespace tetgenBR {
         // Create a new tetrahedron.
         maketetrahedron(&tetloop); // tetloop.ver = 11.
         setvertices(tetloop, p[0], p[1], p[2], p[3]);
-        // Try connecting this tet to others that share the common faces.
-        for(tetloop.ver = 0; tetloop.ver < 4; tetloop.ver++) {
-          p[3] = oppo(tetloop);
-          // Look for other tets having this vertex.
-          idx = pointmark(p[3]) - in->firstnumber;
-          tptr = ver2tetarray[idx];
-          // Link the current tet to the next one in the stack.
-          tetloop.tet[8 + tetloop.ver] = tptr;
-          // Push the current tet onto the stack.
-          ver2tetarray[idx] = encode(tetloop);
-          decode(tptr, checktet);
-          if(checktet.tet != nullptr) {
-            p[0] = org(tetloop); // a
-            p[1] = dest(tetloop); // b
-            p[2] = apex(tetloop); // c
-            prevchktet = tetloop;
-            do {
-              q[0] = org(checktet); // a'
-              q[1] = dest(checktet); // b'
-              q[2] = apex(checktet); // c'
-              // Check the three faces at 'd' in 'checktet'.
-              bondflag = 0;
-              for(int j = 0; j < 3; j++) {
-                // Go to the face [b',a',d], or [c',b',d], or [a',c',d].
-                esym(checktet, face2);
-                if(face2.tet[face2.ver & 3] == nullptr) {
-                  k = ((j + 1) % 3);
-                  if(q[k] == p[0]) { // b', c', a' = a
-                    if(q[j] == p[1]) { // a', b', c' = b
-                      // [#,#,d] is matched to [b,a,d].
-                      esym(tetloop, face1);
-                      bond(face1, face2);
-                      bondflag++;
-                    }
-                  }
-                  if(q[k] == p[1]) { // b',c',a' = b
-                    if(q[j] == p[2]) { // a',b',c' = c
-                      // [#,#,d] is matched to [c,b,d].
-                      enext(tetloop, face1);
-                      esymself(face1);
-                      bond(face1, face2);
-                      bondflag++;
-                    }
-                  }
-                  if(q[k] == p[2]) { // b',c',a' = c
-                    if(q[j] == p[0]) { // a',b',c' = a
-                      // [#,#,d] is matched to [a,c,d].
-                      eprev(tetloop, face1);
-                      esymself(face1);
-                      bond(face1, face2);
-                      bondflag++;
-                    }
-                  }
-                }
-                else {
-                  bondflag++;
-                }
-                enextself(checktet);
-              } // j
-              // Go to the next tet in the link.
-              tptr = checktet.tet[8 + checktet.ver];
-              if(bondflag == 3) {
-                // All three faces at d in 'checktet' have been connected.
-                // It can be removed from the link.
-                prevchktet.tet[8 + prevchktet.ver] = tptr;
-              }
-              else {
-                // Bakup the previous tet in the link.
-                prevchktet = checktet;
-              }
-              decode(tptr, checktet);
-            } while(checktet.tet != nullptr);
-          } // if(checktet.tet != nullptr)
-        } // for(tetloop.ver = 0; ...
-      } // i
+        tetlist[i] = tetloop.tet;
+      }
+
+      // Connect the tetrahedra that share a common face, using the adjacencies
+      // of the Delaunay triangulation. Each tetrahedron only sets its own
+      // links, so this can be done in parallel.
+      int nthreads = CTX::instance()->numThreads;
+      if(!nthreads) nthreads = Msg::GetMaxThreads();
+      bool inconsistent = false;
+#pragma omp parallel for num_threads(nthreads)
+      for(std::size_t i = 0; i < numTets; i++) {
+        triface t1, t2;
+        t1.tet = tetlist[i];
+        for(t1.ver = 0; t1.ver < 4; t1.ver++) {
+          point d = oppo(t1);
+          long n = -1;
+          for(int j = 0; j < 4; j++) {
+            if(idx2verlist[tets[4 * i + j] + 1] == d) n = neighbors[4 * i + j];
+          }
+          if(n < 0) continue;
+          // Find the version of the face [b,a,c] in the adjacent tet.
+          t2.tet = tetlist[n];
+          for(t2.ver = 0; t2.ver < 12; t2.ver++) {
+            if(org(t2) == dest(t1) && dest(t2) == org(t1) &&
+               apex(t2) == apex(t1))
+              break;
+          }
+          if(t2.ver == 12) {
+            inconsistent = true;
+            continue;
+          }
+          t1.tet[t1.ver & 3] = encode2(t2.tet, bondtbl[t1.ver][t2.ver]);
+        }
+      }
+      if(inconsistent) {
+        Msg::Error("Inconsistent adjacencies in initial tetrahedralization");
+        delete[] idx2verlist;
+        return 0;
+      }
+      tets.clear(); // Release all memory in these vectors.
+      neighbors.clear();
 
       // Remember a tet of the mesh.
       recenttet = tetloop;
@@ -475,19 +410,12 @@ namespace tetgenBR {
           }
           // Create the point-to-tet map.
           setpoint2tet((point)(tetloop.tet[4 + tetloop.ver]), tptr);
-          // Clean the temporary used space.
-          tetloop.tet[8 + tetloop.ver] = nullptr;
         }
         tetloop.tet = tetrahedrontraverse();
       }
 
       hullsize = tetrahedrons->items - hullsize;
-
-      delete[] ver2tetarray;
-      for(std::size_t i = 0; i < tets.size(); i++) delete tets[i];
-      tets.clear(); // Release all memory in this vector.
     }
-#endif
 
       std::vector<GFace *> const &f_list = _gr->faces();
       std::vector<GEdge *> const &e_list = _gr->embeddedEdges();
@@ -651,10 +579,15 @@ namespace tetgenBR {
 
       delete[] idx2verlist;
 
-      // Boundary recovery.
+      // Boundary recovery. Only the construction of the initial TetGen mesh
+      // above is done in parallel: the recovery of the missing segments and
+      // faces still works on the TetGen pools, one constraint at a time, as
+      // the flip queues and the Steiner point insertion are global to the
+      // mesh.
 
       clock_t t;
       Msg::Info(" - Recovering boundary");
+      double t_rec = Cpu(), w_rec = TimeOfDay();
       recoverboundary(t);
 
       carveholes();
@@ -666,6 +599,19 @@ namespace tetgenBR {
       // let's try
       optimizemesh();
 
+      {
+        long flips = flip23count + flip32count + flip44count + flip41count +
+                     flip31count + flip22count;
+        long steiner = st_segref_count + st_facref_count + st_volref_count;
+        Msg::Info(" - Done recovering boundary: %ld flips, %ld Steiner points "
+                  "(%ld on curves, %ld on surfaces, %ld in volume) "
+                  "(Wall %gs, CPU %gs)", flips, steiner, st_segref_count,
+                  st_facref_count, st_volref_count, TimeOfDay() - w_rec,
+                  Cpu() - t_rec);
+        Profiler::count("Flips", flips);
+        Profiler::count("Steiner points", steiner);
+      }
+
       if((dupverts > 0l) || (unuverts > 0l)) {
         // Remove hanging nodes.
         // cannot call this here due to 8 additional exterior vertices we
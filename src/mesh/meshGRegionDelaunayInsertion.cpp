@@ -10,6 +10,7 @@
 #include "GmshMessage.h"
 #include "robustPredicates.h"
 #include "OS.h"
+#include "Profiler.h"
 #include "meshGRegion.h"
 #include "meshGRegionLocalMeshMod.h"
 #include "meshGRegionDelaunayInsertion.h"
@@ -1525,6 +1526,8 @@ void insertVerticesInRegion(GRegion *gr, int maxIter,
   Msg::Info(" - %d nodes could not be inserted", COUNT_MISS);
   Msg::Info(" - %d tetrahedra created in %g sec. (%d tets/s)", allTets.size(),
             dt, (int)(allTets.size() / dt));
+  Profiler::count("Insertions", REALCOUNT);
+  Profiler::count("Rejected insertions", COUNT_MISS);
 
   // relocate vertices
   int nbReloc = 0;
@@ -1541,6 +1544,7 @@ void insertVerticesInRegion(GRegion *gr, int maxIter,
   }
 
   Msg::Info("%d node relocations", nbReloc);
+  Profiler::count("Relocations", nbReloc);
 
   while(1) {
     if(allTets.begin() == allTets.end()) break;
@@ -18,6 +18,7 @@
 #include "meshGRegion.h"
 #include "Context.h"
 #include "MVertexRTree.h"
+#include "meshExtrudedVertices.h"
 
 #if defined(HAVE_QUADTRI)
 #include "QuadTriExtruded3D.h"
@@ -29,27 +30,12 @@ static void addTetrahedron(MVertex *v1, MVertex *v2, MVertex *v3, MVertex *v4,
   to->tetrahedra.push_back(new MTetrahedron(v1, v2, v3, v4));
 }
 
-static void addPyramid(MVertex *v1, MVertex *v2, MVertex *v3, MVertex *v4,
-                       MVertex *v5, GRegion *to)
-{
-  to->pyramids.push_back(new MPyramid(v1, v2, v3, v4, v5));
-}
-
-static void addPrism(MVertex *v1, MVertex *v2, MVertex *v3, MVertex *v4,
-                     MVertex *v5, MVertex *v6, GRegion *to)
-{
-  to->prisms.push_back(new MPrism(v1, v2, v3, v4, v5, v6));
-}
-
-static void addHexahedron(MVertex *v1, MVertex *v2, MVertex *v3, MVertex *v4,
-                          MVertex *v5, MVertex *v6, MVertex *v7, MVertex *v8,
-                          GRegion *to)
-{
-  to->hexahedra.push_back(new MHexahedron(v1, v2, v3, v4, v5, v6, v7, v8));
-}
+// the elements are created with an explicit number, as they are created in
+// parallel (the static variables are only used to issue a single warning per
+// volume)
 
-static void createPriPyrTet(std::vector<MVertex *> &v, GRegion *to,
-                            MElement *source)
+static MElement *createPriPyrTet(std::vector<MVertex *> &v, GRegion *to,
+                                 MElement *source, int num)
 {
   static int warningReg = 0;
 
@@ -60,31 +46,34 @@ static void createPriPyrTet(std::vector<MVertex *> &v, GRegion *to,
 
   if(j == 2) {
     if(dup[0] == 0 && dup[1] == 1)
-      addTetrahedron(v[0], v[1], v[2], v[5], to);
+      return new MTetrahedron(v[0], v[1], v[2], v[5], num);
     else if(dup[0] == 1 && dup[1] == 2)
-      addTetrahedron(v[0], v[1], v[2], v[3], to);
+      return new MTetrahedron(v[0], v[1], v[2], v[3], num);
     else
-      addTetrahedron(v[0], v[1], v[2], v[4], to);
+      return new MTetrahedron(v[0], v[1], v[2], v[4], num);
   }
   else if(j == 1) {
     if(dup[0] == 0)
-      addPyramid(v[1], v[4], v[5], v[2], v[0], to);
+      return new MPyramid(v[1], v[4], v[5], v[2], v[0], num);
     else if(dup[0] == 1)
-      addPyramid(v[0], v[2], v[5], v[3], v[1], to);
+      return new MPyramid(v[0], v[2], v[5], v[3], v[1], num);
     else
-      addPyramid(v[0], v[1], v[4], v[3], v[2], to);
+      return new MPyramid(v[0], v[1], v[4], v[3], v[2], num);
   }
   else {
-    addPrism(v[0], v[1], v[2], v[3], v[4], v[5], to);
-    if(j && warningReg != to->tag()) {
-      warningReg = to->tag();
-      Msg::Warning("Degenerated prism in extrusion of volume %d", to->tag());
+    if(j) {
+#pragma omp critical(createPriPyrTet)
+      if(warningReg != to->tag()) {
+        warningReg = to->tag();
+        Msg::Warning("Degenerated prism in extrusion of volume %d", to->tag());
+      }
     }
+    return new MPrism(v[0], v[1], v[2], v[3], v[4], v[5], num);
   }
 }
 
-static void createHexPri(std::vector<MVertex *> &v, GRegion *to,
-                         MElement *source)
+static MElement *createHexPri(std::vector<MVertex *> &v, GRegion *to,
+                              MElement *source, int num)
 {
   static int errorReg = 0;
   static int warningReg = 0;
@@ -96,25 +85,31 @@ static void createHexPri(std::vector<MVertex *> &v, GRegion *to,
 
   if(j == 2) {
     if(dup[0] == 0 && dup[1] == 1)
-      addPrism(v[0], v[3], v[7], v[1], v[2], v[6], to);
+      return new MPrism(v[0], v[3], v[7], v[1], v[2], v[6], num);
     else if(dup[0] == 1 && dup[1] == 2)
-      addPrism(v[0], v[1], v[4], v[3], v[2], v[7], to);
+      return new MPrism(v[0], v[1], v[4], v[3], v[2], v[7], num);
     else if(dup[0] == 2 && dup[1] == 3)
-      addPrism(v[0], v[3], v[4], v[1], v[2], v[5], to);
+      return new MPrism(v[0], v[3], v[4], v[1], v[2], v[5], num);
     else if(dup[0] == 0 && dup[1] == 3)
-      addPrism(v[0], v[1], v[5], v[3], v[2], v[6], to);
-    else if(to->tag() != errorReg) {
+      return new MPrism(v[0], v[1], v[5], v[3], v[2], v[6], num);
+#pragma omp critical(createHexPri)
+    if(to->tag() != errorReg) {
       errorReg = to->tag();
       Msg::Error("Wrong hexahedron in extrusion of volume %d", to->tag());
     }
+    return nullptr;
   }
   else {
-    addHexahedron(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], to);
-    if(j && warningReg != to->tag()) {
-      warningReg = to->tag();
-      Msg::Warning("Degenerated hexahedron in extrusion of volume %d",
-                   to->tag());
+    if(j) {
+#pragma omp critical(createHexPri)
+      if(warningReg != to->tag()) {
+        warningReg = to->tag();
+        Msg::Warning("Degenerated hexahedron in extrusion of volume %d",
+                     to->tag());
+      }
     }
+    return new MHexahedron(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7],
+                           num);
   }
 }
 
@@ -125,32 +120,6 @@ static void createTet(MVertex *v1, MVertex *v2, MVertex *v3, MVertex *v4,
     addTetrahedron(v1, v2, v3, v4, to);
 }
 
-static int getExtrudedVertices(MElement *ele, ExtrudeParams *ep, int j, int k,
-                               MVertexRTree &pos, std::vector<MVertex *> &verts)
-{
-  double x[8], y[8], z[8];
-  int n = ele->getNumVertices();
-  for(int p = 0; p < n; p++) {
-    MVertex *v = ele->getVertex(p);
-    x[p] = x[p + n] = v->x();
-    y[p] = y[p + n] = v->y();
-    z[p] = z[p + n] = v->z();
-  }
-  for(int p = 0; p < n; p++) {
-    ep->Extrude(j, k, x[p], y[p], z[p]);
-    ep->Extrude(j, k + 1, x[p + n], y[p + n], z[p + n]);
-  }
-  for(int p = 0; p < 2 * n; p++) {
-    MVertex *tmp = pos.find(x[p], y[p], z[p]);
-    if(!tmp)
-      Msg::Error("Could not find extruded vertex (%.16g, %.16g, %.16g)", x[p],
-                 y[p], z[p]);
-    else
-      verts.push_back(tmp);
-  }
-  return verts.size();
-}
-
 static void extrudeMesh(GFace *from, GRegion *to, MVertexRTree &pos)
 {
   ExtrudeParams *ep = to->meshAttributes.extrude;
@@ -178,60 +147,117 @@ static void extrudeMesh(GFace *from, GRegion *to, MVertexRTree &pos)
   }
   mesh_vertices.insert(mesh_vertices.end(), seam.begin(), seam.end());
 
-  // create extruded vertices
-  for(std::size_t i = 0; i < mesh_vertices.size(); i++) {
-    MVertex *v = mesh_vertices[i];
-    for(int j = 0; j < ep->mesh.NbLayer; j++) {
-      for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
-        double x = v->x(), y = v->y(), z = v->z();
-        ep->Extrude(j, k + 1, x, y, z);
-        if(j != ep->mesh.NbLayer - 1 || k != ep->mesh.NbElmLayer[j] - 1) {
-          if(!pos.find(x, y, z)) {
-            MVertex *newv = new MVertex(x, y, z, to);
-            to->mesh_vertices.push_back(newv);
-            pos.insert(newv);
-          }
-        }
-      }
+  // the nodes of all the sub-layers, indexed by source node
+  extrudedVertices ev(ep);
+  ev.addSources(from->triangles);
+  ev.addSources(from->quadrangles);
+  std::vector<MVertex *> interior;
+  std::set<MVertex *> unique;
+  for(auto v : mesh_vertices) {
+    ev.addSource(v);
+    if(unique.insert(v).second) interior.push_back(v);
+  }
+  ev.allocate();
+  const int numSubLayers = ev.getNumSubLayers();
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  // the nodes extruded from embedded nodes and from nodes on seams can already
+  // exist (e.g. on the boundary of the volume)
+  const std::size_t numInterior = from->mesh_vertices.size();
+#pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads)
+  for(std::size_t p = numInterior; p < interior.size(); p++) {
+    std::size_t i = ev.getIndex(interior[p]);
+    for(int l = 1; l < numSubLayers; l++) {
+      double x, y, z;
+      ev.getPosition(i, l, x, y, z);
+      ev.node(i, l) = pos.find(x, y, z);
     }
   }
 
+  // create the other nodes extruded from the interior nodes of the source
+  // surface, except on the last sub-layer (the top surface), numbered in the
+  // same order as if they were created one by one; extruded nodes are only
+  // shared with their source node if they coincide (e.g. on a rotation axis)
+  const double tol = CTX::instance()->geom.tolerance * CTX::instance()->lc;
+  std::vector<std::size_t> numNew(interior.size() + 1, 0);
+#pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads)
+  for(std::size_t p = 0; p < interior.size(); p++) {
+    std::size_t i = ev.getIndex(interior[p]);
+    for(int l = 1; l < numSubLayers; l++) {
+      if(ev.node(i, l)) continue;
+      double x, y, z;
+      ev.getPosition(i, l, x, y, z);
+      if(!ev.isDegenerate(i, x, y, z, tol)) numNew[p + 1]++;
+    }
+  }
+  for(std::size_t p = 0; p < interior.size(); p++) numNew[p + 1] += numNew[p];
+  GModel *m = to->model();
+  const std::size_t vertexNum = m->getMaxVertexNumber();
+#pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads)
+  for(std::size_t p = 0; p < interior.size(); p++) {
+    std::size_t i = ev.getIndex(interior[p]), num = vertexNum + numNew[p];
+    for(int l = 1; l < numSubLayers; l++) {
+      if(ev.node(i, l)) continue;
+      double x, y, z;
+      ev.getPosition(i, l, x, y, z);
+      if(ev.isDegenerate(i, x, y, z, tol))
+        ev.node(i, l) = interior[p];
+      else
+        ev.node(i, l) = new MVertex(x, y, z, to, ++num);
+    }
+  }
+  m->setMaxVertexNumber(vertexNum + numNew[interior.size()]);
+  for(auto v : interior) {
+    std::size_t i = ev.getIndex(v);
+    for(int l = 1; l < numSubLayers; l++) {
+      if(ev.node(i, l)->onWhat() == to)
+        to->mesh_vertices.push_back(ev.node(i, l));
+    }
+  }
+
+  // look up the other nodes, on the boundary of the volume
+  ev.lookup(pos, nthreads);
+
 #if defined(HAVE_QUADTRI)
   if(ep && ep->mesh.ExtrudeMesh && ep->mesh.QuadToTri && ep->mesh.Recombine) {
+    pos.insert(to->mesh_vertices);
     meshQuadToTriRegion(to, pos);
     return;
   }
 #endif
 
-  // create elements (note that it would be faster to access the *interior*
-  // nodes by direct indexing, but it's just simpler to query everything by
-  // position)
-  for(std::size_t i = 0; i < from->triangles.size(); i++) {
+  // create elements, in parallel over the source elements, and numbered in
+  // the same order as if they were created one by one
+  std::size_t nt = from->triangles.size(), nq = from->quadrangles.size();
+  if(nq && !ep->mesh.Recombine) {
+    Msg::Error("Cannot extrude quadrangles without Recombine");
+    nq = 0;
+  }
+  const std::size_t elementNum = m->getMaxElementNumber();
+  std::vector<MElement *> elements((nt + nq) * numSubLayers, nullptr);
+#pragma omp parallel for schedule(dynamic, 64) num_threads(nthreads)
+  for(std::size_t e = 0; e < nt + nq; e++) {
+    MElement *source = (e < nt) ? static_cast<MElement *>(from->triangles[e]) :
+                                  from->quadrangles[e - nt];
+    std::size_t idx[4];
+    ev.getIndices(source, idx);
     for(int j = 0; j < ep->mesh.NbLayer; j++) {
       for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
         std::vector<MVertex *> verts;
-        if(getExtrudedVertices(from->triangles[i], ep, j, k, pos, verts) == 6) {
-          createPriPyrTet(verts, to, from->triangles[i]);
-        }
-      }
-    }
-  }
-
-  if(from->quadrangles.size() && !ep->mesh.Recombine) {
-    Msg::Error("Cannot extrude quadrangles without Recombine");
-  }
-  else {
-    for(std::size_t i = 0; i < from->quadrangles.size(); i++) {
-      for(int j = 0; j < ep->mesh.NbLayer; j++) {
-        for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
-          std::vector<MVertex *> verts;
-          if(getExtrudedVertices(from->quadrangles[i], ep, j, k, pos, verts) ==
-             8)
-            createHexPri(verts, to, from->quadrangles[i]);
-        }
+        std::size_t s = e * numSubLayers + ev.getSubLayer(j, k);
+        int n = ev.get(source, idx, j, k, verts);
+        if(e < nt && n == 6)
+          elements[s] = createPriPyrTet(verts, to, source, elementNum + s + 1);
+        else if(e >= nt && n == 8)
+          elements[s] = createHexPri(verts, to, source, elementNum + s + 1);
       }
     }
   }
+  m->setMaxElementNumber(elementNum + elements.size());
+  for(auto e : elements)
+    if(e) to->addElement(e);
 }
 
 static void insertAllVertices(GRegion *gr, MVertexRTree &pos)
@@ -314,7 +340,7 @@ static void deleteEdge(MVertex *v1, MVertex *v2,
 }
 
 // subdivide the 3 lateral faces of each prism
-static void phase1(GRegion *gr, MVertexRTree &pos,
+static void phase1(GRegion *gr, extrudedVertices &ev,
                    std::set<std::pair<MVertex *, MVertex *> > &edges, int ntry)
 {
   ExtrudeParams *ep = gr->meshAttributes.extrude;
@@ -325,7 +351,7 @@ static void phase1(GRegion *gr, MVertexRTree &pos,
     for(int j = 0; j < ep->mesh.NbLayer; j++) {
       for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
         std::vector<MVertex *> v;
-        if(getExtrudedVertices(from->triangles[i], ep, j, k, pos, v) == 6) {
+        if(ev.get(from->triangles[i], j, k, v) == 6) {
           if(ntry == 1) {
             if(!edgeExists(v[0], v[4], edges)) createEdge(v[1], v[3], edges);
             if(!edgeExists(v[4], v[2], edges)) createEdge(v[1], v[5], edges);
@@ -352,7 +378,7 @@ static void phase1(GRegion *gr, MVertexRTree &pos,
 }
 
 // modify lateral edges to make them "tet-compatible"
-static void phase2(GRegion *gr, MVertexRTree &pos,
+static void phase2(GRegion *gr, extrudedVertices &ev,
                    std::set<std::pair<MVertex *, MVertex *> > &edges,
                    std::set<std::pair<MVertex *, MVertex *> > &edges_swap,
                    int &swap)
@@ -365,7 +391,7 @@ static void phase2(GRegion *gr, MVertexRTree &pos,
     for(int j = 0; j < ep->mesh.NbLayer; j++) {
       for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
         std::vector<MVertex *> v;
-        if(getExtrudedVertices(from->triangles[i], ep, j, k, pos, v) == 6) {
+        if(ev.get(from->triangles[i], j, k, v) == 6) {
           if(edgeExists(v[3], v[1], edges) && edgeExists(v[4], v[2], edges) &&
              edgeExists(v[0], v[5], edges)) {
             swap++;
@@ -418,7 +444,7 @@ static void phase2(GRegion *gr, MVertexRTree &pos,
 }
 
 // create tets
-static void phase3(GRegion *gr, MVertexRTree &pos,
+static void phase3(GRegion *gr, extrudedVertices &ev,
                    std::set<std::pair<MVertex *, MVertex *> > &edges)
 {
   ExtrudeParams *ep = gr->meshAttributes.extrude;
@@ -430,7 +456,7 @@ static void phase3(GRegion *gr, MVertexRTree &pos,
     for(int j = 0; j < ep->mesh.NbLayer; j++) {
       for(int k = 0; k < ep->mesh.NbElmLayer[j]; k++) {
         std::vector<MVertex *> v;
-        if(getExtrudedVertices(tri, ep, j, k, pos, v) == 6) {
+        if(ev.get(tri, j, k, v) == 6) {
           if(edgeExists(v[3], v[1], edges) && edgeExists(v[4], v[2], edges) &&
              edgeExists(v[3], v[2], edges)) {
             createTet(v[0], v[1], v[2], v[3], gr, tri);
@@ -509,19 +535,32 @@ int SubdivideExtrudedMesh(GModel *m)
 
   Msg::Info("Subdividing extruded mesh");
 
+  // tables of the extruded nodes of each volume, looked up once
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  std::vector<extrudedVertices> ev;
+  for(std::size_t i = 0; i < regions.size(); i++) {
+    ExtrudeParams *ep = regions[i]->meshAttributes.extrude;
+    ev.push_back(extrudedVertices(ep));
+    GFace *from = m->getFaceByTag(std::abs(ep->geo.Source));
+    if(from) ev[i].addSources(from->triangles);
+    ev[i].allocate();
+    ev[i].lookup(pos, nthreads);
+  }
+
   std::set<std::pair<MVertex *, MVertex *> > edges;
 
   for(int ntry = 1; ntry <= 2; ntry++) {
     // create edges on lateral sides of "prisms"
     for(std::size_t i = 0; i < regions.size(); i++)
-      phase1(regions[i], pos, edges, ntry);
+      phase1(regions[i], ev[i], edges, ntry);
     // swap lateral edges to make them "tet-compatible"
     int j = 0, swap;
     std::set<std::pair<MVertex *, MVertex *> > edges_swap;
     do {
       swap = 0;
       for(std::size_t i = 0; i < regions.size(); i++)
-        phase2(regions[i], pos, edges, edges_swap, swap);
+        phase2(regions[i], ev[i], edges, edges_swap, swap);
       Msg::Info("Swapping %d", swap);
       if(j && j == swap) {
         if(ntry == 1) {
@@ -554,7 +593,7 @@ int SubdivideExtrudedMesh(GModel *m)
     gr->prisms.clear();
     for(std::size_t i = 0; i < gr->pyramids.size(); i++) delete gr->pyramids[i];
     gr->pyramids.clear();
-    phase3(gr, pos, edges);
+    phase3(gr, ev[i], edges);
   }
 
   // remesh bounding surfaces, to make them compatible with the volume mesh
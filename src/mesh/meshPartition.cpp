@@ -59,6 +59,7 @@ typedef std::set<std::pair<int, GEntity *>, OriGEntityPtrFullLessThan>
 
 #include "OS.h"
 #include "Context.h"
+#include "Profiler.h"
 #include "partitionRegion.h"
 #include "partitionFace.h"
 #include "partitionEdge.h"
@@ -2268,6 +2269,7 @@ int PartitionMesh(GModel *model, int numPart)
 
   Msg::StatusBar(true, "Partitioning mesh...");
   double t1 = Cpu(), w1 = TimeOfDay();
+  ProfileScope scope("Partition");
 
   Graph graph(model);
   if(makeGraph(model, graph, -1)) return 1;
@@ -525,6 +525,7 @@ int BuildBackgroundMeshAndGuidingField(GModel *gm, bool overwriteGModelMesh,
    * more finer than the target quadrangulation, to get a more accurate cross
    * field */
   double edgeScaling = CTX::instance()->mesh.quadqsScalingOnTriangulation;
+  double w0 = TimeOfDay();
   if(!surfaceMeshed) { generateMeshWithSpecialParameters(gm, edgeScaling); }
 
   GlobalBackgroundMesh &bmesh = getBackgroundMesh(BMESH_NAME);
@@ -539,6 +540,7 @@ int BuildBackgroundMeshAndGuidingField(GModel *gm, bool overwriteGModelMesh,
     Msg::Debug("delete GModel mesh");
     gm->deleteMesh();
   }
+  double w1 = TimeOfDay();
 
   /* Build guiding field on background mesh:
    * - per GFace:
@@ -578,15 +580,16 @@ int BuildBackgroundMeshAndGuidingField(GModel *gm, bool overwriteGModelMesh,
     global_size_map.reserve(3 * ntris);
 
     int nthreads = getNumThreads();
-#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
-    for(size_t f = 0; f < faces.size(); ++f) {
-      GFace *gf = faces[f];
 
+    /* Timings of the per-face stages, cumulated over the faces */
+    double timeCrossField = 0., timeScaling = 0., timeSizeMap = 0.;
+
+    auto processFace = [&](GFace *gf, int solverThreads) {
       if(CTX::instance()->mesh.meshOnlyVisible && !gf->getVisibility())
-        continue;
+        return;
       if(CTX::instance()->debugSurface > 0 &&
          gf->tag() != CTX::instance()->debugSurface)
-        continue;
+        return;
 
       /* Compute a cross field on each face */
 
@@ -598,10 +601,11 @@ int BuildBackgroundMeshAndGuidingField(GModel *gm, bool overwriteGModelMesh,
       if(!oklt && triangles.size() == 0) {
         Msg::Error("- Face %i: failed to get triangles from background mesh",
                    gf->tag());
-        continue;
+        return;
       }
 
       /* Cross field */
+      double t0 = TimeOfDay();
       std::vector<std::array<double, 3> > triEdgeTheta;
       int nbDiffusionLevels = 4;
       double thresholdNormConvergence = 1.e-2;
@@ -613,7 +617,8 @@ int BuildBackgroundMeshAndGuidingField(GModel *gm, bool overwriteGModelMesh,
                 nbDiffusionLevels);
       int scf = computeCrossFieldWithHeatEquation(
         N, triangles, lines, triEdgeTheta, nbDiffusionLevels,
-        thresholdNormConvergence, nbBoundaryExtensionLayer, verbosity);
+        thresholdNormConvergence, nbBoundaryExtensionLayer, verbosity,
+        solverThreads);
       if(scf != 0) {
         Msg::Warning("- Face %i: failed to compute cross field", gf->tag());
       }
@@ -653,6 +658,9 @@ int BuildBackgroundMeshAndGuidingField(GModel *gm, bool overwriteGModelMesh,
           gf->tag());
       }
 
+      double t1 = TimeOfDay();
+      double tScaling = 0.;
+
       /* Build the size map of the guiding field */
       std::unordered_map<MVertex *, double> localSizemap;
       if(externalSizemap) { /* Size map from background field */
@@ -685,8 +693,9 @@ int BuildBackgroundMeshAndGuidingField(GModel *gm, bool overwriteGModelMesh,
         /* Conformal scaling associated to cross field */
         Msg::Info("- Face %i/%li: compute cross field conformal scaling ...",
                   gf->tag(), faces.size());
-        int scs = computeCrossFieldConformalScaling(N, triangles, triEdgeTheta,
-                                                    localSizemap);
+        double ts = TimeOfDay();
+        int scs = computeCrossFieldConformalScaling(
+          N, triangles, triEdgeTheta, localSizemap, solverThreads);
         if(scs != 0) {
           Msg::Warning(
             "- Face %i: failed to compute conformal scaling, use uniform size",
@@ -697,6 +706,8 @@ int BuildBackgroundMeshAndGuidingField(GModel *gm, bool overwriteGModelMesh,
             }
         }
 
+        tScaling = TimeOfDay() - ts;
+
         /* Quantile filtering on the conformal scaling histogram */
         Msg::Debug("- Face %i/%li: conformal scaling quantile filtering ...",
                    gf->tag(), faces.size());
@@ -740,11 +751,45 @@ int BuildBackgroundMeshAndGuidingField(GModel *gm, bool overwriteGModelMesh,
         }
         // GeoLog::add(dynamic_cast_vector<MTriangle*,MElement*>(triangles),
         //    localSizemap, "sizemap_f"+std::to_string(gf->tag()));
-      }
+        timeCrossField += t1 - t0;
+        timeScaling += tScaling;
+        timeSizeMap += TimeOfDay() - t1 - tScaling;
+      }
+    };
+
+    /* The faces are processed in parallel, with one thread per face. A face
+     * with a large triangulation would however dominate the loop, so such
+     * faces are processed afterwards, one at a time, with multithreaded
+     * linear solves inside the face */
+    const size_t largeFace =
+      std::max((size_t)50000, ntris / std::max(nthreads, 1));
+    std::vector<GFace *> smallFaces, largeFaces;
+    for(GFace *gf : faces) {
+      auto it = bmesh.faceBackgroundMeshes.find(gf);
+      if(nthreads > 1 && it != bmesh.faceBackgroundMeshes.end() &&
+         it->second.triangles.size() > largeFace)
+        largeFaces.push_back(gf);
+      else
+        smallFaces.push_back(gf);
+    }
+
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(size_t f = 0; f < smallFaces.size(); ++f) processFace(smallFaces[f], 1);
+
+    for(GFace *gf : largeFaces) {
+      Msg::Info("- Face %i: large face, multithreaded linear solves (%i "
+                "threads)",
+                gf->tag(), nthreads);
+      processFace(gf, nthreads);
     }
+
+    Msg::Info("- cumulated time over faces: cross field %g s, conformal "
+              "scaling %g s, size map %g s",
+              timeCrossField, timeScaling, timeSizeMap);
   }
 
   sort_unique(global_size_map);
+  double w2 = TimeOfDay();
 
   /* Warning: from now on, code is not optimized in terms of data structures
    *          (slow unordered_map instead of contiguous vectors, etc)
@@ -859,6 +904,11 @@ int BuildBackgroundMeshAndGuidingField(GModel *gm, bool overwriteGModelMesh,
     return -1;
   }
 
+  double w3 = TimeOfDay();
+  Msg::Info("Done building background mesh and guiding field (Wall %gs: "
+            "background mesh %gs, per-face fields %gs, global size map %gs)",
+            w3 - w0, w1 - w0, w2 - w1, w3 - w2);
+
   return 0;
 }
 
@@ -7,6 +7,9 @@
 //   Brian Helenbrook
 //
 
+#include <algorithm>
+#include <climits>
+#include <unordered_map>
 #include "GModel.h"
 #include "HighOrder.h"
 #include "MLine.h"
@@ -16,6 +19,8 @@
 #include "MHexahedron.h"
 #include "MPrism.h"
 #include "MPyramid.h"
+#include "MEdgeHash.h"
+#include "meshVertexTuples.h"
 #include "GmshMessage.h"
 #include "OS.h"
 #include "meshGFaceOptimize.h"
@@ -189,36 +194,101 @@ static void Subdivide(GFace *gf, bool splitIntoQuads, bool splitIntoHexas,
   gf->deleteVertexArrays();
 }
 
+// Split templates of complete second order volume elements, given the nodes v
+// of the element: the children are stored in c (and t for the tetrahedra
+// created when splitting pyramids) and numbered consecutively from num if num
+// is not zero
+
+static int childNum(int num, int k) { return num ? num + k : 0; }
+
+static void splitTetrahedron(MVertex *const *v, MTetrahedron **c, int num = 0)
+{
+  // Use a template that maximizes the quality, which is a modification of
+  // Algorithm RedRefinement3D in: Bey, Jürgen. "Simplicial grid refinement: on
+  // Freudenthal's algorithm and the optimal number of congruence classes."
+  // Numerische Mathematik 85.1 (2000): 1-29. Contributed by Jose Paulo
+  // Moitinho de Almeida, April 2019.
+  c[0] = new MTetrahedron(v[0], v[4], v[6], v[7], childNum(num, 0));
+  c[1] = new MTetrahedron(v[4], v[1], v[5], v[9], childNum(num, 1));
+  c[2] = new MTetrahedron(v[6], v[5], v[2], v[8], childNum(num, 2));
+  c[3] = new MTetrahedron(v[7], v[9], v[8], v[3], childNum(num, 3));
+  c[4] = new MTetrahedron(v[4], v[6], v[7], v[9], childNum(num, 4));
+  c[5] = new MTetrahedron(v[4], v[9], v[5], v[6], childNum(num, 5));
+  c[6] = new MTetrahedron(v[6], v[7], v[9], v[8], childNum(num, 6));
+  c[7] = new MTetrahedron(v[6], v[8], v[9], v[5], childNum(num, 7));
+}
+
+static void splitHexahedron(MVertex *const *v, MHexahedron **c, int num = 0)
+{
+  c[0] = new MHexahedron(v[0], v[8], v[20], v[9], v[10], v[21], v[26], v[22],
+                         childNum(num, 0));
+  c[1] = new MHexahedron(v[10], v[21], v[26], v[22], v[4], v[16], v[25], v[17],
+                         childNum(num, 1));
+  c[2] = new MHexahedron(v[8], v[1], v[11], v[20], v[21], v[12], v[23], v[26],
+                         childNum(num, 2));
+  c[3] = new MHexahedron(v[21], v[12], v[23], v[26], v[16], v[5], v[18], v[25],
+                         childNum(num, 3));
+  c[4] = new MHexahedron(v[9], v[20], v[13], v[3], v[22], v[26], v[24], v[15],
+                         childNum(num, 4));
+  c[5] = new MHexahedron(v[22], v[26], v[24], v[15], v[17], v[25], v[19], v[7],
+                         childNum(num, 5));
+  c[6] = new MHexahedron(v[20], v[11], v[2], v[13], v[26], v[23], v[14], v[24],
+                         childNum(num, 6));
+  c[7] = new MHexahedron(v[26], v[23], v[14], v[24], v[25], v[18], v[6], v[19],
+                         childNum(num, 7));
+}
+
+static void splitPrism(MVertex *const *v, MPrism **c, int num = 0)
+{
+  c[0] = new MPrism(v[0], v[6], v[7], v[8], v[15], v[16], childNum(num, 0));
+  c[1] = new MPrism(v[8], v[15], v[16], v[3], v[12], v[13], childNum(num, 1));
+  c[2] = new MPrism(v[6], v[1], v[9], v[15], v[10], v[17], childNum(num, 2));
+  c[3] = new MPrism(v[15], v[10], v[17], v[12], v[4], v[14], childNum(num, 3));
+  c[4] = new MPrism(v[7], v[9], v[2], v[16], v[17], v[11], childNum(num, 4));
+  c[5] = new MPrism(v[16], v[17], v[11], v[13], v[14], v[5], childNum(num, 5));
+  c[6] = new MPrism(v[9], v[7], v[6], v[17], v[16], v[15], childNum(num, 6));
+  c[7] = new MPrism(v[17], v[16], v[15], v[14], v[13], v[12], childNum(num, 7));
+}
+
+static void splitPyramid(MVertex *const *v, MPyramid **c, MTetrahedron **t,
+                         int num = 0)
+{
+  // Base
+  c[0] = new MPyramid(v[0], v[5], v[13], v[6], v[7], childNum(num, 0));
+  c[1] = new MPyramid(v[5], v[1], v[8], v[13], v[9], childNum(num, 1));
+  c[2] = new MPyramid(v[13], v[8], v[2], v[10], v[11], childNum(num, 2));
+  c[3] = new MPyramid(v[6], v[13], v[10], v[3], v[12], childNum(num, 3));
+
+  // Split remaining into tets
+  // Top
+  t[0] = new MTetrahedron(v[7], v[9], v[12], v[4], childNum(num, 4));
+  t[1] = new MTetrahedron(v[9], v[11], v[12], v[4], childNum(num, 5));
+
+  // Upside down one
+  t[2] = new MTetrahedron(v[9], v[12], v[11], v[13], childNum(num, 6));
+  t[3] = new MTetrahedron(v[7], v[12], v[9], v[13], childNum(num, 7));
+
+  // Four tets around bottom perimeter
+  t[4] = new MTetrahedron(v[7], v[9], v[5], v[13], childNum(num, 8));
+  t[5] = new MTetrahedron(v[9], v[11], v[8], v[13], childNum(num, 9));
+  t[6] = new MTetrahedron(v[12], v[10], v[11], v[13], childNum(num, 10));
+  t[7] = new MTetrahedron(v[7], v[6], v[12], v[13], childNum(num, 11));
+}
+
 static void Subdivide(GRegion *gr, bool splitIntoHexas,
                       faceContainer &faceVertices)
 {
+  std::vector<MVertex *> v;
   if(!splitIntoHexas) {
     // Split tets into other tets
     std::vector<MTetrahedron *> tetrahedra2;
     for(std::size_t i = 0; i < gr->tetrahedra.size(); i++) {
       MTetrahedron *t = gr->tetrahedra[i];
-      // Use a template that maximizes the quality, which is a modification of
-      // Algorithm RedRefinement3D in: Bey, Jürgen. "Simplicial grid refinement:
-      // on Freudenthal's algorithm and the optimal number of congruence
-      // classes." Numerische Mathematik 85.1 (2000): 1-29. Contributed by Jose
-      // Paulo Moitinho de Almeida, April 2019.
       if(t->getNumVertices() == 10) {
-        tetrahedra2.push_back(new MTetrahedron(
-          t->getVertex(0), t->getVertex(4), t->getVertex(6), t->getVertex(7)));
-        tetrahedra2.push_back(new MTetrahedron(
-          t->getVertex(4), t->getVertex(1), t->getVertex(5), t->getVertex(9)));
-        tetrahedra2.push_back(new MTetrahedron(
-          t->getVertex(6), t->getVertex(5), t->getVertex(2), t->getVertex(8)));
-        tetrahedra2.push_back(new MTetrahedron(
-          t->getVertex(7), t->getVertex(9), t->getVertex(8), t->getVertex(3)));
-        tetrahedra2.push_back(new MTetrahedron(
-          t->getVertex(4), t->getVertex(6), t->getVertex(7), t->getVertex(9)));
-        tetrahedra2.push_back(new MTetrahedron(
-          t->getVertex(4), t->getVertex(9), t->getVertex(5), t->getVertex(6)));
-        tetrahedra2.push_back(new MTetrahedron(
-          t->getVertex(6), t->getVertex(7), t->getVertex(9), t->getVertex(8)));
-        tetrahedra2.push_back(new MTetrahedron(
-          t->getVertex(6), t->getVertex(8), t->getVertex(9), t->getVertex(5)));
+        MTetrahedron *c[8];
+        t->getVertices(v);
+        splitTetrahedron(&v[0], c);
+        tetrahedra2.insert(tetrahedra2.end(), c, c + 8);
         setBLData(t);
       }
       delete t;
@@ -231,34 +301,10 @@ static void Subdivide(GRegion *gr, bool splitIntoHexas,
   for(std::size_t i = 0; i < gr->hexahedra.size(); i++) {
     MHexahedron *h = gr->hexahedra[i];
     if(h->getNumVertices() == 27) {
-      hexahedra2.push_back(new MHexahedron(h->getVertex(0), h->getVertex(8),
-                                           h->getVertex(20), h->getVertex(9),
-                                           h->getVertex(10), h->getVertex(21),
-                                           h->getVertex(26), h->getVertex(22)));
-      hexahedra2.push_back(new MHexahedron(
-        h->getVertex(10), h->getVertex(21), h->getVertex(26), h->getVertex(22),
-        h->getVertex(4), h->getVertex(16), h->getVertex(25), h->getVertex(17)));
-      hexahedra2.push_back(new MHexahedron(h->getVertex(8), h->getVertex(1),
-                                           h->getVertex(11), h->getVertex(20),
-                                           h->getVertex(21), h->getVertex(12),
-                                           h->getVertex(23), h->getVertex(26)));
-      hexahedra2.push_back(new MHexahedron(
-        h->getVertex(21), h->getVertex(12), h->getVertex(23), h->getVertex(26),
-        h->getVertex(16), h->getVertex(5), h->getVertex(18), h->getVertex(25)));
-      hexahedra2.push_back(new MHexahedron(h->getVertex(9), h->getVertex(20),
-                                           h->getVertex(13), h->getVertex(3),
-                                           h->getVertex(22), h->getVertex(26),
-                                           h->getVertex(24), h->getVertex(15)));
-      hexahedra2.push_back(new MHexahedron(
-        h->getVertex(22), h->getVertex(26), h->getVertex(24), h->getVertex(15),
-        h->getVertex(17), h->getVertex(25), h->getVertex(19), h->getVertex(7)));
-      hexahedra2.push_back(new MHexahedron(h->getVertex(20), h->getVertex(11),
-                                           h->getVertex(2), h->getVertex(13),
-                                           h->getVertex(26), h->getVertex(23),
-                                           h->getVertex(14), h->getVertex(24)));
-      hexahedra2.push_back(new MHexahedron(
-        h->getVertex(26), h->getVertex(23), h->getVertex(14), h->getVertex(24),
-        h->getVertex(25), h->getVertex(18), h->getVertex(6), h->getVertex(19)));
+      MHexahedron *c[8];
+      h->getVertices(v);
+      splitHexahedron(&v[0], c);
+      hexahedra2.insert(hexahedra2.end(), c, c + 8);
       setBLData(h);
     }
     delete h;
@@ -373,30 +419,10 @@ static void Subdivide(GRegion *gr, bool splitIntoHexas,
   for(std::size_t i = 0; i < gr->prisms.size(); i++) {
     MPrism *p = gr->prisms[i];
     if(p->getNumVertices() == 18) {
-      prisms2.push_back(new MPrism(p->getVertex(0), p->getVertex(6),
-                                   p->getVertex(7), p->getVertex(8),
-                                   p->getVertex(15), p->getVertex(16)));
-      prisms2.push_back(new MPrism(p->getVertex(8), p->getVertex(15),
-                                   p->getVertex(16), p->getVertex(3),
-                                   p->getVertex(12), p->getVertex(13)));
-      prisms2.push_back(new MPrism(p->getVertex(6), p->getVertex(1),
-                                   p->getVertex(9), p->getVertex(15),
-                                   p->getVertex(10), p->getVertex(17)));
-      prisms2.push_back(new MPrism(p->getVertex(15), p->getVertex(10),
-                                   p->getVertex(17), p->getVertex(12),
-                                   p->getVertex(4), p->getVertex(14)));
-      prisms2.push_back(new MPrism(p->getVertex(7), p->getVertex(9),
-                                   p->getVertex(2), p->getVertex(16),
-                                   p->getVertex(17), p->getVertex(11)));
-      prisms2.push_back(new MPrism(p->getVertex(16), p->getVertex(17),
-                                   p->getVertex(11), p->getVertex(13),
-                                   p->getVertex(14), p->getVertex(5)));
-      prisms2.push_back(new MPrism(p->getVertex(9), p->getVertex(7),
-                                   p->getVertex(6), p->getVertex(17),
-                                   p->getVertex(16), p->getVertex(15)));
-      prisms2.push_back(new MPrism(p->getVertex(17), p->getVertex(16),
-                                   p->getVertex(15), p->getVertex(14),
-                                   p->getVertex(13), p->getVertex(12)));
+      MPrism *c[8];
+      p->getVertices(v);
+      splitPrism(&v[0], c);
+      prisms2.insert(prisms2.end(), c, c + 8);
       setBLData(p);
     }
     delete p;
@@ -411,44 +437,12 @@ static void Subdivide(GRegion *gr, bool splitIntoHexas,
     }
     MPyramid *p = gr->pyramids[i];
     if(p->getNumVertices() == 14) {
-      // Base
-      pyramids2.push_back(new MPyramid(p->getVertex(0), p->getVertex(5),
-                                       p->getVertex(13), p->getVertex(6),
-                                       p->getVertex(7)));
-      pyramids2.push_back(new MPyramid(p->getVertex(5), p->getVertex(1),
-                                       p->getVertex(8), p->getVertex(13),
-                                       p->getVertex(9)));
-      pyramids2.push_back(new MPyramid(p->getVertex(13), p->getVertex(8),
-                                       p->getVertex(2), p->getVertex(10),
-                                       p->getVertex(11)));
-      pyramids2.push_back(new MPyramid(p->getVertex(6), p->getVertex(13),
-                                       p->getVertex(10), p->getVertex(3),
-                                       p->getVertex(12)));
-
-      // Split remaining into tets
-      // Top
-      gr->tetrahedra.push_back((new MTetrahedron(
-        p->getVertex(7), p->getVertex(9), p->getVertex(12), p->getVertex(4))));
-      gr->tetrahedra.push_back((new MTetrahedron(
-        p->getVertex(9), p->getVertex(11), p->getVertex(12), p->getVertex(4))));
-
-      // Upside down one
-      gr->tetrahedra.push_back(
-        (new MTetrahedron(p->getVertex(9), p->getVertex(12), p->getVertex(11),
-                          p->getVertex(13))));
-      gr->tetrahedra.push_back((new MTetrahedron(
-        p->getVertex(7), p->getVertex(12), p->getVertex(9), p->getVertex(13))));
-
-      // Four tets around bottom perimeter
-      gr->tetrahedra.push_back((new MTetrahedron(
-        p->getVertex(7), p->getVertex(9), p->getVertex(5), p->getVertex(13))));
-      gr->tetrahedra.push_back((new MTetrahedron(
-        p->getVertex(9), p->getVertex(11), p->getVertex(8), p->getVertex(13))));
-      gr->tetrahedra.push_back(
-        (new MTetrahedron(p->getVertex(12), p->getVertex(10), p->getVertex(11),
-                          p->getVertex(13))));
-      gr->tetrahedra.push_back((new MTetrahedron(
-        p->getVertex(7), p->getVertex(6), p->getVertex(12), p->getVertex(13))));
+      MPyramid *c[4];
+      MTetrahedron *t[8];
+      p->getVertices(v);
+      splitPyramid(&v[0], c, t);
+      pyramids2.insert(pyramids2.end(), c, c + 4);
+      gr->tetrahedra.insert(gr->tetrahedra.end(), t, t + 8);
       setBLData(p);
     }
     delete p;
@@ -460,15 +454,387 @@ static void Subdivide(GRegion *gr, bool splitIntoHexas,
   gr->deleteVertexArrays();
 }
 
+// Direct (and multithreaded) uniform refinement of first order volume meshes,
+// without creating the second order volume elements. The new nodes on edges
+// and on quadrangular faces are identified by pairs of nodes (the nodes of the
+// edge, or the node with the smallest number in the face and the opposite
+// node), stored in tables of node tuples.
+
+typedef std::unordered_map<MEdge, MVertex *, MEdgeHash, MEdgeEqual>
+  pairContainer;
+
+// edges and quadrangular faces of the first order volume elements, in the
+// order of the corresponding nodes in the complete second order elements
+struct refineTopology {
+  int numCorners, numEdges, numQuads;
+  int edges[12][2];
+  int quads[6][4];
+};
+
+static int refineTopologyIndex(int type)
+{
+  switch(type) {
+  case TYPE_TET: return 0;
+  case TYPE_HEX: return 1;
+  case TYPE_PRI: return 2;
+  case TYPE_PYR: return 3;
+  default: return -1;
+  }
+}
+
+static void getRefineTopologies(refineTopology topo[4])
+{
+  topo[0].numCorners = 4;
+  topo[0].numEdges = 6;
+  topo[0].numQuads = 0;
+  topo[1].numCorners = 8;
+  topo[1].numEdges = 12;
+  topo[1].numQuads = 6;
+  topo[2].numCorners = 6;
+  topo[2].numEdges = 9;
+  topo[2].numQuads = 3;
+  topo[3].numCorners = 5;
+  topo[3].numEdges = 8;
+  topo[3].numQuads = 1;
+  for(int j = 0; j < 2; j++) {
+    for(int i = 0; i < 6; i++)
+      topo[0].edges[i][j] = MTetrahedron::edges_tetra(i, j);
+    for(int i = 0; i < 12; i++)
+      topo[1].edges[i][j] = MHexahedron::edges_hexa(i, j);
+    for(int i = 0; i < 9; i++) topo[2].edges[i][j] = MPrism::edges_prism(i, j);
+    for(int i = 0; i < 8; i++)
+      topo[3].edges[i][j] = MPyramid::edges_pyramid(i, j);
+  }
+  for(int j = 0; j < 4; j++) {
+    for(int i = 0; i < 6; i++)
+      topo[1].quads[i][j] = MHexahedron::faces_hexa(i, j);
+    // the first two faces of prisms are triangles
+    for(int i = 0; i < 3; i++)
+      topo[2].quads[i][j] = MPrism::faces_prism(i + 2, j);
+    // the last face of pyramids is the base
+    topo[3].quads[0][j] = MPyramid::faces_pyramid(4, j);
+  }
+}
+
+// position of the node with the smallest number in a quadrangular face: the
+// face is identified by this node and the opposite one
+static int quadDiagonal(MVertex *const *c)
+{
+  int l = 0;
+  for(int k = 1; k < 4; k++)
+    if(c[k]->getNum() < c[l]->getNum()) l = k;
+  return l;
+}
+
+static bool canRefineVolumesDirectly(GModel *m)
+{
+  std::size_t numElements = 0;
+  for(auto it = m->firstRegion(); it != m->lastRegion(); ++it) {
+    GRegion *gr = *it;
+    if(gr->trihedra.size() || gr->polyhedra.size()) return false;
+    for(std::size_t i = 0; i < gr->getNumMeshElements(); i++)
+      if(gr->getMeshElement(i)->getPolynomialOrder() != 1) return false;
+    numElements += gr->getNumMeshElements();
+  }
+  // element numbers and local node indices are stored as int
+  return m->getMaxElementNumber() + 12 * numElements < (std::size_t)INT_MAX;
+}
+
+// store the second order nodes of the (already subdivided) curves and surfaces
+static void getBoundaryVertices(GModel *m, pairContainer &edgeVertices,
+                                pairContainer &faceVertices)
+{
+  for(auto it = m->firstEdge(); it != m->lastEdge(); ++it) {
+    for(auto l : (*it)->lines) {
+      if(l->getNumVertices() != 3) continue;
+      edgeVertices[MEdge(l->getVertex(0), l->getVertex(1))] = l->getVertex(2);
+    }
+  }
+  for(auto it = m->firstFace(); it != m->lastFace(); ++it) {
+    for(auto t : (*it)->triangles) {
+      if(t->getNumVertices() != 6) continue;
+      for(int k = 0; k < 3; k++)
+        edgeVertices[MEdge(t->getVertex(k), t->getVertex((k + 1) % 3))] =
+          t->getVertex(3 + k);
+    }
+    for(auto q : (*it)->quadrangles) {
+      if(q->getNumVertices() != 9) continue;
+      MVertex *c[4];
+      for(int k = 0; k < 4; k++) {
+        c[k] = q->getVertex(k);
+        edgeVertices[MEdge(q->getVertex(k), q->getVertex((k + 1) % 4))] =
+          q->getVertex(4 + k);
+      }
+      int l = quadDiagonal(c);
+      faceVertices[MEdge(c[l], c[(l + 2) % 4])] = q->getVertex(8);
+    }
+  }
+}
+
+static void RefineVolumesDirectly(GModel *m, const pairContainer &bndEdges,
+                                  const pairContainer &bndFaces)
+{
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  refineTopology topo[4];
+  getRefineTopologies(topo);
+
+  // flat list of elements, ordered by volume and by type
+  std::vector<GRegion *> regions(m->firstRegion(), m->lastRegion());
+  std::vector<std::size_t> regionStart(1, 0);
+  std::vector<MElement *> elms;
+  for(auto gr : regions) {
+    elms.insert(elms.end(), gr->tetrahedra.begin(), gr->tetrahedra.end());
+    elms.insert(elms.end(), gr->hexahedra.begin(), gr->hexahedra.end());
+    elms.insert(elms.end(), gr->prisms.begin(), gr->prisms.end());
+    elms.insert(elms.end(), gr->pyramids.begin(), gr->pyramids.end());
+    regionStart.push_back(elms.size());
+  }
+  auto regionOf = [&](std::size_t e) {
+    return regions[std::upper_bound(regionStart.begin(), regionStart.end(),
+                                    e) -
+                   regionStart.begin() - 1];
+  };
+
+  // index the nodes of the volume elements (the original indices are restored
+  // at the end)
+  std::vector<GEntity *> entities;
+  m->getEntities(entities);
+  std::vector<long int> oldIndex;
+  for(auto ge : entities)
+    for(auto v : ge->mesh_vertices) oldIndex.push_back(v->getIndex());
+  for(auto e : elms)
+    for(std::size_t k = 0; k < e->getNumVertices(); k++)
+      e->getVertex(k)->setIndex(-1);
+  std::vector<MVertex *> verts;
+  for(auto e : elms) {
+    for(std::size_t k = 0; k < e->getNumVertices(); k++) {
+      MVertex *v = e->getVertex(k);
+      if(v->getIndex() < 0) {
+        v->setIndex(verts.size());
+        verts.push_back(v);
+      }
+    }
+  }
+  int numVertices = verts.size();
+
+  // the code of each pair is the index of the (first) element containing it
+  meshVertexTuples<2> edges, quads;
+  edges.build(
+    numVertices, elms.size(),
+    [&](std::size_t e, int p[][2], std::size_t *c) {
+      MElement *el = elms[e];
+      const refineTopology &t = topo[refineTopologyIndex(el->getType())];
+      for(int k = 0; k < t.numEdges; k++) {
+        p[k][0] = el->getVertex(t.edges[k][0])->getIndex();
+        p[k][1] = el->getVertex(t.edges[k][1])->getIndex();
+        c[k] = e;
+      }
+      return t.numEdges;
+    },
+    nthreads);
+  quads.build(
+    numVertices, elms.size(),
+    [&](std::size_t e, int p[][2], std::size_t *c) {
+      MElement *el = elms[e];
+      const refineTopology &t = topo[refineTopologyIndex(el->getType())];
+      for(int k = 0; k < t.numQuads; k++) {
+        MVertex *q[4];
+        for(int l = 0; l < 4; l++) q[l] = el->getVertex(t.quads[k][l]);
+        int l = quadDiagonal(q);
+        p[k][0] = q[l]->getIndex();
+        p[k][1] = q[(l + 2) % 4]->getIndex();
+        c[k] = e;
+      }
+      return t.numQuads;
+    },
+    nthreads);
+  auto findPair = [](const meshVertexTuples<2> &vt, MVertex *v0,
+                     MVertex *v1) {
+    int p[2] = {(int)v0->getIndex(), (int)v1->getIndex()};
+    return vt.find(p);
+  };
+
+  Msg::Info("Refining %lu volume elements (%lu edges, %lu quadrangular faces)",
+            elms.size(), edges.size(), quads.size());
+
+  // reuse the nodes on the curves and surfaces, and count the new nodes in
+  // each row
+  std::vector<MVertex *> edgeVertices(edges.size(), nullptr);
+  std::vector<MVertex *> faceVertices(quads.size(), nullptr);
+  std::vector<std::size_t> numNew(2 * numVertices + 1, 0);
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+  for(int i = 0; i < numVertices; i++) {
+    for(std::size_t k = edges.begin(i); k < edges.end(i); k++) {
+      auto it = bndEdges.find(MEdge(verts[i], verts[edges.getKey(k)[0]]));
+      if(it != bndEdges.end())
+        edgeVertices[k] = it->second;
+      else
+        numNew[i + 1]++;
+    }
+    for(std::size_t k = quads.begin(i); k < quads.end(i); k++) {
+      auto it = bndFaces.find(MEdge(verts[i], verts[quads.getKey(k)[0]]));
+      if(it != bndFaces.end())
+        faceVertices[k] = it->second;
+      else
+        numNew[numVertices + i + 1]++;
+    }
+  }
+  for(int i = 0; i < 2 * numVertices; i++) numNew[i + 1] += numNew[i];
+
+  // create the new nodes on the edges (at the middle), then on the faces
+  // (using the transfinite interpolation of the edge nodes)
+  const std::size_t firstNewNum = m->getMaxVertexNumber() + 1;
+  std::size_t maxVertexNum = firstNewNum - 1;
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+  for(int i = 0; i < numVertices; i++) {
+    std::size_t num = maxVertexNum + numNew[i];
+    for(std::size_t k = edges.begin(i); k < edges.end(i); k++) {
+      if(edgeVertices[k]) continue;
+      MVertex *v0 = verts[i], *v1 = verts[edges.getKey(k)[0]];
+      edgeVertices[k] = new MVertex(
+        0.5 * (v0->x() + v1->x()), 0.5 * (v0->y() + v1->y()),
+        0.5 * (v0->z() + v1->z()), regionOf(edges.getCode(k)), ++num);
+    }
+  }
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+  for(int i = 0; i < numVertices; i++) {
+    std::size_t num = maxVertexNum + numNew[numVertices + i];
+    for(std::size_t k = quads.begin(i); k < quads.end(i); k++) {
+      if(faceVertices[k]) continue;
+      MElement *el = elms[quads.getCode(k)];
+      const refineTopology &t = topo[refineTopologyIndex(el->getType())];
+      for(int q = 0; q < t.numQuads; q++) {
+        MVertex *c[4];
+        for(int l = 0; l < 4; l++) c[l] = el->getVertex(t.quads[q][l]);
+        int l = quadDiagonal(c);
+        if(c[l] != verts[i] || c[(l + 2) % 4] != verts[quads.getKey(k)[0]])
+          continue;
+        SPoint3 p(0., 0., 0.);
+        for(int l = 0; l < 4; l++) {
+          MVertex *mid =
+            edgeVertices[findPair(edges, c[l], c[(l + 1) % 4])];
+          p += SPoint3(0.5 * mid->x() - 0.25 * c[l]->x(),
+                       0.5 * mid->y() - 0.25 * c[l]->y(),
+                       0.5 * mid->z() - 0.25 * c[l]->z());
+        }
+        faceVertices[k] = new MVertex(p.x(), p.y(), p.z(),
+                                      regionOf(quads.getCode(k)), ++num);
+        break;
+      }
+    }
+  }
+  maxVertexNum += numNew[2 * numVertices];
+
+  // split the elements, volume by volume; the nodes at the center of the
+  // hexahedra are created on the fly
+  std::size_t maxElementNum = m->getMaxElementNumber();
+  std::vector<MVertex *> centerVertices;
+  for(std::size_t r = 0; r < regions.size(); r++) {
+    GRegion *gr = regions[r];
+    std::size_t first = regionStart[r], nt = gr->tetrahedra.size(),
+                nh = gr->hexahedra.size(), np = gr->prisms.size(),
+                ny = gr->pyramids.size();
+    std::vector<MTetrahedron *> tetrahedra2(8 * (nt + ny));
+    std::vector<MHexahedron *> hexahedra2(8 * nh);
+    std::vector<MPrism *> prisms2(8 * np);
+    std::vector<MPyramid *> pyramids2(4 * ny);
+    std::size_t numCenters = centerVertices.size();
+    centerVertices.resize(numCenters + nh);
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+    for(std::size_t i = 0; i < nt + nh + np + ny; i++) {
+      MElement *el = elms[first + i];
+      const refineTopology &t = topo[refineTopologyIndex(el->getType())];
+      MVertex *v[27];
+      for(int k = 0; k < t.numCorners; k++) v[k] = el->getVertex(k);
+      for(int k = 0; k < t.numEdges; k++)
+        v[t.numCorners + k] =
+          edgeVertices[findPair(edges, v[t.edges[k][0]], v[t.edges[k][1]])];
+      for(int k = 0; k < t.numQuads; k++) {
+        MVertex *c[4];
+        for(int l = 0; l < 4; l++) c[l] = v[t.quads[k][l]];
+        int l = quadDiagonal(c);
+        v[t.numCorners + t.numEdges + k] =
+          faceVertices[findPair(quads, c[l], c[(l + 2) % 4])];
+      }
+      if(i < nt) {
+        splitTetrahedron(v, &tetrahedra2[8 * i], maxElementNum + 8 * i + 1);
+      }
+      else if(i < nt + nh) {
+        std::size_t j = i - nt;
+        SPoint3 p(0., 0., 0.);
+        for(int k = 0; k < 26; k++) {
+          double w = k < 8 ? 0.125 : k < 20 ? -0.25 : 0.5;
+          p += SPoint3(w * v[k]->x(), w * v[k]->y(), w * v[k]->z());
+        }
+        v[26] = new MVertex(p.x(), p.y(), p.z(), gr,
+                            maxVertexNum + numCenters + j + 1);
+        centerVertices[numCenters + j] = v[26];
+        splitHexahedron(v, &hexahedra2[8 * j],
+                        maxElementNum + 8 * (nt + j) + 1);
+      }
+      else if(i < nt + nh + np) {
+        std::size_t j = i - nt - nh;
+        splitPrism(v, &prisms2[8 * j], maxElementNum + 8 * (nt + nh + j) + 1);
+      }
+      else {
+        std::size_t j = i - nt - nh - np;
+        splitPyramid(v, &pyramids2[4 * j], &tetrahedra2[8 * (nt + j)],
+                     maxElementNum + 8 * (nt + nh + np) + 12 * j + 1);
+      }
+      delete el;
+    }
+#pragma omp parallel for num_threads(nthreads)
+    for(std::size_t i = 0; i < tetrahedra2.size(); i++)
+      tetrahedra2[i]->setVolumePositive();
+#pragma omp parallel for num_threads(nthreads)
+    for(std::size_t i = 0; i < hexahedra2.size(); i++)
+      hexahedra2[i]->setVolumePositive();
+#pragma omp parallel for num_threads(nthreads)
+    for(std::size_t i = 0; i < prisms2.size(); i++)
+      prisms2[i]->setVolumePositive();
+#pragma omp parallel for num_threads(nthreads)
+    for(std::size_t i = 0; i < pyramids2.size(); i++)
+      pyramids2[i]->setVolumePositive();
+    gr->tetrahedra.swap(tetrahedra2);
+    gr->hexahedra.swap(hexahedra2);
+    gr->prisms.swap(prisms2);
+    gr->pyramids.swap(pyramids2);
+    maxElementNum += 8 * (nt + nh + np) + 12 * ny;
+    if(gr->getColumns() != nullptr) gr->getColumns()->clearElementData();
+    gr->deleteVertexArrays();
+  }
+  maxVertexNum += centerVertices.size();
+  m->setMaxVertexNumber(maxVertexNum);
+  m->setMaxElementNumber(maxElementNum);
+
+  // restore the indices, and store the new nodes in the volumes
+  std::size_t n = 0;
+  for(auto ge : entities)
+    for(auto v : ge->mesh_vertices) v->setIndex(oldIndex[n++]);
+  for(auto v : edgeVertices)
+    if(v->getNum() >= firstNewNum) v->onWhat()->mesh_vertices.push_back(v);
+  for(auto v : faceVertices)
+    if(v->getNum() >= firstNewNum) v->onWhat()->mesh_vertices.push_back(v);
+  for(auto v : centerVertices) v->onWhat()->mesh_vertices.push_back(v);
+}
+
 void RefineMesh(GModel *m, bool linear, bool splitIntoQuads,
                 bool splitIntoHexas)
 {
   Msg::StatusBar(true, "Refining mesh...");
   double t1 = Cpu(), w1 = TimeOfDay();
 
+  // Without optimization of the high-order mesh nor recombination, volume
+  // elements are split directly (and in parallel) from the first order mesh
+  bool direct = !splitIntoQuads && !splitIntoHexas &&
+                !CTX::instance()->mesh.hoOptimize &&
+                canRefineVolumesDirectly(m);
+
   // Create 2nd order mesh (using "2nd order complete" elements) to
   // generate vertex positions
-  SetOrderN(m, 2, linear, false);
+  SetOrderN(m, 2, linear, false, false, direct ? 2 : 3);
 
   // Optimize high order elements
   if(CTX::instance()->mesh.hoOptimize == 2 ||
@@ -488,16 +854,25 @@ void RefineMesh(GModel *m, bool linear, bool splitIntoQuads,
   // only used when splitting tets into hexes
   faceContainer faceVertices;
 
+  // second order nodes of curves and surfaces, reused in the volumes
+  pairContainer bndEdges, bndFaces;
+  if(direct) getBoundaryVertices(m, bndEdges, bndFaces);
+
   // Subdivide the second order elements to create the refined linear
   // mesh
   for(auto it = m->firstEdge(); it != m->lastEdge(); ++it) Subdivide(*it);
   for(auto it = m->firstFace(); it != m->lastFace(); ++it)
     Subdivide(*it, splitIntoQuads, splitIntoHexas, faceVertices, linear);
-  for(auto it = m->firstRegion(); it != m->lastRegion(); ++it)
-    Subdivide(*it, splitIntoHexas, faceVertices);
+  if(direct) {
+    RefineVolumesDirectly(m, bndEdges, bndFaces);
+  }
+  else {
+    for(auto it = m->firstRegion(); it != m->lastRegion(); ++it)
+      Subdivide(*it, splitIntoHexas, faceVertices);
 
-  // Check all 3D elements for negative volume and reverse if needed
-  m->setAllVolumesPositive();
+    // Check all 3D elements for negative volume and reverse if needed
+    m->setAllVolumesPositive();
+  }
 
   double t2 = Cpu(), w2 = TimeOfDay();
   Msg::StatusBar(true, "Done refining mesh (Wall %gs, CPU %gs)", w2 - w1,
@@ -3,13 +3,27 @@
 // See the LICENSE.txt file in the Gmsh root directory for license information.
 // Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
+#include <algorithm>
 #include "meshRenumber.h"
 #include "GModel.h"
+#include "MPoint.h"
+#include "MLine.h"
+#include "MTriangle.h"
+#include "MQuadrangle.h"
+#include "MTetrahedron.h"
+#include "MHexahedron.h"
+#include "MPrism.h"
+#include "MPyramid.h"
+#include "MTrihedron.h"
+#include "MElementCut.h"
+#include "ExtrudeParams.h"
+#include "GmshDefines.h"
 #include "GmshMessage.h"
 #include "GmshConfig.h"
 #include "HilbertCurve.h"
-#include <queue>
-#include <cmath>
+#include "OS.h"
+#include "Context.h"
+#include "robin_hood.h"
 
 #if defined(HAVE_METIS)
 #include "metis.h"
@@ -17,17 +31,112 @@
 
 #define DIFF(x, y) (x > y ? x - y : y - x)
 
-template <typename T>
-static T bandwidth(std::vector<T> &ai, std::vector<T> &aj, T *p = nullptr)
+void meshRenumberGraph::build(GModel *gm,
+                              const std::vector<std::size_t> &elementTags)
 {
-  T maxdx = 0;
-  for(size_t i = 0; i < ai.size() - 1; i++) {
-    for(T j = ai[i]; j < ai[i + 1]; j++) {
-      T dx = p ? DIFF(p[aj[j]], p[i]) : DIFF(aj[j], (T)i);
-      if(dx > maxdx) maxdx = dx;
+  vertices.clear();
+  elements.clear();
+  ai.clear();
+  aj.clear();
+  ei.clear();
+  ej.clear();
+
+  if(elementTags.empty()) {
+    std::vector<GEntity *> entities;
+    gm->getEntities(entities);
+    for(auto ge : entities) {
+      for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
+        elements.push_back(ge->getMeshElement(j));
+      }
+    }
+  }
+  else {
+    for(auto n : elementTags) {
+      MElement *e = gm->getMeshElementByTag(n);
+      if(e) elements.push_back(e);
+    }
+  }
+
+  // element-to-node connectivity; nodes are numbered in order of first
+  // appearance, so that the result does not depend on memory addresses
+  robin_hood::unordered_map<MVertex *, std::size_t> numbering;
+  ei.reserve(elements.size() + 1);
+  ei.push_back(0);
+  for(auto e : elements) {
+    for(std::size_t i = 0; i < e->getNumVertices(); i++) {
+      MVertex *v = e->getVertex(i);
+      auto it = numbering.find(v);
+      if(it == numbering.end()) {
+        numbering[v] = vertices.size();
+        ej.push_back(vertices.size());
+        vertices.push_back(v);
+      }
+      else
+        ej.push_back(it->second);
     }
+    ei.push_back(ej.size());
+  }
+
+  // node-to-element connectivity
+  const std::size_t n = vertices.size();
+  std::vector<std::size_t> ni(n + 1, 0), nj(ej.size());
+  for(auto j : ej) ni[j + 1]++;
+  for(std::size_t i = 0; i < n; i++) ni[i + 1] += ni[i];
+  {
+    std::vector<std::size_t> pos(ni.begin(), ni.end() - 1);
+    for(std::size_t k = 0; k < elements.size(); k++)
+      for(std::size_t j = ei[k]; j < ei[k + 1]; j++) nj[pos[ej[j]]++] = k;
+  }
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  // node-to-node adjacency, in two parallel passes (count, then fill)
+  ai.resize(n + 1, 0);
+  for(int pass = 0; pass < 2; pass++) {
+#pragma omp parallel num_threads(nthreads)
+    {
+      std::vector<std::size_t> neigh;
+#pragma omp for schedule(dynamic, 1024)
+      for(std::size_t i = 0; i < n; i++) {
+        neigh.clear();
+        for(std::size_t k = ni[i]; k < ni[i + 1]; k++) {
+          const std::size_t e = nj[k];
+          for(std::size_t j = ei[e]; j < ei[e + 1]; j++)
+            if(ej[j] != i) neigh.push_back(ej[j]);
+        }
+        std::sort(neigh.begin(), neigh.end());
+        neigh.erase(std::unique(neigh.begin(), neigh.end()), neigh.end());
+        if(pass == 0)
+          ai[i + 1] = neigh.size();
+        else
+          std::copy(neigh.begin(), neigh.end(), aj.begin() + ai[i]);
+      }
+    }
+    if(pass == 0) {
+      for(std::size_t i = 0; i < n; i++) ai[i + 1] += ai[i];
+      aj.resize(ai[n]);
+    }
+  }
+}
+
+void meshRenumberGraph::getBandwidthAndProfile(const std::size_t *perm,
+                                               std::size_t &bandwidth,
+                                               std::size_t &profile) const
+{
+  bandwidth = 0;
+  profile = 0;
+  const std::size_t n = vertices.size();
+  for(std::size_t i = 0; i < n; i++) {
+    const std::size_t pi = perm ? perm[i] : i;
+    std::size_t row = 0;
+    for(std::size_t j = ai[i]; j < ai[i + 1]; j++) {
+      const std::size_t pj = perm ? perm[aj[j]] : aj[j];
+      const std::size_t dx = DIFF(pj, pi);
+      if(dx > bandwidth) bandwidth = dx;
+      if(pj < pi && dx > row) row = dx;
+    }
+    profile += row;
   }
-  return maxdx;
 }
 
 struct SortClass {
@@ -44,24 +153,30 @@ static void RCM(std::vector<std::size_t> &sorted, const std::size_t *const row,
   // Adapted from GmshFEM - Copyright (C) 2019-2022, A. Royer, E. Béchet,
   // C. Geuzaine, Université de Liège
 
+  const std::size_t n = sorted.size();
+  if(!n) return;
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
   std::vector<std::size_t> min; // long long for padding (64bits)
   std::vector<std::size_t> Nmin;
   std::vector<std::size_t> degree;
   std::vector<std::size_t> newIndices;
-#pragma omp parallel num_threads(Msg::GetNumThreads())
+#pragma omp parallel num_threads(nthreads)
   {
     unsigned int numThreads = Msg::GetNumThreads();
     unsigned int myThreadID = Msg::GetThreadNum();
 #pragma omp single
     {
-      min.resize(numThreads, row[sorted.size()] - row[0]);
+      min.resize(numThreads, row[n] - row[0] + 1);
       Nmin.resize(numThreads, 0);
-      degree.resize(sorted.size(), 0);
+      degree.resize(n, 0);
     }
 #pragma omp for
-    for(auto i = 0ULL; i < sorted.size(); ++i) {
+    for(auto i = 0ULL; i < n; ++i) {
       degree[i] = row[i + 1] - row[i];
-      if(min[myThreadID] > degree[i]) {
+      if(min[myThreadID] > degree[i] ||
+         (min[myThreadID] == degree[i] && Nmin[myThreadID] > i)) {
         min[myThreadID] = degree[i];
         Nmin[myThreadID] = i;
       }
@@ -69,7 +184,7 @@ static void RCM(std::vector<std::size_t> &sorted, const std::size_t *const row,
 #pragma omp single
     {
       for(auto i = 0U; i < numThreads; ++i) {
-        if(min[0] > min[i]) {
+        if(min[0] > min[i] || (min[0] == min[i] && Nmin[0] > Nmin[i])) {
           min[0] = min[i];
           Nmin[0] = Nmin[i];
         }
@@ -80,222 +195,218 @@ static void RCM(std::vector<std::size_t> &sorted, const std::size_t *const row,
 
 #pragma omp single
     {
-      newIndices.resize(row[sorted.size()], 0);
+      newIndices.resize(row[n], 0);
     }
 #pragma omp for
-    for(auto i = 0ULL; i < sorted.size(); ++i) {
+    for(auto i = 0ULL; i < n; ++i) {
       for(auto j = row[i]; j < row[i + 1]; ++j) { newIndices[j] = indices[j]; }
-      std::sort(&newIndices[row[i]], &newIndices[row[i + 1]], sortClass);
+      std::stable_sort(newIndices.data() + row[i], newIndices.data() + row[i + 1],
+                       sortClass);
     }
   }
 
-  sorted[Nmin[0]] = sorted.size();
-  std::size_t nbrNodesSorted = sorted.size() - 1;
-
-  std::queue<std::size_t> queue;
-  for(auto i = row[Nmin[0]]; i < row[Nmin[0] + 1]; ++i) {
-    queue.push(newIndices[i]);
-  }
+  // breadth-first search by level sets: the unnumbered neighbors of each node
+  // of the current level are collected in parallel, then numbered serially in
+  // the order of the level (which gives the same ordering as the sequential
+  // queue-based Cuthill-McKee algorithm)
+  std::size_t nbrNodesSorted = n;
+  std::size_t nextStart = 0;
+  std::vector<std::size_t> level, nextLevel;
+  std::vector<std::vector<std::size_t> > candidates;
+  sorted[Nmin[0]] = nbrNodesSorted--;
+  level.push_back(Nmin[0]);
 
   while(nbrNodesSorted != 0) {
-    if(queue.size() != 0) {
-      if(sorted[queue.front()] == 0) {
-        sorted[queue.front()] = nbrNodesSorted--;
-        for(auto i = row[queue.front()]; i < row[queue.front() + 1]; ++i) {
-          queue.push(newIndices[i]);
+    if(level.empty()) {
+      // start a new connected component from a node of minimum degree
+      std::size_t minDegree = row[n] - row[0] + 1;
+      std::size_t start = n;
+      for(auto i = nextStart; i < n; ++i) {
+        if(sorted[i] == 0 && degree[i] < minDegree) {
+          minDegree = degree[i];
+          start = i;
         }
       }
-      queue.pop();
+      if(start == n) break;
+      while(nextStart < n && sorted[nextStart] != 0) nextStart++;
+      sorted[start] = nbrNodesSorted--;
+      level.push_back(start);
+      continue;
+    }
+    candidates.resize(level.size());
+#pragma omp parallel for num_threads(nthreads) \
+  schedule(dynamic, 256) if(level.size() > 4096)
+    for(std::size_t k = 0; k < level.size(); k++) {
+      candidates[k].clear();
+      const std::size_t i = level[k];
+      for(auto j = row[i]; j < row[i + 1]; ++j) {
+        if(sorted[newIndices[j]] == 0) candidates[k].push_back(newIndices[j]);
+      }
     }
-    else {
-      std::size_t min = row[sorted.size()] - row[0];
-      std::size_t Nmin = 0;
-      for(auto i = 0ULL; i < sorted.size(); ++i) {
-        if(min > degree[i] && sorted[i] == 0) {
-          min = degree[i];
-          Nmin = i;
+    nextLevel.clear();
+    for(std::size_t k = 0; k < level.size(); k++) {
+      for(auto j : candidates[k]) {
+        if(sorted[j] == 0) {
+          sorted[j] = nbrNodesSorted--;
+          nextLevel.push_back(j);
         }
       }
-      queue.push(Nmin);
     }
+    level.swap(nextLevel);
   }
 }
 
-template <typename T>
 static void
-createVertexToVertexGraph(GModel *gm,
-                          const std::vector<std::size_t> &elementTags,
-                          std::map<MVertex *, std::size_t> &initial_numbering,
-                          std::map<std::size_t, MVertex *> &invert_numbering,
-                          std::vector<T> &ai, std::vector<T> &aj)
+computeElementPermutations(const meshRenumberGraph &graph,
+                           const std::vector<std::size_t> &perm,
+                           std::map<std::size_t, std::size_t> &permutations)
 {
-  ai.clear();
-  aj.clear();
-  initial_numbering.clear();
-
-  std::vector<MElement *> elements;
-  if(elementTags.empty()) {
-    std::vector<GEntity *> entities;
-    gm->getEntities(entities);
-    for(auto ge : entities) {
-      for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
-        elements.push_back(ge->getMeshElement(j));
-      }
-    }
-  }
-  else {
-    for(auto n : elementTags) elements.push_back(gm->getMeshElementByTag(n));
+  // sort the elements according to the smallest new number of their nodes,
+  // so that element and node orderings are consistent
+  const std::size_t ne = graph.elements.size();
+  std::vector<std::pair<std::size_t, std::size_t> > keys(ne);
+  std::vector<std::size_t> tags(ne);
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t k = 0; k < ne; k++) {
+    std::size_t m = graph.getNumVertices() + 1;
+    for(std::size_t j = graph.ei[k]; j < graph.ei[k + 1]; j++)
+      m = std::min(m, perm[graph.ej[j]]);
+    keys[k] = std::make_pair(m, k);
+    tags[k] = graph.elements[k]->getNum();
   }
+  std::sort(keys.begin(), keys.end());
+  std::sort(tags.begin(), tags.end());
+  permutations.clear();
+  for(std::size_t k = 0; k < ne; k++)
+    permutations[graph.elements[keys[k].second]->getNum()] = tags[k];
+}
 
-  std::size_t count = 0;
-  std::vector<std::pair<T, T>> coords;
-  std::size_t numbers[1000];
-  for(auto e : elements) {
-    for(std::size_t i = 0; i < e->getNumVertices(); i++) {
-      MVertex *v = e->getVertex(i);
-      auto it = initial_numbering.find(v);
-      if(it == initial_numbering.end()) {
-        numbers[i] = count;
-        invert_numbering[count] = v;
-        initial_numbering[v] = count++;
-      }
-      else
-        numbers[i] = it->second;
-    }
-    for(std::size_t i = 0; i < e->getNumVertices(); i++) {
-      for(std::size_t j = 0; j < e->getNumVertices(); j++) {
-        if(i != j) coords.push_back(std::make_pair(numbers[i], numbers[j]));
-      }
-    }
-  }
-  std::sort(coords.begin(), coords.end());
+static void
+finalizeRenumbering(const meshRenumberGraph &graph,
+                    const std::vector<std::size_t> &perm,
+                    std::map<std::size_t, std::size_t> &permutations,
+                    std::map<std::size_t, std::size_t> *elementPermutations)
+{
+  std::size_t bw0, prof0, bw1, prof1;
+  graph.getBandwidthAndProfile(nullptr, bw0, prof0);
+  graph.getBandwidthAndProfile(&perm[0], bw1, prof1);
+  Msg::Info("Bandwidth %lu -> %lu, profile %lu -> %lu", bw0, bw1, prof0,
+            prof1);
 
-  auto last = std::unique(coords.begin(), coords.end());
-  coords.erase(last, coords.end());
+  for(std::size_t i = 0; i < graph.getNumVertices(); i++)
+    permutations[graph.vertices[i]->getNum()] = perm[i];
 
-  ai.push_back(0);
-  T line = coords[0].first;
-  for(auto c : coords) {
-    if(c.first != line) {
-      ai.push_back((T)aj.size());
-      line = c.first;
-    }
-    aj.push_back(c.second);
-  }
-  ai.push_back((T)aj.size());
+  if(elementPermutations)
+    computeElementPermutations(graph, perm, *elementPermutations);
 }
 
-int meshRenumber_Vertices_RCMK(const std::vector<std::size_t> &elementTags,
-                               std::map<std::size_t, std::size_t> &permutations)
+int meshRenumber_Vertices_RCMK(
+  const std::vector<std::size_t> &elementTags,
+  std::map<std::size_t, std::size_t> &permutations,
+  std::map<std::size_t, std::size_t> *elementPermutations)
 {
   GModel *gm = GModel ::current();
   permutations.clear();
 
   Msg::Info("RCMK renumbering...");
+  double t1 = Cpu(), w1 = TimeOfDay();
 
-  std::map<MVertex *, std::size_t> initial_numbering;
-  std::map<std::size_t, MVertex *> inverse_numbering;
-  std::vector<std::size_t> ai, aj;
-  createVertexToVertexGraph(gm, elementTags, initial_numbering,
-                            inverse_numbering, ai, aj);
-
-  //  int before = bandwidth(ai, aj);
-
-  std::vector<std::size_t> sorted(initial_numbering.size());
+  meshRenumberGraph graph;
+  graph.build(gm, elementTags);
+  if(!graph.getNumVertices()) {
+    Msg::Warning("No nodes to renumber");
+    return -1;
+  }
 
-  RCM(sorted, &ai[0], &aj[0]);
+  std::vector<std::size_t> sorted(graph.getNumVertices(), 0);
 
-  int after = bandwidth(ai, aj, &sorted[0]);
+  RCM(sorted, &graph.ai[0], graph.aj.empty() ? nullptr : &graph.aj[0]);
 
-  for(auto it : initial_numbering) {
-    permutations[it.first->getNum()] = sorted[it.second];
-  }
+  finalizeRenumbering(graph, sorted, permutations, elementPermutations);
 
-  Msg::Info("Done RCMK renumbering (bandwidth is now %d)",
-            after);
+  double t2 = Cpu(), w2 = TimeOfDay();
+  Msg::Info("Done RCMK renumbering (Wall %gs, CPU %gs)", w2 - w1, t2 - t1);
 
   return 0;
 }
 
 int meshRenumber_Vertices_Hilbert(
   const std::vector<std::size_t> &elementTags,
-  std::map<std::size_t, std::size_t> &permutations)
+  std::map<std::size_t, std::size_t> &permutations,
+  std::map<std::size_t, std::size_t> *elementPermutations)
 {
   GModel *gm = GModel ::current();
   permutations.clear();
 
   Msg::Info("Hilbert renumbering...");
+  double t1 = Cpu(), w1 = TimeOfDay();
 
-  std::set<MVertex *> allv;
-  if(elementTags.empty()) {
-    std::vector<GEntity *> entities;
-    gm->getEntities(entities);
-    for(auto ge : entities) {
-      for(std::size_t k = 0; k < ge->getNumMeshVertices(); k++) {
-        allv.insert(ge->getMeshVertex(k));
-      }
-    }
-  }
-  else {
-    for(auto n : elementTags) {
-      MElement *e = gm->getMeshElementByTag(n);
-      for(std::size_t k = 0; k < e->getNumVertices(); k++) {
-        allv.insert(e->getVertex(k));
-      }
-    }
+  meshRenumberGraph graph;
+  graph.build(gm, elementTags);
+  if(!graph.getNumVertices()) {
+    Msg::Warning("No nodes to renumber");
+    return -1;
   }
 
-  std::vector<MVertex *> v(allv.begin(), allv.end());
-
+  std::vector<MVertex *> v(graph.vertices);
   SortHilbert_Without_Brio(v);
 
-  for(std::size_t i = 0; i < v.size(); i++) {
-    permutations[v[i]->getNum()] = i + 1;
-  }
+  robin_hood::unordered_map<MVertex *, std::size_t> rank;
+  for(std::size_t i = 0; i < v.size(); i++) rank[v[i]] = i + 1;
+  std::vector<std::size_t> perm(graph.getNumVertices());
+  for(std::size_t i = 0; i < graph.getNumVertices(); i++)
+    perm[i] = rank[graph.vertices[i]];
+
+  finalizeRenumbering(graph, perm, permutations, elementPermutations);
 
-  Msg::Info("Done Hilbert renumbering");
+  double t2 = Cpu(), w2 = TimeOfDay();
+  Msg::Info("Done Hilbert renumbering (Wall %gs, CPU %gs)", w2 - w1, t2 - t1);
 
   return 0;
 }
 
 int meshRenumber_Vertices_Metis(
   const std::vector<std::size_t> &elementTags,
-  std::map<std::size_t, std::size_t> &permutations)
+  std::map<std::size_t, std::size_t> &permutations,
+  std::map<std::size_t, std::size_t> *elementPermutations)
 {
   permutations.clear();
 
 #if defined(HAVE_METIS)
 
   Msg::Info("METIS renumbering (nested dissection)...");
+  double t1 = Cpu(), w1 = TimeOfDay();
 
   GModel *gm = GModel ::current();
-  std::map<MVertex *, std::size_t> initial_numbering;
-  std::map<std::size_t, MVertex *> invert_numbering;
-  std::vector<idx_t> ai, aj;
-  createVertexToVertexGraph(gm, elementTags, initial_numbering,
-                            invert_numbering, ai, aj);
-
-  idx_t n = (idx_t)initial_numbering.size();
-  idx_t *xadj = &ai[0];
-  idx_t *adjncy = &aj[0];
-  idx_t *perm = new idx_t[n];
-  idx_t *iperm = new idx_t[n];
-  int result = METIS_NodeND(&n, xadj, adjncy, nullptr, nullptr, perm, iperm);
+  meshRenumberGraph graph;
+  graph.build(gm, elementTags);
+  if(!graph.getNumVertices()) {
+    Msg::Warning("No nodes to renumber");
+    return -1;
+  }
+
+  idx_t n = (idx_t)graph.getNumVertices();
+  std::vector<idx_t> xadj(graph.ai.begin(), graph.ai.end());
+  std::vector<idx_t> adjncy(graph.aj.begin(), graph.aj.end());
+  if(adjncy.empty()) adjncy.push_back(0);
+  std::vector<idx_t> perm(n), iperm(n);
+  int result = METIS_NodeND(&n, &xadj[0], &adjncy[0], nullptr, nullptr,
+                            &perm[0], &iperm[0]);
 
   if(result != METIS_OK) {
-    delete[] perm;
-    delete[] iperm;
     Msg::Warning("Renumbering with METIS failed");
     return -1;
   }
 
-  for(auto it : initial_numbering) {
-    permutations[it.first->getNum()] = iperm[it.second] + 1;
-  }
-  delete[] perm;
-  delete[] iperm;
+  std::vector<std::size_t> sorted(n);
+  for(idx_t i = 0; i < n; i++) sorted[i] = iperm[i] + 1;
 
-  Msg::Info("Done METIS renumbering");
+  finalizeRenumbering(graph, sorted, permutations, elementPermutations);
+
+  double t2 = Cpu(), w2 = TimeOfDay();
+  Msg::Info("Done METIS renumbering (Wall %gs, CPU %gs)", w2 - w1, t2 - t1);
 
 #else
 
@@ -305,3 +416,122 @@ int meshRenumber_Vertices_Metis(
 
   return 0;
 }
+
+template <class T> static SPoint3 barycenter(T *e) { return e->barycenter(); }
+
+static SPoint3 barycenter(MVertex *v) { return v->point(); }
+
+template <class T>
+static void addBarycenters(std::vector<T *> &elements,
+                           std::vector<SPoint3> &barycenters,
+                           SBoundingBox3d &bbox)
+{
+  for(auto e : elements) {
+    SPoint3 p = barycenter(e);
+    barycenters.push_back(p);
+    bbox += p;
+  }
+}
+
+template <class T>
+static void sortHilbert(std::vector<T *> &elements,
+                        const SPoint3 *barycenters, const SBoundingBox3d &bbox)
+{
+  if(elements.size() < 2) return;
+  const SPoint3 &pmin = bbox.min(), &pmax = bbox.max();
+  double s[3];
+  for(int i = 0; i < 3; i++) {
+    const double d = pmax[i] - pmin[i];
+    s[i] = d > 0. ? 1. / d : 0.;
+  }
+  std::vector<std::pair<unsigned long long, std::size_t> > keys(
+    elements.size());
+  for(std::size_t i = 0; i < elements.size(); i++) {
+    const SPoint3 &p = barycenters[i];
+    keys[i] = std::make_pair(HilbertKey((p.x() - pmin.x()) * s[0],
+                                        (p.y() - pmin.y()) * s[1],
+                                        (p.z() - pmin.z()) * s[2]),
+                             i);
+  }
+  std::sort(keys.begin(), keys.end());
+  std::vector<T *> sorted(elements.size());
+  for(std::size_t i = 0; i < keys.size(); i++)
+    sorted[i] = elements[keys[i].second];
+  elements.swap(sorted);
+}
+
+template <class T>
+static void sortHilbert(std::vector<T *> &elements,
+                        std::vector<SPoint3> &barycenters,
+                        std::size_t &offset, const SBoundingBox3d &bbox)
+{
+  sortHilbert(elements, barycenters.data() + offset, bbox);
+  offset += elements.size();
+}
+
+static void reorderEntity(GEntity *ge)
+{
+  std::vector<SPoint3> b;
+  SBoundingBox3d bbox;
+  std::size_t o = 0;
+  switch(ge->dim()) {
+  case 0: break;
+  case 1: break; // lines are already ordered along the curve
+  case 2: {
+    GFace *f = static_cast<GFace *>(ge);
+    ExtrudeParams *ep = f->meshAttributes.extrude;
+    if(f->meshAttributes.method == MESH_TRANSFINITE ||
+       (ep && ep->mesh.ExtrudeMesh))
+      break;
+    addBarycenters(f->triangles, b, bbox);
+    addBarycenters(f->quadrangles, b, bbox);
+    addBarycenters(f->polygons, b, bbox);
+    addBarycenters(f->mesh_vertices, b, bbox);
+    sortHilbert(f->triangles, b, o, bbox);
+    sortHilbert(f->quadrangles, b, o, bbox);
+    sortHilbert(f->polygons, b, o, bbox);
+    sortHilbert(f->mesh_vertices, b, o, bbox);
+  } break;
+  case 3: {
+    GRegion *r = static_cast<GRegion *>(ge);
+    ExtrudeParams *ep = r->meshAttributes.extrude;
+    if(r->meshAttributes.method == MESH_TRANSFINITE ||
+       (ep && ep->mesh.ExtrudeMesh))
+      break;
+    addBarycenters(r->tetrahedra, b, bbox);
+    addBarycenters(r->hexahedra, b, bbox);
+    addBarycenters(r->prisms, b, bbox);
+    addBarycenters(r->pyramids, b, bbox);
+    addBarycenters(r->trihedra, b, bbox);
+    addBarycenters(r->polyhedra, b, bbox);
+    addBarycenters(r->mesh_vertices, b, bbox);
+    sortHilbert(r->tetrahedra, b, o, bbox);
+    sortHilbert(r->hexahedra, b, o, bbox);
+    sortHilbert(r->prisms, b, o, bbox);
+    sortHilbert(r->pyramids, b, o, bbox);
+    sortHilbert(r->trihedra, b, o, bbox);
+    sortHilbert(r->polyhedra, b, o, bbox);
+    sortHilbert(r->mesh_vertices, b, o, bbox);
+  } break;
+  }
+}
+
+void meshReorder_Elements_Hilbert(GModel *gm)
+{
+  Msg::StatusBar(true, "Reordering mesh elements...");
+  double t1 = Cpu(), w1 = TimeOfDay();
+
+  std::vector<GEntity *> entities;
+  gm->getEntities(entities);
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < entities.size(); i++) reorderEntity(entities[i]);
+
+  gm->destroyMeshCaches();
+
+  double t2 = Cpu(), w2 = TimeOfDay();
+  Msg::StatusBar(true, "Done reordering mesh elements (Wall %gs, CPU %gs)",
+                 w2 - w1, t2 - t1);
+}
@@ -8,14 +8,61 @@
 
 #include <map>
 #include <vector>
+#include <cstddef>
 
-int meshRenumber_Vertices_RCMK(const std::vector<std::size_t> &elements,
-                               std::map<std::size_t, std::size_t> &permutations);
+class GModel;
+class MVertex;
+class MElement;
 
-int meshRenumber_Vertices_Hilbert(const std::vector<std::size_t> &elements,
-                                  std::map<std::size_t, std::size_t> &permutations);
+// Node graph of (a subset of) the mesh, stored in CSR format. It is built once
+// and shared by all the steps of the renumbering pipeline (node ordering,
+// element ordering and bandwidth/profile statistics).
+class meshRenumberGraph {
+public:
+  // local node index -> node, in order of first appearance in the elements
+  std::vector<MVertex *> vertices;
+  std::vector<MElement *> elements;
+  // node-to-node adjacency (without the diagonal)
+  std::vector<std::size_t> ai, aj;
+  // element-to-node connectivity, with local node indices
+  std::vector<std::size_t> ei, ej;
 
-int meshRenumber_Vertices_Metis(const std::vector<std::size_t> &elementTags,
-                                std::map<std::size_t, std::size_t> &permutations);
+  // build the graph for the given elements (all the elements in the model if
+  // elementTags is empty)
+  void build(GModel *gm, const std::vector<std::size_t> &elementTags);
+  std::size_t getNumVertices() const { return vertices.size(); }
+  // compute the bandwidth and the profile (sum over the rows of the distance
+  // to the left-most entry) of the adjacency matrix, with the nodes numbered
+  // according to perm (local index -> new number), or in their local order if
+  // perm is null
+  void getBandwidthAndProfile(const std::size_t *perm, std::size_t &bandwidth,
+                              std::size_t &profile) const;
+};
+
+// Compute node renumberings (old tag -> new tag). If elementPermutations is
+// provided, also compute a compatible element renumbering in the same pass:
+// elements are sorted according to the smallest new number of their nodes,
+// and are given a permutation of their current tags.
+int meshRenumber_Vertices_RCMK(
+  const std::vector<std::size_t> &elementTags,
+  std::map<std::size_t, std::size_t> &permutations,
+  std::map<std::size_t, std::size_t> *elementPermutations = nullptr);
+
+int meshRenumber_Vertices_Hilbert(
+  const std::vector<std::size_t> &elementTags,
+  std::map<std::size_t, std::size_t> &permutations,
+  std::map<std::size_t, std::size_t> *elementPermutations = nullptr);
+
+int meshRenumber_Vertices_Metis(
+  const std::vector<std::size_t> &elementTags,
+  std::map<std::size_t, std::size_t> &permutations,
+  std::map<std::size_t, std::size_t> *elementPermutations = nullptr);
+
+// Reorder the elements and the nodes of each surface and volume along a
+// Hilbert curve going through the element barycenters and the nodes, to
+// improve the memory locality of loops over the mesh (structured meshes, and
+// curves, whose lines are ordered along the curve, are left untouched). This
+// does not change element or node tags.
+void meshReorder_Elements_Hilbert(GModel *gm);
 
 #endif
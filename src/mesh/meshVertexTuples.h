@@ -0,0 +1,132 @@
+// Gmsh - Copyright (C) 1997-2024 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#ifndef MESH_VERTEX_TUPLES_H
+#define MESH_VERTEX_TUPLES_H
+
+#include <cstddef>
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <utility>
+
+// Table of the unique tuples of at most N nodes (e.g. the edges or the faces of
+// the elements of a mesh), the nodes being identified by local indices in [0,
+// numVertices). The table is built in parallel without hashing: the nodes of
+// each tuple are sorted, and the tuples are stored in compressed rows indexed
+// by their smallest node, row i holding the tuples (i, j, ...) with i < j <
+// ..., in increasing order. Tuples with less than N nodes are padded with -1.
+//
+// A code is associated with each tuple when it is inserted (e.g. identifying
+// the element and the local edge or face in the element); when a tuple is
+// inserted several times, the smallest code is kept, so that the table does not
+// depend on the number of threads.
+template <int N> class meshVertexTuples {
+public:
+  // maximum number of tuples inserted per item
+  enum { MAX_TUPLES = 12 };
+  typedef std::array<int, N - 1> key;
+
+private:
+  std::vector<std::size_t> _ptr;
+  std::vector<key> _keys;
+  std::vector<std::size_t> _codes;
+  // sort the nodes of tuple t, and return its row
+  static int _sort(int *t)
+  {
+    int n = N;
+    while(n > 1 && t[n - 1] < 0) n--;
+    std::sort(t, t + n);
+    return t[0];
+  }
+
+public:
+  // tuples(e, t, c) stores the tuples of item e in t (an array of
+  // MAX_TUPLES * N int) and their codes in c, and returns their number
+  template <class F>
+  void build(int numVertices, std::size_t numItems, F tuples, int nthreads)
+  {
+    // count the tuples in each row (with duplicates)
+    std::vector<std::size_t> start(numVertices + 1, 0);
+#pragma omp parallel for num_threads(nthreads)
+    for(std::size_t e = 0; e < numItems; e++) {
+      int t[MAX_TUPLES][N];
+      std::size_t c[MAX_TUPLES];
+      int n = tuples(e, t, c);
+      for(int k = 0; k < n; k++) {
+        std::size_t &s = start[_sort(t[k]) + 1];
+#pragma omp atomic update
+        s++;
+      }
+    }
+    for(int i = 0; i < numVertices; i++) start[i + 1] += start[i];
+
+    // fill the rows
+    std::vector<std::pair<key, std::size_t> > entries(start[numVertices]);
+    std::vector<std::size_t> pos(start.begin(), start.end() - 1);
+#pragma omp parallel for num_threads(nthreads)
+    for(std::size_t e = 0; e < numItems; e++) {
+      int t[MAX_TUPLES][N];
+      std::size_t c[MAX_TUPLES];
+      int n = tuples(e, t, c);
+      for(int k = 0; k < n; k++) {
+        int i = _sort(t[k]);
+        std::size_t l;
+#pragma omp atomic capture
+        l = pos[i]++;
+        std::copy(t[k] + 1, t[k] + N, entries[l].first.begin());
+        entries[l].second = c[k];
+      }
+    }
+    std::vector<std::size_t>().swap(pos);
+
+    // sort the rows and remove the duplicates, keeping the smallest code
+    _ptr.assign(numVertices + 1, 0);
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+    for(int i = 0; i < numVertices; i++) {
+      std::sort(entries.begin() + start[i], entries.begin() + start[i + 1]);
+      std::size_t n = 0;
+      for(std::size_t k = start[i]; k < start[i + 1]; k++)
+        if(k == start[i] || entries[k].first != entries[k - 1].first) n++;
+      _ptr[i + 1] = n;
+    }
+    for(int i = 0; i < numVertices; i++) _ptr[i + 1] += _ptr[i];
+    _keys.resize(_ptr[numVertices]);
+    _codes.resize(_ptr[numVertices]);
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+    for(int i = 0; i < numVertices; i++) {
+      std::size_t n = _ptr[i];
+      for(std::size_t k = start[i]; k < start[i + 1]; k++) {
+        if(k == start[i] || entries[k].first != entries[k - 1].first) {
+          _keys[n] = entries[k].first;
+          _codes[n] = entries[k].second;
+          n++;
+        }
+      }
+    }
+  }
+  std::size_t size() const { return _keys.size(); }
+  // tuples of row i: [begin(i), end(i))
+  std::size_t begin(int i) const { return _ptr[i]; }
+  std::size_t end(int i) const { return _ptr[i + 1]; }
+  // other nodes and code of tuple k
+  const key &getKey(std::size_t k) const { return _keys[k]; }
+  std::size_t getCode(std::size_t k) const { return _codes[k]; }
+  // index of the tuple t (whose nodes do not need to be sorted), or size() if
+  // it is not in the table
+  std::size_t find(const int *t) const
+  {
+    int s[N];
+    std::copy(t, t + N, s);
+    int i = _sort(s);
+    key k;
+    std::copy(s + 1, s + N, k.begin());
+    auto first = _keys.begin() + _ptr[i], last = _keys.begin() + _ptr[i + 1];
+    auto it = std::lower_bound(first, last, k);
+    return (it != last && *it == k) ? it - _keys.begin() : size();
+  }
+};
+
+#endif
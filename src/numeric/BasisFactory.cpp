@@ -11,6 +11,7 @@
 #include "miniBasis.h"
 #include "CondNumBasis.h"
 #include "JacobianBasis.h"
+#include "QuadratureBasis.h"
 #include <map>
 #include <cstddef>
 
@@ -19,6 +20,8 @@ std::map<int, CondNumBasis *> BasisFactory::cs;
 std::map<FuncSpaceData, JacobianBasis *> BasisFactory::js;
 std::map<FuncSpaceData, bezierBasis *> BasisFactory::bs;
 std::map<FuncSpaceData, GradientBasis *> BasisFactory::gs;
+std::map<std::pair<int, std::pair<int, bool> >, QuadratureBasis *>
+  BasisFactory::qs;
 
 const nodalBasis *BasisFactory::getNodalBasis(int tag)
 {
@@ -147,6 +150,38 @@ const bezierBasis *BasisFactory::getBezierBasis(int tag)
   return getBezierBasis(FuncSpaceData(tag));
 }
 
+const QuadratureBasis *BasisFactory::getQuadratureBasis(int tag, int order,
+                                                        bool forceTensorRule)
+{
+  std::pair<int, std::pair<int, bool> > key(
+    tag, std::make_pair(order, forceTensorRule));
+
+  QuadratureBasis *Q = nullptr;
+#pragma omp critical(BasisFactoryQuadrature)
+  {
+    auto it = qs.find(key);
+    if(it != qs.end()) { Q = it->second; }
+  }
+  if(Q) return Q;
+
+  // tabulate outside of the critical section (this calls getNodalBasis)
+  Q = new QuadratureBasis(tag, order, forceTensorRule);
+  if(!Q->getNumShapeFunctions()) {
+    delete Q;
+    return nullptr;
+  }
+
+#pragma omp critical(BasisFactoryQuadrature)
+  {
+    auto inserted = qs.insert(std::make_pair(key, Q));
+    if(!inserted.second) {
+      delete Q;
+      Q = inserted.first->second;
+    }
+  }
+  return Q;
+}
+
 void BasisFactory::clearAll()
 {
   auto itF = fs.begin();
@@ -183,4 +218,11 @@ void BasisFactory::clearAll()
     itB++;
   }
   bs.clear();
+
+  auto itQ = qs.begin();
+  while(itQ != qs.end()) {
+    delete itQ->second;
+    itQ++;
+  }
+  qs.clear();
 }
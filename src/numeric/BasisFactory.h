@@ -13,6 +13,7 @@ class bezierBasis;
 class CondNumBasis;
 class JacobianBasis;
 class FuncSpaceData;
+class QuadratureBasis;
 
 class BasisFactory {
 private:
@@ -21,6 +22,7 @@ private:
   static std::map<FuncSpaceData, JacobianBasis *> js;
   static std::map<FuncSpaceData, bezierBasis *> bs;
   static std::map<FuncSpaceData, GradientBasis *> gs;
+  static std::map<std::pair<int, std::pair<int, bool> >, QuadratureBasis *> qs;
 
 public:
   // Caution: the returned pointer can be NULL
@@ -48,6 +50,11 @@ public:
   static const bezierBasis *getBezierBasis(int parentType, int order);
   static const bezierBasis *getBezierBasis(int tag);
 
+  // Shape functions and gradients tabulated at Gauss points: fetch the
+  // pointer once outside of element loops, it remains valid until clearAll()
+  static const QuadratureBasis *getQuadratureBasis(int tag, int order,
+                                                   bool forceTensorRule = false);
+
   static void clearAll();
 };
 
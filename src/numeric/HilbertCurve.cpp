@@ -273,3 +273,42 @@ void SortHilbert_Without_Brio(std::vector<MVertex *> &v){
   HilbertSort h(1000);
   h.Apply(v,v.size()+1);
 }
+
+unsigned long long HilbertKey(double x, double y, double z)
+{
+  // J. Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707, 2004:
+  // quantize the coordinates on 21 bits, transform them to the transposed
+  // Hilbert index, then interleave the bits into a 63 bit key
+  const int nbits = 21;
+  const unsigned int maxc = (1U << nbits) - 1;
+  const double c[3] = {x, y, z};
+  unsigned int X[3];
+  for(int i = 0; i < 3; i++) {
+    double t = c[i] < 0. ? 0. : (c[i] > 1. ? 1. : c[i]);
+    X[i] = (unsigned int)(t * maxc);
+  }
+  const unsigned int M = 1U << (nbits - 1);
+  // inverse undo
+  for(unsigned int Q = M; Q > 1; Q >>= 1) {
+    const unsigned int P = Q - 1;
+    for(int i = 0; i < 3; i++) {
+      if(X[i] & Q)
+        X[0] ^= P;
+      else {
+        const unsigned int t = (X[0] ^ X[i]) & P;
+        X[0] ^= t;
+        X[i] ^= t;
+      }
+    }
+  }
+  // Gray encode
+  for(int i = 1; i < 3; i++) X[i] ^= X[i - 1];
+  unsigned int t = 0;
+  for(unsigned int Q = M; Q > 1; Q >>= 1)
+    if(X[2] & Q) t ^= Q - 1;
+  for(int i = 0; i < 3; i++) X[i] ^= t;
+  unsigned long long key = 0;
+  for(int b = nbits - 1; b >= 0; b--)
+    for(int i = 0; i < 3; i++) key = (key << 1) | ((X[i] >> b) & 1U);
+  return key;
+}
@@ -9,4 +9,8 @@
 void SortHilbert(std::vector<MVertex *> &);
 void SortHilbert_Without_Brio(std::vector<MVertex *> &v);
 
+// index of the point (x, y, z) along a Hilbert curve filling the unit cube
+// (coordinates are clamped to [0, 1])
+unsigned long long HilbertKey(double x, double y, double z);
+
 #endif
@@ -0,0 +1,69 @@
+// Gmsh - Copyright (C) 1997-2024 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#include "QuadratureBasis.h"
+#include "BasisFactory.h"
+#include "ElementType.h"
+#include "GaussIntegration.h"
+#include "GmshMessage.h"
+#include "nodalBasis.h"
+
+QuadratureBasis::QuadratureBasis(int tag, int order, bool forceTensorRule)
+  : _tag(tag), _order(order)
+{
+  gaussIntegration::get(ElementType::getParentType(tag), order, _points,
+                        _weights, forceTensorRule);
+  _tabulate();
+}
+
+QuadratureBasis::QuadratureBasis(int tag, const fullMatrix<double> &points,
+                                 const fullVector<double> &weights)
+  : _tag(tag), _order(-1), _points(points), _weights(weights)
+{
+  _tabulate();
+}
+
+void QuadratureBasis::_tabulate()
+{
+  const nodalBasis *fs = BasisFactory::getNodalBasis(_tag);
+  if(!fs) {
+    Msg::Error("No nodal basis for element type %d (in QuadratureBasis)",
+               _tag);
+    return;
+  }
+  const int nbPts = _points.size1();
+  const int nbFcts = fs->getNumShapeFunctions();
+  const int dim = _points.size2();
+  _f.resize(nbFcts, nbPts);
+  _df.resize(nbFcts, 3 * nbPts);
+  double s[1256], ds[1256][3];
+  for(int i = 0; i < nbPts; i++) {
+    const double u = _points(i, 0);
+    const double v = dim > 1 ? _points(i, 1) : 0.;
+    const double w = dim > 2 ? _points(i, 2) : 0.;
+    fs->f(u, v, w, s);
+    fs->df(u, v, w, ds);
+    for(int j = 0; j < nbFcts; j++) {
+      _f(j, i) = s[j];
+      _df(j, 3 * i) = ds[j][0];
+      _df(j, 3 * i + 1) = ds[j][1];
+      _df(j, 3 * i + 2) = ds[j][2];
+    }
+  }
+}
+
+void QuadratureBasis::getPointsFromNodes(const fullMatrix<double> &nodes,
+                                         fullMatrix<double> &xyz) const
+{
+  xyz.resize(3, getNumPoints(), false);
+  nodes.transpose().mult(_f, xyz);
+}
+
+void QuadratureBasis::getJacobiansFromNodes(const fullMatrix<double> &nodes,
+                                            fullMatrix<double> &jac) const
+{
+  jac.resize(3, 3 * getNumPoints(), false);
+  nodes.transpose().mult(_df, jac);
+}
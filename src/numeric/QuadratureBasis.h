@@ -0,0 +1,65 @@
+// Gmsh - Copyright (C) 1997-2024 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#ifndef QUADRATURE_BASIS_H
+#define QUADRATURE_BASIS_H
+
+#include "fullMatrix.h"
+
+// Nodal shape functions and their gradients tabulated once at the points of a
+// quadrature rule. The data is stored point by point (column-major), so that
+// evaluating a quantity at all the points of an element reduces to a single
+// matrix-matrix product with the nodal data of that element.
+class QuadratureBasis {
+private:
+  const int _tag, _order;
+  fullMatrix<double> _points;
+  fullVector<double> _weights;
+  // _f(j, i) is the value of shape function j at point i
+  fullMatrix<double> _f;
+  // _df(j, 3 * i + k) is the derivative of shape function j with respect to
+  // the k-th parametric coordinate at point i
+  fullMatrix<double> _df;
+
+  void _tabulate();
+
+public:
+  // Gauss quadrature of the given order on the parent type of element "tag"
+  QuadratureBasis(int tag, int order, bool forceTensorRule = false);
+  // arbitrary set of points (one per row) and weights
+  QuadratureBasis(int tag, const fullMatrix<double> &points,
+                  const fullVector<double> &weights);
+
+  int getTag() const { return _tag; }
+  int getOrder() const { return _order; }
+  int getNumPoints() const { return _points.size1(); }
+  int getNumShapeFunctions() const { return _f.size1(); }
+  const fullMatrix<double> &getPoints() const { return _points; }
+  const fullVector<double> &getWeights() const { return _weights; }
+
+  // contiguous values of all the shape functions at point i
+  const double *getShapeFunctions(int i) const
+  {
+    return _f.getDataPtr() + (std::size_t)i * _f.size1();
+  }
+  // (numShapeFunctions x 3) proxy on the gradients at point i
+  void getGradShapeFunctions(int i, fullMatrix<double> &gsf) const
+  {
+    gsf.setAsProxy(_df, 3 * i, 3);
+  }
+  const fullMatrix<double> &getShapeFunctionsMatrix() const { return _f; }
+  const fullMatrix<double> &getGradShapeFunctionsMatrix() const { return _df; }
+
+  // Given the (numShapeFunctions x 3) nodal coordinates of an element, compute
+  // the (3 x numPoints) physical coordinates of all the points, and the
+  // (3 x 3 numPoints) Jacobian matrices jac(c, 3 * i + k) = dx_c/du_k at
+  // point i
+  void getPointsFromNodes(const fullMatrix<double> &nodes,
+                          fullMatrix<double> &xyz) const;
+  void getJacobiansFromNodes(const fullMatrix<double> &nodes,
+                             fullMatrix<double> &jac) const;
+};
+
+#endif
@@ -15,7 +15,7 @@
 #if defined(HAVE_SOLVER)
 #include "dofManager.h"
 #include "linearSystemCSR.h"
-#include "linearSystemFull.h"
+#include "linearSystemCSRIterative.h"
 #include "linearSystemPETSc.h"
 #include "distanceTerm.h"
 #endif
@@ -230,10 +230,9 @@ PView *GMSH_DistancePlugin::execute(PView *v)
 #if defined(HAVE_SOLVER)
 #if defined(HAVE_PETSC)
     linearSystemPETSc<double> *lsys = new linearSystemPETSc<double>;
-#elif defined(HAVE_GMM)
-    linearSystemCSRGmm<double> *lsys = new linearSystemCSRGmm<double>;
 #else
-    linearSystemFull<double> *lsys = new linearSystemFull<double>;
+    linearSystemCSRIterative<double> *lsys =
+      new linearSystemCSRIterative<double>(CSRIterativeCG, CSRIterativeAMG);
 #endif
     dofManager<double> *dofView = new dofManager<double>(lsys);
 
@@ -291,10 +290,7 @@ PView *GMSH_DistancePlugin::execute(PView *v)
       double mu = type * L;
       simpleFunction<double> DIFF(mu * mu), ONE(1.0);
       distanceTerm distance(GModel::current(), 1, &DIFF, &ONE);
-      for(auto it = allElems.begin(); it != allElems.end(); it++) {
-        SElement se((*it));
-        distance.addToMatrix(*dofView, &se);
-      }
+      distance.addToMatrixColored(*dofView, allElems);
       groupOfElements gr(allElems);
       distance.addToRightHandSide(*dofView, gr);
       lsys->systemSolve();
@@ -48,48 +48,60 @@ PView *GMSH_GradientPlugin::execute(PView *v)
   PViewDataList *data2 = getDataList(v2);
   int firstNonEmptyStep = data1->getFirstNonEmptyTimeStep();
 
-  for(int ent = 0; ent < data1->getNumEntities(firstNonEmptyStep); ent++) {
-    for(int ele = 0; ele < data1->getNumElements(firstNonEmptyStep, ent);
-        ele++) {
-      if(data1->skipElement(firstNonEmptyStep, ent, ele)) continue;
-      int numComp = data1->getNumComponents(firstNonEmptyStep, ent, ele);
-      if(numComp != 1 && numComp != 3) continue;
-      int type = data1->getType(firstNonEmptyStep, ent, ele);
-      int numNodes = data1->getNumNodes(firstNonEmptyStep, ent, ele);
-      std::vector<double> *out =
-        data2->incrementList((numComp == 1) ? 3 : 9, type, numNodes);
-      if(!out) continue;
-      double x[8], y[8], z[8], val[8 * 3];
-      for(int nod = 0; nod < numNodes; nod++)
-        data1->getNode(firstNonEmptyStep, ent, ele, nod, x[nod], y[nod],
-                       z[nod]);
-      int dim = data1->getDimension(firstNonEmptyStep, ent, ele);
-      elementFactory factory;
-      element *element = factory.create(numNodes, dim, x, y, z);
-      if(!element) continue;
-      for(int nod = 0; nod < numNodes; nod++) out->push_back(x[nod]);
-      for(int nod = 0; nod < numNodes; nod++) out->push_back(y[nod]);
-      for(int nod = 0; nod < numNodes; nod++) out->push_back(z[nod]);
-      for(int step = 0; step < data1->getNumTimeSteps(); step++) {
-        if(!data1->hasTimeStep(step)) continue;
-        for(int nod = 0; nod < numNodes; nod++)
-          for(int comp = 0; comp < numComp; comp++)
-            data1->getValue(step, ent, ele, nod, comp,
-                            val[numComp * nod + comp]);
+  std::vector<int> steps;
+  for(int step = 0; step < data1->getNumTimeSteps(); step++)
+    if(data1->hasTimeStep(step)) steps.push_back(step);
+
+  std::vector<double> out;
+  forEachElementBatch(
+    data1, firstNonEmptyStep, steps,
+    [&](const PViewElementBatch &b) {
+      const int numNodes = b.numNodes, numComp = b.numComp;
+      if(numComp != 1 && numComp != 3) return;
+      if(numNodes > 8) return;
+      const std::size_t stride = (3 + steps.size() * numComp * 3) * numNodes;
+      out.resize(b.size() * stride);
+      std::vector<char> ok(b.size(), 0);
+      forEachElement(b.size(), [&](std::size_t i, int thread) {
+        double x[8], y[8], z[8];
         for(int nod = 0; nod < numNodes; nod++) {
-          double u, v, w, f[3];
-          element->getNode(nod, u, v, w);
-          for(int comp = 0; comp < numComp; comp++) {
-            element->interpolateGrad(val + comp, u, v, w, f, numComp);
-            out->push_back(f[0]);
-            out->push_back(f[1]);
-            out->push_back(f[2]);
+          x[nod] = b.x(i)[nod];
+          y[nod] = b.y(i)[nod];
+          z[nod] = b.z(i)[nod];
+        }
+        elementFactory factory;
+        element *element = factory.create(numNodes, b.dim, x, y, z);
+        if(!element) return;
+        double *o = &out[i * stride];
+        for(int k = 0; k < 3 * numNodes; k++) *o++ = b.x(i)[k];
+        for(std::size_t s = 0; s < steps.size(); s++) {
+          double *val = const_cast<double *>(b.value(i, s));
+          for(int nod = 0; nod < numNodes; nod++) {
+            double u, v, w, f[3];
+            element->getNode(nod, u, v, w);
+            for(int comp = 0; comp < numComp; comp++) {
+              element->interpolateGrad(val + comp, u, v, w, f, numComp);
+              *o++ = f[0];
+              *o++ = f[1];
+              *o++ = f[2];
+            }
           }
         }
+        delete element;
+        ok[i] = 1;
+      });
+      for(std::size_t i = 0; i < b.size(); i++) {
+        if(!ok[i]) continue;
+        std::vector<double> *l =
+          data2->incrementList((numComp == 1) ? 3 : 9, b.type, numNodes);
+        if(!l) continue;
+        l->insert(l->end(), out.begin() + i * stride,
+                  out.begin() + (i + 1) * stride);
       }
-      delete element;
-    }
-  }
+    },
+    [&](int ent, int ele) {
+      return !data1->skipElement(firstNonEmptyStep, ent, ele);
+    });
 
   for(int i = 0; i < data1->getNumTimeSteps(); i++) {
     if(!data1->hasTimeStep(i)) continue;
@@ -69,44 +69,57 @@ PView *GMSH_IntegratePlugin::execute(PView *v)
     for(int step = 0; step < data1->getNumTimeSteps(); step++) {
       double res = 0, resv[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
       bool simpleSum = false;
-      for(int ent = 0; ent < data1->getNumEntities(step); ent++) {
-        if(visible && data1->skipEntity(step, ent)) continue;
-        for(int ele = 0; ele < data1->getNumElements(step, ent); ele++) {
-          if(data1->skipElement(step, ent, ele, visible)) continue;
-          int numComp = data1->getNumComponents(step, ent, ele);
-          int numEdges = data1->getNumEdges(step, ent, ele);
-          bool scalar = (numComp == 1);
-          bool circulation = (numComp == 3 && numEdges == 1);
-          bool flux = (numComp == 3 && (numEdges == 3 || numEdges == 4));
-          int numNodes = data1->getNumNodes(step, ent, ele);
-          int dim = data1->getDimension(step, ent, ele);
-          if((dimension > 0) && (dim != dimension)) continue;
-          double x[8], y[8], z[8], val[8 * 3] = {0.};
-          for(int nod = 0; nod < numNodes; nod++) {
-            data1->getNode(step, ent, ele, nod, x[nod], y[nod], z[nod]);
-            for(int comp = 0; comp < numComp; comp++)
-              data1->getValue(step, ent, ele, nod, comp,
-                              val[numComp * nod + comp]);
-          }
+      std::vector<double> contrib;
+      forEachElementBatch(
+        data1, step, std::vector<int>(1, step),
+        [&](const PViewElementBatch &b) {
+          const int numNodes = b.numNodes, numComp = b.numComp;
           if(numNodes == 1) {
             simpleSum = true;
-            res += val[0];
-            for(int comp = 0; comp < numComp; comp++) resv[comp] += val[comp];
+            for(std::size_t i = 0; i < b.size(); i++) {
+              const double *val = b.value(i, 0);
+              res += val[0];
+              for(int comp = 0; comp < numComp; comp++)
+                resv[comp] += val[comp];
+            }
+            return;
           }
-          else {
+          if(numNodes > 8 || numComp > 3) return;
+          const int numEdges = data1->getNumEdges(step, b.ent, b.elements[0]);
+          const bool scalar = (numComp == 1);
+          const bool circulation = (numComp == 3 && numEdges == 1);
+          const bool flux = (numComp == 3 && (numEdges == 3 || numEdges == 4));
+          contrib.assign(b.size(), 0.);
+          forEachElement(b.size(), [&](std::size_t i, int thread) {
+            double x[8], y[8], z[8], val[8 * 3] = {0.};
+            for(int nod = 0; nod < numNodes; nod++) {
+              x[nod] = b.x(i)[nod];
+              y[nod] = b.y(i)[nod];
+              z[nod] = b.z(i)[nod];
+            }
+            const double *v = b.value(i, 0);
+            for(int k = 0; k < numNodes * numComp; k++) val[k] = v[k];
             elementFactory factory;
-            element *element = factory.create(numNodes, dim, x, y, z);
-            if(!element) continue;
+            element *element = factory.create(numNodes, b.dim, x, y, z);
+            if(!element) return;
             if(scalar)
-              res += element->integrate(val);
+              contrib[i] = element->integrate(val);
             else if(circulation)
-              res += element->integrateCirculation(val);
+              contrib[i] = element->integrateCirculation(val);
             else if(flux)
-              res += element->integrateFlux(val);
+              contrib[i] = element->integrateFlux(val);
             delete element;
-          }
-        }
-      }
+          });
+          // sum sequentially, so that the result does not depend on the
+          // number of threads
+          for(std::size_t i = 0; i < b.size(); i++) res += contrib[i];
+        },
+        [&](int ent, int ele) {
+          if(visible && data1->skipEntity(step, ent)) return false;
+          if(data1->skipElement(step, ent, ele, visible)) return false;
+          int dim = data1->getDimension(step, ent, ele);
+          return (dimension <= 0) || (dim == dimension);
+        });
       if(simpleSum)
         Msg::Info("Step %d: sum = %g %g %g %g %g %g %g %g %g", step, resv[0],
                   resv[1], resv[2], resv[3], resv[4], resv[5], resv[6], resv[7],
@@ -126,48 +139,46 @@ PView *GMSH_IntegratePlugin::execute(PView *v)
   else {
     int firstStep = data1->getFirstNonEmptyTimeStep();
     int numSteps = data1->getNumTimeSteps();
-    for(int ent = 0; ent < data1->getNumEntities(firstStep); ent++) {
-      for(int ele = 0; ele < data1->getNumElements(firstStep, ent); ele++) {
-        if(data1->skipElement(firstStep, ent, ele)) continue;
-        int dim = data1->getDimension(firstStep, ent, ele);
-        if((dimension > 0) && (dim != dimension)) continue;
-
-        int numNodes = data1->getNumNodes(firstStep, ent, ele);
-        int type = data1->getType(firstStep, ent, ele);
-        int numComp = data1->getNumComponents(firstStep, ent, ele);
-        if(numComp != 1)
+    std::vector<int> steps;
+    std::vector<double> t;
+    for(int step = firstStep + overTime; step < numSteps - 1; step++) {
+      if(!data1->hasTimeStep(step)) continue;
+      steps.push_back(step);
+      t.push_back(data1->getTime(step));
+    }
+    std::vector<double> out;
+    forEachElementBatch(
+      data1, firstStep, steps,
+      [&](const PViewElementBatch &b) {
+        const int numNodes = b.numNodes;
+        if(b.numComp != 1) {
           Msg::Error("Can only integrate scalar views over time");
-        std::vector<double> *out =
-          data2->incrementList(numComp, type, numNodes);
-        std::vector<double> x(numNodes), y(numNodes), z(numNodes);
-        for(int nod = 0; nod < numNodes; nod++)
-          data1->getNode(firstStep, ent, ele, nod, x[nod], y[nod], z[nod]);
-        for(int nod = 0; nod < numNodes; nod++) out->push_back(x[nod]);
-        for(int nod = 0; nod < numNodes; nod++) out->push_back(y[nod]);
-        for(int nod = 0; nod < numNodes; nod++) out->push_back(z[nod]);
-
-        std::vector<double> val, t;
-        for(int step = firstStep + overTime; step < numSteps - 1; step++) {
-          if(!data1->hasTimeStep(step)) continue;
-          t.push_back(data1->getTime(step));
-          for(int nod = 0; nod < numNodes; nod++) {
-            double v;
-            data1->getValue(step, ent, ele, nod, 0, v);
-            val.push_back(v);
-          }
+          return;
         }
-        std::vector<double> timeIntegral(numNodes, 0.);
-        for(std::size_t step = 0; step < t.size() - 1; step++) {
-          double dt = t[step + 1] - t[step];
-          for(int nod = 0; nod < numNodes; nod++) {
-            timeIntegral[nod] += 0.5 *
-              (val[step * numNodes + nod] + val[(step + 1) * numNodes + nod]) * dt;
+        const std::size_t stride = 4 * numNodes;
+        out.resize(b.size() * stride);
+        forEachElement(b.size(), [&](std::size_t i, int thread) {
+          double *o = &out[i * stride];
+          for(int k = 0; k < 3 * numNodes; k++) *o++ = b.x(i)[k];
+          for(int nod = 0; nod < numNodes; nod++) o[nod] = 0.;
+          for(std::size_t s = 0; s + 1 < t.size(); s++) {
+            const double dt = t[s + 1] - t[s];
+            const double *v0 = b.value(i, s), *v1 = b.value(i, s + 1);
+            for(int nod = 0; nod < numNodes; nod++)
+              o[nod] += 0.5 * (v0[nod] + v1[nod]) * dt;
           }
+        });
+        for(std::size_t i = 0; i < b.size(); i++) {
+          std::vector<double> *l = data2->incrementList(1, b.type, numNodes);
+          l->insert(l->end(), out.begin() + i * stride,
+                    out.begin() + (i + 1) * stride);
         }
-        for(int nod = 0; nod < numNodes; nod++)
-          out->push_back(timeIntegral[nod]);
-      }
-    }
+      },
+      [&](int ent, int ele) {
+        if(data1->skipElement(firstStep, ent, ele)) return false;
+        int dim = data1->getDimension(firstStep, ent, ele);
+        return (dimension <= 0) || (dim == dimension);
+      });
   }
 
   data2->setName(data1->getName() + "_Integrate");
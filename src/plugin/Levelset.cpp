@@ -10,6 +10,9 @@
 #include "adaptiveData.h"
 #include "GmshDefines.h"
 #include "PViewOptions.h"
+#include "PViewDataGModel.h"
+#include "GEntity.h"
+#include "MElement.h"
 
 static const int exn[13][12][2] = {
   {{0, 0}}, // point
@@ -223,7 +226,6 @@ static void reorderPrism(int numComp, double xp[12], double yp[12],
 
 GMSH_LevelsetPlugin::GMSH_LevelsetPlugin()
 {
-  _invert = 0.;
   _ref[0] = _ref[1] = _ref[2] = 0.;
   _valueIndependent = 0; // "moving" levelset
   _valueView = -1; // use same view for levelset and field data
@@ -238,7 +240,8 @@ GMSH_LevelsetPlugin::GMSH_LevelsetPlugin()
 void GMSH_LevelsetPlugin::_addElement(int np, int numEdges, int numComp,
                                       double xp[12], double yp[12],
                                       double zp[12], double valp[12][9],
-                                      PViewDataList *out, bool firstStep)
+                                      PViewDataList *out,
+                                      bool firstStep) const
 {
   std::vector<double> *list;
   int *nbPtr;
@@ -372,21 +375,14 @@ void GMSH_LevelsetPlugin::_addElement(int np, int numEdges, int numComp,
 }
 
 void GMSH_LevelsetPlugin::_cutAndAddElements(
-  PViewData *vdata, PViewData *wdata, int ent, int ele, int vstep, int wstep,
-  double x[8], double y[8], double z[8], double levels[8],
-  double scalarValues[8], PViewDataList *out)
+  int type, int numNodes, int numEdges, int numComp, int numSteps,
+  const char *hasStep, const double *wval, double x[8], double y[8],
+  double z[8], double levels[8], double scalarValues[8],
+  PViewDataList *out) const
 {
-  int stepmin = vstep, stepmax = vstep + 1, otherstep = wstep;
-  if(stepmin < 0) {
-    stepmin = vdata->getFirstNonEmptyTimeStep();
-    stepmax = vdata->getNumTimeSteps();
-  }
-  if(wstep < 0) otherstep = wdata->getFirstNonEmptyTimeStep();
-
-  int numNodes = vdata->getNumNodes(stepmin, ent, ele);
-  int numEdges = vdata->getNumEdges(stepmin, ent, ele);
-  int numComp = wdata->getNumComponents(otherstep, ent, ele);
-  int type = vdata->getType(stepmin, ent, ele);
+  // orientation of the cut elements, computed only once for spatially-fixed
+  // views
+  double invert = 0.;
 
   // decompose the element into simplices
   for(int simplex = 0; simplex < numSimplexDec(type); simplex++) {
@@ -395,11 +391,10 @@ void GMSH_LevelsetPlugin::_cutAndAddElements(
                   nsn, nse);
 
     // loop over time steps
-    for(int step = stepmin; step < stepmax; step++) {
+    for(int step = 0; step < numSteps; step++) {
       // check which edges cut the iso and interpolate the value
-      if(wstep < 0) otherstep = step;
-
-      if(!wdata->hasTimeStep(otherstep)) continue;
+      if(!hasStep[step]) continue;
+      const double *w = &wval[step * numNodes * numComp];
 
       int np = 0;
       double xp[12], yp[12], zp[12], valp[12][9];
@@ -409,9 +404,8 @@ void GMSH_LevelsetPlugin::_cutAndAddElements(
           double c = InterpolateIso(x, y, z, levels, 0., n[n0], n[n1], &xp[np],
                                     &yp[np], &zp[np]);
           for(int comp = 0; comp < numComp; comp++) {
-            double v0, v1;
-            wdata->getValue(otherstep, ent, ele, n[n0], comp, v0);
-            wdata->getValue(otherstep, ent, ele, n[n1], comp, v1);
+            double v0 = w[n[n0] * numComp + comp];
+            double v1 = w[n[n1] * numComp + comp];
             valp[np][comp] = v0 + c * (v1 - v0);
           }
           ep[np++] = i + 1;
@@ -439,11 +433,9 @@ void GMSH_LevelsetPlugin::_cutAndAddElements(
             yp[nod] = y[n[nod]];
             zp[nod] = z[n[nod]];
             for(int comp = 0; comp < numComp; comp++)
-              wdata->getValue(otherstep, ent, ele, n[nod], comp,
-                              valp[nod][comp]);
+              valp[nod][comp] = w[n[nod] * numComp + comp];
           }
-          _addElement(nsn, nse, numComp, xp, yp, zp, valp, out,
-                      step == stepmin);
+          _addElement(nsn, nse, numComp, xp, yp, zp, valp, out, step == 0);
         }
         continue;
       }
@@ -462,7 +454,7 @@ void GMSH_LevelsetPlugin::_cutAndAddElements(
       // orient the triangles and the quads to get the normals right
       if(!_extractVolume && (np == 3 || np == 4)) {
         // compute invertion test only once for spatially-fixed views
-        if(step == stepmin || !_valueIndependent) {
+        if(step == 0 || !_valueIndependent) {
           double v1[3] = {xp[2] - xp[0], yp[2] - yp[0], zp[2] - zp[0]};
           double v2[3] = {xp[1] - xp[0], yp[1] - yp[0], zp[1] - zp[0]};
           double gr[3], normal[3];
@@ -470,19 +462,19 @@ void GMSH_LevelsetPlugin::_cutAndAddElements(
           switch(_orientation) {
           case MAP:
             gradSimplex(x, y, z, scalarValues, gr);
-            _invert = prosca(gr, normal);
+            invert = prosca(gr, normal);
             break;
-          case PLANE: _invert = prosca(normal, _ref); break;
+          case PLANE: invert = prosca(normal, _ref); break;
           case SPHERE:
             gr[0] = xp[0] - _ref[0];
             gr[1] = yp[0] - _ref[1];
             gr[2] = zp[0] - _ref[2];
-            _invert = prosca(gr, normal);
+            invert = prosca(gr, normal);
           case NONE:
           default: break;
           }
         }
-        if(_invert > 0.) {
+        if(invert > 0.) {
           double xpi[12], ypi[12], zpi[12], valpi[12][9];
           int epi[12];
           for(int k = 0; k < np; k++)
@@ -506,8 +498,7 @@ void GMSH_LevelsetPlugin::_cutAndAddElements(
             yp[np] = y[n[nod]];
             zp[np] = z[n[nod]];
             for(int comp = 0; comp < numComp; comp++)
-              wdata->getValue(otherstep, ent, ele, n[nod], comp,
-                              valp[np][comp]);
+              valp[np][comp] = w[n[nod] * numComp + comp];
             ep[np] = -(nod + 1); // store node num!
             np++;
           }
@@ -520,18 +511,109 @@ void GMSH_LevelsetPlugin::_cutAndAddElements(
       }
 
       // finally, add the new element
-      _addElement(np, numEdges, numComp, xp, yp, zp, valp, out,
-                  step == stepmin);
+      _addElement(np, numEdges, numComp, xp, yp, zp, valp, out, step == 0);
     }
+  }
+}
 
+bool GMSH_LevelsetPlugin::_cutNodeData(PViewDataGModel *vdata,
+                                       PViewDataGModel *wdata, int gstep,
+                                       int stepmin, int stepmax,
+                                       bool useValues,
+                                       PViewDataList *out) const
+{
+  stepData<double> *vsd = vdata->getStepData(gstep);
+  int numSteps = stepmax - stepmin;
+  std::vector<stepData<double> *> wsd(numSteps, nullptr);
+  std::vector<char> hasStep(numSteps, 0);
+  for(int s = 0; s < numSteps; s++) {
+    int wstep = (_valueTimeStep < 0) ? stepmin + s : _valueTimeStep;
+    if(!wdata->hasTimeStep(wstep)) continue;
+    wsd[s] = wdata->getStepData(wstep);
+    hasStep[s] = 1;
   }
+  int vnumComp = vsd->getNumComponents(), numComp = 0;
+  for(int s = 0; s < numSteps && !numComp; s++)
+    if(hasStep[s]) numComp = wsd[s]->getNumComponents();
+  if(!numComp) numComp = 1; // no values to interpolate
+
+  // split the elements of each entity into chunks, cut in parallel: each
+  // chunk is stored in its own list-based dataset, which are then merged in
+  // order to get the same output as the serial algorithm
+  const std::size_t chunkSize = 1024;
+  std::vector<std::pair<GEntity *, std::size_t> > chunks;
+  for(int ent = 0; ent < vdata->getNumEntities(gstep); ent++) {
+    GEntity *ge = vdata->getEntity(gstep, ent);
+    for(std::size_t i = 0; i < ge->getNumMeshElements(); i += chunkSize)
+      chunks.push_back(std::make_pair(ge, i));
+  }
+  std::vector<PViewDataList *> outs(chunks.size(), nullptr);
+  std::vector<char> found(chunks.size(), 0);
+
+  int nthreads = getNumThreads();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t c = 0; c < chunks.size(); c++) {
+    GEntity *ge = chunks[c].first;
+    std::size_t last =
+      std::min(chunks[c].second + chunkSize, ge->getNumMeshElements());
+    std::vector<double> wval(numSteps * 8 * numComp, 0.);
+    double x[8], y[8], z[8], levels[8];
+    double scalarValues[8] = {0., 0., 0., 0., 0., 0., 0., 0.};
+    for(std::size_t i = chunks[c].second; i < last; i++) {
+      MElement *e = ge->getMeshElement(i);
+      int numNodes = e->getNumPrimaryVertices();
+      bool skip = false;
+      for(int nod = 0; nod < numNodes; nod++) {
+        MVertex *v = e->getVertex(nod);
+        double *d = vsd->getData(v->getNum());
+        if(!d) {
+          skip = true;
+          break;
+        }
+        x[nod] = v->x();
+        y[nod] = v->y();
+        z[nod] = v->z();
+        if(useValues)
+          scalarValues[nod] =
+            (vnumComp == 1) ? d[0] : ComputeScalarRep(vnumComp, d);
+        levels[nod] = levelset(x[nod], y[nod], z[nod], scalarValues[nod]);
+      }
+      if(skip) continue;
+      found[c] = 1;
+
+      // elements that do not cross the levelset do not produce anything
+      if(!_extractVolume) {
+        bool pos = true, neg = true;
+        for(int nod = 0; nod < numNodes; nod++) {
+          if(levels[nod] <= 0.) pos = false;
+          if(levels[nod] >= 0.) neg = false;
+        }
+        if(pos || neg) continue;
+      }
 
-  if(vstep < 0 && (stepmax - stepmin) > (int)out->Time.size()) {
-    out->Time.clear();
-    for(int i = stepmin; i < stepmax; i++) {
-      out->Time.push_back(vdata->getTime(i));
+      for(int s = 0; s < numSteps; s++) {
+        if(!hasStep[s]) continue;
+        for(int nod = 0; nod < numNodes; nod++) {
+          double *d = wsd[s]->getData(e->getVertex(nod)->getNum());
+          for(int comp = 0; comp < numComp; comp++)
+            wval[(s * numNodes + nod) * numComp + comp] = d ? d[comp] : 0.;
+        }
+      }
+      if(!outs[c]) outs[c] = new PViewDataList();
+      _cutAndAddElements(e->getType(), numNodes, e->getNumEdges(), numComp,
+                         numSteps, &hasStep[0], &wval[0], x, y, z, levels,
+                         scalarValues, outs[c]);
     }
   }
+
+  bool ret = false;
+  for(std::size_t c = 0; c < chunks.size(); c++) {
+    if(found[c]) ret = true;
+    if(!outs[c]) continue;
+    out->appendLists(*outs[c]);
+    delete outs[c];
+  }
+  return ret;
 }
 
 PView *GMSH_LevelsetPlugin::execute(PView *v)
@@ -569,50 +651,118 @@ PView *GMSH_LevelsetPlugin::execute(PView *v)
   // Force creation of one view per time step if we have multi meshes
   if(vdata->hasMultipleMeshes()) _valueIndependent = 0;
 
+  // node-based views defined on the same mesh are cut directly from the mesh
+  // and the node data, without going through the generic (element by element)
+  // data interface
+  PViewDataGModel *vgm = dynamic_cast<PViewDataGModel *>(vdata);
+  PViewDataGModel *wgm = dynamic_cast<PViewDataGModel *>(wdata);
+  bool native = vgm && wgm && vgm->isNodeData() && wgm->isNodeData() &&
+                !vgm->hasMultipleMeshes() && !wgm->hasMultipleMeshes() &&
+                !vgm->getNumPolygons() && !vgm->getNumPolyhedra() &&
+                vgm->getNumTimeSteps() && wgm->getNumTimeSteps() &&
+                vgm->getModel(0) == wgm->getModel(0);
+
   double x[8], y[8], z[8], levels[8];
   double scalarValues[8] = {0., 0., 0., 0., 0., 0., 0., 0.};
+  std::vector<double> wval;
+  std::vector<char> hasStep;
 
   PView *v2 = nullptr;
   if(_valueIndependent) {
     // create a single output view containing the (possibly multi-step) levelset
     int firstNonEmptyStep = vdata->getFirstNonEmptyTimeStep();
+    int numSteps = vdata->getNumTimeSteps();
     v2 = new PView();
     PViewDataList *out = getDataList(v2);
-    for(int ent = 0; ent < vdata->getNumEntities(firstNonEmptyStep); ent++) {
-      for(int ele = 0; ele < vdata->getNumElements(firstNonEmptyStep, ent);
-          ele++) {
-        if(vdata->skipElement(firstNonEmptyStep, ent, ele)) continue;
-        for(int nod = 0; nod < vdata->getNumNodes(firstNonEmptyStep, ent, ele);
-            nod++) {
-          vdata->getNode(firstNonEmptyStep, ent, ele, nod, x[nod], y[nod],
-                         z[nod]);
-          levels[nod] = levelset(x[nod], y[nod], z[nod], 0.);
+    bool found = false;
+    if(native) {
+      found = _cutNodeData(vgm, wgm, firstNonEmptyStep, firstNonEmptyStep,
+                           numSteps, false, out);
+    }
+    else {
+      int nsteps = numSteps - firstNonEmptyStep;
+      hasStep.resize(std::max(nsteps, 0));
+      for(int ent = 0; ent < vdata->getNumEntities(firstNonEmptyStep); ent++) {
+        for(int ele = 0; ele < vdata->getNumElements(firstNonEmptyStep, ent);
+            ele++) {
+          if(vdata->skipElement(firstNonEmptyStep, ent, ele)) continue;
+          found = true;
+          int numNodes = vdata->getNumNodes(firstNonEmptyStep, ent, ele);
+          bool pos = true, neg = true;
+          for(int nod = 0; nod < numNodes; nod++) {
+            vdata->getNode(firstNonEmptyStep, ent, ele, nod, x[nod], y[nod],
+                           z[nod]);
+            levels[nod] = levelset(x[nod], y[nod], z[nod], 0.);
+            if(levels[nod] <= 0.) pos = false;
+            if(levels[nod] >= 0.) neg = false;
+          }
+          if(!_extractVolume && (pos || neg)) continue;
+          int wstep0 = (_valueTimeStep < 0) ? wdata->getFirstNonEmptyTimeStep() :
+                                              _valueTimeStep;
+          int numComp = wdata->getNumComponents(wstep0, ent, ele);
+          wval.resize(nsteps * numNodes * numComp);
+          for(int s = 0; s < nsteps; s++) {
+            int wstep =
+              (_valueTimeStep < 0) ? firstNonEmptyStep + s : _valueTimeStep;
+            hasStep[s] = wdata->hasTimeStep(wstep);
+            if(!hasStep[s]) continue;
+            for(int nod = 0; nod < numNodes; nod++)
+              for(int comp = 0; comp < numComp; comp++)
+                wdata->getValue(wstep, ent, ele, nod, comp,
+                                wval[(s * numNodes + nod) * numComp + comp]);
+          }
+          _cutAndAddElements(vdata->getType(firstNonEmptyStep, ent, ele),
+                             numNodes,
+                             vdata->getNumEdges(firstNonEmptyStep, ent, ele),
+                             numComp, nsteps, &hasStep[0], &wval[0], x, y, z,
+                             levels, scalarValues, out);
         }
-        _cutAndAddElements(vdata, wdata, ent, ele, -1, _valueTimeStep, x, y, z,
-                           levels, scalarValues, out);
       }
     }
+    if(found && numSteps - firstNonEmptyStep > (int)out->Time.size()) {
+      out->Time.clear();
+      for(int i = firstNonEmptyStep; i < numSteps; i++)
+        out->Time.push_back(vdata->getTime(i));
+    }
     out->setName(vdata->getName() + "_Levelset");
     out->setFileName(vdata->getFileName() + "_Levelset.pos");
     out->finalize();
   }
   else {
     // create one view per timestep
+    hasStep.resize(1, 1);
     for(int step = 0; step < vdata->getNumTimeSteps(); step++) {
       if(!vdata->hasTimeStep(step)) continue;
       v2 = new PView();
       PViewDataList *out = getDataList(v2);
-      for(int ent = 0; ent < vdata->getNumEntities(step); ent++) {
-        for(int ele = 0; ele < vdata->getNumElements(step, ent); ele++) {
-          if(vdata->skipElement(step, ent, ele)) continue;
-          for(int nod = 0; nod < vdata->getNumNodes(step, ent, ele); nod++) {
-            vdata->getNode(step, ent, ele, nod, x[nod], y[nod], z[nod]);
-            vdata->getScalarValue(step, ent, ele, nod, scalarValues[nod]);
-            levels[nod] = levelset(x[nod], y[nod], z[nod], scalarValues[nod]);
+      int wstep = (_valueTimeStep < 0) ? step : _valueTimeStep;
+      if(native) { _cutNodeData(vgm, wgm, step, step, step + 1, true, out); }
+      else if(wdata->hasTimeStep(wstep)) {
+        for(int ent = 0; ent < vdata->getNumEntities(step); ent++) {
+          for(int ele = 0; ele < vdata->getNumElements(step, ent); ele++) {
+            if(vdata->skipElement(step, ent, ele)) continue;
+            int numNodes = vdata->getNumNodes(step, ent, ele);
+            bool pos = true, neg = true;
+            for(int nod = 0; nod < numNodes; nod++) {
+              vdata->getNode(step, ent, ele, nod, x[nod], y[nod], z[nod]);
+              vdata->getScalarValue(step, ent, ele, nod, scalarValues[nod]);
+              levels[nod] =
+                levelset(x[nod], y[nod], z[nod], scalarValues[nod]);
+              if(levels[nod] <= 0.) pos = false;
+              if(levels[nod] >= 0.) neg = false;
+            }
+            if(!_extractVolume && (pos || neg)) continue;
+            int numComp = wdata->getNumComponents(wstep, ent, ele);
+            wval.resize(numNodes * numComp);
+            for(int nod = 0; nod < numNodes; nod++)
+              for(int comp = 0; comp < numComp; comp++)
+                wdata->getValue(wstep, ent, ele, nod, comp,
+                                wval[nod * numComp + comp]);
+            _cutAndAddElements(vdata->getType(step, ent, ele), numNodes,
+                               vdata->getNumEdges(step, ent, ele), numComp, 1,
+                               &hasStep[0], &wval[0], x, y, z, levels,
+                               scalarValues, out);
           }
-          int wstep = (_valueTimeStep < 0) ? step : _valueTimeStep;
-          _cutAndAddElements(vdata, wdata, ent, ele, step, wstep, x, y, z,
-                             levels, scalarValues, out);
         }
       }
       char tmp[246];
@@ -8,16 +8,28 @@
 
 #include "Plugin.h"
 
+class PViewDataGModel;
+
 class GMSH_LevelsetPlugin : public GMSH_PostPlugin {
 private:
-  double _invert;
   void _addElement(int np, int numEdges, int numComp, double xp[12],
                    double yp[12], double zp[12], double valp[12][9],
-                   PViewDataList *out, bool firstStep);
-  void _cutAndAddElements(PViewData *vdata, PViewData *wdata, int ent, int ele,
-                          int step, int wstep, double x[8], double y[8],
-                          double z[8], double levels[8], double scalarValues[8],
-                          PViewDataList *out);
+                   PViewDataList *out, bool firstStep) const;
+  // cut an element given its node coordinates, the levelset values at its
+  // nodes and the values of the field to interpolate (numComp values per
+  // node, for each of the numSteps steps, steps with hasStep[s] == 0 being
+  // skipped), and add the resulting elements to out
+  void _cutAndAddElements(int type, int numNodes, int numEdges, int numComp,
+                          int numSteps, const char *hasStep,
+                          const double *wval, double x[8], double y[8],
+                          double z[8], double levels[8],
+                          double scalarValues[8], PViewDataList *out) const;
+  // cut the elements of node-based views directly from the mesh and the node
+  // data, in parallel; the levelset is evaluated at step gstep and the field
+  // is interpolated for steps [stepmin, stepmax)
+  bool _cutNodeData(PViewDataGModel *vdata, PViewDataGModel *wdata, int gstep,
+                    int stepmin, int stepmax, bool useValues,
+                    PViewDataList *out) const;
 
 protected:
   double _ref[3], _targetError;
@@ -28,6 +40,7 @@ protected:
 
 public:
   GMSH_LevelsetPlugin();
+  // must be thread-safe: it can be evaluated concurrently
   virtual double levelset(double x, double y, double z, double val) const = 0;
   virtual PView *execute(PView *);
   void assignSpecificVisibility() const;
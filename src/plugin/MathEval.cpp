@@ -158,9 +158,17 @@ PView *GMSH_MathEvalPlugin::execute(PView *view)
   std::size_t numVariables = sizeof(names) / sizeof(names[0]);
   std::vector<std::string> variables(numVariables);
   for(std::size_t i = 0; i < numVariables; i++) variables[i] = names[i];
-  mathEvaluator f(expr, variables);
-  if(expr.empty()) return view;
-  std::vector<double> values(numVariables), res(numComp2);
+  const int nthreads = getNumThreads();
+  std::vector<mathEvaluator *> f(nthreads, nullptr);
+  for(int i = 0; i < nthreads; i++) {
+    f[i] = new mathEvaluator(expr, variables);
+    if(expr.empty()) break;
+  }
+  if(expr.empty()) {
+    for(int i = 0; i < nthreads; i++)
+      if(f[i]) delete f[i];
+    return view;
+  }
 
   OctreePost *octree = nullptr;
   if(forceInterpolation ||
@@ -183,75 +191,121 @@ PView *GMSH_MathEvalPlugin::execute(PView *view)
   int firstNonEmptyStep = data1->getFirstNonEmptyTimeStep();
   int timeBeg = (timeStep < 0) ? firstNonEmptyStep : timeStep;
   int timeEnd = (timeStep < 0) ? -timeStep : timeStep + 1;
-  for(int ent = 0; ent < data1->getNumEntities(timeBeg); ent++) {
-    bool ok = (physicalRegion <= 0);
-    if(physicalRegion > 0) {
-      GEntity *ge = data1->getEntity(timeBeg, ent);
-      if(ge) {
-        auto it =
-          std::find(ge->physicals.begin(), ge->physicals.end(), physicalRegion);
-        ok = (it != ge->physicals.end());
+  std::vector<int> steps;
+  for(int step = timeBeg; step < timeEnd; step++)
+    if(data1->hasTimeStep(step)) steps.push_back(step);
+
+  int currentEnt = -1;
+  bool currentOk = true;
+  auto filter = [&](int ent, int ele) {
+    if(ent != currentEnt) {
+      currentEnt = ent;
+      currentOk = (physicalRegion <= 0);
+      if(physicalRegion > 0) {
+        GEntity *ge = data1->getEntity(timeBeg, ent);
+        if(ge) {
+          auto it = std::find(ge->physicals.begin(), ge->physicals.end(),
+                              physicalRegion);
+          currentOk = (it != ge->physicals.end());
+        }
       }
     }
-    if(!ok) continue;
-    for(int ele = 0; ele < data1->getNumElements(timeBeg, ent); ele++) {
-      if(data1->skipElement(timeBeg, ent, ele)) continue;
-      int numNodes = data1->getNumNodes(timeBeg, ent, ele);
-      int type = data1->getType(timeBeg, ent, ele);
-      int numComp = data1->getNumComponents(timeBeg, ent, ele);
-      int otherNumComp = (!otherData || octree) ?
-                           9 :
-                           otherData->getNumComponents(timeBeg, ent, ele);
-      std::vector<double> *out = data2->incrementList(numComp2, type, numNodes);
-      std::vector<double> v(std::max(9, numComp), 0.);
-      std::vector<double> w(std::max(9, otherNumComp), 0.);
-      std::vector<double> x(numNodes), y(numNodes), z(numNodes);
-      for(int nod = 0; nod < numNodes; nod++)
-        data1->getNode(timeBeg, ent, ele, nod, x[nod], y[nod], z[nod]);
-      for(int nod = 0; nod < numNodes; nod++) out->push_back(x[nod]);
-      for(int nod = 0; nod < numNodes; nod++) out->push_back(y[nod]);
-      for(int nod = 0; nod < numNodes; nod++) out->push_back(z[nod]);
-      for(int step = timeBeg; step < timeEnd; step++) {
-        if(!data1->hasTimeStep(step)) continue;
-        int step2 = (otherTimeStep < 0) ? step : otherTimeStep;
-        for(int nod = 0; nod < numNodes; nod++) {
-          for(int comp = 0; comp < numComp; comp++)
-            data1->getValue(step, ent, ele, nod, comp, v[comp]);
-          if(otherData) {
-            if(octree) {
-              int qn = forceInterpolation ? numNodes : 0;
-              if(!octree->searchScalar(x[nod], y[nod], z[nod], &w[0], step2,
-                                       nullptr, qn, &x[0], &y[0], &z[0],
-                                       false, dimension))
-                if(!octree->searchVector(x[nod], y[nod], z[nod], &w[0], step2,
-                                         nullptr, qn, &x[0], &y[0], &z[0],
-                                         false, dimension))
-                  octree->searchTensor(x[nod], y[nod], z[nod], &w[0], step2,
-                                       nullptr, qn, &x[0], &y[0], &z[0],
-                                       false, dimension);
-            }
-            else
+    return currentOk && !data1->skipElement(timeBeg, ent, ele);
+  };
+
+  // the interpolation in the other view is not thread-safe
+  const int numThreads = octree ? 1 : nthreads;
+  bool error = false;
+  std::vector<double> out;
+  forEachElementBatch(
+    data1, timeBeg, steps,
+    [&](const PViewElementBatch &b) {
+      if(error) return;
+      const int numNodes = b.numNodes, numComp = b.numComp;
+      const std::size_t stride = (3 + steps.size() * numComp2) * numNodes;
+      out.resize(b.size() * stride);
+      // values of the other view (loaded sequentially, as the accessors of
+      // the view data are not thread-safe)
+      std::vector<double> wval;
+      if(!octree) {
+        wval.resize(b.size() * steps.size() * numNodes * 9, 0.);
+        std::size_t k = 0;
+        for(std::size_t i = 0; i < b.size(); i++) {
+          const int ele = b.elements[i];
+          const int otherNumComp =
+            std::min(9, otherData->getNumComponents(timeBeg, b.ent, ele));
+          for(std::size_t s = 0; s < steps.size(); s++) {
+            const int step2 = (otherTimeStep < 0) ? steps[s] : otherTimeStep;
+            for(int nod = 0; nod < numNodes; nod++, k += 9)
               for(int comp = 0; comp < otherNumComp; comp++)
-                otherData->getValue(step2, ent, ele, nod, comp, w[comp]);
+                otherData->getValue(step2, b.ent, ele, nod, comp,
+                                    wval[k + comp]);
           }
-          values[0] = x[nod];
-          values[1] = y[nod];
-          values[2] = z[nod];
-          for(int i = 0; i < 9; i++) values[3 + i] = v[i];
-          for(int i = 0; i < 9; i++) values[12 + i] = w[i];
-          if(f.eval(values, res)) {
-            for(int i = 0; i < numComp2; i++) out->push_back(res[i]);
-          }
-          else {
-            goto end;
+        }
+      }
+      std::vector<char> ok(b.size(), 1);
+      forEachElement(
+        b.size(),
+        [&](std::size_t i, int thread) {
+          const double *x = b.x(i), *y = b.y(i), *z = b.z(i);
+          double *o = &out[i * stride];
+          for(int k = 0; k < 3 * numNodes; k++) *o++ = x[k];
+          double w[9] = {0., 0., 0., 0., 0., 0., 0., 0., 0.};
+          std::vector<double> values(numVariables, 0.), res(numComp2);
+          for(std::size_t s = 0; s < steps.size(); s++) {
+            const double *v = b.value(i, s);
+            const int step2 = (otherTimeStep < 0) ? steps[s] : otherTimeStep;
+            for(int nod = 0; nod < numNodes; nod++) {
+              if(octree) {
+                int qn = forceInterpolation ? numNodes : 0;
+                double *xx = const_cast<double *>(x);
+                double *yy = const_cast<double *>(y);
+                double *zz = const_cast<double *>(z);
+                if(!octree->searchScalar(x[nod], y[nod], z[nod], w, step2,
+                                         nullptr, qn, xx, yy, zz, false,
+                                         dimension))
+                  if(!octree->searchVector(x[nod], y[nod], z[nod], w, step2,
+                                           nullptr, qn, xx, yy, zz, false,
+                                           dimension))
+                    octree->searchTensor(x[nod], y[nod], z[nod], w, step2,
+                                         nullptr, qn, xx, yy, zz, false,
+                                         dimension);
+              }
+              else {
+                const double *wv =
+                  &wval[((i * steps.size() + s) * numNodes + nod) * 9];
+                for(int k = 0; k < 9; k++) w[k] = wv[k];
+              }
+              values[0] = x[nod];
+              values[1] = y[nod];
+              values[2] = z[nod];
+              for(int k = 0; k < 9; k++)
+                values[3 + k] = (k < numComp) ? v[numComp * nod + k] : 0.;
+              for(int k = 0; k < 9; k++) values[12 + k] = w[k];
+              if(!f[thread]->eval(values, res)) {
+                ok[i] = 0;
+                return;
+              }
+              for(int k = 0; k < numComp2; k++) *o++ = res[k];
+            }
           }
+        },
+        numThreads);
+      for(std::size_t i = 0; i < b.size(); i++) {
+        if(!ok[i]) {
+          error = true;
+          return;
         }
+        std::vector<double> *l =
+          data2->incrementList(numComp2, b.type, numNodes);
+        l->insert(l->end(), out.begin() + i * stride,
+                  out.begin() + (i + 1) * stride);
       }
-    }
-  }
+    },
+    filter);
 
-end:
   if(octree) delete octree;
+  for(int i = 0; i < nthreads; i++) delete f[i];
 
   if(timeStep < 0) {
     for(int i = firstNonEmptyStep; i < data1->getNumTimeSteps(); i++) {
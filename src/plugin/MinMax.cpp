@@ -5,6 +5,7 @@
 
 #include "MinMax.h"
 #include "PViewOptions.h"
+#include "Numeric.h"
 
 StringXNumber MinMaxOptions_Number[] = {{GMSH_FULLRC, "View", nullptr, -1.},
                                         {GMSH_FULLRC, "OverTime", nullptr, 0},
@@ -72,24 +73,61 @@ PView *GMSH_MinMaxPlugin::execute(PView *v)
     if(data1->hasTimeStep(step)) {
       double minView = VAL_INF, maxView = -VAL_INF;
       double xmin = 0., ymin = 0., zmin = 0., xmax = 0., ymax = 0., zmax = 0.;
-      for(int ent = 0; ent < data1->getNumEntities(step); ent++) {
-        if(visible && data1->skipEntity(step, ent)) continue;
-        for(int ele = 0; ele < data1->getNumElements(step, ent); ele++) {
-          if(data1->skipElement(step, ent, ele, visible)) continue;
-          for(int nod = 0; nod < data1->getNumNodes(step, ent, ele); nod++) {
-            double val;
-            data1->getScalarValue(step, ent, ele, nod, val);
-            if(val < minView) {
-              data1->getNode(step, ent, ele, nod, xmin, ymin, zmin);
-              minView = val;
+      struct extrema {
+        double min, max;
+        int nodMin, nodMax;
+      };
+      std::vector<extrema> ext;
+      forEachElementBatch(
+        data1, step, std::vector<int>(1, step),
+        [&](const PViewElementBatch &b) {
+          const int numNodes = b.numNodes, numComp = b.numComp;
+          ext.resize(b.size());
+          forEachElement(b.size(), [&](std::size_t i, int thread) {
+            const double *v = b.value(i, 0);
+            std::vector<double> d(numComp);
+            extrema &e = ext[i];
+            e.min = VAL_INF;
+            e.max = -VAL_INF;
+            e.nodMin = e.nodMax = -1;
+            for(int nod = 0; nod < numNodes; nod++) {
+              double val;
+              if(numComp == 1)
+                val = v[nod];
+              else {
+                for(int comp = 0; comp < numComp; comp++)
+                  d[comp] = v[numComp * nod + comp];
+                val = ComputeScalarRep(numComp, &d[0]);
+              }
+              if(val < e.min) {
+                e.min = val;
+                e.nodMin = nod;
+              }
+              if(val > e.max) {
+                e.max = val;
+                e.nodMax = nod;
+              }
             }
-            if(val > maxView) {
-              data1->getNode(step, ent, ele, nod, xmax, ymax, zmax);
-              maxView = val;
+          });
+          for(std::size_t i = 0; i < b.size(); i++) {
+            if(ext[i].nodMin >= 0 && ext[i].min < minView) {
+              minView = ext[i].min;
+              xmin = b.x(i)[ext[i].nodMin];
+              ymin = b.y(i)[ext[i].nodMin];
+              zmin = b.z(i)[ext[i].nodMin];
+            }
+            if(ext[i].nodMax >= 0 && ext[i].max > maxView) {
+              maxView = ext[i].max;
+              xmax = b.x(i)[ext[i].nodMax];
+              ymax = b.y(i)[ext[i].nodMax];
+              zmax = b.z(i)[ext[i].nodMax];
             }
           }
-        }
-      }
+        },
+        [&](int ent, int ele) {
+          if(visible && data1->skipEntity(step, ent)) return false;
+          return !data1->skipElement(step, ent, ele, visible);
+        });
 
       if(!overTime) {
         if(argument) {
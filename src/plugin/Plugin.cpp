@@ -4,6 +4,8 @@
 // Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
 #include <sstream>
+#include <map>
+#include <algorithm>
 #include <stdio.h>
 #include <string.h>
 #include "GmshConfig.h"
@@ -116,3 +118,66 @@ PViewDataList *GMSH_PostPlugin::getDataList(PView *view, bool showError)
       "This plugin can only be run on list-based views (`.pos' files)");
   return nullptr;
 }
+
+void GMSH_PostPlugin::forEachElementBatch(
+  PViewData *data, int geomStep, const std::vector<int> &steps,
+  const std::function<void(const PViewElementBatch &)> &fct,
+  const std::function<bool(int, int)> &filter, std::size_t maxBatchSize)
+{
+  if(!data) return;
+  for(int ent = 0; ent < data->getNumEntities(geomStep); ent++) {
+    // batches currently being filled, by kind
+    std::map<std::vector<int>, PViewElementBatch> batches;
+    for(int ele = 0; ele < data->getNumElements(geomStep, ent); ele++) {
+      if(filter && !filter(ent, ele)) continue;
+      const int type = data->getType(geomStep, ent, ele);
+      const int dim = data->getDimension(geomStep, ent, ele);
+      const int numNodes = data->getNumNodes(geomStep, ent, ele);
+      const int numComp = data->getNumComponents(geomStep, ent, ele);
+      std::vector<int> kind = {type, dim, numNodes, numComp};
+      PViewElementBatch &b = batches[kind];
+      if(b.elements.empty()) {
+        b.ent = ent;
+        b.type = type;
+        b.dim = dim;
+        b.numNodes = numNodes;
+        b.numComp = numComp;
+        b.steps = steps;
+        b.xyz.reserve(std::min(maxBatchSize, (std::size_t)1024) * 3 *
+                      numNodes);
+      }
+      b.elements.push_back(ele);
+      const std::size_t ox = b.xyz.size();
+      b.xyz.resize(ox + 3 * numNodes);
+      for(int nod = 0; nod < numNodes; nod++)
+        data->getNode(geomStep, ent, ele, nod, b.xyz[ox + nod],
+                      b.xyz[ox + numNodes + nod],
+                      b.xyz[ox + 2 * numNodes + nod]);
+      std::size_t ov = b.values.size();
+      b.values.resize(ov + steps.size() * numNodes * numComp);
+      for(std::size_t s = 0; s < steps.size(); s++)
+        for(int nod = 0; nod < numNodes; nod++)
+          for(int comp = 0; comp < numComp; comp++)
+            data->getValue(steps[s], ent, ele, nod, comp, b.values[ov++]);
+      if(b.size() >= maxBatchSize) {
+        fct(b);
+        b.elements.clear();
+        b.xyz.clear();
+        b.values.clear();
+      }
+    }
+    for(auto &it : batches)
+      if(it.second.size()) fct(it.second);
+  }
+}
+
+void GMSH_PostPlugin::forEachElement(
+  std::size_t n, const std::function<void(std::size_t, int)> &fct,
+  int numThreads)
+{
+  const int nthreads = numThreads > 0 ? numThreads : getNumThreads();
+#pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads)
+  for(std::size_t i = 0; i < n; i++) fct(i, Msg::GetThreadNum());
+}
+
+int GMSH_PostPlugin::getNumThreads() { return Msg::GetMaxThreads(); }
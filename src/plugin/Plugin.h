@@ -14,6 +14,8 @@
 //  in the executable. I think that it's a good way to start.
 
 #include <string>
+#include <vector>
+#include <functional>
 #include "Options.h"
 #include "GmshMessage.h"
 #include "PView.h"
@@ -78,6 +80,32 @@ public:
 #endif
 };
 
+// A batch of elements of a post-processing view, all in the same entity and
+// with the same type, number of nodes and number of components, whose
+// coordinates and values (for a set of time steps) are stored contiguously
+class PViewElementBatch {
+public:
+  int ent, type, dim, numNodes, numComp;
+  // the time steps for which the values are loaded
+  std::vector<int> steps;
+  // indices of the elements in the entity
+  std::vector<int> elements;
+  // coordinates of the nodes of each element, in list format (the x of all
+  // the nodes, then the y, then the z)
+  std::vector<double> xyz;
+  // values of each element at each step, node by node
+  std::vector<double> values;
+  PViewElementBatch() : ent(0), type(0), dim(0), numNodes(0), numComp(0) {}
+  std::size_t size() const { return elements.size(); }
+  const double *x(std::size_t i) const { return &xyz[3 * numNodes * i]; }
+  const double *y(std::size_t i) const { return x(i) + numNodes; }
+  const double *z(std::size_t i) const { return x(i) + 2 * numNodes; }
+  const double *value(std::size_t i, std::size_t s) const
+  {
+    return &values[(i * steps.size() + s) * numNodes * numComp];
+  }
+};
+
 // The base class for post-processing plugins. The user can either
 // modify or duplicate a post-processing view
 class GMSH_PostPlugin : public GMSH_Plugin {
@@ -109,6 +137,25 @@ public:
   // available, otherwise get the original data
   virtual PViewData *getPossiblyAdaptiveData(PView *view);
   virtual void assignSpecificVisibility() const {}
+  // loop over the elements of the data by batches of elements of the same
+  // kind: the geometry is taken at step geomStep, the values are loaded for
+  // the given steps, and only the elements for which filter(ent, ele) returns
+  // true (if provided) are considered. Batches are loaded sequentially (the
+  // PViewData accessors are not thread-safe), and for a given kind they are
+  // passed to fct in the order of the elements in the data.
+  static void
+  forEachElementBatch(PViewData *data, int geomStep,
+                      const std::vector<int> &steps,
+                      const std::function<void(const PViewElementBatch &)> &fct,
+                      const std::function<bool(int, int)> &filter = nullptr,
+                      std::size_t maxBatchSize = 50000);
+  // call fct(i, thread) for i in [0, n), in parallel
+  static void
+  forEachElement(std::size_t n,
+                 const std::function<void(std::size_t, int)> &fct,
+                 int numThreads = 0);
+  // the number of threads used by forEachElement by default
+  static int getNumThreads();
   virtual bool geometricalFilter(fullMatrix<double> *) const { return true; }
 };
 
@@ -287,6 +287,11 @@ public:
   // get (approx) memry used by data in Mb
   virtual double getMemoryInMb() { return 0; }
 
+  // store the values of all the time steps except keepStep in compact form
+  // (1: single precision, 2: quantized on 16 bits, 3: temporary file), or
+  // restore them in memory (0); stored steps are restored on access
+  virtual void storeSteps(int storage, int keepStep = -1) {}
+
   // get GModel (if view supports it)
   virtual GModel *getModel(int step);
 
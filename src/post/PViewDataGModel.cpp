@@ -18,14 +18,97 @@
 #include "GmshMessage.h"
 #include "pyramidalBasis.h"
 
+// number of values quantized with the same minimum and step
+static const std::size_t quantizationBlock = 256;
+
+bool stepStorage::store(int mode, const std::vector<double> &values, FILE *fp)
+{
+  std::size_t size = _size;
+  _size = values.size();
+  std::vector<float>().swap(_values);
+  std::vector<unsigned short>().swap(_quantized);
+  std::vector<double>().swap(_blocks);
+  if(mode == 1) {
+    _values.assign(values.begin(), values.end());
+  }
+  else if(mode == 2) {
+    _quantized.resize(_size);
+    _blocks.resize(2 * ((_size + quantizationBlock - 1) / quantizationBlock));
+    for(std::size_t b = 0; b < _size; b += quantizationBlock) {
+      std::size_t e = std::min(b + quantizationBlock, _size);
+      double min = values[b], max = values[b];
+      for(std::size_t i = b + 1; i < e; i++) {
+        min = std::min(min, values[i]);
+        max = std::max(max, values[i]);
+      }
+      double step = (max - min) / 65535.;
+      _blocks[2 * (b / quantizationBlock)] = min;
+      _blocks[2 * (b / quantizationBlock) + 1] = step;
+      for(std::size_t i = b; i < e; i++) {
+        double q = (step > 0.) ? std::floor((values[i] - min) / step + .5) : 0.;
+        _quantized[i] = (unsigned short)std::max(0., std::min(65535., q));
+      }
+    }
+  }
+  else if(mode == 3) {
+    if(!fp) return false;
+    // overwrite the previous values if their number has not changed
+    if(_mode != 3 || _fp != fp || _offset < 0 || size != _size) {
+      if(fseek(fp, 0, SEEK_END)) return false;
+      _offset = ftell(fp);
+    }
+    else if(fseek(fp, _offset, SEEK_SET))
+      return false;
+    if(fwrite(values.data(), sizeof(double), _size, fp) != _size) {
+      _offset = -1;
+      return false;
+    }
+    _fp = fp;
+  }
+  else
+    return false;
+  _mode = mode;
+  return true;
+}
+
+bool stepStorage::load(std::vector<double> &values) const
+{
+  values.resize(_size);
+  if(_mode == 1) {
+    for(std::size_t i = 0; i < _size; i++) values[i] = _values[i];
+    return true;
+  }
+  else if(_mode == 2) {
+    for(std::size_t i = 0; i < _size; i++) {
+      std::size_t b = 2 * (i / quantizationBlock);
+      values[i] = _blocks[b] + _quantized[i] * _blocks[b + 1];
+    }
+    return true;
+  }
+  else if(_mode == 3) {
+    if(!_fp || fseek(_fp, _offset, SEEK_SET)) return false;
+    return fread(values.data(), sizeof(double), _size, _fp) == _size;
+  }
+  return false;
+}
+
+std::size_t stepStorage::getMemory() const
+{
+  return _values.capacity() * sizeof(float) +
+         _quantized.capacity() * sizeof(unsigned short) +
+         _blocks.capacity() * sizeof(double);
+}
+
 PViewDataGModel::PViewDataGModel(DataType type)
-  : PViewData(), _min(VAL_INF), _max(-VAL_INF), _type(type)
+  : PViewData(), _min(VAL_INF), _max(-VAL_INF), _type(type),
+    _storageFile(nullptr)
 {
 }
 
 PViewDataGModel::~PViewDataGModel()
 {
   for(std::size_t i = 0; i < _steps.size(); i++) delete _steps[i];
+  if(_storageFile) fclose(_storageFile);
 }
 
 static MElement *_getOneElementOfGivenType(GModel *m, int type)
@@ -93,6 +176,13 @@ bool PViewDataGModel::finalize(bool computeMinMax,
     _max = -VAL_INF;
     int tensorRep = 0; // Von-Mises: we could/should be able to choose this
     for(int step = 0; step < getNumTimeSteps(); step++) {
+      // the values of the steps in compact storage have not changed since
+      // they were stored, and neither have their min/max
+      if(_steps[step]->getStorage()) {
+        _min = std::min(_min, _steps[step]->getMin());
+        _max = std::max(_max, _steps[step]->getMax());
+        continue;
+      }
       _steps[step]->setMin(VAL_INF);
       _steps[step]->setMax(-VAL_INF);
       if(_type == NodeData || _type == ElementData) {
@@ -761,6 +851,24 @@ double PViewDataGModel::getMemoryInMb()
   return m;
 }
 
+void PViewDataGModel::storeSteps(int storage, int keepStep)
+{
+  if(storage == 3 && !_storageFile) {
+    _storageFile = tmpfile();
+    if(!_storageFile) {
+      Msg::Error("Could not create temporary file to store view data");
+      return;
+    }
+  }
+  for(int step = 0; step < (int)_steps.size(); step++) {
+    int current = _steps[step]->getStorage();
+    if(current && (current != storage || step == keepStep))
+      _steps[step]->load();
+    if(storage > 0 && step != keepStep)
+      _steps[step]->store(storage, _storageFile);
+  }
+}
+
 bool PViewDataGModel::combineTime(nameData &nd)
 {
   // sanity checks
@@ -6,10 +6,37 @@
 #ifndef PVIEW_DATA_GMODEL_H
 #define PVIEW_DATA_GMODEL_H
 
+#include <atomic>
+#include <stdio.h>
 #include "PViewData.h"
 #include "GModel.h"
+#include "GmshMessage.h"
 #include "SBoundingBox3d.h"
 
+// Compact storage of the values of a time step that is not in use (see
+// PViewData::storeSteps()): the values are stored in single precision (mode
+// 1), quantized on 16 bits by blocks (mode 2, with an absolute error bounded
+// by 1/131070 of the range of the values in each block), or written in double
+// precision to a temporary file (mode 3).
+class stepStorage {
+private:
+  int _mode;
+  std::size_t _size;
+  std::vector<float> _values;
+  std::vector<unsigned short> _quantized;
+  // minimum and quantization step of each block of quantized values
+  std::vector<double> _blocks;
+  FILE *_fp;
+  long _offset;
+
+public:
+  stepStorage() : _mode(0), _size(0), _fp(nullptr), _offset(-1) {}
+  int getMode() const { return _mode; }
+  bool store(int mode, const std::vector<double> &values, FILE *fp);
+  bool load(std::vector<double> &values) const;
+  std::size_t getMemory() const;
+};
+
 template <class Real> class stepData {
 private:
   // a pointer to the underlying model
@@ -47,16 +74,44 @@ private:
   std::vector<std::vector<double> > _gaussPoints;
   // a set of all "partitions" encountered in the data
   std::set<int> _partitions;
+  // the compact copy of the values when the step is not in use: _stored
+  // flags the indices that have values, and _data is rebuilt on access
+  stepStorage *_storage;
+  std::vector<bool> _stored;
+  std::atomic<bool> _inStorage;
+  void _load()
+  {
+    if(!_inStorage) return;
+    // the values can be accessed concurrently, e.g. by plugins
+#pragma omp critical(stepDataLoad)
+    if(_inStorage) {
+      std::vector<double> values;
+      if(!_storage->load(values))
+        Msg::Error("Could not load values of time step %g", _time);
+      _data = new std::vector<Real *>(_stored.size(), (Real *)0);
+      std::size_t k = 0;
+      for(std::size_t i = 0; i < _stored.size(); i++) {
+        if(!_stored[i]) continue;
+        int m = getMult(i) * _numComp;
+        (*_data)[i] = new Real[m];
+        for(int j = 0; j < m; j++)
+          (*_data)[i][j] = (k < values.size()) ? values[k++] : 0.;
+      }
+      _inStorage = false;
+    }
+  }
 
 public:
   stepData(GModel *model, int numComp, const std::string &fileName = "",
            int fileIndex = -1, double time = 0., double min = VAL_INF,
            double max = -VAL_INF)
     : _model(model), _fileName(fileName), _fileIndex(fileIndex), _time(time),
-      _min(min), _max(max), _numComp(numComp), _data(0)
+      _min(min), _max(max), _numComp(numComp), _data(0), _storage(nullptr),
+      _inStorage(false)
   {
   }
-  stepData(stepData<Real> &other) : _data(0)
+  stepData(stepData<Real> &other)
+    : _data(0), _storage(nullptr), _inStorage(false)
   {
     _model = other._model;
     _entities = other._entities;
@@ -67,6 +122,7 @@ public:
     _min = other._min;
     _max = other._max;
     _numComp = other._numComp;
+    other.load();
     if(other._data) {
       std::size_t n = other.getNumData();
       _data = new std::vector<Real *>(n, (Real *)0);
@@ -108,17 +164,20 @@ public:
   void setMax(double max) { _max = max; }
   std::size_t getNumData()
   {
+    if(_inStorage) return _stored.size();
     if(!_data) return 0;
     return _data->size();
   }
   void resizeData(int n)
   {
+    _load();
     if(!_data) _data = new std::vector<Real *>(n, (Real *)0);
     if(n > (int)_data->size()) _data->resize(n, (Real *)0);
   }
   Real *getData(int index, bool allocIfNeeded = false, int mult = 1)
   {
     if(index < 0) return 0;
+    _load();
     if(allocIfNeeded) {
       if(index >= (int)getNumData()) resizeData(index + 100); // optimize this
       if(!(*_data)[index]) {
@@ -138,6 +197,12 @@ public:
   }
   void destroyData()
   {
+    if(_storage) {
+      delete _storage;
+      _storage = nullptr;
+      _stored.clear();
+      _inStorage = false;
+    }
     if(_data) {
       for(unsigned int i = 0; i < _data->size(); i++)
         if((*_data)[i]) delete[](*_data)[i];
@@ -147,6 +212,7 @@ public:
   }
   void renumberData(const std::map<std::size_t, std::size_t> &mapping)
   {
+    _load();
     if(!_data) return;
     std::size_t imax = 0, imin = 0;
     for(auto m : mapping) {
@@ -177,10 +243,36 @@ public:
   std::set<int> &getPartitions() { return _partitions; }
   double getMemoryInMb()
   {
+    if(_inStorage)
+      return (_storage->getMemory() + _stored.size() / 8) / 1024. / 1024.;
     double b = 0.;
     for(std::size_t i = 0; i < getNumData(); i++) b += getMult(i);
     return b * getNumComponents() * sizeof(Real) / 1024. / 1024.;
   }
+  // storage mode of the step (0 if its values are in memory)
+  int getStorage() { return _inStorage ? _storage->getMode() : 0; }
+  // store the values in compact form (see stepStorage) and free them
+  void store(int mode, FILE *fp)
+  {
+    if(_inStorage || !_data) return;
+    std::vector<double> values;
+    _stored.assign(_data->size(), false);
+    for(std::size_t i = 0; i < _data->size(); i++) {
+      if(!(*_data)[i]) continue;
+      _stored[i] = true;
+      int m = getMult(i) * _numComp;
+      for(int j = 0; j < m; j++) values.push_back((*_data)[i][j]);
+    }
+    if(!_storage) _storage = new stepStorage();
+    if(!_storage->store(mode, values, fp)) return;
+    for(std::size_t i = 0; i < _data->size(); i++)
+      if((*_data)[i]) delete[](*_data)[i];
+    delete _data;
+    _data = 0;
+    _inStorage = true;
+  }
+  // restore the values in memory
+  void load() { _load(); }
 };
 
 // The data container using elements from one or more GModel(s).
@@ -201,6 +293,8 @@ private:
   double _min, _max;
   // the type of the dataset
   DataType _type;
+  // the temporary file where the values of the steps are stored, if any
+  FILE *_storageFile;
   // cache last element to speed up loops
   MElement *_getElement(int step, int ent, int ele);
   MVertex *_getNode(MElement *e, int nod);
@@ -255,6 +349,7 @@ public:
   void reverseElement(int step, int ent, int ele);
   void smooth();
   double getMemoryInMb();
+  void storeSteps(int storage, int keepStep = -1);
   bool combineTime(nameData &nd);
   bool skipEntity(int step, int ent);
   bool skipElement(int step, int ent, int ele, bool checkVisibility = false,
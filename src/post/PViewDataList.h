@@ -148,6 +148,9 @@ public:
                         bool forceElementData = false);
   virtual void importLists(int N[24], std::vector<double> *V[24]);
   virtual void getListPointers(int N[24], std::vector<double> *V[24]);
+  // append the elements of another list-based dataset with the same number
+  // of time steps (e.g. built concurrently in a separate object)
+  void appendLists(PViewDataList &other);
   void importList(int index, int n, const std::vector<double> &v,
                   bool finalize);
 };
@@ -834,3 +834,16 @@ void PViewDataList::getListPointers(int N[24], std::vector<double> *V[24])
     V[i] = list; // copy pointer only
   }
 }
+
+void PViewDataList::appendLists(PViewDataList &other)
+{
+  for(int i = 0; i < 33; i++) {
+    std::vector<double> *list = nullptr, *list2 = nullptr;
+    int *nbe = nullptr, *nbe2 = nullptr, nbc, nbn;
+    _getRawData(i, &list, &nbe, &nbc, &nbn);
+    other._getRawData(i, &list2, &nbe2, &nbc, &nbn);
+    if(!*nbe2) continue;
+    list->insert(list->end(), list2->begin(), list2->end());
+    *nbe += *nbe2;
+  }
+}
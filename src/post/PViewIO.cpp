@@ -299,7 +299,10 @@ bool PView::readMSH(const std::string &fileName, int fileIndex,
               d->setName(viewName);
               d->setFileName(fileName);
               d->setFileIndex(index);
-              if(create) new PView(d);
+              if(create) p = new PView(d);
+              // keep only the step being read in memory
+              if(p->getOptions()->storage)
+                d->storeSteps(p->getOptions()->storage, timeStep);
             }
           }
         }
@@ -78,6 +78,7 @@ public:
   mathEvaluator *genRaiseEvaluator;
   int adaptVisualizationGrid, maxRecursionLevel;
   double targetError;
+  int storage;
   int clip; // status of clip planes (bit array)
   int forceNumComponents, componentMap[9];
   int sampling;
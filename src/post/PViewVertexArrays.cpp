@@ -1605,6 +1605,9 @@ public:
         p->va_triangles->getMemoryInMb() + p->va_vectors->getMemoryInMb() +
         p->va_ellipses->getMemoryInMb());
 
+    // the other time steps are not needed until the next time step change
+    if(opt->storage) p->getData()->storeSteps(opt->storage, opt->timeStep);
+
     p->setChanged(false);
     return true;
   }
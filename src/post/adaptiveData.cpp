@@ -6,6 +6,7 @@
 #include <math.h>
 #include <list>
 #include <set>
+#include <map>
 #include <algorithm>
 #include "adaptiveData.h"
 #include "PViewDataGModel.h"
@@ -1081,7 +1082,8 @@ void adaptivePyramid::recurError(adaptivePyramid *p, double AVG, double tol)
 template <class T>
 adaptiveElements<T>::adaptiveElements(std::vector<fullMatrix<double> *> &p)
   : _coeffsVal(nullptr), _eexpsVal(nullptr), _interpolVal(nullptr),
-    _coeffsGeom(nullptr), _eexpsGeom(nullptr), _interpolGeom(nullptr)
+    _coeffsGeom(nullptr), _eexpsGeom(nullptr), _interpolGeom(nullptr),
+    _numChildren(0), _master(nullptr)
 {
   if(p.size() >= 2) {
     _coeffsVal = p[0];
@@ -1097,6 +1099,7 @@ template <class T> adaptiveElements<T>::~adaptiveElements()
 {
   if(_interpolVal) delete _interpolVal;
   if(_interpolGeom) delete _interpolGeom;
+  _clearCopies();
   cleanElement<T>();
 }
 
@@ -1143,6 +1146,8 @@ template <class T> void adaptiveElements<T>::init(int level)
   if(tmpv) delete tmpv;
   if(tmpg) delete tmpg;
 
+  _buildTemplate();
+
 #ifdef TIMER
   adaptiveData::timerInit += TimeOfDay() - t1;
   return;
@@ -1196,12 +1201,246 @@ template <> void adaptiveElements<adaptivePyramid>::init(int level)
   if(tmpv) delete tmpv;
   if(tmpg) delete tmpg;
 
+  _buildTemplate();
+
 #ifdef TIMER
   adaptiveData::timerInit += TimeOfDay() - t1;
   return;
 #endif
 }
 
+template <class T> void adaptiveElements<T>::_buildTemplate()
+{
+  _clearCopies();
+
+  std::map<const adaptiveVertex *, int> vertexIndex;
+  int i = 0;
+  for(auto it = T::allVertices.begin(); it != T::allVertices.end(); ++it)
+    vertexIndex[&(*it)] = i++;
+  std::map<const T *, int> elementIndex;
+  i = 0;
+  for(auto it = T::all.begin(); it != T::all.end(); ++it)
+    elementIndex[*it] = i++;
+
+  _numChildren = sizeof(T::e) / sizeof(T *);
+  _templateNodes.resize(T::all.size() * T::numNodes);
+  _templateChildren.resize(T::all.size() * _numChildren);
+  i = 0;
+  for(auto it = T::all.begin(); it != T::all.end(); ++it, ++i) {
+    for(int j = 0; j < T::numNodes; j++)
+      _templateNodes[i * T::numNodes + j] = vertexIndex[(*it)->p[j]];
+    for(int j = 0; j < _numChildren; j++)
+      _templateChildren[i * _numChildren + j] =
+        (*it)->e[j] ? elementIndex[(*it)->e[j]] : -1;
+  }
+}
+
+template <class T> void adaptiveElements<T>::_clearCopies()
+{
+  if(_master) delete _master;
+  _master = nullptr;
+  for(std::size_t i = 0; i < _copies.size(); i++) delete _copies[i];
+  _copies.clear();
+}
+
+template <class T>
+typename adaptiveElements<T>::templateCopy *
+adaptiveElements<T>::_newCopy(bool master)
+{
+  templateCopy *tc = new templateCopy();
+  std::size_t numVertices = T::allVertices.size(), numEle = T::all.size();
+  if(master) {
+    for(auto it = T::allVertices.begin(); it != T::allVertices.end(); ++it)
+      // ok because we know this will not change the set ordering
+      tc->vertices.push_back((adaptiveVertex *)&(*it));
+    for(auto it = T::all.begin(); it != T::all.end(); ++it)
+      tc->elements.push_back(*it);
+  }
+  else {
+    tc->vertexStore.resize(numVertices);
+    tc->elementStore.reserve(numEle);
+    for(auto it = T::all.begin(); it != T::all.end(); ++it)
+      tc->elementStore.push_back(**it);
+    for(std::size_t i = 0; i < numVertices; i++)
+      tc->vertices.push_back(&tc->vertexStore[i]);
+    for(std::size_t i = 0; i < numEle; i++) {
+      T *e = &tc->elementStore[i];
+      for(int j = 0; j < T::numNodes; j++)
+        e->p[j] = tc->vertices[_templateNodes[i * T::numNodes + j]];
+      for(int j = 0; j < _numChildren; j++) {
+        int c = _templateChildren[i * _numChildren + j];
+        e->e[j] = (c < 0) ? nullptr : &tc->elementStore[c];
+      }
+      tc->elements.push_back(e);
+    }
+  }
+  int numVals = _coeffsVal ? _coeffsVal->size1() : T::numNodes;
+  int numNodes = _coeffsGeom ? _coeffsGeom->size1() : T::numNodes;
+  tc->val.resize(numVals);
+  tc->res.resize(numVertices);
+  tc->xyz.resize(numNodes, 3);
+  tc->XYZ.resize(numVertices, 3);
+  return tc;
+}
+
+template <class T>
+void adaptiveElements<T>::_minMax(templateCopy &tc, int numComp,
+                                  const double *values, double &minVal,
+                                  double &maxVal) const
+{
+  // same scalar as in adapt(): the value, or the square of the norm
+  int numVals = tc.val.size();
+  for(int i = 0; i < numVals; i++) {
+    if(numComp == 1)
+      tc.val(i) = values[i];
+    else {
+      tc.val(i) = 0.;
+      for(int k = 0; k < numComp; k++)
+        tc.val(i) += values[i * numComp + k] * values[i * numComp + k];
+    }
+  }
+  _interpolVal->mult(tc.val, tc.res);
+  for(int i = 0; i < tc.res.size(); i++) {
+    minVal = std::min(minVal, tc.res(i));
+    maxVal = std::max(maxVal, tc.res(i));
+  }
+}
+
+template <class T>
+void adaptiveElements<T>::_adaptElement(templateCopy &tc, double tol,
+                                        double avg, int numComp,
+                                        const double *xyz,
+                                        const double *values,
+                                        GMSH_PostPlugin *plug,
+                                        std::vector<double> &out) const
+{
+  int numVals = tc.val.size(), numNodes = tc.xyz.size1();
+  int numVertices = tc.vertices.size();
+
+  if(numComp == 1) {
+    for(int i = 0; i < numVals; i++) tc.val(i) = values[i];
+    _interpolVal->mult(tc.val, tc.res);
+  }
+  else {
+    tc.valxyz.resize(numVals, numComp, false);
+    tc.resxyz.resize(numVertices, numComp, false);
+    for(int i = 0; i < numVals; i++)
+      for(int k = 0; k < numComp; k++)
+        tc.valxyz(i, k) = values[i * numComp + k];
+    _interpolVal->mult(tc.valxyz, tc.resxyz);
+  }
+  for(int i = 0; i < numNodes; i++)
+    for(int k = 0; k < 3; k++) tc.xyz(i, k) = xyz[3 * i + k];
+  _interpolGeom->mult(tc.xyz, tc.XYZ);
+
+  for(int i = 0; i < numVertices; i++) {
+    adaptiveVertex *p = tc.vertices[i];
+    if(numComp == 1)
+      p->val = tc.res(i);
+    else {
+      p->val = tc.resxyz(i, 0);
+      p->valy = tc.resxyz(i, 1);
+      p->valz = tc.resxyz(i, 2);
+      if(numComp == 9) {
+        p->valyx = tc.resxyz(i, 3);
+        p->valyy = tc.resxyz(i, 4);
+        p->valyz = tc.resxyz(i, 5);
+        p->valzx = tc.resxyz(i, 6);
+        p->valzy = tc.resxyz(i, 7);
+        p->valzz = tc.resxyz(i, 8);
+      }
+    }
+    p->X = tc.XYZ(i, 0);
+    p->Y = tc.XYZ(i, 1);
+    p->Z = tc.XYZ(i, 2);
+  }
+
+  for(std::size_t i = 0; i < tc.elements.size(); i++)
+    tc.elements[i]->visible = false;
+
+  if(!plug || tol != 0.) {
+    if(tol < 0) avg = 1.; // force visibility to the smallest subdivision
+    T::recurError(tc.elements[0], avg, tol);
+  }
+
+  if(plug) plug->assignSpecificVisibility();
+
+  for(std::size_t i = 0; i < tc.elements.size(); i++) {
+    if(!tc.elements[i]->visible) continue;
+    adaptiveVertex **p = tc.elements[i]->p;
+    for(int k = 0; k < T::numNodes; ++k) out.push_back(p[k]->X);
+    for(int k = 0; k < T::numNodes; ++k) out.push_back(p[k]->Y);
+    for(int k = 0; k < T::numNodes; ++k) out.push_back(p[k]->Z);
+    for(int k = 0; k < T::numNodes; ++k) {
+      out.push_back(p[k]->val);
+      if(numComp == 1) continue;
+      out.push_back(p[k]->valy);
+      out.push_back(p[k]->valz);
+      if(numComp == 3) continue;
+      out.push_back(p[k]->valyx);
+      out.push_back(p[k]->valyy);
+      out.push_back(p[k]->valyz);
+      out.push_back(p[k]->valzx);
+      out.push_back(p[k]->valzy);
+      out.push_back(p[k]->valzz);
+    }
+  }
+}
+
+template <class T>
+void adaptiveElements<T>::_adaptBatch(double tol, int numComp,
+                                      std::size_t numEle,
+                                      const std::vector<double> &xyz,
+                                      const std::vector<double> &values,
+                                      double &minVal, double &maxVal,
+                                      GMSH_PostPlugin *plug,
+                                      std::vector<double> &outList,
+                                      int &outNb)
+{
+  if(!numEle) return;
+
+  // plugins modify the visibility of the static template: refine serially on
+  // the master copy in that case
+  int nthreads = plug ? 1 : Msg::GetMaxThreads();
+  if(plug) {
+    if(!_master) _master = _newCopy(true);
+  }
+  else {
+    while((int)_copies.size() < nthreads) _copies.push_back(_newCopy(false));
+  }
+
+  int numVals = _coeffsVal ? _coeffsVal->size1() : T::numNodes;
+  int numNodes = _coeffsGeom ? _coeffsGeom->size1() : T::numNodes;
+  std::size_t valStride = numVals * numComp, xyzStride = 3 * numNodes;
+
+  // range of the values in the batch
+  std::vector<double> mins(numEle, minVal), maxs(numEle, maxVal);
+#pragma omp parallel for schedule(dynamic, 16) num_threads(nthreads)
+  for(std::size_t i = 0; i < numEle; i++) {
+    templateCopy *tc = plug ? _master : _copies[Msg::GetThreadNum()];
+    _minMax(*tc, numComp, &values[i * valStride], mins[i], maxs[i]);
+  }
+  for(std::size_t i = 0; i < numEle; i++) {
+    minVal = std::min(minVal, mins[i]);
+    maxVal = std::max(maxVal, maxs[i]);
+  }
+  double avg = fabs(maxVal - minVal);
+
+  // refine the elements, and append the results in order
+  std::vector<std::vector<double> > out(numEle);
+#pragma omp parallel for schedule(dynamic, 16) num_threads(nthreads)
+  for(std::size_t i = 0; i < numEle; i++) {
+    templateCopy *tc = plug ? _master : _copies[Msg::GetThreadNum()];
+    _adaptElement(*tc, tol, avg, numComp, &xyz[i * xyzStride],
+                  &values[i * valStride], plug, out[i]);
+  }
+  std::size_t eleSize = T::numNodes * (3 + numComp);
+  for(std::size_t i = 0; i < numEle; i++) {
+    outNb += out[i].size() / eleSize;
+    outList.insert(outList.end(), out[i].begin(), out[i].end());
+  }
+}
+
 template <class T>
 bool adaptiveElements<T>::adapt(double tol, int numComp,
                                 std::vector<PCoords> &coords,
@@ -1424,73 +1663,68 @@ void adaptiveElements<T>::addInView(double tol, int step, PViewData *in,
   outList->clear();
   *outNb = 0;
 
+  if(!T::allVertices.size()) {
+    Msg::Warning("No adapted vertices to interpolate");
+    return;
+  }
+
+  int numVals = _coeffsVal ? _coeffsVal->size1() : T::numNodes;
+  int numNodes = _coeffsGeom ? _coeffsGeom->size1() : T::numNodes;
+
+  // the data is read serially (the view accessors are not thread-safe), in
+  // batches whose refined output remains of reasonable size
+  std::size_t maxOut = T::all.size() * T::numNodes * (3 + numComp);
+  std::size_t batchSize =
+    std::max((std::size_t)64,
+             std::min((std::size_t)4096, ((std::size_t)1 << 24) / maxOut));
+  std::vector<double> xyz, values;
+  xyz.reserve(batchSize * 3 * numNodes);
+  values.reserve(batchSize * numVals * numComp);
+  std::size_t numBatch = 0;
+  bool wrongNodes = false, wrongValues = false;
+
   for(int ent = 0; ent < in->getNumEntities(step); ent++) {
     for(int ele = 0; ele < in->getNumElements(step, ent); ele++) {
       if(in->skipElement(step, ent, ele) ||
          in->getNumEdges(step, ent, ele) != T::numEdges)
         continue;
-      int numNodes = in->getNumNodes(step, ent, ele);
-      std::vector<PCoords> coords;
+      if(in->getNumNodes(step, ent, ele) != numNodes) {
+        wrongNodes = true;
+        continue;
+      }
+      if(in->getNumValues(step, ent, ele) / numComp != numVals) {
+        wrongValues = true;
+        continue;
+      }
       for(int i = 0; i < numNodes; i++) {
         double x, y, z;
         in->getNode(step, ent, ele, i, x, y, z);
-        coords.push_back(PCoords(x, y, z));
-      }
-      int numVal = in->getNumValues(step, ent, ele);
-      std::vector<PValues> values;
-
-      switch(numComp) {
-      case 1:
-        for(int i = 0; i < numVal; i++) {
-          double val;
-          in->getValue(step, ent, ele, i, val);
-          values.push_back(PValues(val));
-        }
-        break;
-      case 3: {
-        for(int i = 0; i < numVal / 3; i++) {
-          double vx, vy, vz;
-          in->getValue(step, ent, ele, 3 * i + 0, vx);
-          in->getValue(step, ent, ele, 3 * i + 1, vy);
-          in->getValue(step, ent, ele, 3 * i + 2, vz);
-          values.push_back(PValues(vx, vy, vz));
-        }
-        break;
-      }
-      case 9: {
-        for(int i = 0; i < numVal / 9; i++) {
-          double vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz;
-          in->getValue(step, ent, ele, 9 * i + 0, vxx);
-          in->getValue(step, ent, ele, 9 * i + 1, vxy);
-          in->getValue(step, ent, ele, 9 * i + 2, vxz);
-          in->getValue(step, ent, ele, 9 * i + 3, vyx);
-          in->getValue(step, ent, ele, 9 * i + 4, vyy);
-          in->getValue(step, ent, ele, 9 * i + 5, vyz);
-          in->getValue(step, ent, ele, 9 * i + 6, vzx);
-          in->getValue(step, ent, ele, 9 * i + 7, vzy);
-          in->getValue(step, ent, ele, 9 * i + 8, vzz);
-          values.push_back(
-            PValues(vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz));
-        }
-        break;
+        xyz.push_back(x);
+        xyz.push_back(y);
+        xyz.push_back(z);
       }
+      for(int i = 0; i < numVals * numComp; i++) {
+        double val;
+        in->getValue(step, ent, ele, i, val);
+        values.push_back(val);
       }
-      if(adapt(tol, numComp, coords, values, out->Min, out->Max, plug)) {
-        *outNb += coords.size() / T::numNodes;
-        for(std::size_t i = 0; i < coords.size() / T::numNodes; i++) {
-          for(int k = 0; k < T::numNodes; ++k)
-            outList->push_back(coords[T::numNodes * i + k].c[0]);
-          for(int k = 0; k < T::numNodes; ++k)
-            outList->push_back(coords[T::numNodes * i + k].c[1]);
-          for(int k = 0; k < T::numNodes; ++k)
-            outList->push_back(coords[T::numNodes * i + k].c[2]);
-          for(int k = 0; k < T::numNodes; ++k)
-            for(int l = 0; l < numComp; ++l)
-              outList->push_back(values[T::numNodes * i + k].v[l]);
-        }
+      if(++numBatch == batchSize) {
+        _adaptBatch(tol, numComp, numBatch, xyz, values, out->Min, out->Max,
+                    plug, *outList, *outNb);
+        numBatch = 0;
+        xyz.clear();
+        values.clear();
       }
     }
   }
+  _adaptBatch(tol, numComp, numBatch, xyz, values, out->Min, out->Max, plug,
+              *outList, *outNb);
+
+  if(wrongNodes)
+    Msg::Error("Wrong number of nodes in adaptation (should be %d)", numNodes);
+  if(wrongValues)
+    Msg::Warning("Wrong number of values in adaptation (should be %d)",
+                 numVals);
 }
 
 adaptiveData::adaptiveData(PViewData *data, bool outDataInit)
@@ -597,6 +597,42 @@ template <class T> class adaptiveElements {
 private:
   fullMatrix<double> *_coeffsVal, *_eexpsVal, *_interpolVal;
   fullMatrix<double> *_coeffsGeom, *_eexpsGeom, *_interpolGeom;
+  // flat description of the refinement template at the current level: node
+  // indices (in the T::allVertices order) and child indices (in the T::all
+  // order, -1 for leaves) of each sub-element
+  std::vector<int> _templateNodes, _templateChildren;
+  int _numChildren;
+  // working copy of the refinement template and scratch arrays, so that
+  // elements can be adapted concurrently (one copy per thread); the master
+  // copy works directly on the static template (required by plugins, which
+  // modify its visibility in assignSpecificVisibility())
+  class templateCopy {
+  public:
+    std::vector<adaptiveVertex> vertexStore;
+    std::vector<T> elementStore;
+    std::vector<adaptiveVertex *> vertices;
+    std::vector<T *> elements;
+    fullVector<double> val, res;
+    fullMatrix<double> valxyz, resxyz, xyz, XYZ;
+  };
+  templateCopy *_master;
+  std::vector<templateCopy *> _copies;
+  void _buildTemplate();
+  void _clearCopies();
+  templateCopy *_newCopy(bool master);
+  // interpolate the values of an element on the template vertices, and
+  // return their range (values are stored as numVals x numComp)
+  void _minMax(templateCopy &tc, int numComp, const double *values,
+               double &minVal, double &maxVal) const;
+  // refine a single element and append the visible sub-elements to out
+  void _adaptElement(templateCopy &tc, double tol, double avg, int numComp,
+                     const double *xyz, const double *values,
+                     GMSH_PostPlugin *plug, std::vector<double> &out) const;
+  void _adaptBatch(double tol, int numComp, std::size_t numEle,
+                   const std::vector<double> &xyz,
+                   const std::vector<double> &values, double &minVal,
+                   double &maxVal, GMSH_PostPlugin *plug,
+                   std::vector<double> &outList, int &outNb);
 
 public:
   adaptiveElements(std::vector<fullMatrix<double> *> &interpolationMatrices);
@@ -611,7 +647,10 @@ public:
              GMSH_PostPlugin *plug = nullptr, bool onlyComputeMinMax = false);
   // adapt all the T-type elements in the input view and add the
   // refined elements in the output view (we will remove this when we
-  // switch to true on-the-fly local refinement in drawPost())
+  // switch to true on-the-fly local refinement in drawPost()). Elements are
+  // read in batches and refined in parallel (unless a plugin drives the
+  // refinement); the error of all the elements in a batch is measured w.r.t.
+  // the range of the values up to and including the batch
   void addInView(double tol, int step, PViewData *in, PViewDataList *out,
                  GMSH_PostPlugin *plug = nullptr);
 
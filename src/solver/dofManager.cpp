@@ -3,6 +3,8 @@
 // See the LICENSE.txt file in the Gmsh root directory for license information.
 // Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
+#include <algorithm>
+#include <cstdint>
 #include "GmshConfig.h"
 
 #ifdef HAVE_MPI
@@ -155,3 +157,88 @@ void dofManagerBase::_parallelFinalize()
 #endif
   _parallelFinalized = true;
 }
+
+int dofManagerBase::colorElements(
+  std::size_t numElements,
+  const std::function<void(std::size_t, std::vector<int> &)> &unknowns,
+  std::vector<int> &colors)
+{
+  // greedy coloring, by rounds of 64 colors: for each unknown, a bit mask of
+  // the colors (in the current round) of the elements that contain it
+  colors.assign(numElements, -1);
+  std::vector<uint64_t> used;
+  std::vector<int> nums;
+  std::size_t numColored = 0;
+  int numColors = 0;
+  for(int round = 0; numColored < numElements; round++) {
+    used.clear();
+    for(std::size_t i = 0; i < numElements; i++) {
+      if(colors[i] >= 0) continue;
+      nums.clear();
+      unknowns(i, nums);
+      uint64_t mask = 0;
+      for(std::size_t j = 0; j < nums.size(); j++) {
+        if(nums[j] < 0) continue;
+        if(nums[j] >= (int)used.size()) used.resize(nums[j] + 1, 0);
+        mask |= used[nums[j]];
+      }
+      if(mask == ~(uint64_t)0) continue; // no free color in this round
+      int c = 0;
+      while(mask & ((uint64_t)1 << c)) c++;
+      for(std::size_t j = 0; j < nums.size(); j++)
+        if(nums[j] >= 0) used[nums[j]] |= ((uint64_t)1 << c);
+      colors[i] = 64 * round + c;
+      numColors = std::max(numColors, colors[i] + 1);
+      numColored++;
+    }
+  }
+  return numColors;
+}
+
+void dofManagerBase::buildSparsityPattern(int numRows,
+                                          const std::vector<std::size_t> &eptr,
+                                          const std::vector<int> &eind,
+                                          std::vector<int> &jptr,
+                                          std::vector<int> &ai)
+{
+  // elements containing each unknown
+  const std::size_t numElements = eptr.empty() ? 0 : eptr.size() - 1;
+  std::vector<std::size_t> rptr(numRows + 1, 0);
+  for(std::size_t k = 0; k < eind.size(); k++) rptr[eind[k] + 1]++;
+  for(int i = 0; i < numRows; i++) rptr[i + 1] += rptr[i];
+  std::vector<std::size_t> rind(rptr[numRows]);
+  {
+    std::vector<std::size_t> pos(rptr.begin(), rptr.end() - 1);
+    for(std::size_t e = 0; e < numElements; e++)
+      for(std::size_t k = eptr[e]; k < eptr[e + 1]; k++)
+        rind[pos[eind[k]]++] = e;
+  }
+
+  // columns of each row, counted and then stored
+  jptr.assign(numRows + 1, 0);
+  for(int pass = 0; pass < 2; pass++) {
+#pragma omp parallel num_threads(Msg::GetMaxThreads())
+    {
+      std::vector<int> cols;
+#pragma omp for schedule(dynamic, 1024)
+      for(int i = 0; i < numRows; i++) {
+        cols.clear();
+        for(std::size_t k = rptr[i]; k < rptr[i + 1]; k++) {
+          const std::size_t e = rind[k];
+          cols.insert(cols.end(), eind.begin() + eptr[e],
+                      eind.begin() + eptr[e + 1]);
+        }
+        std::sort(cols.begin(), cols.end());
+        cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+        if(pass)
+          std::copy(cols.begin(), cols.end(), ai.begin() + jptr[i]);
+        else
+          jptr[i + 1] = cols.size();
+      }
+    }
+    if(!pass) {
+      for(int i = 0; i < numRows; i++) jptr[i + 1] += jptr[i];
+      ai.resize(jptr[numRows]);
+    }
+  }
+}
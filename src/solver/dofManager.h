@@ -10,6 +10,8 @@
 #include <string>
 #include <complex>
 #include <map>
+#include <unordered_map>
+#include <functional>
 #include <list>
 #include <iostream>
 #include "MVertex.h"
@@ -47,6 +49,15 @@ public:
   }
 };
 
+struct DofHash {
+  std::size_t operator()(const Dof &d) const
+  {
+    std::size_t h = std::hash<long int>()(d.getEntity());
+    return h ^ (std::hash<int>()(d.getType()) + 0x9e3779b9 + (h << 6) +
+                (h >> 2));
+  }
+};
+
 template <class T> struct dofTraits {
   typedef T VecType;
   typedef T MatType;
@@ -85,11 +96,12 @@ public:
 // include mpi.h in the .h file)
 class dofManagerBase {
 protected:
-  // numbering of unknown dof blocks
-  std::map<Dof, int> unknown;
+  // numbering of unknown dof blocks (hashed, as it is queried for each entry
+  // during assembly)
+  std::unordered_map<Dof, int, DofHash> unknown;
 
   // associatations (not used ?)
-  std::map<Dof, Dof> associatedWith;
+  std::unordered_map<Dof, Dof, DofHash> associatedWith;
 
   // parallel section
   // those dof are images of ghost located on another proc (id givent by the
@@ -105,6 +117,23 @@ protected:
     _isParallel = isParallel;
     _parallelFinalized = false;
   }
+
+public:
+  // color numElements elements so that elements with the same color do not
+  // share any unknown, given the numbers of the unknowns of each element
+  // (returned by the unknowns function); return the number of colors
+  static int
+  colorElements(std::size_t numElements,
+                const std::function<void(std::size_t, std::vector<int> &)>
+                  &unknowns,
+                std::vector<int> &colors);
+  // compute the sorted CSR pattern (jptr, ai) of the numRows x numRows matrix
+  // coupling the unknowns of each element, given in CSR format (eptr, eind)
+  static void buildSparsityPattern(int numRows,
+                                   const std::vector<std::size_t> &eptr,
+                                   const std::vector<int> &eind,
+                                   std::vector<int> &jptr,
+                                   std::vector<int> &ai);
 };
 
 // A manager for degrees of freedoms, templated on the value of a dof
@@ -390,6 +419,66 @@ public:
     }
   }
 
+  // insert the entries coupling the dofs of each one of numElements elements
+  // (given by the keys function, which must be thread-safe) in the sparsity
+  // pattern. This is done in two passes, and in parallel: the unknowns of the
+  // elements are first collected, and the exact pattern is then computed row
+  // by row and set at once in the linear system (which allocates its entries).
+  // If the entries are already allocated (e.g. when the matrix is
+  // re-assembled after systemClear()), the current pattern is kept.
+  virtual void sparsityDofs(
+    std::size_t numElements,
+    const std::function<void(std::size_t, std::vector<Dof> &)> &keys)
+  {
+    if(_current->hasPreAllocatedEntries()) return;
+    if(_isParallel || !constraints.empty() || !associatedWith.empty()) {
+      std::vector<Dof> R;
+      for(std::size_t i = 0; i < numElements; i++) {
+        R.clear();
+        keys(i, R);
+        sparsityDof(R);
+      }
+      return;
+    }
+    if(!_current->isAllocated()) _current->allocate(sizeOfR());
+
+    // symbolic pass: unknowns of each element (counted, then stored)
+    int nthreads = Msg::GetMaxThreads();
+    std::vector<std::size_t> eptr(numElements + 1, 0);
+    std::vector<int> eind;
+    for(int pass = 0; pass < 2; pass++) {
+#pragma omp parallel num_threads(nthreads)
+      {
+        std::vector<Dof> R;
+#pragma omp for schedule(dynamic, 1024)
+        for(std::size_t i = 0; i < numElements; i++) {
+          R.clear();
+          keys(i, R);
+          std::size_t n = 0;
+          for(std::size_t j = 0; j < R.size(); j++) {
+            auto it = unknown.find(R[j]);
+            if(it == unknown.end()) continue;
+            if(pass) eind[eptr[i] + n] = it->second;
+            n++;
+          }
+          if(!pass) eptr[i + 1] = n;
+        }
+      }
+      if(!pass) {
+        for(std::size_t i = 0; i < numElements; i++) eptr[i + 1] += eptr[i];
+        eind.resize(eptr[numElements]);
+      }
+    }
+
+    std::vector<int> jptr, ai;
+    buildSparsityPattern(sizeOfR(), eptr, eind, jptr, ai);
+    if(!_current->setSparsityPattern(jptr, ai)) {
+      for(int i = 0; i < sizeOfR(); i++)
+        for(int k = jptr[i]; k < jptr[i + 1]; k++)
+          _current->insertInSparsityPattern(i, ai[k]);
+    }
+  }
+
   virtual inline void assemble(const Dof &R, const Dof &C, const dataMat &value)
   {
     if(_isParallel && !_parallelFinalized) _parallelFinalize();
@@ -421,7 +510,6 @@ public:
   {
     if(_isParallel && !_parallelFinalized) _parallelFinalize();
     if(!_current->isAllocated()) _current->allocate(sizeOfR());
-    printf("coucou\n");
 
     for(std::size_t i = 0; i < R.size(); i++) {
       auto it = associatedWith.find(R[i]);
@@ -481,7 +569,6 @@ public:
   {
     if(_isParallel && !_parallelFinalized) _parallelFinalize();
     if(!_current->isAllocated()) _current->allocate(sizeOfR());
-    printf("coucou RHS\n");
 
     for(std::size_t i = 0; i < R.size(); i++) {
       auto it = associatedWith.find(R[i]);
@@ -608,6 +695,25 @@ public:
     return _isParallel ? _localSize : unknown.size();
   }
   virtual int sizeOfF() const { return fixed.size(); }
+  // allocate the entries of the current matrix, using the sparsity pattern
+  // inserted so far
+  virtual void preAllocateEntries()
+  {
+    if(_isParallel && !_parallelFinalized) _parallelFinalize();
+    if(!_current->isAllocated()) _current->allocate(sizeOfR());
+    _current->preAllocateEntries();
+  }
+  // return true if elements that do not share any unknown can be assembled
+  // concurrently (see AssembleColored() in solverAlgorithms.h): this requires
+  // a linear system that supports it, whose entries have been allocated, and
+  // no affine constraints, associations or ghost dofs (which lead to
+  // contributions in other rows)
+  virtual bool allowsConcurrentAssembly() const
+  {
+    return !_isParallel && constraints.empty() && associatedWith.empty() &&
+           ghostValue.empty() && _current->isAllocated() &&
+           _current->allowsConcurrentAssembly();
+  }
   virtual void systemSolve() { _current->systemSolve(); }
   virtual void systemClear()
   {
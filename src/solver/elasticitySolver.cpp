@@ -7,6 +7,7 @@
 #include "GmshConfig.h"
 #include "elasticitySolver.h"
 #include "linearSystemCSR.h"
+#include "linearSystemCSRIterative.h"
 #include "linearSystemPETSc.h"
 #include "linearSystemFull.h"
 #include "Numeric.h"
@@ -122,7 +123,14 @@ void elasticitySolver::solve()
 #elif defined(HAVE_GMM)
   linearSystemCSRGmm<double> *lsys = new linearSystemCSRGmm<double>;
 #else
-  linearSystemFull<double> *lsys = new linearSystemFull<double>;
+  // the Lagrange multipliers lead to an indefinite (saddle point) system,
+  // which the conjugate gradient cannot solve
+  linearSystem<double> *lsys;
+  if(LagrangeMultiplierFields.empty())
+    lsys =
+      new linearSystemCSRIterative<double>(CSRIterativeCG, CSRIterativeILU0);
+  else
+    lsys = new linearSystemFull<double>;
 #endif
 
   assemble(lsys);
@@ -573,12 +581,27 @@ void elasticitySolver::assemble(linearSystem<double> *lsys)
   }
   // Assemble elastic term for
   GaussQuadrature Integ_Bulk(GaussQuadrature::GradGrad);
+  // without Lagrange multipliers the elastic terms are the only matrix terms:
+  // insert them all in the sparsity pattern, so that the elements can be
+  // assembled concurrently
+  const bool colored = LagrangeMultiplierFields.empty();
+  if(colored) {
+    std::vector<MElement *> bulk;
+    for(std::size_t i = 0; i < elasticFields.size(); i++)
+      bulk.insert(bulk.end(), elasticFields[i].g->begin(),
+                  elasticFields[i].g->end());
+    SparsityDofs(*LagSpace, bulk.begin(), bulk.end(), *pAssembler);
+  }
   for(std::size_t i = 0; i < elasticFields.size(); i++) {
     printf("Elastic\n");
     IsotropicElasticTerm Eterm(*LagSpace, elasticFields[i]._e,
                                elasticFields[i]._nu);
-    Assemble(Eterm, *LagSpace, elasticFields[i].g->begin(),
-             elasticFields[i].g->end(), Integ_Bulk, *pAssembler);
+    if(colored)
+      AssembleColored(Eterm, *LagSpace, elasticFields[i].g->begin(),
+                      elasticFields[i].g->end(), Integ_Bulk, *pAssembler);
+    else
+      Assemble(Eterm, *LagSpace, elasticFields[i].g->begin(),
+               elasticFields[i].g->end(), Integ_Bulk, *pAssembler);
   }
 
   printf("nDofs=%d\n", pAssembler->sizeOfR());
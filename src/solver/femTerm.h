@@ -8,6 +8,7 @@
 
 #include <math.h>
 #include <map>
+#include <set>
 #include <vector>
 #include "fullMatrix.h"
 #include "simpleFunction.h"
@@ -102,6 +103,67 @@ public:
       dm.assemble(R, localMatrix);
   }
 
+  // add the contribution from all the elements, assembling elements that do
+  // not share any unknown concurrently; elementMatrix() must be thread-safe.
+  // All the unknowns must have been numbered. The entries of the matrix are
+  // allocated from the sparsity pattern of the elements, unless they are
+  // already allocated (when re-assembling after systemClear()).
+  void addToMatrixColored(dofManager<dataVec> &dm,
+                          std::vector<MElement *> &elements) const
+  {
+    dm.sparsityDofs(elements.size(), [&](std::size_t i, std::vector<Dof> &R) {
+      SElement se(elements[i]);
+      for(int j = 0; j < sizeOfR(&se); j++) R.push_back(getLocalDofR(&se, j));
+    });
+    // make sure the integration rules and the shape functions are tabulated
+    // before the parallel loop
+    std::set<int> types;
+    for(std::size_t i = 0; i < elements.size(); i++) {
+      if(types.insert(elements[i]->getTypeForMSH()).second) {
+        SElement se(elements[i]);
+        fullMatrix<dataMat> m(sizeOfR(&se), sizeOfC(&se));
+        elementMatrix(&se, m);
+      }
+    }
+    int nthreads = Msg::GetMaxThreads();
+    if(nthreads > 1) {
+      dm.preAllocateEntries();
+      if(!dm.allowsConcurrentAssembly()) nthreads = 1;
+    }
+    if(nthreads == 1) {
+      for(std::size_t i = 0; i < elements.size(); i++) {
+        SElement se(elements[i]);
+        addToMatrix(dm, &se);
+      }
+      return;
+    }
+
+    std::vector<int> colors;
+    int numColors = dofManagerBase::colorElements(
+      elements.size(),
+      [&](std::size_t i, std::vector<int> &nums) {
+        SElement se(elements[i]);
+        for(int j = 0; j < sizeOfR(&se); j++)
+          nums.push_back(dm.getDofNumber(getLocalDofR(&se, j)));
+      },
+      colors);
+    std::vector<std::vector<MElement *> > byColor(numColors);
+    for(std::size_t i = 0; i < elements.size(); i++)
+      byColor[colors[i]].push_back(elements[i]);
+
+    Msg::Debug("Assembling %lu elements with %d colors on %d threads",
+               elements.size(), numColors, nthreads);
+
+    for(int c = 0; c < numColors; c++) {
+      std::vector<MElement *> &ec = byColor[c];
+#pragma omp parallel for schedule(dynamic, 64) num_threads(nthreads)
+      for(std::size_t i = 0; i < ec.size(); i++) {
+        SElement se(ec[i]);
+        addToMatrix(dm, &se);
+      }
+    }
+  }
+
   void dirichletNodalBC(int physical, int dim, int comp, int field,
                         const simpleFunction<dataVec> &e,
                         dofManager<dataVec> &dm)
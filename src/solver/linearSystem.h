@@ -8,6 +8,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 // A class that encapsulates a linear system solver interface :
 // building a sparse matrix, solving a linear system
@@ -31,6 +32,23 @@ public:
   void setParameter(const std::string &key, std::string value);
   std::string getParameter(const std::string &key) const;
   virtual void insertInSparsityPattern(int _row, int _col){};
+  // set the whole sparsity pattern at once, in CSR format (with sorted
+  // columns), once the system is allocated; return false if this is not
+  // supported, or if some entries have already been inserted: the entries
+  // should then be inserted one by one
+  virtual bool setSparsityPattern(const std::vector<int> &jptr,
+                                  const std::vector<int> &ai)
+  {
+    return false;
+  }
+  // return true if the entries of the matrix have been allocated: the pattern
+  // is then kept until the system is reallocated, and zeroMatrix() allows to
+  // re-assemble the matrix in place
+  virtual bool hasPreAllocatedEntries() const { return false; }
+  // return true if addToMatrix() and addToRightHandSide() can be called
+  // concurrently for distinct rows, provided that the entries are in the
+  // sparsity pattern used to allocate the matrix
+  virtual bool allowsConcurrentAssembly() const { return false; }
   virtual double normInfRightHandSide() const = 0;
   virtual double normInfSolution() const { return 0; };
 };
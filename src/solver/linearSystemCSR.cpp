@@ -175,6 +175,62 @@ template <> void linearSystemCSR<std::complex<double> >::preAllocateEntries()
   }
 }
 
+template <class scalar>
+static bool setSparsityPattern_(int nbRows, const std::vector<int> &jptr,
+                                const std::vector<int> &ai, CSRList_T *_a,
+                                CSRList_T *_ai, CSRList_T *_ptr,
+                                CSRList_T *_jptr, char *something)
+{
+  if((int)jptr.size() != nbRows + 1 || jptr[nbRows] != (int)ai.size() ||
+     ai.empty())
+    return false;
+  const INDEX_TYPE nnz = ai.size();
+  CSRList_Resize_strict(_ai, nnz);
+  CSRList_Resize_strict(_ptr, nnz);
+  INDEX_TYPE *pj = (INDEX_TYPE *)_jptr->array;
+  INDEX_TYPE *pai = (INDEX_TYPE *)_ai->array;
+  INDEX_TYPE *pptr = (INDEX_TYPE *)_ptr->array;
+  for(int i = 0; i <= nbRows; i++) pj[i] = jptr[i];
+  for(INDEX_TYPE k = 0; k < nnz; k++) {
+    pai[k] = ai[k];
+    pptr[k] = k + 1;
+  }
+  for(int i = 0; i < nbRows; i++) {
+    if(jptr[i + 1] != jptr[i]) pptr[jptr[i + 1] - 1] = 0;
+    something[i] = (jptr[i + 1] == jptr[i] ? 0 : 1);
+  }
+  CSRList_Resize_strict(_a, nnz);
+  scalar *a = (scalar *)_a->array;
+  for(INDEX_TYPE k = 0; k < nnz; k++) a[k] = scalar();
+  return true;
+}
+
+template <>
+bool linearSystemCSR<double>::setSparsityPattern(const std::vector<int> &jptr,
+                                                 const std::vector<int> &ai)
+{
+  if(!_a || _entriesPreAllocated || _sparsity.getNbRows()) return false;
+  if(!setSparsityPattern_<double>(_b->size(), jptr, ai, _a, _ai, _ptr, _jptr,
+                                  something))
+    return false;
+  _entriesPreAllocated = true;
+  sorted = true;
+  return true;
+}
+
+template <>
+bool linearSystemCSR<std::complex<double> >::setSparsityPattern(
+  const std::vector<int> &jptr, const std::vector<int> &ai)
+{
+  if(!_a || _entriesPreAllocated || _sparsity.getNbRows()) return false;
+  if(!setSparsityPattern_<std::complex<double> >(
+       _b->size(), jptr, ai, _a, _ai, _ptr, _jptr, something))
+    return false;
+  _entriesPreAllocated = true;
+  sorted = true;
+  return true;
+}
+
 template <> void linearSystemCSR<double>::allocate(int nbRows)
 {
   if(_a) {
@@ -186,6 +242,9 @@ template <> void linearSystemCSR<double>::allocate(int nbRows)
     delete _b;
     delete[] something;
   }
+  // the entries (and their pattern) are lost
+  _entriesPreAllocated = false;
+  sorted = false;
 
   if(nbRows == 0) {
     _a = nullptr;
@@ -194,7 +253,6 @@ template <> void linearSystemCSR<double>::allocate(int nbRows)
     _jptr = nullptr;
     _b = nullptr;
     _x = nullptr;
-    sorted = false;
     something = nullptr;
     return;
   }
@@ -223,6 +281,9 @@ template <> void linearSystemCSR<std::complex<double> >::allocate(int nbRows)
     delete _b;
     delete[] something;
   }
+  // the entries (and their pattern) are lost
+  _entriesPreAllocated = false;
+  sorted = false;
 
   if(nbRows == 0) {
     _a = nullptr;
@@ -231,7 +292,6 @@ template <> void linearSystemCSR<std::complex<double> >::allocate(int nbRows)
     _jptr = nullptr;
     _b = nullptr;
     _x = nullptr;
-    sorted = false;
     something = nullptr;
     return;
   }
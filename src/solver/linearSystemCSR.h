@@ -48,9 +48,18 @@ public:
   virtual ~linearSystemCSR() { allocate(0); }
   virtual void insertInSparsityPattern(int i, int j)
   {
-    _sparsity.insertEntry(i, j);
+    // the pattern is frozen once the entries are allocated
+    if(!_entriesPreAllocated) _sparsity.insertEntry(i, j);
   }
+  virtual bool setSparsityPattern(const std::vector<int> &jptr,
+                                  const std::vector<int> &ai);
   virtual void preAllocateEntries();
+  virtual bool hasPreAllocatedEntries() const { return _entriesPreAllocated; }
+  virtual bool allowsConcurrentAssembly() const
+  {
+    // entries are then stored at fixed locations, and found by bisection
+    return _entriesPreAllocated;
+  }
   virtual void addToMatrix(int il, int ic, const scalar &val)
   {
     if(!_entriesPreAllocated) preAllocateEntries();
@@ -0,0 +1,602 @@
+// Gmsh - Copyright (C) 1997-2024 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#include <cmath>
+#include <algorithm>
+#include "GmshMessage.h"
+#include "linearSystemCSRIterative.h"
+
+// vectors smaller than this are processed by a single thread
+static const int minParallelSize = 10000;
+
+// minimum (average) number of rows per level for the level scheduling of the
+// ILU(0) factorization and triangular solves
+static const int minLevelSize = 256;
+
+static int numThreads(int n)
+{
+  return n < minParallelSize ? 1 : Msg::GetMaxThreads();
+}
+
+// y = A x
+static void spmv(int n, const INDEX_TYPE *jptr, const INDEX_TYPE *ai,
+                 const double *a, const double *x, double *y)
+{
+#pragma omp parallel for schedule(static) num_threads(numThreads(n))
+  for(int i = 0; i < n; i++) {
+    double s = 0.;
+    for(INDEX_TYPE k = jptr[i]; k < jptr[i + 1]; k++) s += a[k] * x[ai[k]];
+    y[i] = s;
+  }
+}
+
+// r = b - A x
+static void residual(int n, const INDEX_TYPE *jptr, const INDEX_TYPE *ai,
+                     const double *a, const double *x, const double *b,
+                     double *r)
+{
+#pragma omp parallel for schedule(static) num_threads(numThreads(n))
+  for(int i = 0; i < n; i++) {
+    double s = b[i];
+    for(INDEX_TYPE k = jptr[i]; k < jptr[i + 1]; k++) s -= a[k] * x[ai[k]];
+    r[i] = s;
+  }
+}
+
+static double dot(int n, const double *x, const double *y)
+{
+  double s = 0.;
+#pragma omp parallel for schedule(static) reduction(+ : s)                     \
+  num_threads(numThreads(n))
+  for(int i = 0; i < n; i++) s += x[i] * y[i];
+  return s;
+}
+
+// first position with column >= i in each row (the diagonal, if present)
+static void diagonalPositions(int n, const INDEX_TYPE *jptr,
+                              const INDEX_TYPE *ai,
+                              std::vector<INDEX_TYPE> &diag)
+{
+  diag.resize(n);
+#pragma omp parallel for schedule(static) num_threads(numThreads(n))
+  for(int i = 0; i < n; i++)
+    diag[i] = std::lower_bound(ai + jptr[i], ai + jptr[i + 1], i) - ai;
+}
+
+static void inverseDiagonal(int n, const INDEX_TYPE *jptr,
+                            const INDEX_TYPE *ai, const double *a,
+                            std::vector<double> &invDiag)
+{
+  invDiag.resize(n);
+#pragma omp parallel for schedule(static) num_threads(numThreads(n))
+  for(int i = 0; i < n; i++) {
+    double d = 0.;
+    for(INDEX_TYPE k = jptr[i]; k < jptr[i + 1]; k++)
+      if(ai[k] == i) d = a[k];
+    invDiag[i] = (d != 0.) ? 1. / d : 1.;
+  }
+}
+
+// group the rows by level, given the level of each row
+static void groupByLevel(const std::vector<int> &lev, int numLevels,
+                         std::vector<int> &levels, std::vector<int> &rows)
+{
+  levels.assign(numLevels + 1, 0);
+  for(std::size_t i = 0; i < lev.size(); i++) levels[lev[i] + 1]++;
+  for(int l = 0; l < numLevels; l++) levels[l + 1] += levels[l];
+  rows.resize(lev.size());
+  std::vector<int> pos(levels.begin(), levels.end() - 1);
+  for(std::size_t i = 0; i < lev.size(); i++) rows[pos[lev[i]]++] = i;
+}
+
+void linearSystemCSRIterative<double>::_getMatrix()
+{
+  getMatrix(_rowStart, _colIndex, _values);
+  _n = _b->size();
+  diagonalPositions(_n, _rowStart, _colIndex, _diag);
+}
+
+void linearSystemCSRIterative<double>::_buildILU0()
+{
+  const int n = _n;
+  const INDEX_TYPE nnz = _rowStart[n];
+  _lu.assign(_values, _values + nnz);
+  _luInvDiag.resize(n);
+
+  // levels of the rows for the lower triangular part (which are also the
+  // dependencies of the factorization) and for the upper triangular part
+  std::vector<int> lev(n);
+  int numLevels = 0;
+  for(int i = 0; i < n; i++) {
+    int l = 0;
+    for(INDEX_TYPE k = _rowStart[i]; k < _diag[i]; k++)
+      l = std::max(l, lev[_colIndex[k]] + 1);
+    lev[i] = l;
+    numLevels = std::max(numLevels, l + 1);
+  }
+  groupByLevel(lev, numLevels, _lowerLevels, _lowerRows);
+  numLevels = 0;
+  for(int i = n - 1; i >= 0; i--) {
+    int l = 0;
+    for(INDEX_TYPE k = _diag[i]; k < _rowStart[i + 1]; k++)
+      if(_colIndex[k] > i) l = std::max(l, lev[_colIndex[k]] + 1);
+    lev[i] = l;
+    numLevels = std::max(numLevels, l + 1);
+  }
+  groupByLevel(lev, numLevels, _upperLevels, _upperRows);
+  // with small levels, process the rows sequentially in their natural order,
+  // for a better locality
+  const int numLower = _lowerLevels.size() - 1;
+  const int numUpper = _upperLevels.size() - 1;
+  _iluParallel = numThreads(n) > 1 && n >= minLevelSize * numLower &&
+                 n >= minLevelSize * numUpper;
+  if(!_iluParallel) {
+    _lowerLevels.assign(1, 0);
+    _lowerLevels.push_back(n);
+    _upperLevels = _lowerLevels;
+    for(int i = 0; i < n; i++) {
+      _lowerRows[i] = i;
+      _upperRows[i] = n - 1 - i;
+    }
+  }
+
+  // factorization, level by level
+  const int nthreads = numThreads(n);
+  std::vector<std::vector<INDEX_TYPE> > work(nthreads);
+  int numBadPivots = 0;
+  for(std::size_t l = 0; l + 1 < _lowerLevels.size(); l++) {
+    const int l0 = _lowerLevels[l], l1 = _lowerLevels[l + 1];
+#pragma omp parallel for schedule(dynamic, 64) num_threads(nthreads)          \
+  reduction(+ : numBadPivots) if(_iluParallel && l1 - l0 >= minLevelSize)
+    for(int li = l0; li < l1; li++) {
+      std::vector<INDEX_TYPE> &iw = work[Msg::GetThreadNum()];
+      if((int)iw.size() != n) iw.assign(n, -1);
+      const int i = _lowerRows[li];
+      for(INDEX_TYPE k = _rowStart[i]; k < _rowStart[i + 1]; k++)
+        iw[_colIndex[k]] = k;
+      for(INDEX_TYPE k = _rowStart[i]; k < _diag[i]; k++) {
+        const int c = _colIndex[k];
+        _lu[k] *= _luInvDiag[c];
+        for(INDEX_TYPE kk = _diag[c]; kk < _rowStart[c + 1]; kk++) {
+          if(_colIndex[kk] <= c) continue;
+          const INDEX_TYPE p = iw[_colIndex[kk]];
+          if(p >= 0) _lu[p] -= _lu[k] * _lu[kk];
+        }
+      }
+      double pivot = 0., rowMax = 0.;
+      for(INDEX_TYPE k = _rowStart[i]; k < _rowStart[i + 1]; k++) {
+        rowMax = std::max(rowMax, std::abs(_values[k]));
+        if(_colIndex[k] == i) pivot = _lu[k];
+      }
+      if(std::abs(pivot) <= 1e-14 * rowMax || pivot == 0.) {
+        pivot = (rowMax > 0.) ? rowMax : 1.;
+        numBadPivots++;
+      }
+      _luInvDiag[i] = 1. / pivot;
+      for(INDEX_TYPE k = _rowStart[i]; k < _rowStart[i + 1]; k++)
+        iw[_colIndex[k]] = -1;
+    }
+  }
+  if(numBadPivots)
+    Msg::Warning("Replaced %d small pivots in ILU(0) factorization",
+                 numBadPivots);
+  Msg::Debug("ILU(0) factorization: %d lower and %d upper levels%s", numLower,
+             numUpper, _iluParallel ? "" : " (sequential)");
+}
+
+void linearSystemCSRIterative<double>::_solveILU0(const double *r, double *z)
+{
+  // L y = r (L with unit diagonal), then U z = y
+  for(std::size_t l = 0; l + 1 < _lowerLevels.size(); l++) {
+    const int l0 = _lowerLevels[l], l1 = _lowerLevels[l + 1];
+#pragma omp parallel for schedule(static) num_threads(numThreads(_n))         \
+  if(_iluParallel && l1 - l0 >= minLevelSize)
+    for(int li = l0; li < l1; li++) {
+      const int i = _lowerRows[li];
+      double s = r[i];
+      for(INDEX_TYPE k = _rowStart[i]; k < _diag[i]; k++)
+        s -= _lu[k] * z[_colIndex[k]];
+      z[i] = s;
+    }
+  }
+  for(std::size_t l = 0; l + 1 < _upperLevels.size(); l++) {
+    const int l0 = _upperLevels[l], l1 = _upperLevels[l + 1];
+#pragma omp parallel for schedule(static) num_threads(numThreads(_n))         \
+  if(_iluParallel && l1 - l0 >= minLevelSize)
+    for(int li = l0; li < l1; li++) {
+      const int i = _upperRows[li];
+      double s = z[i];
+      for(INDEX_TYPE k = _diag[i]; k < _rowStart[i + 1]; k++)
+        if(_colIndex[k] > i) s -= _lu[k] * z[_colIndex[k]];
+      z[i] = s * _luInvDiag[i];
+    }
+  }
+}
+
+// aggregation of the unknowns of a matrix, based on the strength of the
+// connections: return the number of aggregates
+static int aggregate(int n, const INDEX_TYPE *jptr, const INDEX_TYPE *ai,
+                     const double *a, std::vector<int> &agg)
+{
+  const double theta = 0.08;
+  std::vector<double> diag(n, 0.);
+  for(int i = 0; i < n; i++)
+    for(INDEX_TYPE k = jptr[i]; k < jptr[i + 1]; k++)
+      if(ai[k] == i) diag[i] = std::abs(a[k]);
+  auto strong = [&](int i, INDEX_TYPE k) {
+    const int j = ai[k];
+    return j != i && a[k] != 0. &&
+           std::abs(a[k]) >= theta * std::sqrt(diag[i] * diag[j]);
+  };
+
+  // seeds whose strong neighbors are all free, with their neighbors
+  agg.assign(n, -1);
+  int nc = 0;
+  for(int i = 0; i < n; i++) {
+    if(agg[i] >= 0) continue;
+    bool free = true;
+    for(INDEX_TYPE k = jptr[i]; k < jptr[i + 1] && free; k++)
+      if(strong(i, k) && agg[ai[k]] >= 0) free = false;
+    if(!free) continue;
+    agg[i] = nc;
+    for(INDEX_TYPE k = jptr[i]; k < jptr[i + 1]; k++)
+      if(strong(i, k)) agg[ai[k]] = nc;
+    nc++;
+  }
+  // remaining unknowns join the aggregate they are most strongly connected to
+  std::vector<int> agg1(agg);
+  for(int i = 0; i < n; i++) {
+    if(agg1[i] >= 0) continue;
+    double best = 0.;
+    for(INDEX_TYPE k = jptr[i]; k < jptr[i + 1]; k++) {
+      if(strong(i, k) && agg1[ai[k]] >= 0 && std::abs(a[k]) > best) {
+        best = std::abs(a[k]);
+        agg[i] = agg1[ai[k]];
+      }
+    }
+  }
+  // new aggregates for the others
+  for(int i = 0; i < n; i++) {
+    if(agg[i] >= 0) continue;
+    agg[i] = nc;
+    for(INDEX_TYPE k = jptr[i]; k < jptr[i + 1]; k++)
+      if(strong(i, k) && agg[ai[k]] < 0) agg[ai[k]] = nc;
+    nc++;
+  }
+  return nc;
+}
+
+// Galerkin coarse matrix P^T A P, with P the (piecewise constant)
+// prolongation from the aggregates, given by agg and by the unknowns of each
+// aggregate (aptr, arows)
+static void coarseMatrix(const INDEX_TYPE *jptr, const INDEX_TYPE *ai,
+                         const double *a, const std::vector<int> &agg,
+                         const std::vector<int> &aptr,
+                         const std::vector<int> &arows, int nc,
+                         std::vector<INDEX_TYPE> &cjptr,
+                         std::vector<INDEX_TYPE> &cai, std::vector<double> &ca)
+{
+  cjptr.assign(nc + 1, 0);
+  for(int pass = 0; pass < 2; pass++) {
+#pragma omp parallel num_threads(numThreads(arows.size()))
+    {
+      std::vector<std::pair<int, double> > row;
+#pragma omp for schedule(dynamic, 256)
+      for(int c = 0; c < nc; c++) {
+        row.clear();
+        for(int r = aptr[c]; r < aptr[c + 1]; r++) {
+          const int i = arows[r];
+          for(INDEX_TYPE k = jptr[i]; k < jptr[i + 1]; k++)
+            row.push_back(std::make_pair(agg[ai[k]], a[k]));
+        }
+        std::sort(row.begin(), row.end(),
+                  [](const std::pair<int, double> &x,
+                     const std::pair<int, double> &y) {
+                    return x.first < y.first;
+                  });
+        INDEX_TYPE m = 0;
+        for(std::size_t k = 0; k < row.size(); k++) {
+          if(k && row[k].first == row[k - 1].first) {
+            if(pass) ca[cjptr[c] + m - 1] += row[k].second;
+            continue;
+          }
+          if(pass) {
+            cai[cjptr[c] + m] = row[k].first;
+            ca[cjptr[c] + m] = row[k].second;
+          }
+          m++;
+        }
+        if(!pass) cjptr[c + 1] = m;
+      }
+    }
+    if(!pass) {
+      for(int c = 0; c < nc; c++) cjptr[c + 1] += cjptr[c];
+      cai.resize(cjptr[nc]);
+      ca.resize(cjptr[nc]);
+    }
+  }
+}
+
+// in-place dense LU factorization with partial pivoting (row-major)
+static void denseLU(int n, std::vector<double> &m, std::vector<int> &piv)
+{
+  piv.resize(n);
+  double norm = 0.;
+  for(std::size_t k = 0; k < m.size(); k++)
+    norm = std::max(norm, std::abs(m[k]));
+  for(int k = 0; k < n; k++) {
+    int p = k;
+    for(int i = k + 1; i < n; i++)
+      if(std::abs(m[i * n + k]) > std::abs(m[p * n + k])) p = i;
+    piv[k] = p;
+    if(p != k)
+      for(int j = 0; j < n; j++) std::swap(m[k * n + j], m[p * n + j]);
+    // singular matrices (e.g. pure Neumann problems): regularize the pivot
+    if(std::abs(m[k * n + k]) <= 1e-14 * norm)
+      m[k * n + k] = (norm > 0.) ? norm : 1.;
+    const double inv = 1. / m[k * n + k];
+    for(int i = k + 1; i < n; i++) {
+      const double f = (m[i * n + k] *= inv);
+      if(f == 0.) continue;
+      for(int j = k + 1; j < n; j++) m[i * n + j] -= f * m[k * n + j];
+    }
+  }
+}
+
+static void denseLUSolve(int n, const std::vector<double> &m,
+                         const std::vector<int> &piv, double *x)
+{
+  for(int k = 0; k < n; k++) {
+    if(piv[k] != k) std::swap(x[k], x[piv[k]]);
+    for(int i = k + 1; i < n; i++) x[i] -= m[i * n + k] * x[k];
+  }
+  for(int i = n - 1; i >= 0; i--) {
+    double s = x[i];
+    for(int j = i + 1; j < n; j++) s -= m[i * n + j] * x[j];
+    x[i] = s / m[i * n + i];
+  }
+}
+
+void linearSystemCSRIterative<double>::_buildAMG()
+{
+  const int maxCoarseSize = 500, maxNumLevels = 20;
+  _levels.clear();
+  _coarseLU.clear();
+  _levels.push_back(level());
+  _levels[0].n = _n;
+  for(std::size_t l = 0;; l++) {
+    level &L = _levels[l];
+    const int n = L.n;
+    const INDEX_TYPE *jptr = l ? &L.jptr[0] : _rowStart;
+    const INDEX_TYPE *ai = l ? &L.ai[0] : _colIndex;
+    const double *a = l ? &L.a[0] : _values;
+    inverseDiagonal(n, jptr, ai, a, L.invDiag);
+    L.r.resize(n);
+    if(l) {
+      L.b.resize(n);
+      L.x.resize(n);
+    }
+    if(n <= maxCoarseSize) {
+      // direct solve on the coarsest level
+      _coarseLU.assign((std::size_t)n * n, 0.);
+      for(int i = 0; i < n; i++)
+        for(INDEX_TYPE k = jptr[i]; k < jptr[i + 1]; k++)
+          _coarseLU[(std::size_t)i * n + ai[k]] += a[k];
+      denseLU(n, _coarseLU, _coarsePiv);
+      break;
+    }
+    if(l + 1 == (std::size_t)maxNumLevels) break;
+    std::vector<int> agg;
+    const int nc = aggregate(n, jptr, ai, a, agg);
+    // stop if the coarsening stalls: the last level is then only smoothed
+    if(nc > 0.9 * n) break;
+    L.agg.swap(agg);
+    L.aptr.assign(nc + 1, 0);
+    L.arows.resize(n);
+    for(int i = 0; i < n; i++) L.aptr[L.agg[i] + 1]++;
+    for(int c = 0; c < nc; c++) L.aptr[c + 1] += L.aptr[c];
+    std::vector<int> pos(L.aptr.begin(), L.aptr.end() - 1);
+    for(int i = 0; i < n; i++) L.arows[pos[L.agg[i]]++] = i;
+    level C;
+    C.n = nc;
+    coarseMatrix(jptr, ai, a, L.agg, L.aptr, L.arows, nc, C.jptr, C.ai, C.a);
+    _levels.push_back(level());
+    _levels.back().n = nc;
+    _levels.back().jptr.swap(C.jptr);
+    _levels.back().ai.swap(C.ai);
+    _levels.back().a.swap(C.a);
+  }
+  Msg::Debug("AMG preconditioner: %d levels, %d unknowns on the coarsest",
+             (int)_levels.size(), _levels.back().n);
+}
+
+void linearSystemCSRIterative<double>::_vCycle(std::size_t l, const double *b,
+                                               double *x)
+{
+  level &L = _levels[l];
+  const int n = L.n;
+  const INDEX_TYPE *jptr = l ? &L.jptr[0] : _rowStart;
+  const INDEX_TYPE *ai = l ? &L.ai[0] : _colIndex;
+  const double *a = l ? &L.a[0] : _values;
+  const bool coarsest = (l + 1 == _levels.size());
+  if(coarsest && !_coarseLU.empty()) {
+    std::copy(b, b + n, x);
+    denseLUSolve(n, _coarseLU, _coarsePiv, x);
+    return;
+  }
+
+  // damped Jacobi smoothing, from x = 0
+  const double omega = 2. / 3.;
+  const int numSweeps = coarsest ? 10 : 2;
+  const int nthreads = numThreads(n);
+  double *r = &L.r[0];
+  const double *invDiag = &L.invDiag[0];
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+  for(int i = 0; i < n; i++) x[i] = omega * invDiag[i] * b[i];
+  for(int s = 1; s < numSweeps; s++) {
+    residual(n, jptr, ai, a, x, b, r);
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+    for(int i = 0; i < n; i++) x[i] += omega * invDiag[i] * r[i];
+  }
+  if(coarsest) return;
+
+  // coarse grid correction
+  level &C = _levels[l + 1];
+  residual(n, jptr, ai, a, x, b, r);
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+  for(int c = 0; c < C.n; c++) {
+    double s = 0.;
+    for(int k = L.aptr[c]; k < L.aptr[c + 1]; k++) s += r[L.arows[k]];
+    C.b[c] = s;
+  }
+  _vCycle(l + 1, &C.b[0], &C.x[0]);
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+  for(int i = 0; i < n; i++) x[i] += C.x[L.agg[i]];
+
+  // post-smoothing
+  for(int s = 0; s < numSweeps; s++) {
+    residual(n, jptr, ai, a, x, b, r);
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+    for(int i = 0; i < n; i++) x[i] += omega * invDiag[i] * r[i];
+  }
+}
+
+void linearSystemCSRIterative<double>::_buildPreconditioner()
+{
+  switch(_prec) {
+  case CSRIterativeJacobi:
+    inverseDiagonal(_n, _rowStart, _colIndex, _values, _invDiag);
+    break;
+  case CSRIterativeILU0: _buildILU0(); break;
+  case CSRIterativeAMG: _buildAMG(); break;
+  default: break;
+  }
+  _precBuilt = true;
+}
+
+void linearSystemCSRIterative<double>::_applyPreconditioner(const double *r,
+                                                            double *z)
+{
+  switch(_prec) {
+  case CSRIterativeJacobi:
+#pragma omp parallel for schedule(static) num_threads(numThreads(_n))
+    for(int i = 0; i < _n; i++) z[i] = _invDiag[i] * r[i];
+    break;
+  case CSRIterativeILU0: _solveILU0(r, z); break;
+  case CSRIterativeAMG: _vCycle(0, r, z); break;
+  default: std::copy(r, r + _n, z); break;
+  }
+}
+
+int linearSystemCSRIterative<double>::_solveCG(double *x, const double *b)
+{
+  const int n = _n;
+  const int nthreads = numThreads(n);
+  std::vector<double> r(n), z(n), p(n), q(n);
+  const double bnorm = std::sqrt(dot(n, b, b));
+  if(bnorm == 0.) {
+    std::fill(x, x + n, 0.);
+    _res = 0.;
+    return 1;
+  }
+  residual(n, _rowStart, _colIndex, _values, x, b, &r[0]);
+  _res = std::sqrt(dot(n, &r[0], &r[0])) / bnorm;
+  if(_res < _tol) return 1;
+  _applyPreconditioner(&r[0], &z[0]);
+  p = z;
+  double rz = dot(n, &r[0], &z[0]);
+  for(_numIter = 1; _numIter <= _maxIter; _numIter++) {
+    spmv(n, _rowStart, _colIndex, _values, &p[0], &q[0]);
+    const double pq = dot(n, &p[0], &q[0]);
+    if(pq == 0.) return 0;
+    const double alpha = rz / pq;
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+    for(int i = 0; i < n; i++) {
+      x[i] += alpha * p[i];
+      r[i] -= alpha * q[i];
+    }
+    _res = std::sqrt(dot(n, &r[0], &r[0])) / bnorm;
+    if(_noisy) Msg::Info("CG iteration %d: residual %g", _numIter, _res);
+    if(_res < _tol) return 1;
+    _applyPreconditioner(&r[0], &z[0]);
+    const double rzNew = dot(n, &r[0], &z[0]);
+    const double beta = rzNew / rz;
+    rz = rzNew;
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+    for(int i = 0; i < n; i++) p[i] = z[i] + beta * p[i];
+  }
+  return 0;
+}
+
+int linearSystemCSRIterative<double>::_solveBiCGStab(double *x,
+                                                     const double *b)
+{
+  const int n = _n;
+  const int nthreads = numThreads(n);
+  std::vector<double> r(n), rhat(n), p(n, 0.), v(n, 0.), phat(n), s(n),
+    shat(n), t(n);
+  const double bnorm = std::sqrt(dot(n, b, b));
+  if(bnorm == 0.) {
+    std::fill(x, x + n, 0.);
+    _res = 0.;
+    return 1;
+  }
+  residual(n, _rowStart, _colIndex, _values, x, b, &r[0]);
+  _res = std::sqrt(dot(n, &r[0], &r[0])) / bnorm;
+  if(_res < _tol) return 1;
+  rhat = r;
+  double rho = 1., alpha = 1., omega = 1.;
+  for(_numIter = 1; _numIter <= _maxIter; _numIter++) {
+    const double rhoNew = dot(n, &rhat[0], &r[0]);
+    if(rhoNew == 0.) return 0;
+    const double beta = (rhoNew / rho) * (alpha / omega);
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+    for(int i = 0; i < n; i++) p[i] = r[i] + beta * (p[i] - omega * v[i]);
+    _applyPreconditioner(&p[0], &phat[0]);
+    spmv(n, _rowStart, _colIndex, _values, &phat[0], &v[0]);
+    const double rv = dot(n, &rhat[0], &v[0]);
+    if(rv == 0.) return 0;
+    alpha = rhoNew / rv;
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+    for(int i = 0; i < n; i++) s[i] = r[i] - alpha * v[i];
+    _res = std::sqrt(dot(n, &s[0], &s[0])) / bnorm;
+    if(_res < _tol) {
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+      for(int i = 0; i < n; i++) x[i] += alpha * phat[i];
+      return 1;
+    }
+    _applyPreconditioner(&s[0], &shat[0]);
+    spmv(n, _rowStart, _colIndex, _values, &shat[0], &t[0]);
+    const double tt = dot(n, &t[0], &t[0]);
+    omega = (tt != 0.) ? dot(n, &t[0], &s[0]) / tt : 0.;
+#pragma omp parallel for schedule(static) num_threads(nthreads)
+    for(int i = 0; i < n; i++) {
+      x[i] += alpha * phat[i] + omega * shat[i];
+      r[i] = s[i] - omega * t[i];
+    }
+    _res = std::sqrt(dot(n, &r[0], &r[0])) / bnorm;
+    if(_noisy) Msg::Info("BiCGStab iteration %d: residual %g", _numIter, _res);
+    if(_res < _tol) return 1;
+    if(omega == 0.) return 0;
+    rho = rhoNew;
+  }
+  return 0;
+}
+
+int linearSystemCSRIterative<double>::systemSolve()
+{
+  if(!isAllocated() || !_b->size()) return 0;
+  _getMatrix();
+  if(!_precBuilt) _buildPreconditioner();
+  _numIter = 0;
+  if(_method == CSRIterativeCG ? _solveCG(&(*_x)[0], &(*_b)[0]) :
+                                 _solveBiCGStab(&(*_x)[0], &(*_b)[0]))
+    Msg::Debug("Iterative linear solver converged in %d iterations "
+               "(res = %g)", _numIter, _res);
+  else
+    Msg::Warning("Iterative linear solver has not converged (res = %g)",
+                 _res);
+  return 1;
+}
@@ -0,0 +1,136 @@
+// Gmsh - Copyright (C) 1997-2024 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#ifndef LINEAR_SYSTEM_CSR_ITERATIVE_H
+#define LINEAR_SYSTEM_CSR_ITERATIVE_H
+
+// Multithreaded iterative solvers for linear systems stored in CSR format,
+// without external dependencies
+
+#include <vector>
+#include "linearSystemCSR.h"
+
+enum linearSystemCSRIterativeMethod { CSRIterativeCG, CSRIterativeBiCGStab };
+
+enum linearSystemCSRIterativePreconditioner {
+  CSRIterativeNone,
+  CSRIterativeJacobi,
+  // incomplete LU factorization without fill-in
+  CSRIterativeILU0,
+  // multigrid V-cycle on a hierarchy of aggregated (unsmoothed) matrices
+  CSRIterativeAMG
+};
+
+template <class scalar>
+class linearSystemCSRIterative : public linearSystemCSR<scalar> {
+public:
+  linearSystemCSRIterative(
+    linearSystemCSRIterativeMethod method = CSRIterativeBiCGStab,
+    linearSystemCSRIterativePreconditioner prec = CSRIterativeILU0,
+    double tol = 1e-8, int maxIter = 1000)
+  {
+  }
+  virtual int systemSolve()
+  {
+    Msg::Error("Iterative CSR solver not implemented for this scalar type");
+    return 0;
+  }
+};
+
+// The matrix-vector products, the vector operations and the application of
+// the preconditioners are threaded (the ILU(0) factorization and triangular
+// solves by level scheduling). The preconditioner is built at the first solve
+// and kept for the next ones; it is rebuilt when the matrix is reallocated or
+// cleared with zeroMatrix(), unless reusePreconditioner() is set: with the
+// same sparsity pattern, e.g. in nonlinear or transient loops, the previous
+// preconditioner is then reused with the new values (call
+// rebuildPreconditioner() to force an update). The current solution is used
+// as initial guess.
+template <>
+class linearSystemCSRIterative<double> : public linearSystemCSR<double> {
+private:
+  struct level {
+    int n;
+    std::vector<INDEX_TYPE> jptr, ai;
+    std::vector<double> a, invDiag;
+    // aggregate (coarse unknown) of each unknown, and unknowns of each
+    // aggregate
+    std::vector<int> agg, aptr, arows;
+    // work vectors
+    std::vector<double> b, x, r;
+  };
+  linearSystemCSRIterativeMethod _method;
+  linearSystemCSRIterativePreconditioner _prec;
+  double _tol;
+  int _maxIter, _noisy;
+  bool _reuse, _precBuilt;
+  int _numIter;
+  double _res;
+  // matrix (sorted CSR arrays of the linear system), diagonal positions
+  int _n;
+  INDEX_TYPE *_rowStart, *_colIndex;
+  double *_values;
+  std::vector<INDEX_TYPE> _diag;
+  // Jacobi: inverse of the diagonal
+  std::vector<double> _invDiag;
+  // ILU(0): factors (with the same pattern as the matrix, and the inverse of
+  // the diagonal of U), and rows grouped by levels for the lower and upper
+  // triangular solves
+  std::vector<double> _lu, _luInvDiag;
+  std::vector<int> _lowerLevels, _lowerRows, _upperLevels, _upperRows;
+  bool _iluParallel;
+  // AMG: coarse levels, and LU factors of the coarsest matrix
+  std::vector<level> _levels;
+  std::vector<double> _coarseLU;
+  std::vector<int> _coarsePiv;
+  void _getMatrix();
+  void _buildPreconditioner();
+  void _buildILU0();
+  void _buildAMG();
+  void _applyPreconditioner(const double *r, double *z);
+  void _solveILU0(const double *r, double *z);
+  void _vCycle(std::size_t l, const double *b, double *x);
+  int _solveCG(double *x, const double *b);
+  int _solveBiCGStab(double *x, const double *b);
+
+public:
+  linearSystemCSRIterative(
+    linearSystemCSRIterativeMethod method = CSRIterativeBiCGStab,
+    linearSystemCSRIterativePreconditioner prec = CSRIterativeILU0,
+    double tol = 1e-8, int maxIter = 1000)
+    : _method(method), _prec(prec), _tol(tol), _maxIter(maxIter), _noisy(0),
+      _reuse(false), _precBuilt(false), _numIter(0), _res(0.), _n(0),
+      _rowStart(nullptr), _colIndex(nullptr), _values(nullptr),
+      _iluParallel(false)
+  {
+  }
+  virtual ~linearSystemCSRIterative() {}
+  void setMethod(linearSystemCSRIterativeMethod method) { _method = method; }
+  void setPreconditioner(linearSystemCSRIterativePreconditioner prec)
+  {
+    _prec = prec;
+    _precBuilt = false;
+  }
+  void setTolerance(double tol) { _tol = tol; }
+  void setMaxIterations(int maxIter) { _maxIter = maxIter; }
+  void setNoisy(int n) { _noisy = n; }
+  void reusePreconditioner(bool reuse) { _reuse = reuse; }
+  void rebuildPreconditioner() { _precBuilt = false; }
+  int getNumIterations() const { return _numIter; }
+  double getResidual() const { return _res; }
+  virtual void allocate(int nbRows)
+  {
+    _precBuilt = false;
+    linearSystemCSR<double>::allocate(nbRows);
+  }
+  virtual void zeroMatrix()
+  {
+    if(!_reuse) _precBuilt = false;
+    linearSystemCSR<double>::zeroMatrix();
+  }
+  virtual int systemSolve();
+};
+
+#endif
@@ -9,7 +9,11 @@
 
 #if defined(HAVE_EIGEN)
 
-linearSystemEigen<double>::linearSystemEigen() { solverType = EigenSparseLU; }
+linearSystemEigen<double>::linearSystemEigen()
+{
+  solverType = EigenSparseLU;
+  tolerance = 0.;
+}
 
 bool linearSystemEigen<double>::isAllocated() const
 {
@@ -109,14 +113,21 @@ int linearSystemEigen<double>::systemSolve()
     }
   }
   else if(solverType == EigenCG) {
-    Eigen::ConjugateGradient<Eigen::SparseMatrix<double> > solver;
-    solver.compute(A);
+    // row-major copy with both triangles: the matrix-vector products are
+    // multithreaded by Eigen; the current solution is used as initial guess
+    Eigen::SparseMatrix<double, Eigen::RowMajor> Ar = A;
+    Eigen::ConjugateGradient<Eigen::SparseMatrix<double, Eigen::RowMajor>,
+                             Eigen::Lower | Eigen::Upper>
+      solver;
+    if(tolerance > 0.) solver.setTolerance(tolerance);
+    solver.compute(Ar);
     if(solver.info() != Eigen::ComputationInfo::Success) {
       Msg::Warning(
         "Eigen: failed to solve linear system with Conjugate Gradient");
       return -1;
     }
-    X = solver.solve(B);
+    if(X.size() != B.size()) X = Eigen::VectorXd::Zero(B.size());
+    X = solver.solveWithGuess(B, Eigen::VectorXd(X));
     if(solver.info() != Eigen::ComputationInfo::Success) {
       Msg::Warning(
         "Eigen: failed to solve linear system with Conjugate Gradient");
@@ -139,13 +150,16 @@ int linearSystemEigen<double>::systemSolve()
     }
   }
   else if(solverType == EigenBiCGSTAB) {
-    Eigen::BiCGSTAB<Eigen::SparseMatrix<double> > solver;
-    solver.compute(A);
+    Eigen::SparseMatrix<double, Eigen::RowMajor> Ar = A;
+    Eigen::BiCGSTAB<Eigen::SparseMatrix<double, Eigen::RowMajor> > solver;
+    if(tolerance > 0.) solver.setTolerance(tolerance);
+    solver.compute(Ar);
     if(solver.info() != Eigen::ComputationInfo::Success) {
       Msg::Warning("Eigen: failed to solve linear system with BiCGSTAB");
       return -1;
     }
-    X = solver.solve(B);
+    if(X.size() != B.size()) X = Eigen::VectorXd::Zero(B.size());
+    X = solver.solveWithGuess(B, Eigen::VectorXd(X));
     if(solver.info() != Eigen::ComputationInfo::Success) {
       Msg::Warning("Eigen: failed to solve linear system with BiCGSTAB");
       return -1;
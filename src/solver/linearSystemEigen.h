@@ -60,11 +60,14 @@ private:
   Eigen::VectorXd B;
   Eigen::SparseMatrix<double> A;
   linearSystemEigenSolver solverType;
+  double tolerance;
 
 public:
   linearSystemEigen();
 
   void setSolverType(linearSystemEigenSolver solverName);
+  // relative tolerance of the iterative solvers (Eigen default if <= 0)
+  void setTolerance(double tol) { tolerance = tol; }
 
   virtual bool isAllocated() const;
   virtual void allocate(int nbRows);
@@ -10,6 +10,7 @@
 #ifndef SOLVERALGORITHMS_H
 #define SOLVERALGORITHMS_H
 
+#include <set>
 #include "dofManager.h"
 #include "terms.h"
 #include "quadratureRules.h"
@@ -34,6 +35,98 @@ void Assemble(BilinearTermBase &term, FunctionSpaceBase &space,
   }
 }
 
+// insert the entries of a symmetric term in the sparsity pattern (all at
+// once: the pattern is frozen afterwards, see dofManager::sparsityDofs())
+template <class Iterator, class Assembler>
+void SparsityDofs(FunctionSpaceBase &space, Iterator itbegin, Iterator itend,
+                  Assembler &assembler)
+{
+  std::vector<MElement *> elements(itbegin, itend);
+  assembler.sparsityDofs(
+    elements.size(),
+    [&](std::size_t i, std::vector<Dof> &R) { space.getKeys(elements[i], R); });
+}
+
+// same as Assemble(), but with elements assembled concurrently: elements are
+// colored so that elements with the same color do not share any unknown, and
+// the elements of each color are assembled in parallel. All the entries of
+// the matrix must have been inserted in the sparsity pattern (see
+// SparsityDofs()) before the first call; the serial version is used if the
+// assembler does not allow concurrent assembly.
+template <class Iterator, class Assembler>
+void AssembleColored(BilinearTermBase &term, FunctionSpaceBase &space,
+                     Iterator itbegin, Iterator itend,
+                     QuadratureBase &integrator, Assembler &assembler)
+{
+  int nthreads = Msg::GetMaxThreads();
+  if(nthreads > 1) {
+    assembler.preAllocateEntries();
+    if(!assembler.allowsConcurrentAssembly()) nthreads = 1;
+  }
+  if(nthreads == 1) {
+    Assemble(term, space, itbegin, itend, integrator, assembler);
+    return;
+  }
+
+  std::vector<MElement *> elements;
+  std::set<int> types;
+  fullMatrix<typename Assembler::dataMat> m;
+  for(Iterator it = itbegin; it != itend; ++it) {
+    MElement *e = *it;
+    elements.push_back(e);
+    // make sure the integration rules and the shape functions are tabulated
+    // before the parallel loop
+    if(types.insert(e->getTypeForMSH()).second) {
+      IntPt *GP;
+      int npts = integrator.getIntPoints(e, &GP);
+      term.get(e, npts, GP, m);
+    }
+  }
+  std::vector<int> colors;
+  std::vector<Dof> R;
+  int numColors = dofManagerBase::colorElements(
+    elements.size(),
+    [&](std::size_t i, std::vector<int> &nums) {
+      R.clear();
+      space.getKeys(elements[i], R);
+      for(std::size_t j = 0; j < R.size(); j++)
+        nums.push_back(assembler.getDofNumber(R[j]));
+    },
+    colors);
+
+  // elements sorted by color
+  std::vector<std::size_t> colorStart(numColors + 1, 0);
+  for(std::size_t i = 0; i < elements.size(); i++) colorStart[colors[i] + 1]++;
+  for(int c = 0; c < numColors; c++) colorStart[c + 1] += colorStart[c];
+  std::vector<MElement *> sorted(elements.size());
+  std::vector<std::size_t> pos(colorStart.begin(), colorStart.end() - 1);
+  for(std::size_t i = 0; i < elements.size(); i++)
+    sorted[pos[colors[i]]++] = elements[i];
+
+  Msg::Debug("Assembling %lu elements with %d colors on %d threads",
+             elements.size(), numColors, nthreads);
+
+#pragma omp parallel num_threads(nthreads)
+  {
+    BilinearTermBase *t = term.clone();
+    fullMatrix<typename Assembler::dataMat> localMatrix;
+    std::vector<Dof> keys;
+    for(int c = 0; c < numColors; c++) {
+#pragma omp for schedule(dynamic, 64)
+      for(std::size_t i = colorStart[c]; i < colorStart[c + 1]; i++) {
+        MElement *e = sorted[i];
+        keys.clear();
+        IntPt *GPe;
+        int npts = integrator.getIntPoints(e, &GPe);
+        t->get(e, npts, GPe, localMatrix);
+        space.getKeys(e, keys);
+        assembler.assemble(keys, localMatrix);
+      }
+    }
+    delete t;
+  }
+}
+
 template <class Iterator, class Assembler>
 void Assemble(BilinearTermBase &term, FunctionSpaceBase &space,
               Iterator itbegin, Iterator itend, QuadratureBase &integrator,
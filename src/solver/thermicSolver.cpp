@@ -7,6 +7,7 @@
 #include "GmshConfig.h"
 #include "thermicSolver.h"
 #include "linearSystemCSR.h"
+#include "linearSystemCSRIterative.h"
 #include "linearSystemPETSc.h"
 #include "linearSystemFull.h"
 #include "Numeric.h"
@@ -46,7 +47,14 @@ void thermicSolver::solve()
   lsys->setGmres(1);
   lsys->setNoisy(1);
 #else
-  linearSystemFull<double> *lsys = new linearSystemFull<double>;
+  // the Lagrange multipliers lead to an indefinite (saddle point) system,
+  // which the conjugate gradient cannot solve
+  linearSystem<double> *lsys;
+  if(LagrangeMultiplierFields.empty())
+    lsys =
+      new linearSystemCSRIterative<double>(CSRIterativeCG, CSRIterativeAMG);
+  else
+    lsys = new linearSystemFull<double>;
 #endif
   assemble(lsys);
   lsys->systemSolve();
@@ -168,11 +176,26 @@ void thermicSolver::assemble(linearSystem<double> *lsys)
   }
   // Assemble thermic term
   GaussQuadrature Integ_Bulk(GaussQuadrature::ValVal);
+  // without Lagrange multipliers the thermic terms are the only matrix terms:
+  // insert them all in the sparsity pattern, so that the elements can be
+  // assembled concurrently
+  const bool colored = LagrangeMultiplierFields.empty();
+  if(colored) {
+    std::vector<MElement *> bulk;
+    for(std::size_t i = 0; i < thermicFields.size(); i++)
+      bulk.insert(bulk.end(), thermicFields[i].g->begin(),
+                  thermicFields[i].g->end());
+    SparsityDofs(*LagSpace, bulk.begin(), bulk.end(), *pAssembler);
+  }
   for(std::size_t i = 0; i < thermicFields.size(); i++) {
     printf("Thermic Term\n");
     LaplaceTerm<double, double> Tterm(*LagSpace, thermicFields[i]._k);
-    Assemble(Tterm, *LagSpace, thermicFields[i].g->begin(),
-             thermicFields[i].g->end(), Integ_Bulk, *pAssembler);
+    if(colored)
+      AssembleColored(Tterm, *LagSpace, thermicFields[i].g->begin(),
+                      thermicFields[i].g->end(), Integ_Bulk, *pAssembler);
+    else
+      Assemble(Tterm, *LagSpace, thermicFields[i].g->begin(),
+               thermicFields[i].g->end(), Integ_Bulk, *pAssembler);
   }
 
   /*for (int i = 0;i<pAssembler->sizeOfR();i++){